@@ -0,0 +1,52 @@
+/*
+ * adcSampler.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+
+#ifndef ADCSAMPLER_H_
+#define ADCSAMPLER_H_
+
+/*******************************************************************************
+ * INCLUDED HEADER FILES
+ ******************************************************************************/
+#include "Arduino.h"
+#include "fanControlUtils.h"
+
+/*******************************************************************************
+ * MACRO DEFINITIONS
+ ******************************************************************************/
+#define ADC_SAMPLES_PER_READING ( 1 << ( 2 * ADC_OVERSAMPLE_BITS ) )                                            // number of 10-bit samples summed for each oversampled reading (4 to the power of ADC_OVERSAMPLE_BITS)
+#define ADC_CSRA_RUN            ( _BV ( ADEN ) | _BV ( ADIE ) | _BV ( ADPS2 ) | _BV ( ADPS1 ) | _BV ( ADPS0 ) ) // ADCSRA value while sampling: enabled, interrupt on, clock prescaled by 128 (125 kHz, about 104 us per conversion)
+
+#if ADC_OVERSAMPLE_BITS > 3
+#error "ADC_OVERSAMPLE_BITS above 3 would overflow the unsigned int sample sums"
+#endif
+
+/*******************************************************************************
+ * TYPE DEFINITIONS
+ ******************************************************************************/
+/* Analog channels sampled, in the order they are converted */
+typedef enum ADC_CHAN_ENUM
+{
+  ADC_TEMP1,    // temperature sensor 1 (TEMP1PIN)
+  ADC_TEMP2,    // temperature sensor 2 (TEMP2PIN)
+  ADC_NUM_CHANS // number of channels sampled
+} ADC_CHAN_ENUM_TYPE;
+
+/* Running total of the oversampled readings of one channel, published by the
+ * ADC interrupt.  Both fields just wrap, so the main loop works from the
+ * difference since its last look. */
+typedef struct ADC_TOTAL {
+  unsigned long sum; // sum of all readings
+  unsigned int  cnt; // number of readings
+} ADC_TOTAL_TYPE;
+
+/*******************************************************************************
+ * FUNCTION DECLARATIONS
+ ******************************************************************************/
+void adcSamplerInit ( void );                                           // starts converting the analog channels in turn, from the ADC interrupt
+byte adcSamplerRead ( ADC_CHAN_ENUM_TYPE chan, unsigned int *reading ); // gets the mean reading of a channel since the last call, returning high if there was one
+
+#endif /* ADCSAMPLER_H_ */
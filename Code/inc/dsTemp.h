@@ -0,0 +1,36 @@
+/*
+ * dsTemp.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+
+#ifndef DSTEMP_H_
+#define DSTEMP_H_
+
+/*******************************************************************************
+ * INCLUDED HEADER FILES
+ ******************************************************************************/
+#include "Arduino.h"
+#include "fanControlUtils.h"
+#include "taskSched.h"
+
+/*******************************************************************************
+ * MACRO DEFINITIONS
+ ******************************************************************************/
+#define DS_MAX_DEVS    2                                                    // largest number of DS18B20 sensors used (TMPSRC_OW1, TMPSRC_OW2)
+#define DS_CONV_US     750000UL                                             // longest 12-bit temperature conversion time (us)
+#define DS_STEP_US     ( (unsigned long) OW_TICKS * SYSTICK_US )            // time between each step of the read cycle (us)
+#define DS_CONV_STEPS  ( ( DS_CONV_US + DS_STEP_US - 1 ) / DS_STEP_US + 1 ) // steps of the read cycle to wait for a conversion (rounded up, plus one for the partial first step)
+#define DS_STALE_CONVS 3                                                    // number of conversions in a row a sensor can miss before it is faulted
+#define DS_BYTES_STEP  2                                                    // largest number of bytes sent or received on the bus in one step (each takes about 0.56 ms)
+
+/*******************************************************************************
+ * FUNCTION DECLARATIONS
+ ******************************************************************************/
+void         dsTempInit ( void );      // finds the DS18B20 sensors on the 1-Wire bus
+void         dsTempStep ( void );      // runs the next step of the read cycle, once every OW_TICKS scheduler ticks
+unsigned int dsTempRead ( byte dev );  // returns the last good temperature of a sensor, stored digitally (0-TEMP_DIG_MAX)
+byte         dsTempFault ( byte dev ); // returns high if a sensor is missing or its reading is stale
+
+#endif /* DSTEMP_H_ */
@@ -0,0 +1,57 @@
+/*
+ * dutyMap.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+
+#ifndef DUTYMAP_H_
+#define DUTYMAP_H_
+
+/*******************************************************************************
+ * INCLUDED HEADER FILES
+ ******************************************************************************/
+#include "Arduino.h"
+#include "fanControlUtils.h"
+
+/*******************************************************************************
+ * MACRO DEFINITIONS
+ ******************************************************************************/
+#define DMAP_WIN_MS      1000                                                                // length of the window averaged into each sample (milliseconds)
+#define DMAP_WIN_LOOPS   ( (byte) ( (unsigned long) DMAP_WIN_MS * 1000UL / LOOPTIME_US ) ) // number of control loops averaged into each sample
+#define DMAP_BAND_SHIFT  5                                                                   // speed error allowed while steady, as a right shift of the reference (about 3%)
+#define DMAP_FORGET_BITS 6                                                                   // forgetting factor of the fit is 1 - 2^-DMAP_FORGET_BITS (remembers about 64 samples)
+#define DMAP_FRAC_BITS   6                                                                   // fraction bits of the running means
+#define DMAP_DX_BITS     2                                                                   // speed deviations are squared in units of 1 << DMAP_DX_BITS rpm, to fit a long
+#define DMAP_SLOPE_BITS  13                                                                  // fraction bits of the map slope (quarter duty counts per rpm)
+#define DMAP_MIN_SPREAD  100                                                                 // least standard deviation of the sample speeds for which the slope is fitted (rpm)
+#define DMAP_SAVE_S      3600UL                                                              // least time between saves of a learned map to EEPROM (seconds)
+
+/*******************************************************************************
+ * TYPE DEFINITIONS
+ ******************************************************************************/
+/* Steady-state duty map learner of one fan, kept by the main loop.  The map
+ * itself lives in the fan's saved variables (dmapNOfs, dmapNSlope), so it is
+ * loaded at start-up and can be read or set like any other setting.  Starts
+ * out zeroed, and the first sample starts the fit. */
+typedef struct DUTY_MAP {
+  long int      mx;      // running mean speed of the samples (rpm << DMAP_FRAC_BITS)
+  long int      my;      // running mean duty of the samples (quarter duty counts << DMAP_FRAC_BITS)
+  long int      vxx;     // running variance of the sample speeds ((1 << DMAP_DX_BITS) rpm, squared)
+  long int      vxy;     // running covariance of the sample speeds and duties (rpm times quarter duty counts)
+  unsigned long sumRpm;  // sum of the speeds over the current window (rpm)
+  unsigned int  sumDuty; // sum of the duties over the current window (duty counts)
+  unsigned int  ref;     // speed reference at the start of the current window (rpm)
+  byte          loops;   // control loops into the current window
+  byte          settled; // high once a whole window has been steady, so the windows after it are samples
+  byte          samples; // number of samples fitted (saturates at 1 << DMAP_FORGET_BITS)
+  byte          changed; // high if the map has changed since it was last saved
+} DUTY_MAP_TYPE;
+
+/*******************************************************************************
+ * FUNCTION DECLARATIONS
+ ******************************************************************************/
+void dutyMapLearn ( DUTY_MAP_TYPE *map, unsigned int ref, unsigned int rpm, byte duty, int *ofs, int *slope ); // fits the duty map of a fan to its steady-state speeds and duties
+int  dutyMapEval ( int ofs, int slope, unsigned int rpm );                                                    // returns the duty feedforward at a speed (quarter duty counts)
+
+#endif /* DUTYMAP_H_ */
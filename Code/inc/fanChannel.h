@@ -0,0 +1,132 @@
+/*
+ * fanChannel.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+
+#ifndef FANCHANNEL_H_
+#define FANCHANNEL_H_
+
+/*******************************************************************************
+ * INCLUDED HEADER FILES
+ ******************************************************************************/
+#include "Arduino.h"
+#include "fanControlUtils.h"
+#include "hallRing.h"
+#include "fanMonitor.h"
+#include "piController.h"
+#include "fanCurve.h"
+#include "refShape.h"
+#include "feedFwd.h"
+#include "tempFuse.h"
+#include "dutyMap.h"
+#include <avr/pgmspace.h>
+
+/*******************************************************************************
+ * MACRO DEFINITIONS
+ ******************************************************************************/
+#define FAN_TBL_PTS 4 // number of points in each fan speed-temp lookup table
+
+#if FAN_TBL_PTS + 1 > FAN_CURVE_MAX_PTS
+#error "The turn-on point and lookup table must fit in a fan curve"
+#endif
+
+#define FAN_CFG_U( chan, field ) \
+  /* Pointer to an unsigned saved setting of a fan channel, from the settings table in flash */ \
+  ( (unsigned int *) pgm_read_word ( &fanCfgTbl [ chan ].field ) )
+#define FAN_CFG_S( chan, field ) \
+  /* Pointer to a signed saved setting of a fan channel, from the settings table in flash */ \
+  ( (int *) pgm_read_word ( &fanCfgTbl [ chan ].field ) )
+
+/*******************************************************************************
+ * TYPE DEFINITIONS
+ ******************************************************************************/
+/* Settings of one fan channel, kept in flash.  The saved settings stay in
+ * their own saved variables (so the EEPROM layout is unchanged), and the
+ * table just points to them, so code can reach them by channel number. */
+typedef struct FAN_CFG {
+  unsigned int  *minRpm;                    // minimum speed setpoint (rpm)
+  unsigned int  *maxRpm;                    // maximum speed setpoint (rpm)
+  unsigned int  *filt;                      // speed filter gain (0-1023)
+  unsigned int  *tmpsrc;                    // temperature source (TMPSRC_xxx)
+  unsigned int  *turnOffTmp;                // raw temperature at which the fan turns off
+  unsigned int  *turnOnTmp;                 // raw temperature at which the fan turns on (at minRpm)
+  unsigned int  *tblTmp [ FAN_TBL_PTS ];    // raw temperatures of the lookup table points
+  unsigned int  *tblSpd [ FAN_TBL_PTS ];    // speeds of the lookup table points (rpm)
+  int           *kp;                        // PI controller proportional gain
+  int           *ki;                        // PI controller integral gain
+  int           *imax;                      // PI controller integrator max limit
+  int           *imin;                      // PI controller integrator min limit
+  unsigned int  *failsafeRpm;               // speed setpoint while a temperature sensor used is faulted (rpm)
+  unsigned int  *fuseWt [ TFUSE_NUM_INS ];  // temperature fusion weight of each input (TMPSRC_FUSE)
+  int           *fuseOfs [ TFUSE_NUM_INS ]; // temperature fusion offset of each input, stored digitally (TMPSRC_FUSE)
+  unsigned int  *fuseMode;                  // temperature fusion mode (TFUSE_MEAN or TFUSE_MAX)
+  int           *dmapOfs;                   // duty map offset (quarter duty counts)
+  int           *dmapSlope;                 // duty map slope (quarter duty counts per rpm << DMAP_SLOPE_BITS)
+  unsigned long rpmCnts;                    // speed times full hall period (rpm * timer1 counts)
+  unsigned long maxPeriod;                  // longest full hall period measured (timer1 counts)
+  unsigned int  maxN;                       // maximum speed measurement (rpm)
+} FAN_CFG_TYPE;
+
+/*******************************************************************************
+ * CLASS DECLARATIONS
+ ******************************************************************************/
+
+/*
+ * Class:		fanChannels
+ * Function:	NA
+ * Scope:		global
+ * Arguments:	N - number of fan channels
+ * Description:	This class holds the speed measurement, reference, control
+ *				and stall monitoring of all the fans.  The per-loop values are
+ *				kept as one array per field, so each step runs as a loop over
+ *				the channels.  Channel 0 is fan 1.
+ */
+template <byte N>
+class fanChannels
+{
+public:
+unsigned int   rpm [ N ];    // fan speeds (rpm)
+unsigned int   rpmRef [ N ]; // reference fan speeds (rpm)
+byte           duty [ N ];   // PWM duty cycles (0-255 maps to 0%-100%)
+HALL_RING_TYPE ring [ N ];   // ring buffers of hall sensor edge timestamps, filled by the hall interrupts
+HALL_EST_TYPE  est [ N ];    // hall period estimates
+FAN_MON_TYPE   mon [ N ];    // stall monitors
+piController   pi [ N ];     // PI speed controllers
+FAN_CURVE_TYPE curve [ N ];  // speed-temperature curves, from the turn-on point and lookup table
+TEMP_FUSE_TYPE fuse [ N ];   // temperature fusion stages, from the temperature source selections
+byte           cfgGen;       // savedVarsGen when the curves and fusion stages were built
+REF_SHAPE_TYPE shape [ N ];  // reference shaping stages
+FEED_FWD_TYPE  ff [ N ];     // temperature rise feedforward stages
+DUTY_MAP_TYPE  dmap [ N ];   // duty map learners
+byte           dmapSaveIdx;  // next duty map setting to save in the current save pass (2 * N when no pass is running)
+byte           dmapSlopeDue; // high if the slope of the map whose offset was just saved still has to be saved
+unsigned long  dmapSaveTime; // run time at the start of the last save pass (seconds)
+byte           bumpless;     // high when the next regSpeeds() takes the duties over from something else
+byte           dmapHeld;     // channel whose duty map isn't learned, as something else sets its duty (N when none)
+
+fanChannels ( void );                       // constructor for fanChannels
+void measSpeeds ( unsigned long thisTime ); // calculates fan speeds, in rpm
+void setRefSpeeds ( void );                 // sets reference fan speeds to track desired temperature
+void shapeRefSpeeds ( void );               // limits the slew rate of the reference fan speeds, and keeps them out of the skip bands
+void regSpeeds ( void );                    // regulates fan speeds to reference values
+void takeOver ( void );                     // makes the next regSpeeds() carry on from the present duties (bumpless handover)
+void holdLearning ( byte chan );            // stops the duty map of a channel learning until the next takeOver()
+void monStalls ( void );                    // checks for stalled fans, and overrides the PWM duties to restart them
+byte stallFault ( void );                   // returns high if a fan has stalled and could not be restarted
+void setGains ( byte chan );                // gives the saved PI gains of a channel to its controller
+byte setCurve ( byte chan );                // rebuilds the speed-temperature curve of a channel from its saved settings
+void setFuse ( byte chan );                 // rebuilds the temperature fusion stage of a channel from its saved settings
+void saveDutyMaps ( void );                 // saves the learned duty maps to EEPROM, slowly
+void allOff ( void );                       // sets all PWM duties to zero
+void setOutputs ( void );                   // sets the PWM outputs to the duties
+};
+
+/*******************************************************************************
+ * VARIABLE DECLARATIONS
+ ******************************************************************************/
+extern const FAN_CFG_TYPE    fanCfgTbl [ NUM_FANS ]; // settings of each fan channel (stored in flash)
+extern fanChannels<NUM_FANS> fans;                   // the fan channels
+
+#endif /* FANCHANNEL_H_ */
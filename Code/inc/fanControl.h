@@ -17,5 +17,14 @@
 #include "LiquidCrystal.h"
 #include "savedVars.h"
 #include "fanCtrlStateMachine.h"
+#include "sysTimer.h"
+#include "taskSched.h"
+#include "loopTiming.h"
+#include "timeBase.h"
+#include "pwmOut.h"
+#include "fanChannel.h"
+#include "adcSampler.h"
+#include "tempCond.h"
+#include "dsTemp.h"
 
 #endif /* _FanControl_H_ */
@@ -16,13 +16,14 @@
 /*******************************************************************************
  * DEFINITIONS OF CODE VERSION
  ******************************************************************************/
-#define CODEVER 0x00000005 // software version code, checked in EEPROM for changes.  Change this value whenever making a new software version to re-load eeprom values.
+#define CODEVER 0x0000000D // software version code, checked in EEPROM for changes.  Change this value whenever making a new software version to re-load eeprom values.
 
 /*******************************************************************************
  * SYSTEM DEFINITIONS
  ******************************************************************************/
 #define BAUDRATE          9600  // baudrate used for serial comms
-#define LOOPTIME_US       50000 // number of microseconds between each loop iteration
+#define SYSTICK_US        12500 // number of microseconds between each scheduler tick
+#define LOOPTIME_US       50000 // number of microseconds between each control loop iteration (must be a multiple of SYSTICK_US)
 #define MEANINGLESS_VALUE 0     // this just denotes that the value is meaningless, since it will be over-written at initialization anyway
 
 /*******************************************************************************
@@ -34,19 +35,28 @@
 #define DEBUGHEADSIZE     4      // number of bytes in header of debug message, which tells which debug mode to enter
 #define DEBUG_DISPSWITCH  20     // number of times display is updated before it switches to different value, in debug modes where display changes.
 #define NORMAL_HEAD       "NRML" // keyword to use in header when returning to normal mode
-#define DEBUGPI1_HEAD     "DPI1" // keyword to use in header of debug message telling to enter DEBUG_PI1 mode
-#define DEBUGPI2_HEAD     "DPI2" // keyword to use in header of debug message telling to enter DEBUG_PI2 mode
+#define DEBUGPI_HEAD      "DPI"  // keyword to use in header of debug message telling to enter DEBUG_PI mode, followed by the fan number ("DPI1", "DPI2", ...)
 #define DEBUGBTN_HEAD     "DBTN" // keyword to use in header of debug message telling to enter DEBUG_BTNS mode
 #define DEBUGTMP_HEAD     "DTMP" // keyword to use in header of debug message telling to enter DEBUG_TMP mode
 #define DEBUGFON_HEAD     "DFON" // keyword to use in header of debug message telling to enter DEBUG_FON mode
-#define DEBUGTB1_HEAD     "DTB1" // keyword to use in header of debug message telling to enter DEBUG_TB1 mode
-#define DEBUGTB2_HEAD     "DTB2" // keyword to use in header of debug message telling to enter DEBUG_TB2 mode
+#define DEBUGTB_HEAD      "DTB"  // keyword to use in header of debug message telling to enter DEBUG_TB mode, followed by the fan number ("DTB1", "DTB2", ...)
+#define DEBUGTIM_HEAD     "DTIM" // keyword to use in header of debug message requesting a loop timing report (first data word nonzero clears statistics after report)
+#define AUTOTUNE_HEAD     "ATN"  // keyword to use in header of debug message telling to enter AUTOTUNE mode, followed by the fan number ("ATN1", "ATN2", ...).  Data words are the speed (rpm), relay amplitude (duty counts) and hysteresis (rpm), 0 for the defaults
 
 /*******************************************************************************
  * DEFINITIONS FOR PERIPHERAL USE
  ******************************************************************************/
+/* Hall sensor measurement backends (choose one with HALL_BACKEND) */
+#define HALL_BACKEND_EXTINT 0                   // both hall sensors timestamped in external interrupt (INT0/INT1) handlers
+#define HALL_BACKEND_ICP1   1                   // hall sensor 1 timestamped in hardware by timer1 input capture (needs hall 1 wired to pin 8 and LCD RS moved to pin A5), hall sensor 2 as EXTINT
+#define HALL_BACKEND        HALL_BACKEND_EXTINT // hall sensor measurement backend in use
+
 /* LCD definitions */
+#if HALL_BACKEND == HALL_BACKEND_ICP1
+#define LCDRSPIN     19 // Arduino pin connected to LCD 'RS' pin (A5, since pin 8 is used for input capture)
+#else
 #define LCDRSPIN     8  // Arduino pin connected to LCD 'RS' pin
+#endif
 #define LCDRWPIN     7  // Arduino pin connected to LCD 'RW' pin
 #define LCDENABLEPIN 9  // Arduino pin connected to LCD 'Enable' pin
 #define LCDD0PIN     10 // Arduino pin connected to LCD 'Data 0' pin
@@ -55,7 +65,9 @@
 #define LCDD3PIN     13 // Arduino pin connected to LCD 'Data 3' pin
 #define LCDCOLS      16 // number of columns of LCD screen
 #define LCDROWS      2  // number of rows of LCD screen
-#define LCD_DEC      5  // decimation of loop iterations to print to lcd (eg 4 means that the LCD screen is updated every fourth loop)
+
+/* Fan channel definitions */
+#define NUM_FANS 2 // number of fans controlled (each needs its own PWM output, hall sensor input and saved variables)
 
 /* PWM output definitions */
 #define PWM1PIN 5 // Arduino pin used for PWM 1 output
@@ -64,64 +76,117 @@
 /* Hall sensor input definitions */
 #define FAN1PPR  2    // Hall sensor pulses-per-revolution of fan 1
 #define FAN2PPR  2    // Hall sensor pulses-per-revolution of fan 2
+#if HALL_BACKEND == HALL_BACKEND_ICP1
+#define HALL1PIN 8    // Arduino pin used for Hall Sensor 1 input (ICP1)
+#else
 #define HALL1PIN 2    // Arduino pin used for Hall Sensor 1 input
+#endif
 #define HALL2PIN 3    // Arduino pin used for Hall sensor 2 input
 #define MAXN1    9999 // maximum fan 1 speed measurement (rpm)
 #define MAXN2    9999 // maximum fan 2 speed measurement (rpm)
 #define MINN1    50   // minimum fan 1 speed measurement (rpm)
 #define MINN2    50   // minimum fan 2 speed measurement (rpm)
 
+/* Hall sensor level reads, straight from the port registers since
+ * digitalRead() is too slow for the hall interrupts.  These must match
+ * HALL1PIN and HALL2PIN. */
+#if HALL_BACKEND == HALL_BACKEND_ICP1
+#define HALL1_READ( ) ( PINB & _BV ( PINB0 ) ) // reads hall sensor 1 level (pin 8 is PB0)
+#else
+#define HALL1_READ( ) ( PIND & _BV ( PIND2 ) ) // reads hall sensor 1 level (pin 2 is PD2)
+#endif
+#define HALL2_READ( ) ( PIND & _BV ( PIND3 ) ) // reads hall sensor 2 level (pin 3 is PD3)
+
 /* Temp sensor input definitions */
 #define TEMP1PIN 0 // Arduino analog pin used for temp sensor 1
 #define TEMP2PIN 1 // Arduino analog pin used for temp sensor 2
 
+/* Temp sensor resolution definitions.  Each reading is oversampled from
+ * 4^ADC_OVERSAMPLE_BITS 10-bit ADC samples (16 samples for 12 bits, 64 for
+ * 13 bits). */
+#define ADC_OVERSAMPLE_BITS 2                                               // bits of temperature resolution added by oversampling (0-3)
+#define TEMP_DIG_BITS       ( 10 + ADC_OVERSAMPLE_BITS )                    // bits in a digital temperature value
+#define TEMP_DIG_MAX        ( ( 1 << TEMP_DIG_BITS ) - 1 )                  // largest digital temperature value
+#define TEMP10_TO_DIG( a )  ( (unsigned int) ( a ) << ADC_OVERSAMPLE_BITS ) // converts a 10-bit digital temperature value to TEMP_DIG_BITS
+
+/* Temp sensor conditioning definitions */
+#define TEMPCOND_MED_MAX 5 // largest number of readings in the median spike filter (tmpMedN)
+
+/* 1-Wire temperature sensor bus definitions.  The bus needs a 4.7k pull-up
+ * to 5 V, and the sensors must be externally powered (not parasite power).
+ * The bus is driven straight from the port registers, since the bit timing
+ * is too tight for digitalWrite().  These must match OWPIN. */
+#define OWPIN          A4                         // Arduino pin used for the 1-Wire bus
+#define OW_DRIVE_LOW( ) ( DDRC |= _BV ( DDC4 ) )  // pulls the bus low (pin A4 is PC4, whose PORTC bit is left low)
+#define OW_RELEASE( )   ( DDRC &= ~_BV ( DDC4 ) ) // lets the pull-up take the bus high
+#define OW_READ( )      ( PINC & _BV ( PINC4 ) )  // reads the bus level
+
 /* Button pin definitions */
 #define BTN1PIN 4  // Arduino digital pin used for reading button 1
 #define BTN2PIN A2 // Arduino digital pin used for reading button 1
 #define BTN3PIN A3 // Arduino digital pin used for reading button 1
 
 /* Temp sensor input selection definitions */
-#define TMPSRC_TMP1 0 // selects TMP1 as temp input source
-#define TMPSRC_TMP2 1 // selects TMP2 as temp input source
-#define TMPSRC_MAX  2 // selects max value of TMP1 & TMP2 as temp input source
-#define TMPSRC_MEAN 3 // selects mean value of TMP1 & TMP2 as temp input source
-#define TMPSRC_DEF TMPSRC_MAX // default temperature input source
+#define TMPSRC_TMP1 0           // selects TMP1 as temp input source
+#define TMPSRC_TMP2 1           // selects TMP2 as temp input source
+#define TMPSRC_MAX  2           // selects max value of TMP1 & TMP2 as temp input source
+#define TMPSRC_MEAN 3           // selects mean value of TMP1 & TMP2 as temp input source
+#define TMPSRC_OW1  4           // selects the first 1-Wire sensor found by the ROM search as temp input source
+#define TMPSRC_OW2  5           // selects the second 1-Wire sensor as temp input source
+#define TMPSRC_FUSE 6           // selects the fan's own fusion of all the sensors (fuseNWtx, fuseNOfsx, fuseNMode) as temp input source
+#define TMPSRC_LAST TMPSRC_FUSE // largest valid temp input source
+#define TMPSRC_DEF TMPSRC_MAX   // default temperature input source
+
+/* Temp sensor fusion mode definitions (fuseNMode) */
+#define TFUSE_MEAN 0 // fused temperature is the weighted mean of the inputs, with offsets
+#define TFUSE_MAX  1 // fused temperature is the maximum of the inputs with nonzero weight, with offsets
+
+/* Duty map feedforward mode definitions (dmapMode) */
+#define DMAP_OFF   0 // no duty feedforward, the PI controllers give the whole duty
+#define DMAP_USE   1 // duty feedforward from the saved duty maps, added to the PI outputs
+#define DMAP_LEARN 2 // as DMAP_USE, and the duty maps are learned from steady-state speeds and duties
 
 /*******************************************************************************
  * USEFUL MACROS FOR TEMPERATURE CONVERSION
  ******************************************************************************/
+#define DigTempToC10x16( a, ofs, gain ) \
+  /* Converts from digital value to degrees Celsius times 160, using the */ \
+  /* offset and gain of a sensor.  The 4 extra fraction bits keep the */ \
+  /* Fahrenheit conversion as fine as if it were done directly. */ \
+  /* Returns the result as a long integer */ \
+  ( ( ( ( (long int) a * 10 ) - ( ( (long int) ofs << TEMP_DIG_BITS ) / 500 ) ) * (long int) gain ) >> ( TEMP_DIG_BITS - 4 ) )
 #define DigTemp1ToC10( a ) \
   /* Converts from digital value to degrees Celsius times 10 */ \
   /* Returns the result as an integer */ \
-  ( (int) ( ( ( ( (long int) a * 10 ) - ( ( (long int) Temp1Offset << 10 ) / 500 ) ) * (long int) Temp1DegCPer5V ) >> 10 ) )
+  ( (int) ( DigTempToC10x16 ( a, Temp1Offset, Temp1DegCPer5V ) >> 4 ) )
 #define DigTemp2ToC10( a ) \
   /* Converts from digital value to degrees Celsius times 10 */ \
   /* Returns the result as an integer */ \
-  ( (int) ( ( ( ( (long int) a * 10 ) - ( ( (long int) Temp2Offset << 10 ) / 500 ) ) * (long int) Temp2DegCPer5V ) >> 10 ) )
+  ( (int) ( DigTempToC10x16 ( a, Temp2Offset, Temp2DegCPer5V ) >> 4 ) )
 #define DigTemp1ToF10( a ) \
   /* Converts from digital value to degrees Fahrenheit times 10 */ \
   /* Returns the result as an integer */ \
-  ( (int) ( ( ( ( ( (long int) a * 90 ) - ( ( ( (long int) Temp1Offset * 9 ) << 10 ) / 500 ) ) * (long int) Temp1DegCPer5V / 5 ) >> 10 ) + 320 ) )
+  ( (int) ( ( ( DigTempToC10x16 ( a, Temp1Offset, Temp1DegCPer5V ) * 9 / 5 ) >> 4 ) + 320 ) )
 #define DigTemp2ToF10( a ) \
   /* Converts from digital value to degrees Fahrenheit times 10 */ \
   /* Returns the result as an integer */ \
-  ( (int) ( ( ( ( ( (long int) a * 90 ) - ( ( ( (long int) Temp2Offset * 9 ) << 10 ) / 500 ) ) * (long int) Temp2DegCPer5V / 5 ) >> 10 ) + 320 ) )
+  ( (int) ( ( ( DigTempToC10x16 ( a, Temp2Offset, Temp2DegCPer5V ) * 9 / 5 ) >> 4 ) + 320 ) )
 #define C10ToDigTemp1( a ) \
   /* Converts from signed integer Celsius temperature times to to digital value */ \
   /* Returns the result as an unsigned integer */ \
-  ( (unsigned int) ( ( ( ( ( (long int) a ) << 10 ) / (long int) Temp1DegCPer5V ) + ( ( (long int) Temp1Offset << 10 ) / 500 ) ) / 10 ) )
+  ( (unsigned int) ( ( ( ( ( (long int) a ) << TEMP_DIG_BITS ) / (long int) Temp1DegCPer5V ) + ( ( (long int) Temp1Offset << TEMP_DIG_BITS ) / 500 ) ) / 10 ) )
 #define C10ToDigTemp2( a ) \
   /* Converts from signed integer Celsius temperature times to to digital value */ \
   /* Returns the result as an unsigned integer */ \
-  ( (unsigned int) ( ( ( ( ( (long int) a ) << 10 ) / (long int) Temp2DegCPer5V ) + ( ( (long int) Temp2Offset << 10 ) / 500 ) ) / 10 ) )
+  ( (unsigned int) ( ( ( ( ( (long int) a ) << TEMP_DIG_BITS ) / (long int) Temp2DegCPer5V ) + ( ( (long int) Temp2Offset << TEMP_DIG_BITS ) / 500 ) ) / 10 ) )
 #define F10ToDigTemp1( a ) \
   /* Converts from signed integer Fahrenheit temperature times to to digital value */ \
   /* Returns the result as an unsigned integer */ \
-  ( (unsigned int) ( ( ( ( ( ( (long int) a - 320 ) * 5 / 9 ) << 10 ) / (long int) Temp1DegCPer5V ) + ( ( (long int) Temp1Offset << 10 ) / 500 ) ) / 10 ) )
+  ( (unsigned int) ( ( ( ( ( ( (long int) a - 320 ) * 5 / 9 ) << TEMP_DIG_BITS ) / (long int) Temp1DegCPer5V ) + ( ( (long int) Temp1Offset << TEMP_DIG_BITS ) / 500 ) ) / 10 ) )
 #define F10ToDigTemp2( a ) \
   /* Converts from signed integer Fahrenheit temperature times to to digital value */ \
   /* Returns the result as an unsigned integer */ \
-  ( (unsigned int) ( ( ( ( ( ( (long int) a - 320 ) * 5 / 9 ) << 10 ) / (long int) Temp2DegCPer5V ) + ( ( (long int) Temp2Offset << 10 ) / 500 ) ) / 10 ) )
+  ( (unsigned int) ( ( ( ( ( ( (long int) a - 320 ) * 5 / 9 ) << TEMP_DIG_BITS ) / (long int) Temp2DegCPer5V ) + ( ( (long int) Temp2Offset << TEMP_DIG_BITS ) / 500 ) ) / 10 ) )
 #define C10toC( a ) \
   /* Converts from Celsius times 10 to Celsius */ \
   /* Returns the result as a signed integer */ \
@@ -134,36 +199,22 @@
 /*******************************************************************************
  * VARIABLE DECLARATIONS
  ******************************************************************************/
-extern volatile unsigned long lastEdgeTime1;                       // timestamp of previous edge of hall sensor 1
-extern volatile unsigned long lastEdgeTime2;                       // timestamp of previous edge of hall sensor 2
-extern volatile unsigned long hall1Period;                         // period count for hall sensor 1 (microseconds)
-extern volatile unsigned long hall2Period;                         // period count for hall sensor 2 (microseconds)
-extern unsigned int           Fan1RPM;                             // Fan 1 speed, in rpm
-extern unsigned int           Fan2RPM;                             // Fan 2 speed, in rpm
-extern unsigned int           Fan1RPMRef;                          // Fan 1 reference speed, in rpm
-extern unsigned int           Fan2RPMRef;                          // Fan 2 reference speed, in rpm
-extern byte                   Pwm1Duty;                            // PWM 1 duty cycle (0-255 maps to 0%-100%)
-extern byte                   Pwm2Duty;                            // PWM 2 duty cycle (0-255 maps to 0%-100%)
-extern unsigned int           Temp1;                               // Temperature 1 input, stored digitally (0-1023)
-extern unsigned int           Temp2;                               // Temperature 2 input, stored digitally (0-1023)
-extern unsigned long          loopsRun;                            // total number of loops run since reset
+extern unsigned int           Temp1;                               // Temperature 1 input, stored digitally (0-TEMP_DIG_MAX)
+extern unsigned int           Temp2;                               // Temperature 2 input, stored digitally (0-TEMP_DIG_MAX)
 extern unsigned long          runTime_s;                           // program run-time since reset (seconds)
 extern byte                   stateChange;                         // high when a state change occurs
 extern unsigned int           btn1PressCnt;                        // number of consecutive times button 1 was pressed
 extern unsigned int           btn2PressCnt;                        // number of consecutive times button 1 was pressed
 extern unsigned int           btn3PressCnt;                        // number of consecutive times button 1 was pressed
-extern byte                   lcdLoops;                            // number of loops run since last LCD update
 extern int                    debugDatWords [ DEBUGMSG_DATWORDS ]; // buffer of data words included in payload of debug messages
 
 /*******************************************************************************
  * FUNCTION DECLARATIONS
  ******************************************************************************/
-void initializeSystem ( void );                // initializes the fan control system
-void measFanSpeeds ( unsigned long thisTime ); // Calculates fan speeds, in RPM
-void checkButtonPress ( void );                // checks if buttons were pressed, and updates consecutive press count
-void setRefFanSpeeds ( void );                 // sets reference fan speeds to track desired temperature
-void regFanSpeeds ( void );                    // regulates fan speeds to reference values
-void hall1ISR ( void );                        // hall sensor 1 interrupt service routine
-void hall2ISR ( void );                        // hall sensor 1 interrupt service routine
+void initializeSystem ( void ); // initializes the fan control system
+void checkButtonPress ( void ); // checks if buttons were pressed, and updates consecutive press count
+void hallInit ( void );         // starts timestamping hall sensor edges, using the selected backend
+void hall1ISR ( void );         // hall sensor 1 interrupt service routine
+void hall2ISR ( void );         // hall sensor 2 interrupt service routine
 
 #endif /* FANCONTROLUTILS_H_ */
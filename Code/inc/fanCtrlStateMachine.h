@@ -12,13 +12,13 @@ typedef enum FANCTRLSTATE_ENUM
 {
   INIT,       // initialization
   NORMAL,     // normal fan control operation state
-  DEBUG_PI1,  // debug mode for PI controller #1
-  DEBUG_PI2,  // debug mode for PI controller #2
+  FAULT,      // fan fault state, entered from NORMAL while a fan has stalled and can't be restarted
+  DEBUG_PI,   // debug mode for the PI controller of one fan
   DEBUG_BTNS, // debug mode for buttons
   DEBUG_TMP,  // debug mode for temp sensors
   DEBUG_FON,  // debug mode for determining when fans turn on and off
-  DEBUG_TB1,  // debug mode for setting fan speed-temp lookup table 1
-  DEBUG_TB2,  // debug mode for setting fan speed-temp lookup table 2
+  DEBUG_TB,   // debug mode for setting the fan speed-temp lookup table of one fan
+  AUTOTUNE,   // relay-feedback auto-tuning of the PI gains of one fan
 
 } FANCTRLSTATE_ENUM_TYPE;
 
@@ -36,13 +36,17 @@ typedef enum FANCTRLSTATE_ENUM
 class fanCtrlStateMachine
 {
 private:
-FANCTRLSTATE_ENUM_TYPE state; // fan control state
+FANCTRLSTATE_ENUM_TYPE state;     // fan control state
+FANCTRLSTATE_ENUM_TYPE lastState; // fan control state during previous run
 
 public:
-fanCtrlStateMachine ( void );             // constructor for fanCtrlStateMachine
-FANCTRLSTATE_ENUM_TYPE getState ( void ); // returns the state machine state
-void                   reset ( void );    // resets state machine to run initialization
-void                   run ( void );      // runs the state machine
+fanCtrlStateMachine ( void );                   // constructor for fanCtrlStateMachine
+FANCTRLSTATE_ENUM_TYPE getState ( void );       // returns the state machine state
+void                   reset ( void );          // resets state machine to run initialization
+void                   run ( void );            // runs the control step of the state machine
+void                   display ( void );        // updates the LCD screen for the current state
+void                   checkSerial ( void );    // checks for debug messages and applies their data
+void                   saveTunedGains ( void ); // saves the PI gains found by an auto-tune (may write EEPROM)
 
 };
 
@@ -0,0 +1,49 @@
+/*
+ * fanCurve.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+
+#ifndef FANCURVE_H_
+#define FANCURVE_H_
+
+/*******************************************************************************
+ * INCLUDED HEADER FILES
+ ******************************************************************************/
+#include "Arduino.h"
+#include "fanControlUtils.h"
+
+/*******************************************************************************
+ * MACRO DEFINITIONS
+ ******************************************************************************/
+#define FAN_CURVE_MAX_PTS    16                                     // largest number of points in a fan curve
+#define FAN_CURVE_SLOPE_BITS 14                                     // fraction bits of the segment slopes (speeds up to 65535 rpm times 2^14 still fit a long)
+#define FAN_CURVE_BKT_BITS   5                                      // log2 of the number of temperature buckets in the segment index
+#define FAN_CURVE_BKTS       ( 1 << FAN_CURVE_BKT_BITS )            // number of temperature buckets in the segment index
+#define FAN_CURVE_BKT_SHIFT  ( TEMP_DIG_BITS - FAN_CURVE_BKT_BITS ) // shift from a digital temperature to its bucket
+
+/*******************************************************************************
+ * TYPE DEFINITIONS
+ ******************************************************************************/
+/* Piecewise linear fan speed curve, built by fanCurveBuild() whenever its
+ * settings change.  The points are in strictly increasing temperature
+ * order, so every segment has a slope.  The segment index gives, for each
+ * bucket of temperatures, the segment holding the bottom of the bucket, so
+ * the segment of any temperature is found with one read, plus a step for
+ * each point inside its bucket. */
+typedef struct FAN_CURVE {
+  unsigned int x [ FAN_CURVE_MAX_PTS ];         // temperatures of the points, stored digitally
+  unsigned int y [ FAN_CURVE_MAX_PTS ];         // speeds of the points (rpm)
+  long int     slope [ FAN_CURVE_MAX_PTS - 1 ]; // slope of the segment after each point (rpm per digital count << FAN_CURVE_SLOPE_BITS)
+  byte         seg [ FAN_CURVE_BKTS ];          // segment index, giving the first segment to check for each temperature bucket
+  byte         num;                             // number of points
+} FAN_CURVE_TYPE;
+
+/*******************************************************************************
+ * FUNCTION DECLARATIONS
+ ******************************************************************************/
+byte         fanCurveBuild ( FAN_CURVE_TYPE *curve, const unsigned int *x, const unsigned int *y, byte num ); // builds a curve from its points, returning the number of points dropped as invalid
+unsigned int fanCurveEval ( const FAN_CURVE_TYPE *curve, unsigned int x );                                   // returns the speed on a curve at a temperature (rpm)
+
+#endif /* FANCURVE_H_ */
@@ -0,0 +1,61 @@
+/*
+ * fanMonitor.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+
+#ifndef FANMONITOR_H_
+#define FANMONITOR_H_
+
+/*******************************************************************************
+ * INCLUDED HEADER FILES
+ ******************************************************************************/
+#include "Arduino.h"
+#include "fanControlUtils.h"
+
+/*******************************************************************************
+ * MACRO DEFINITIONS
+ ******************************************************************************/
+#define FANMON_MS_TO_LOOPS( a ) \
+  /* Converts from milliseconds to a number of control loops */ \
+  ( (unsigned int) ( (unsigned long) ( a ) * 1000UL / LOOPTIME_US ) )
+
+#define FANMON_SPINUP_MS 2000  // time a fan is given to show hall edges after being turned on or kicked (milliseconds)
+#define FANMON_KICK_MS   1000  // time a stalled fan is driven at full duty to restart it (milliseconds)
+#define FANMON_KICK_DUTY 255   // duty cycle used to kick a stalled fan (0-255 maps to 0%-100%)
+#define FANMON_MAX_KICKS 3     // number of kicks tried before a stalled fan is faulted
+#define FANMON_RETRY_MS  30000 // time between kicks of a faulted fan, which isn't driven in between (milliseconds)
+
+/*******************************************************************************
+ * TYPE DEFINITIONS
+ ******************************************************************************/
+/* States of the stall monitor for one fan */
+typedef enum FANMON_ENUM
+{
+  FANMON_OFF,    // fan commanded off, so no hall edges expected
+  FANMON_SPINUP, // fan commanded on, waiting for hall edges
+  FANMON_RUN,    // fan commanded on and turning
+  FANMON_KICK,   // fan stalled, being driven at full duty to restart it
+  FANMON_FAULT   // fan could not be restarted, waiting to retry
+} FANMON_ENUM_TYPE;
+
+/* Stall monitor for one fan, kept by the main loop.  The counters are
+ * never reset, and just wrap. */
+typedef struct FAN_MON {
+  byte         state;    // monitor state (FANMON_ENUM_TYPE)
+  unsigned int loops;    // number of control loops spent in the current state
+  byte         kicks;    // number of kicks tried since the fan was last turning
+  byte         fault;    // high from when the fan is faulted until it turns again or is commanded off
+  unsigned int stalls;   // number of stalls detected
+  unsigned int kickCnt;  // number of kicks tried in total
+  unsigned int glitches; // number of hall edges rejected as glitches (copied from the hall period estimate)
+} FAN_MON_TYPE;
+
+/*******************************************************************************
+ * FUNCTION DECLARATIONS
+ ******************************************************************************/
+byte fanMonUpdate ( FAN_MON_TYPE *mon, byte duty, unsigned int rpm ); // runs the stall monitor for one control loop, returning the duty to output
+byte fanMonFault ( const FAN_MON_TYPE *mon );                         // returns high if the fan is faulted
+
+#endif /* FANMONITOR_H_ */
@@ -0,0 +1,42 @@
+/*
+ * feedFwd.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+
+#ifndef FEEDFWD_H_
+#define FEEDFWD_H_
+
+/*******************************************************************************
+ * INCLUDED HEADER FILES
+ ******************************************************************************/
+#include "Arduino.h"
+#include "fanControlUtils.h"
+
+/*******************************************************************************
+ * MACRO DEFINITIONS
+ ******************************************************************************/
+#define FF_SAMPLE_MS    4000                                                               // time between samples of the temperature for the rise rate (milliseconds)
+#define FF_SAMPLE_LOOPS ( (byte) ( (unsigned long) FF_SAMPLE_MS * 1000UL / LOOPTIME_US ) ) // number of control loops between samples of the temperature
+#define FF_PER_MIN      ( 60000UL / FF_SAMPLE_MS )                                         // number of samples per minute
+#define FF_FRAC_BITS    4                                                                  // fraction bits kept in the filtered rise rate
+
+/*******************************************************************************
+ * TYPE DEFINITIONS
+ ******************************************************************************/
+/* Temperature rise feedforward of one fan, kept by the main loop.  Starts
+ * out zeroed, and takes its first sample on the first update. */
+typedef struct FEED_FWD {
+  unsigned int lastTemp; // reference temperature at the last sample, stored digitally
+  byte         loops;    // control loops until the next sample
+  byte         primed;   // high once lastTemp holds a sample
+  long int     rate;     // filtered rise rate (raw counts per minute << FF_FRAC_BITS)
+} FEED_FWD_TYPE;
+
+/*******************************************************************************
+ * FUNCTION DECLARATIONS
+ ******************************************************************************/
+unsigned int feedFwdUpdate ( FEED_FWD_TYPE *ff, unsigned int temp ); // tracks the rise rate of a reference temperature, returning the speed boost for it (rpm)
+
+#endif /* FEEDFWD_H_ */
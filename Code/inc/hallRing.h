@@ -0,0 +1,97 @@
+/*
+ * hallRing.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+
+#ifndef HALLRING_H_
+#define HALLRING_H_
+
+/*******************************************************************************
+ * INCLUDED HEADER FILES
+ ******************************************************************************/
+#include "Arduino.h"
+#include "isrSnapshot.h"
+
+/*******************************************************************************
+ * MACRO DEFINITIONS
+ ******************************************************************************/
+#define HALL_RING_SIZE 16                     // number of edge timestamps buffered for each hall sensor (must be a power of 2, and <= 128)
+#define HALL_RING_MASK ( HALL_RING_SIZE - 1 ) // mask used to wrap ring buffer indices
+
+/* Speed measurement mode switching.  Below the switch speed, each edge is
+ * timestamped and the median period is used (resolution better than 0.15 rpm
+ * at 3000 rpm, and improving as speed drops).  Above it, the interrupt only
+ * counts edges and keeps the newest timestamp, and the period is averaged
+ * over all edges in the control loop window (resolution better than 0.1 rpm
+ * at 9999 rpm).  The gap between the two thresholds is the hysteresis. */
+#define HALL_EDGES_PER_PERIOD 2     // number of edges timestamped in each full hall period (both rising and falling)
+#define HALL_COUNT_ENTER_US   10000 // switch to edge counting mode when the full hall period drops below this (3000 rpm at 2 pulses/rev)
+#define HALL_COUNT_EXIT_US    12500 // switch back to period timing mode when the full hall period rises above this (2400 rpm at 2 pulses/rev)
+
+/* Glitch rejection.  Fan tach lines pick up spikes from the PWM switching.
+ * An edge is only accepted if the hall level sampled in the interrupt has
+ * actually changed (so a spike that has already ended is dropped), and if
+ * the level isn't changed back sooner than any real fan could do it. */
+#define HALL_MIN_EDGE_US      400   // shortest plausible time between edges (edges are 1500 us apart at 9999 rpm and 2 pulses/rev, so this allows for an uneven hall duty cycle)
+
+/*******************************************************************************
+ * TYPE DEFINITIONS
+ ******************************************************************************/
+/* Edge count published by the interrupt in edge counting mode */
+typedef struct HALL_COUNT {
+  unsigned int  edgeCnt;   // number of edges counted since entering edge counting mode
+  unsigned long lastStamp; // timestamp of newest counted edge (timer1 counts)
+  byte          countMode; // high while the interrupt is in edge counting mode
+} HALL_COUNT_TYPE;
+
+/* Ring buffer of hall sensor edge timestamps.  This has a single producer
+ * (the hall sensor interrupt) and a single consumer (the main loop), so no
+ * locking is needed: 'head' is only written by the interrupt, 'tail' is only
+ * written by the main loop, and both are single bytes so they are read and
+ * written atomically.  A slot is only written while it is outside the
+ * [tail, head) range the main loop is reading from.
+ *
+ * In edge counting mode the ring is not used; the interrupt just counts
+ * edges and publishes the count and newest timestamp as a tear-free
+ * snapshot.  The main loop only requests a mode change; the interrupt makes
+ * it on the next edge, so every edge is seen by exactly one of the modes.
+ *
+ * Glitch rejection is done before either mode sees the edge, so rejected
+ * edges are never timestamped or counted, just tallied in 'glitches'.  Each
+ * edge is held in 'pendStamp' until the next edge shows it was real. */
+typedef struct HALL_RING {
+  volatile unsigned long       stamp [ HALL_RING_SIZE ]; // edge timestamps (timer1 counts)
+  volatile byte                head;                     // free-running index of next slot to write (written by interrupt only)
+  volatile byte                tail;                     // free-running index of next slot to read (written by main loop only)
+  volatile byte                drops;                    // number of edges dropped because the ring was full (written by interrupt only)
+  volatile byte                countModeReq;             // high to request edge counting mode (written by main loop only)
+  volatile byte                glitches;                 // number of edges rejected as glitches (written by interrupt only)
+  unsigned long                pendStamp;                // timestamp of the newest edge, not yet known to be real (interrupt only)
+  byte                         pending;                  // high while pendStamp holds an edge (interrupt only)
+  byte                         lastLevel;                // hall level after the newest edge (interrupt only, set by hallRingInit())
+  HALL_COUNT_TYPE              isrCount;                 // edge count being kept by the interrupt (interrupt only)
+  isrSnapshot<HALL_COUNT_TYPE> count;                    // edge count and mode, as published to the main loop
+} HALL_RING_TYPE;
+
+/* State of the period estimate for one hall sensor, kept by the main loop */
+typedef struct HALL_EST {
+  unsigned long prevStamp [ 2 ]; // timestamps of the last two edges used (timer1 counts), newest in [1]
+  byte          numPrev;         // number of valid entries in prevStamp[] (edge counting mode only uses prevStamp[1])
+  byte          lastDrops;       // value of ring 'drops' count when last checked
+  unsigned int  lastCnt;         // edge count at the newest edge used, in edge counting mode
+  byte          countMode;       // high when the main loop is reading edges in edge counting mode
+  unsigned long period;          // full period of hall signal over the last batch of edges (timer1 counts), 0 if unknown
+  byte          lastGlitches;    // value of ring 'glitches' count when last checked
+  unsigned int  glitches;        // total number of edges rejected as glitches
+} HALL_EST_TYPE;
+
+/*******************************************************************************
+ * FUNCTION DECLARATIONS
+ ******************************************************************************/
+void         hallRingInit ( HALL_RING_TYPE *ring, byte level );                    // sets the starting hall level of a ring (call before enabling its interrupt)
+void         hallRingPush ( HALL_RING_TYPE *ring, unsigned long stamp, byte level ); // adds an edge timestamp to a ring, unless it is a glitch (called from interrupt)
+unsigned int hallRingUpdate ( HALL_RING_TYPE *ring, HALL_EST_TYPE *est );            // reads all new edges from a ring, updates the period estimate, and switches measurement mode
+
+#endif /* HALLRING_H_ */
@@ -0,0 +1,117 @@
+/*
+ * isrSnapshot.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+
+#ifndef ISRSNAPSHOT_H_
+#define ISRSNAPSHOT_H_
+
+#include "Arduino.h"
+
+/*******************************************************************************
+ * MACRO DEFINITIONS
+ ******************************************************************************/
+#define ISRSNAPSHOT_BARRIER( ) \
+  /* Stops the compiler moving memory accesses across this point */ \
+  __asm__ __volatile__ ( "" ::: "memory" )
+
+/*******************************************************************************
+ * CLASS DECLARATIONS
+ ******************************************************************************/
+
+/*
+ * Class:		isrSnapshot
+ * Function:	NA
+ * Scope:		global
+ * Arguments:	T - type of the value shared between an interrupt and the main loop
+ * Description:	Holds a value which is written by an interrupt and read by
+ *				the main loop, without the main loop ever disabling
+ *				interrupts.  This 8-bit processor reads multi-byte values a
+ *				byte at a time, so a plain volatile variable can be torn by
+ *				an interrupt which fires mid-read.
+ *
+ *				The interrupt writes each new value into whichever of the two
+ *				buffers the reader is not pointed at, then bumps a one-byte
+ *				generation count, which flips the reader over to it.  The
+ *				reader copies the buffer the generation count points at, and
+ *				retries if the generation changed during the copy.  The copy
+ *				can only be torn if the interrupt wrote twice during it, since
+ *				the first write goes to the other buffer.
+ *
+ *				publish() must only be called from one interrupt, and read()
+ *				only from code which that interrupt can interrupt.
+ */
+template <typename T>
+class isrSnapshot
+{
+private:
+T             buf [ 2 ]; // double buffer of values
+volatile byte gen;       // generation count, whose lowest bit selects the buffer holding the newest value
+
+public:
+void publish ( const T &val ); // publishes a new value (call from the interrupt only)
+T    read ( void ) const;      // returns a consistent copy of the newest value (call from the main loop)
+};
+
+/*******************************************************************************
+ * TEMPLATE METHOD DEFINITIONS
+ ******************************************************************************/
+
+/******************************************************************************
+* Function:
+*   isrSnapshot::publish()
+*
+* Description:
+*   Publishes a new value.  Call from the interrupt only.
+*
+* Arguments:
+*   val - new value
+*
+* Returns:
+*   none
+******************************************************************************/
+template <typename T>
+void isrSnapshot<T>::publish ( const T &val )
+{
+  byte next = gen + 1; // generation of the new value
+
+  buf [ next & 1 ] = val; // write the buffer the reader is not pointed at...
+  ISRSNAPSHOT_BARRIER ( );
+  gen = next;             // ...then point the reader at it
+
+  return;
+} // end of isrSnapshot::publish()
+
+/******************************************************************************
+* Function:
+*   isrSnapshot::read()
+*
+* Description:
+*   Returns a consistent copy of the newest value.  Call from the main loop.
+*
+* Arguments:
+*   none
+*
+* Returns:
+*   val - newest value
+******************************************************************************/
+template <typename T>
+T isrSnapshot<T>::read ( void ) const
+{
+  T    val;     // copy of the value
+  byte thisGen; // generation when the copy was started
+
+  do
+  {
+    thisGen = gen;
+    ISRSNAPSHOT_BARRIER ( );
+    val = buf [ thisGen & 1 ];
+    ISRSNAPSHOT_BARRIER ( );
+  } while ( thisGen != gen ); // value was re-written during the copy, so try again
+
+  return val;
+} // end of isrSnapshot::read()
+
+#endif /* ISRSNAPSHOT_H_ */
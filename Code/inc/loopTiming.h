@@ -0,0 +1,70 @@
+/*
+ * loopTiming.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+
+#ifndef LOOPTIMING_H_
+#define LOOPTIMING_H_
+
+/*******************************************************************************
+ * INCLUDED HEADER FILES
+ ******************************************************************************/
+#include "Arduino.h"
+#include "sysTimer.h"
+
+/*******************************************************************************
+ * MACRO DEFINITIONS
+ ******************************************************************************/
+#define LOOP_TIMING_ENABLE 1  // set to 0 to compile out all loop timing instrumentation (saves about 240 bytes of RAM)
+#define TIMING_HIST_BINS   12 // number of log2 histogram bins for each timed phase
+#define TIMING_HIST_SHIFT  3  // timer1 counts are shifted right by this before binning (bin 0 is < 4 us, bin N is 4*2^(N-1) to 4*2^N us, last bin is everything larger)
+
+/*******************************************************************************
+ * MACRO USED FOR DEFINING TABLE OF TIMED PHASES
+ ******************************************************************************/
+#define TIMINGLIST \
+  /*         id,        name */ \
+  TIMINGDEF ( TIM_TICK,  "TICK" ) /* all tasks run in one scheduler tick */ \
+  TIMINGDEF ( TIM_CTRL,  "CTRL" ) /* control task */ \
+  TIMINGDEF ( TIM_FANS,  "FANS" ) /* measFanSpeeds() */ \
+  TIMINGDEF ( TIM_BTNS,  "BTNS" ) /* checkButtonPress() */ \
+  TIMINGDEF ( TIM_STATE, "STAT" ) /* state machine control step */ \
+  TIMINGDEF ( TIM_PWM,   "PWM" )  /* PWM output updates */ \
+  TIMINGDEF ( TIM_LCD,   "LCD" )  /* display task */ \
+  TIMINGDEF ( TIM_SER,   "SER" )  /* serial task */
+
+#define TIMINGDEF( a, b ) a,
+typedef enum TIMING_ENUM
+{
+  TIMINGLIST
+  NUM_TIMINGS // number of timed phases
+} TIMING_ENUM_TYPE;
+#undef TIMINGDEF
+
+/*******************************************************************************
+ * MACROS FOR TIMING A SECTION OF CODE
+ ******************************************************************************/
+#if LOOP_TIMING_ENABLE
+#define TIMING_START( t ) \
+  /* Declares variable 't' and records the start time in it */ \
+  unsigned long t = sysTimerCount ( )
+#define TIMING_STOP( id, t ) \
+  /* Records the time elapsed since TIMING_START(t) against phase 'id' */ \
+  loopTimingRecord ( id, sysTimerCount ( ) - ( t ) )
+#else
+#define TIMING_START( t )
+#define TIMING_STOP( id, t )
+#endif
+
+/*******************************************************************************
+ * FUNCTION DECLARATIONS
+ ******************************************************************************/
+void loopTimingRecord ( TIMING_ENUM_TYPE id, unsigned long cnts ); // adds an execution time (timer1 counts) to the statistics of a phase
+void loopTimingMissedTicks ( byte ticks );                         // adds to the count of scheduler ticks missed due to overruns
+void loopTimingClear ( void );                                     // clears all timing statistics
+void loopTimingStartReport ( byte clearAfter );                    // starts reporting timing statistics over serial
+void loopTimingReport ( void );                                    // sends the next line of a timing report, if there is room in the serial transmit buffer
+
+#endif /* LOOPTIMING_H_ */
@@ -0,0 +1,35 @@
+/*
+ * oneWire.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+
+#ifndef ONEWIRE_H_
+#define ONEWIRE_H_
+
+/*******************************************************************************
+ * INCLUDED HEADER FILES
+ ******************************************************************************/
+#include "Arduino.h"
+#include "fanControlUtils.h"
+
+/*******************************************************************************
+ * MACRO DEFINITIONS
+ ******************************************************************************/
+#define OW_ROM_BYTES   8    // number of bytes in a device ROM code (family code, serial number, CRC)
+#define OW_SKIP_ROM    0xCC // ROM command addressing every device on the bus
+#define OW_MATCH_ROM   0x55 // ROM command addressing the device whose ROM code follows
+#define OW_SEARCH_ROM  0xF0 // ROM command starting a ROM search
+
+/*******************************************************************************
+ * FUNCTION DECLARATIONS
+ ******************************************************************************/
+void owInit ( void );                                                       // releases the 1-Wire bus
+byte owReset ( void );                                                      // sends a reset pulse, returning high if any device answered
+void owWriteByte ( byte val );                                              // writes a byte to the bus, least significant bit first
+byte owReadByte ( void );                                                   // reads a byte from the bus, least significant bit first
+byte owCrc8 ( const byte *buf, byte len );                                  // returns the 1-Wire CRC of a buffer (zero if the buffer ends in its own valid CRC)
+byte owSearch ( byte roms [ ][ OW_ROM_BYTES ], byte maxDevs, byte family ); // finds the ROM codes of the devices of one family on the bus, returning how many were found
+
+#endif /* ONEWIRE_H_ */
@@ -9,54 +9,129 @@
 #define PICONTROLLER_H_
 
 #include "Arduino.h"
+#include "fanControlUtils.h"
 
 /*******************************************************************************
  * MACRO DEFINITIONS
  ******************************************************************************/
-#define MINPIOUTPUT 1   // minimum PI output control value (must be >= 0, <= 255)
-#define MAXPIOUTPUT 255 // maximum PI output control value (must be >=0, <= 255, >= MINOUTPUT)
+#define MINPIOUTPUT 1      // minimum PI output control value (must be >= 0, <= 255)
+#define MAXPIOUTPUT 255    // maximum PI output control value (must be >=0, <= 255, >= MINOUTPUT)
+#define PI_KP_Q     13     // fraction bits of the fan proportional gain (duty counts per error count)
+#define PI_KI_Q     17     // fraction bits of the fan integral gain (duty counts per error count per 100 milliseconds)
+#define PI_OUT_Q    2      // fraction bits of the fan PI terms (duty counts)
+#define PI_INT_US   100000 // integrator time unit (microseconds), so the integrator holds tenths of error count times seconds
+
+/*******************************************************************************
+ * FUNCTION DEFINITIONS
+ ******************************************************************************/
+
+/******************************************************************************
+* Function:
+*   piGcd()
+*
+* Description:
+*   Returns the greatest common divisor of two numbers, at compile time
+*
+* Arguments:
+*   a, b - numbers
+*
+* Returns:
+*   gcd - greatest common divisor
+******************************************************************************/
+constexpr unsigned long piGcd ( unsigned long a, unsigned long b )
+{
+  return ( b == 0 ) ? a : piGcd ( b, a % b );
+} // end of piGcd()
+
+/******************************************************************************
+* Function:
+*   piSat()
+*
+* Description:
+*   Saturates a value to a range, and returns it as the type it is kept in
+*
+* Arguments:
+*   val - value to saturate
+*   lo - lowest value allowed
+*   hi - highest value allowed
+*
+* Returns:
+*   val - saturated value
+******************************************************************************/
+template <typename T>
+inline T piSat ( long val, long lo, long hi )
+{
+  return (T) ( ( val < lo ) ? lo : ( ( val > hi ) ? hi : val ) );
+} // end of piSat()
 
 /*******************************************************************************
  * CLASS DECLARATIONS
  ******************************************************************************/
 
 /*
- * Class:		piController
+ * Class:		piControllerQ
  * Function:	NA
  * Scope:		global
- * Arguments:	NA
- * Description:	This class contains the PI Controller functions and data
+ * Arguments:	KP_Q - fraction bits of the proportional gain (duty counts per error count)
+ *				KI_Q - fraction bits of the integral gain (duty counts per error count per PI_INT_US)
+ *				OUT_Q - fraction bits of the proportional, integral and feedforward terms (duty counts)
+ *				SAMPLE_US - sample time (microseconds)
+ * Description:	This class contains the PI Controller functions and data.
+ *				The fixed-point formats and sample time are template
+ *				arguments, so all the scaling is worked out at compile time:
+ *				the shifts are constants, and the integrator step reduces
+ *				to a constant fraction of the error (a halving, for the fans).
  */
-class piController
+template <byte KP_Q, byte KI_Q, byte OUT_Q, unsigned long SAMPLE_US>
+class piControllerQ
 {
 private:
-unsigned long sampleTime;  // sample time, (microseconds)
-int           errIntegral; // integral of error  (tenths of error count times seconds)
-int           maxErrInt;   // maximum value of errIntegral  (tenths of error count times seconds)
-int           minErrInt;   // maximum value of errIntegral  (tenths of error count times seconds)
-int           kp;          // Proportional gain (2^-13 duty counts per error count)
-int           ki;          // Integral gain (2^-17 duty counts per error count per 100 milliseconds)
-int           PropTerm;    // proportional term (quarter of duty counts)
-int           IntTerm;     // integral term (quarter of duty counts)
+static constexpr byte KP_SHIFT = KP_Q - OUT_Q;                                               // shift from error count times kp to the proportional term
+static constexpr byte KI_SHIFT = KI_Q - OUT_Q;                                               // shift from integrator times ki to the integral term
+static constexpr long INT_NUM  = SAMPLE_US / piGcd ( SAMPLE_US, PI_INT_US );                 // integrator counts per error count per sample, numerator
+static constexpr long INT_DEN  = PI_INT_US / piGcd ( SAMPLE_US, PI_INT_US );                 // integrator counts per error count per sample, denominator
+static constexpr long AW_GAIN  = ( (unsigned long long) SAMPLE_US << KP_SHIFT ) / PI_INT_US; // anti-windup gain, so the back-calculation runs over the integral time
+static constexpr long TERM_MAX = 16383;                                                      // largest proportional or integral term, so they add up within an int
+static constexpr long OUT_HI   = ( (long) ( MAXPIOUTPUT + 1 ) << OUT_Q ) - 1;                // largest sum of terms which isn't over the output limit
+static constexpr long OUT_LO   = (long) MINPIOUTPUT << OUT_Q;                                // smallest sum of terms which isn't under the output limit
+
+static_assert ( ( KP_Q >= OUT_Q ) && ( KI_Q >= OUT_Q ), "gains must have at least as many fraction bits as the terms" );
+static_assert ( KI_SHIFT <= 15, "integral term shift must fit in a long" );
+static_assert ( ( SAMPLE_US > 0 ) && ( AW_GAIN <= 32767 ), "sample time out of range" );
+
+int errIntegral; // integral of error (PI_INT_US times error count)
+int maxErrInt;   // maximum value of errIntegral (PI_INT_US times error count)
+int minErrInt;   // minimum value of errIntegral (PI_INT_US times error count)
+int kp;          // Proportional gain (2^-KP_Q duty counts per error count)
+int ki;          // Integral gain (2^-KI_Q duty counts per error count per PI_INT_US)
+int PropTerm;    // proportional term (2^-OUT_Q duty counts)
+int IntTerm;     // integral term (2^-OUT_Q duty counts)
 
 public:
-piController ( unsigned long sampleTimeSet,
-  int                        maxErrIntSet,
-  int                        minErrIntSet,
-  int                        kpSet,
-  int                        kiSet ); // constructor for piController
-void setGains ( unsigned long sampleTimeSet,
-  int                         maxErrIntSet,
-  int                         minErrIntSet,
-  int                         kpSet,
-  int                         kiSet ); // method for updating gains of PI controller
-void resetInt ( void );                // resets integral term to zero
-void resetInt ( int errInt );          // resets integral term to specified value
-byte piControl ( int errVal );         // executes one iteration of PI control loop
-byte piControlIntOff ( int errVal );   // executes the PI control loop without updating integral term, to avoid wind-up if needed.
-int  getPropTerm ( void );             // returns the proportional term.  good for debugging.
-int  getIntTerm ( void );              // returns the integral term.  good for debugging.
-int  getIntState ( void );             // returns the integrator state.  good for debugging.
+piControllerQ ( void ); // constructor for piController, with gains to be set by setGains()
+piControllerQ ( int maxErrIntSet,
+  int               minErrIntSet,
+  int               kpSet,
+  int               kiSet ); // constructor for piController
+void setGains ( int maxErrIntSet,
+  int               minErrIntSet,
+  int               kpSet,
+  int               kiSet ); // method for updating gains of PI controller
+void resetInt ( void );                                // resets integral term to zero
+void resetInt ( int errInt );                          // resets integral term to specified value
+void preload ( byte dutyNow, int errVal, int ffTerm ); // pre-loads the integrator so the next step gives the current duty (bumpless handover)
+byte piControl ( int errVal );                         // executes one iteration of PI control loop
+byte piControl ( int errVal, int ffTerm );             // executes one iteration of PI control loop, with a feedforward term added to the output
+int  getPropTerm ( void );                             // returns the proportional term.  good for debugging.
+int  getIntTerm ( void );                              // returns the integral term.  good for debugging.
+int  getIntState ( void );                             // returns the integrator state.  good for debugging.
 };
 
+/*******************************************************************************
+ * TYPE DEFINITIONS
+ ******************************************************************************/
+/* PI controller of the fans: gains in 2^-13 and 2^-17 duty counts, terms in
+ * quarter duty counts, run every control loop */
+typedef piControllerQ<PI_KP_Q, PI_KI_Q, PI_OUT_Q, LOOPTIME_US> piController;
+
 #endif /* PICONTROLLER_H_ */
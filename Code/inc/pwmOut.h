@@ -0,0 +1,39 @@
+/*
+ * pwmOut.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+
+#ifndef PWMOUT_H_
+#define PWMOUT_H_
+
+/*******************************************************************************
+ * INCLUDED HEADER FILES
+ ******************************************************************************/
+#include "Arduino.h"
+#include "fanControlUtils.h"
+
+/*******************************************************************************
+ * MACRO DEFINITIONS
+ ******************************************************************************/
+#define PWMOUT_BLANK_CNTS 16 // number of timer0 counts after each PWM switching instant during which inputs are not sampled (1 us)
+#define PWMOUT_LEAD_CNTS  16 // number of timer0 counts before each PWM switching instant which aren't quiet either, to cover the time from reading the count to sampling an input (1 us)
+
+/*******************************************************************************
+ * TYPE DEFINITION FOR PWM OUTPUT CHANNELS
+ ******************************************************************************/
+typedef enum PWMOUT_ENUM
+{
+  PWMOUT_1, // PWM 1 output (PWM1PIN, timer0 output compare B)
+  PWMOUT_2  // PWM 2 output (PWM2PIN, timer0 output compare A)
+} PWMOUT_ENUM_TYPE;
+
+/*******************************************************************************
+ * FUNCTION DECLARATIONS
+ ******************************************************************************/
+void pwmOutInit ( void );                            // sets up timer0 for 62500 Hz PWM on both outputs, starting at 0% duty
+void pwmOutSet ( PWMOUT_ENUM_TYPE chan, byte duty ); // sets the duty cycle of a PWM output (0-255 maps to 0%-100%)
+void pwmOutQuiet ( void );                           // waits until no PWM output has switched for PWMOUT_BLANK_CNTS timer0 counts, or will for PWMOUT_LEAD_CNTS
+
+#endif /* PWMOUT_H_ */
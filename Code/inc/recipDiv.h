@@ -0,0 +1,29 @@
+/*
+ * recipDiv.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+
+#ifndef RECIPDIV_H_
+#define RECIPDIV_H_
+
+/*******************************************************************************
+ * INCLUDED HEADER FILES
+ ******************************************************************************/
+#include "Arduino.h"
+
+/*******************************************************************************
+ * MACRO DEFINITIONS
+ ******************************************************************************/
+#define RECIP_TBL_BITS  7                               // log2 of number of intervals in reciprocal table
+#define RECIP_TBL_SIZE  ( ( 1 << RECIP_TBL_BITS ) + 1 ) // number of entries in reciprocal table (one extra for the interpolation end point)
+#define RECIP_TBL_SHIFT ( 15 - RECIP_TBL_BITS )         // right shift from normalized divisor offset to table index
+#define RECIP_MIN_DEN   4                               // divisors smaller than this use a real divide
+
+/*******************************************************************************
+ * FUNCTION DECLARATIONS
+ ******************************************************************************/
+unsigned long recipDiv ( unsigned long num, unsigned long den ); // returns num/den, using a reciprocal table instead of a divide (relative error < 2^-13)
+
+#endif /* RECIPDIV_H_ */
@@ -0,0 +1,42 @@
+/*
+ * refShape.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+
+#ifndef REFSHAPE_H_
+#define REFSHAPE_H_
+
+/*******************************************************************************
+ * INCLUDED HEADER FILES
+ ******************************************************************************/
+#include "Arduino.h"
+#include "fanControlUtils.h"
+
+/*******************************************************************************
+ * MACRO DEFINITIONS
+ ******************************************************************************/
+#define REF_SHAPE_FRAC_BITS 8 // fraction bits kept in the shaped reference, so slow slew rates still move
+#define REF_SKIP_BANDS      2 // number of speed bands the reference skips over (refSkipLo1/refSkipHi1, ...)
+
+#define REF_SLEW_STEP( a ) \
+  /* Converts a slew rate in rpm/s to a change per control loop, in rpm << REF_SHAPE_FRAC_BITS */ \
+  /* Returns the result as an unsigned long integer */ \
+  ( (unsigned long) ( a ) * ( ( (unsigned long) LOOPTIME_US << REF_SHAPE_FRAC_BITS ) / 1000UL ) / 1000UL )
+
+/*******************************************************************************
+ * TYPE DEFINITIONS
+ ******************************************************************************/
+/* Reference shaping stage of one fan, kept by the main loop.  Starts out
+ * zeroed, with the fan off. */
+typedef struct REF_SHAPE {
+  unsigned long ref; // shaped reference speed (rpm << REF_SHAPE_FRAC_BITS)
+} REF_SHAPE_TYPE;
+
+/*******************************************************************************
+ * FUNCTION DECLARATIONS
+ ******************************************************************************/
+unsigned int refShapeUpdate ( REF_SHAPE_TYPE *shape, unsigned int target, unsigned int minRpm ); // moves the shaped reference toward a new target, returning the shaped reference speed (rpm)
+
+#endif /* REFSHAPE_H_ */
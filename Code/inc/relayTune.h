@@ -0,0 +1,68 @@
+/*
+ * relayTune.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+
+#ifndef RELAYTUNE_H_
+#define RELAYTUNE_H_
+
+/*******************************************************************************
+ * INCLUDED HEADER FILES
+ ******************************************************************************/
+#include "Arduino.h"
+#include "fanControlUtils.h"
+
+/*******************************************************************************
+ * MACRO DEFINITIONS
+ ******************************************************************************/
+#define RTUNE_LOOPS( ms )  ( (unsigned int) ( (unsigned long) ( ms ) * 1000UL / LOOPTIME_US ) ) // number of control loops in a time (milliseconds)
+#define RTUNE_SETTLE_LOOPS RTUNE_LOOPS ( 8000 )                                                 // least control loops the PI controller holds the fan at the reference before the relay starts
+#define RTUNE_BIAS_LOOPS   RTUNE_LOOPS ( 2000 )                                                 // control loops at the end of settling averaged for the relay bias duty, all with the speed in the settling band
+#define RTUNE_BAND_SHIFT   5                                                                    // speed error allowed while settling, as a right shift of the reference (about 3%)
+#define RTUNE_MAX_LOOPS    RTUNE_LOOPS ( 60000 )                                                // longest time settling, or the relay, may run before the experiment is given up (control loops)
+#define RTUNE_SKIP_CYCLES  2                                                                    // relay cycles let go by before measuring, while the oscillation builds up
+#define RTUNE_MEAS_CYCLES  4                                                                    // relay cycles averaged for the ultimate gain and period
+#define RTUNE_DEF_AMP      25                                                                   // relay amplitude used if none is given (duty counts)
+#define RTUNE_DEF_HYST     20                                                                   // relay hysteresis used if none is given (rpm)
+
+/*******************************************************************************
+ * TYPE DEFINITIONS
+ ******************************************************************************/
+/* Phases of the relay experiment */
+typedef enum RTUNE_PHASE_ENUM
+{
+  RTUNE_SETTLE, // PI controller holds the fan at the reference, to find the bias duty
+  RTUNE_RELAY,  // relay drives the fan into oscillation, and the cycles are measured
+  RTUNE_DONE,   // cycles measured, gains can be worked out
+  RTUNE_FAILED  // no steady oscillation in time
+} RTUNE_PHASE_ENUM_TYPE;
+
+/* Relay feedback experiment on one fan, set up by relayTuneStart() */
+typedef struct RELAY_TUNE {
+  unsigned long sumPeriod; // sum of the measured cycle periods (control loops)
+  unsigned long sumSwing;  // sum of the measured cycle peak-to-peak speeds (rpm)
+  unsigned int  sumDuty;   // sum of the PI duties while finding the bias (duty counts)
+  unsigned int  ref;       // speed the relay switches about (rpm)
+  unsigned int  hyst;      // relay hysteresis (rpm)
+  unsigned int  loops;     // control loops since the start of the phase
+  unsigned int  lastUp;    // loops count at the last upward switch of the relay
+  unsigned int  rpmMax;    // highest speed in the current cycle (rpm)
+  unsigned int  rpmMin;    // lowest speed in the current cycle (rpm)
+  byte          amp;       // relay amplitude (duty counts)
+  byte          bias;      // duty the relay switches about (duty counts)
+  byte          high;      // high while the relay output is high
+  byte          steady;    // control loops of the bias average so far, all with the speed in the settling band
+  byte          cycles;    // relay cycles completed
+  byte          phase;     // phase of the experiment (RTUNE_xxx)
+} RELAY_TUNE_TYPE;
+
+/*******************************************************************************
+ * FUNCTION DECLARATIONS
+ ******************************************************************************/
+void relayTuneStart ( RELAY_TUNE_TYPE *tune, unsigned int ref, byte amp, unsigned int hyst ); // sets up a relay experiment about a speed
+byte relayTuneStep ( RELAY_TUNE_TYPE *tune, unsigned int rpm, byte *duty );                  // runs one control loop of the experiment, returning its phase
+byte relayTuneGains ( const RELAY_TUNE_TYPE *tune, int *kp, int *ki );                       // works out PI gains from a finished experiment, returning high if they are valid
+
+#endif /* RELAYTUNE_H_ */
@@ -12,6 +12,7 @@
  * INCLUDED HEADER FILES
  ******************************************************************************/
 #include <stddef.h>
+#include <avr/pgmspace.h>
 #include "fanControlUtils.h"
 
 #ifdef __cplusplus
@@ -34,68 +35,118 @@ extern "C" {
  ******************************************************************************/
 #define SAVEDVARLIST \
   /* DO NOT CHANGE THE codeVer ENTRY OF THE TABLE BELOW */ \
-  /*           varName,         sign,     type, min,        max,        default */ \
-  SAVEDVARDEF ( codeVer,        unsigned, long, 0x00000000, 0xFFFFFFFF, CODEVER )    /* Code Version */ \
-  SAVEDVARDEF ( Temp1Offset,    signed,   int,  -5000,      5000,       0 )          /* Offset in temperature 1 measurement, mV reading at 0 degC */ \
-  SAVEDVARDEF ( Temp2Offset,    signed,   int,  -5000,      5000,       0 )          /* Offset in temperature 2 measurement, mV reading at 0 degC */ \
-  SAVEDVARDEF ( Temp1DegCPer5V, signed,   int,  -5000,      5000,       250 )        /* Scale of temperature 1 measurement, degC per 5 V */ \
-  SAVEDVARDEF ( Temp2DegCPer5V, signed,   int,  -5000,      5000,       250 )        /* Scale of temperature 2 measurement, degC per 5 V */ \
-  SAVEDVARDEF ( minRpm1,        unsigned, int,  MINN1,      MAXN1,      650 )        /* minimum fan 1 speed setpoint, rpm */ \
-  SAVEDVARDEF ( minRpm2,        unsigned, int,  MINN2,      MAXN2,      650 )        /* minimum fan 2 speed setpoint, rpm */ \
-  SAVEDVARDEF ( maxRpm1,        unsigned, int,  MINN1,      MAXN1,      1100 )       /* minimum fan 1 speed setpoint, rpm */ \
-  SAVEDVARDEF ( maxRpm2,        unsigned, int,  MINN2,      MAXN2,      1100 )       /* minimum fan 2 speed setpoint, rpm */ \
-  SAVEDVARDEF ( useFtemp,       unsigned, int,  0,          1,          0 )          /* When high, temps are displayed in degF instead of degC */ \
-  SAVEDVARDEF ( pi1Kp,          signed,   int,  0,          32767,      5000 )       /* PI controller 1 proportional gain */ \
-  SAVEDVARDEF ( pi1Ki,          signed,   int,  0,          32767,      5000 )       /* PI controller 1 integral gain */ \
-  SAVEDVARDEF ( pi1Imax,        signed,   int,  0,          32767,      30000 )      /* PI controller 1 integrator max limit */ \
-  SAVEDVARDEF ( pi1Imin,        signed,   int,  -32768,     0,          -30000 )     /* PI controller 1 integrator min limit */ \
-  SAVEDVARDEF ( pi2Kp,          signed,   int,  0,          32767,      5000 )       /* PI controller 2 proportional gain */ \
-  SAVEDVARDEF ( pi2Ki,          signed,   int,  0,          32767,      5000 )       /* PI controller 2 integral gain */ \
-  SAVEDVARDEF ( pi2Imax,        signed,   int,  0,          32767,      30000 )      /* PI controller 2 integrator max limit */ \
-  SAVEDVARDEF ( pi2Imin,        signed,   int,  -32768,     0,          -30000 )     /* PI controller 2 integrator min limit */ \
-  SAVEDVARDEF ( fan1Filt,       unsigned, int,  0,          1023,       768 )        /* fan 1 speed filter gain, between 0 and 1023.  Larger value is slower filter response. */ \
-  SAVEDVARDEF ( fan2Filt,       unsigned, int,  0,          1023,       768 )        /* fan 2 speed filter gain, between 0 and 1023.  Larger value is slower filter response. */ \
-  SAVEDVARDEF ( tmpsrc1,        unsigned, int,  0,          3,          TMPSRC_DEF ) /* Source of temp feedback for fan 1.  0=TMP1, 1=TMP2, 2=MAX, 3=MEAN. */ \
-  SAVEDVARDEF ( fan1TurnOffTmp, unsigned, int,  0,          1023,       109 )        /* Raw temperature value at which fan 1 turns off. */ \
-  SAVEDVARDEF ( fan1TurnOnTmp,  unsigned, int,  0,          1023,       132 )        /* Raw temperature value at which fan 1 turns on (goes to minRpm1). */ \
-  SAVEDVARDEF ( fan1TblTmp1,    unsigned, int,  0,          1023,       155 )        /* Raw temperature value of first point in fan1 lookup table. */ \
-  SAVEDVARDEF ( fan1TblTmp2,    unsigned, int,  0,          1023,       189 )        /* Raw temperature value of second point in fan1 lookup table. */ \
-  SAVEDVARDEF ( fan1TblTmp3,    unsigned, int,  0,          1023,       223 )        /* Raw temperature value of third point in fan1 lookup table. */ \
-  SAVEDVARDEF ( fan1TblTmp4,    unsigned, int,  0,          1023,       246 )        /* Raw temperature value of fourth point in fan1 lookup table. */ \
-  SAVEDVARDEF ( fan1TblSpd1,    unsigned, int,  MINN1,      MAXN1,      660 )        /* Speed value at first point in fan1 lookup table. */ \
-  SAVEDVARDEF ( fan1TblSpd2,    unsigned, int,  MINN1,      MAXN1,      750 )        /* Speed value at second point in fan1 lookup table. */ \
-  SAVEDVARDEF ( fan1TblSpd3,    unsigned, int,  MINN1,      MAXN1,      1100 )       /* Speed value at third point in fan1 lookup table. */ \
-  SAVEDVARDEF ( fan1TblSpd4,    unsigned, int,  MINN1,      MAXN1,      1100 )       /* Speed value at fourth point in fan1 lookup table. */ \
-  SAVEDVARDEF ( tmpsrc2,        unsigned, int,  0,          3,          TMPSRC_DEF ) /* Source of temp feedback for fan 2.  0=TMP1, 1=TMP2, 2=MAX, 3=MEAN. */ \
-  SAVEDVARDEF ( fan2TurnOffTmp, unsigned, int,  0,          1023,       109 )        /* Raw temperature value at which fan 2 turns off. */ \
-  SAVEDVARDEF ( fan2TurnOnTmp,  unsigned, int,  0,          1023,       132 )        /* Raw temperature value at which fan 2 turns on (goes to minRpm2). */ \
-  SAVEDVARDEF ( fan2TblTmp1,    unsigned, int,  0,          1023,       155 )        /* Raw temperature value of first point in fan2 lookup table. */ \
-  SAVEDVARDEF ( fan2TblTmp2,    unsigned, int,  0,          1023,       189 )        /* Raw temperature value of second point in fan2 lookup table. */ \
-  SAVEDVARDEF ( fan2TblTmp3,    unsigned, int,  0,          1023,       223 )        /* Raw temperature value of third point in fan2 lookup table. */ \
-  SAVEDVARDEF ( fan2TblTmp4,    unsigned, int,  0,          1023,       246 )        /* Raw temperature value of fourth point in fan2 lookup table. */ \
-  SAVEDVARDEF ( fan2TblSpd1,    unsigned, int,  MINN1,      MAXN1,      660 )        /* Speed value at first point in fan2 lookup table. */ \
-  SAVEDVARDEF ( fan2TblSpd2,    unsigned, int,  MINN1,      MAXN1,      750 )        /* Speed value at second point in fan2 lookup table. */ \
-  SAVEDVARDEF ( fan2TblSpd3,    unsigned, int,  MINN1,      MAXN1,      1100 )       /* Speed value at third point in fan2 lookup table. */ \
-  SAVEDVARDEF ( fan2TblSpd4,    unsigned, int,  MINN1,      MAXN1,      1100 )       /* Speed value at fourth point in fan2 lookup table. */
+  /*           varName,         sign,     type, min,           max,              default */ \
+  SAVEDVARDEF ( codeVer,        unsigned, long, 0x00000000,    0xFFFFFFFF,       CODEVER )                /* Code Version */ \
+  SAVEDVARDEF ( Temp1Offset,    signed,   int,  -5000,         5000,             0 )                      /* Offset in temperature 1 measurement, mV reading at 0 degC */ \
+  SAVEDVARDEF ( Temp2Offset,    signed,   int,  -5000,         5000,             0 )                      /* Offset in temperature 2 measurement, mV reading at 0 degC */ \
+  SAVEDVARDEF ( Temp1DegCPer5V, signed,   int,  -5000,         5000,             250 )                    /* Scale of temperature 1 measurement, degC per 5 V */ \
+  SAVEDVARDEF ( Temp2DegCPer5V, signed,   int,  -5000,         5000,             250 )                    /* Scale of temperature 2 measurement, degC per 5 V */ \
+  SAVEDVARDEF ( minRpm1,        unsigned, int,  MINN1,         MAXN1,            650 )                    /* minimum fan 1 speed setpoint, rpm */ \
+  SAVEDVARDEF ( minRpm2,        unsigned, int,  MINN2,         MAXN2,            650 )                    /* minimum fan 2 speed setpoint, rpm */ \
+  SAVEDVARDEF ( maxRpm1,        unsigned, int,  MINN1,         MAXN1,            1100 )                   /* minimum fan 1 speed setpoint, rpm */ \
+  SAVEDVARDEF ( maxRpm2,        unsigned, int,  MINN2,         MAXN2,            1100 )                   /* minimum fan 2 speed setpoint, rpm */ \
+  SAVEDVARDEF ( useFtemp,       unsigned, int,  0,             1,                0 )                      /* When high, temps are displayed in degF instead of degC */ \
+  SAVEDVARDEF ( pi1Kp,          signed,   int,  0,             32767,            5000 )                   /* PI controller 1 proportional gain */ \
+  SAVEDVARDEF ( pi1Ki,          signed,   int,  0,             32767,            5000 )                   /* PI controller 1 integral gain */ \
+  SAVEDVARDEF ( pi1Imax,        signed,   int,  0,             32767,            30000 )                  /* PI controller 1 integrator max limit */ \
+  SAVEDVARDEF ( pi1Imin,        signed,   int,  -32768,        0,                -30000 )                 /* PI controller 1 integrator min limit */ \
+  SAVEDVARDEF ( pi2Kp,          signed,   int,  0,             32767,            5000 )                   /* PI controller 2 proportional gain */ \
+  SAVEDVARDEF ( pi2Ki,          signed,   int,  0,             32767,            5000 )                   /* PI controller 2 integral gain */ \
+  SAVEDVARDEF ( pi2Imax,        signed,   int,  0,             32767,            30000 )                  /* PI controller 2 integrator max limit */ \
+  SAVEDVARDEF ( pi2Imin,        signed,   int,  -32768,        0,                -30000 )                 /* PI controller 2 integrator min limit */ \
+  SAVEDVARDEF ( fan1Filt,       unsigned, int,  0,             1023,             384 )                    /* fan 1 speed filter gain, between 0 and 1023.  Larger value is slower filter response. */ \
+  SAVEDVARDEF ( fan2Filt,       unsigned, int,  0,             1023,             384 )                    /* fan 2 speed filter gain, between 0 and 1023.  Larger value is slower filter response. */ \
+  SAVEDVARDEF ( tmpsrc1,        unsigned, int,  0,             TMPSRC_LAST,      TMPSRC_DEF )             /* Source of temp feedback for fan 1.  0=TMP1, 1=TMP2, 2=MAX, 3=MEAN, 4=OW1, 5=OW2, 6=FUSE. */ \
+  SAVEDVARDEF ( fan1TurnOffTmp, unsigned, int,  0,             TEMP_DIG_MAX,     TEMP10_TO_DIG ( 109 ) )  /* Raw temperature value at which fan 1 turns off. */ \
+  SAVEDVARDEF ( fan1TurnOnTmp,  unsigned, int,  0,             TEMP_DIG_MAX,     TEMP10_TO_DIG ( 132 ) )  /* Raw temperature value at which fan 1 turns on (goes to minRpm1). */ \
+  SAVEDVARDEF ( fan1TblTmp1,    unsigned, int,  0,             TEMP_DIG_MAX,     TEMP10_TO_DIG ( 155 ) )  /* Raw temperature value of first point in fan1 lookup table. */ \
+  SAVEDVARDEF ( fan1TblTmp2,    unsigned, int,  0,             TEMP_DIG_MAX,     TEMP10_TO_DIG ( 189 ) )  /* Raw temperature value of second point in fan1 lookup table. */ \
+  SAVEDVARDEF ( fan1TblTmp3,    unsigned, int,  0,             TEMP_DIG_MAX,     TEMP10_TO_DIG ( 223 ) )  /* Raw temperature value of third point in fan1 lookup table. */ \
+  SAVEDVARDEF ( fan1TblTmp4,    unsigned, int,  0,             TEMP_DIG_MAX,     TEMP10_TO_DIG ( 246 ) )  /* Raw temperature value of fourth point in fan1 lookup table. */ \
+  SAVEDVARDEF ( fan1TblSpd1,    unsigned, int,  MINN1,         MAXN1,            660 )                    /* Speed value at first point in fan1 lookup table. */ \
+  SAVEDVARDEF ( fan1TblSpd2,    unsigned, int,  MINN1,         MAXN1,            750 )                    /* Speed value at second point in fan1 lookup table. */ \
+  SAVEDVARDEF ( fan1TblSpd3,    unsigned, int,  MINN1,         MAXN1,            1100 )                   /* Speed value at third point in fan1 lookup table. */ \
+  SAVEDVARDEF ( fan1TblSpd4,    unsigned, int,  MINN1,         MAXN1,            1100 )                   /* Speed value at fourth point in fan1 lookup table. */ \
+  SAVEDVARDEF ( tmpsrc2,        unsigned, int,  0,             TMPSRC_LAST,      TMPSRC_DEF )             /* Source of temp feedback for fan 2.  0=TMP1, 1=TMP2, 2=MAX, 3=MEAN, 4=OW1, 5=OW2, 6=FUSE. */ \
+  SAVEDVARDEF ( fan2TurnOffTmp, unsigned, int,  0,             TEMP_DIG_MAX,     TEMP10_TO_DIG ( 109 ) )  /* Raw temperature value at which fan 2 turns off. */ \
+  SAVEDVARDEF ( fan2TurnOnTmp,  unsigned, int,  0,             TEMP_DIG_MAX,     TEMP10_TO_DIG ( 132 ) )  /* Raw temperature value at which fan 2 turns on (goes to minRpm2). */ \
+  SAVEDVARDEF ( fan2TblTmp1,    unsigned, int,  0,             TEMP_DIG_MAX,     TEMP10_TO_DIG ( 155 ) )  /* Raw temperature value of first point in fan2 lookup table. */ \
+  SAVEDVARDEF ( fan2TblTmp2,    unsigned, int,  0,             TEMP_DIG_MAX,     TEMP10_TO_DIG ( 189 ) )  /* Raw temperature value of second point in fan2 lookup table. */ \
+  SAVEDVARDEF ( fan2TblTmp3,    unsigned, int,  0,             TEMP_DIG_MAX,     TEMP10_TO_DIG ( 223 ) )  /* Raw temperature value of third point in fan2 lookup table. */ \
+  SAVEDVARDEF ( fan2TblTmp4,    unsigned, int,  0,             TEMP_DIG_MAX,     TEMP10_TO_DIG ( 246 ) )  /* Raw temperature value of fourth point in fan2 lookup table. */ \
+  SAVEDVARDEF ( fan2TblSpd1,    unsigned, int,  MINN1,         MAXN1,            660 )                    /* Speed value at first point in fan2 lookup table. */ \
+  SAVEDVARDEF ( fan2TblSpd2,    unsigned, int,  MINN1,         MAXN1,            750 )                    /* Speed value at second point in fan2 lookup table. */ \
+  SAVEDVARDEF ( fan2TblSpd3,    unsigned, int,  MINN1,         MAXN1,            1100 )                   /* Speed value at third point in fan2 lookup table. */ \
+  SAVEDVARDEF ( fan2TblSpd4,    unsigned, int,  MINN1,         MAXN1,            1100 )                   /* Speed value at fourth point in fan2 lookup table. */ \
+  SAVEDVARDEF ( tmpMedN,        unsigned, int,  1,             TEMPCOND_MED_MAX, 3 )                      /* Number of newest temperature readings taken the median of, to throw out spikes. */ \
+  SAVEDVARDEF ( tmpFilt,        unsigned, int,  0,             1023,             768 )                    /* temperature filter gain, between 0 and 1023.  Larger value is slower filter response. */ \
+  SAVEDVARDEF ( tmpMinRaw,      unsigned, int,  0,             TEMP_DIG_MAX,     TEMP10_TO_DIG ( 10 ) )   /* Raw temperature value below which a sensor is taken as shorted or open. */ \
+  SAVEDVARDEF ( tmpMaxRaw,      unsigned, int,  0,             TEMP_DIG_MAX,     TEMP10_TO_DIG ( 1013 ) ) /* Raw temperature value above which a sensor is taken as shorted or open. */ \
+  SAVEDVARDEF ( tmpMaxStep,     unsigned, int,  1,             TEMP_DIG_MAX,     TEMP10_TO_DIG ( 16 ) )   /* Largest change in raw temperature between control loops before a sensor is taken as faulty. */ \
+  SAVEDVARDEF ( failsafeRpm1,   unsigned, int,  MINN1,         MAXN1,            1100 )                   /* fan 1 speed setpoint while its temperature sensor is faulted, rpm */ \
+  SAVEDVARDEF ( failsafeRpm2,   unsigned, int,  MINN2,         MAXN2,            1100 )                   /* fan 2 speed setpoint while its temperature sensor is faulted, rpm */ \
+  SAVEDVARDEF ( refSlewUp,      unsigned, int,  0,             65535,            200 )                    /* Largest rate of rise of the fan speed setpoints, rpm/s.  0 for no limit. */ \
+  SAVEDVARDEF ( refSlewDn,      unsigned, int,  0,             65535,            100 )                    /* Largest rate of fall of the fan speed setpoints, rpm/s.  0 for no limit. */ \
+  SAVEDVARDEF ( refSkipLo1,     unsigned, int,  0,             MAXN1,            0 )                      /* Bottom of first speed band the setpoints never settle in (e.g. a cabinet resonance), rpm. */ \
+  SAVEDVARDEF ( refSkipHi1,     unsigned, int,  0,             MAXN1,            0 )                      /* Top of first speed band the setpoints never settle in, rpm.  Band is disabled unless above refSkipLo1. */ \
+  SAVEDVARDEF ( refSkipLo2,     unsigned, int,  0,             MAXN1,            0 )                      /* Bottom of second speed band the setpoints never settle in, rpm. */ \
+  SAVEDVARDEF ( refSkipHi2,     unsigned, int,  0,             MAXN1,            0 )                      /* Top of second speed band the setpoints never settle in, rpm.  Band is disabled unless above refSkipLo2. */ \
+  SAVEDVARDEF ( ffGain,         unsigned, int,  0,             1000,             8 )                      /* Feedforward speed boost while the temperature is rising, rpm per raw temperature count per minute of rise.  0 to disable. */ \
+  SAVEDVARDEF ( ffFilt,         unsigned, int,  0,             1023,             512 )                    /* Rise rate filter gain, between 0 and 1023.  Larger value is slower filter response (and slower decay of the boost). */ \
+  SAVEDVARDEF ( ffMax,          unsigned, int,  0,             MAXN1,            400 )                    /* Largest feedforward speed boost, rpm. */ \
+  SAVEDVARDEF ( fuse1Wt1,       unsigned, int,  0,             255,              1 )                      /* Weight of input 1 (1=TMP1, 2=TMP2, 3=OW1, 4=OW2) in fan 1 temp fusion (tmpsrc1=6).  0 leaves the input out. */ \
+  SAVEDVARDEF ( fuse1Wt2,       unsigned, int,  0,             255,              1 )                      /* Weight of input 2 (1=TMP1, 2=TMP2, 3=OW1, 4=OW2) in fan 1 temp fusion (tmpsrc1=6).  0 leaves the input out. */ \
+  SAVEDVARDEF ( fuse1Wt3,       unsigned, int,  0,             255,              0 )                      /* Weight of input 3 (1=TMP1, 2=TMP2, 3=OW1, 4=OW2) in fan 1 temp fusion (tmpsrc1=6).  0 leaves the input out. */ \
+  SAVEDVARDEF ( fuse1Wt4,       unsigned, int,  0,             255,              0 )                      /* Weight of input 4 (1=TMP1, 2=TMP2, 3=OW1, 4=OW2) in fan 1 temp fusion (tmpsrc1=6).  0 leaves the input out. */ \
+  SAVEDVARDEF ( fuse1Ofs1,      signed,   int,  -TEMP_DIG_MAX, TEMP_DIG_MAX,     0 )                      /* Raw temperature offset added to input 1 in fan 1 temp fusion. */ \
+  SAVEDVARDEF ( fuse1Ofs2,      signed,   int,  -TEMP_DIG_MAX, TEMP_DIG_MAX,     0 )                      /* Raw temperature offset added to input 2 in fan 1 temp fusion. */ \
+  SAVEDVARDEF ( fuse1Ofs3,      signed,   int,  -TEMP_DIG_MAX, TEMP_DIG_MAX,     0 )                      /* Raw temperature offset added to input 3 in fan 1 temp fusion. */ \
+  SAVEDVARDEF ( fuse1Ofs4,      signed,   int,  -TEMP_DIG_MAX, TEMP_DIG_MAX,     0 )                      /* Raw temperature offset added to input 4 in fan 1 temp fusion. */ \
+  SAVEDVARDEF ( fuse1Mode,      unsigned, int,  0,             TFUSE_MAX,        TFUSE_MAX )              /* Fan 1 temp fusion mode.  0=weighted MEAN, 1=MAX of inputs with nonzero weight. */ \
+  SAVEDVARDEF ( fuse2Wt1,       unsigned, int,  0,             255,              1 )                      /* Weight of input 1 (1=TMP1, 2=TMP2, 3=OW1, 4=OW2) in fan 2 temp fusion (tmpsrc2=6).  0 leaves the input out. */ \
+  SAVEDVARDEF ( fuse2Wt2,       unsigned, int,  0,             255,              1 )                      /* Weight of input 2 (1=TMP1, 2=TMP2, 3=OW1, 4=OW2) in fan 2 temp fusion (tmpsrc2=6).  0 leaves the input out. */ \
+  SAVEDVARDEF ( fuse2Wt3,       unsigned, int,  0,             255,              0 )                      /* Weight of input 3 (1=TMP1, 2=TMP2, 3=OW1, 4=OW2) in fan 2 temp fusion (tmpsrc2=6).  0 leaves the input out. */ \
+  SAVEDVARDEF ( fuse2Wt4,       unsigned, int,  0,             255,              0 )                      /* Weight of input 4 (1=TMP1, 2=TMP2, 3=OW1, 4=OW2) in fan 2 temp fusion (tmpsrc2=6).  0 leaves the input out. */ \
+  SAVEDVARDEF ( fuse2Ofs1,      signed,   int,  -TEMP_DIG_MAX, TEMP_DIG_MAX,     0 )                      /* Raw temperature offset added to input 1 in fan 2 temp fusion. */ \
+  SAVEDVARDEF ( fuse2Ofs2,      signed,   int,  -TEMP_DIG_MAX, TEMP_DIG_MAX,     0 )                      /* Raw temperature offset added to input 2 in fan 2 temp fusion. */ \
+  SAVEDVARDEF ( fuse2Ofs3,      signed,   int,  -TEMP_DIG_MAX, TEMP_DIG_MAX,     0 )                      /* Raw temperature offset added to input 3 in fan 2 temp fusion. */ \
+  SAVEDVARDEF ( fuse2Ofs4,      signed,   int,  -TEMP_DIG_MAX, TEMP_DIG_MAX,     0 )                      /* Raw temperature offset added to input 4 in fan 2 temp fusion. */ \
+  SAVEDVARDEF ( fuse2Mode,      unsigned, int,  0,             TFUSE_MAX,        TFUSE_MAX )              /* Fan 2 temp fusion mode.  0=weighted MEAN, 1=MAX of inputs with nonzero weight. */ \
+  SAVEDVARDEF ( dmap1Ofs,       signed,   int,  -1020,         1020,             0 )                      /* Fan 1 duty map offset, quarter duty counts at 0 rpm.  Learned when dmapMode=2. */ \
+  SAVEDVARDEF ( dmap1Slope,     signed,   int,  0,             32767,            0 )                      /* Fan 1 duty map slope, 2^-13 quarter duty counts per rpm.  Learned when dmapMode=2. */ \
+  SAVEDVARDEF ( dmap2Ofs,       signed,   int,  -1020,         1020,             0 )                      /* Fan 2 duty map offset, quarter duty counts at 0 rpm.  Learned when dmapMode=2. */ \
+  SAVEDVARDEF ( dmap2Slope,     signed,   int,  0,             32767,            0 )                      /* Fan 2 duty map slope, 2^-13 quarter duty counts per rpm.  Learned when dmapMode=2. */ \
+  SAVEDVARDEF ( dmapMode,       unsigned, int,  0,             DMAP_LEARN,       DMAP_LEARN )             /* Duty feedforward mode.  0=OFF, 1=USE saved duty maps, 2=use and LEARN them (saved at most hourly). */
 
 
 /*******************************************************************************
  * TYPE DEFINITION FOR TABLE OF SAVED VARIABLE INFO
  ******************************************************************************/
 typedef struct SAVED_VAR_TABLE {
-  void *const varPtr;    // pointer to RAM variable location
-  int         varSigned; // high if variable is signed, 0 otherwise
-  size_t      varSize;   // number of bytes of this variable
-  long        varMin;    // minimum value
-  long        varMax;    // maximum value
-  long        varDef;    // default value
+  void *const   varPtr;    // pointer to RAM variable location
+  unsigned char varSigned; // high if variable is signed, 0 otherwise
+  unsigned char varSize;   // number of bytes of this variable
+  long          varMin;    // minimum value
+  long          varMax;    // maximum value
+  long          varDef;    // default value
 } SAVED_VAR_TABLE_TYPE;
 
+/*******************************************************************************
+ * MACROS FOR READING THE SAVED VARIABLE TABLE (STORED IN FLASH)
+ ******************************************************************************/
+#define SVTBL_PTR( i )    ( (void *) pgm_read_word ( &savedVarsTbl [ i ].varPtr ) ) // pointer to RAM variable of a table entry
+#define SVTBL_SIGNED( i ) ( pgm_read_byte ( &savedVarsTbl [ i ].varSigned ) )       // high if the variable of a table entry is signed
+#define SVTBL_SIZE( i )   ( pgm_read_byte ( &savedVarsTbl [ i ].varSize ) )         // number of bytes of the variable of a table entry
+#define SVTBL_MIN( i )    ( (long) pgm_read_dword ( &savedVarsTbl [ i ].varMin ) )  // minimum value of a table entry
+#define SVTBL_MAX( i )    ( (long) pgm_read_dword ( &savedVarsTbl [ i ].varMax ) )  // maximum value of a table entry
+#define SVTBL_DEF( i )    ( (long) pgm_read_dword ( &savedVarsTbl [ i ].varDef ) )  // default value of a table entry
+
 /*******************************************************************************
  * VARIABLE DECLARATIONS
  ******************************************************************************/
-extern const SAVED_VAR_TABLE_TYPE savedVarsTbl []; // table of saved variables
+extern const SAVED_VAR_TABLE_TYPE savedVarsTbl []; // table of saved variables (stored in flash)
 extern const size_t               savedVarsTblSize;
+extern unsigned char              savedVarsGen;     // changes whenever a saved variable is loaded or saved, so values worked out from them can tell they are stale
 
 /*******************************************************************************
  * EEPROM-STORED GLOBAL VARIABLE DECLARATIONS
@@ -0,0 +1,34 @@
+/*
+ * sysTimer.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+
+#ifndef SYSTIMER_H_
+#define SYSTIMER_H_
+
+/*******************************************************************************
+ * INCLUDED HEADER FILES
+ ******************************************************************************/
+#include "Arduino.h"
+#include "fanControlUtils.h"
+
+/*******************************************************************************
+ * MACRO DEFINITIONS
+ ******************************************************************************/
+#define SYSTIMER_PRESCALE     8                                                                                           // Timer1 clock prescaler (timer1 is free-running, OC1A/OC1B pins left disconnected)
+#define SYSTIMER_CNTS_PER_US  ( F_CPU / 1000000UL / SYSTIMER_PRESCALE )                                                   // number of timer1 counts per microsecond
+#define SYSTICK_CNTS          ( (unsigned int) ( (unsigned long) SYSTICK_US * ( F_CPU / 1000000UL ) / SYSTIMER_PRESCALE ) ) // number of timer1 counts in each scheduler tick (must be < 65536)
+
+/*******************************************************************************
+ * FUNCTION DECLARATIONS
+ ******************************************************************************/
+void               sysTimerInit ( void );                   // starts timer1 and enables the periodic scheduler tick interrupt
+byte               sysTimerWaitTick ( void );               // sleeps (idle mode) until the next scheduler tick, and returns number of ticks elapsed since last call
+unsigned long      sysTimerCount ( void );                  // returns the 32-bit extended timer1 count (SYSTIMER_PRESCALE cpu cycles per count)
+unsigned long long sysTimerCount64 ( void );                // returns the 64-bit extended timer1 count (SYSTIMER_PRESCALE cpu cycles per count)
+unsigned long      sysTimerExtend ( unsigned int capture ); // extends a recently captured 16-bit timer1 value to a 32-bit count
+void               sysTimerCaptureInit ( void );            // enables the timer1 input capture unit and its interrupt
+
+#endif /* SYSTIMER_H_ */
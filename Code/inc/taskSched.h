@@ -0,0 +1,62 @@
+/*
+ * taskSched.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+
+#ifndef TASKSCHED_H_
+#define TASKSCHED_H_
+
+/*******************************************************************************
+ * INCLUDED HEADER FILES
+ ******************************************************************************/
+#include "Arduino.h"
+#include "fanControlUtils.h"
+
+/*******************************************************************************
+ * MACRO DEFINITIONS
+ ******************************************************************************/
+#define CTRL_TICKS   ( LOOPTIME_US / SYSTICK_US ) // scheduler ticks between each control loop iteration
+#define LCD_TICKS    ( CTRL_TICKS * 5 )           // scheduler ticks between each LCD update (must be a multiple of CTRL_TICKS)
+#define SERIAL_TICKS CTRL_TICKS                   // scheduler ticks between each check for serial messages
+#define OW_TICKS     2                            // scheduler ticks between each step of the 1-Wire read cycle
+#define DMAP_TICKS   CTRL_TICKS                   // scheduler ticks between each check for a duty map setting to save
+
+/*******************************************************************************
+ * MACRO USED FOR DEFINING TASK TABLE
+ *
+ * Each task runs once every 'period' ticks, starting at tick number 'phase'.
+ * Tasks which are due in the same tick run in the order listed.  The phases
+ * are staggered so that the LCD update, serial handling and duty map saves
+ * (which may write EEPROM) and the 1-Wire bus steps never run in the same
+ * tick as the control loop.
+ ******************************************************************************/
+#define TASKLIST \
+  /*       taskFunc,    period,       phase */ \
+  TASKDEF ( controlTask, CTRL_TICKS,   0 ) /* measure fan speeds, run state machine and PI control, set PWM outputs */ \
+  TASKDEF ( displayTask, LCD_TICKS,    1 ) /* update LCD screen */ \
+  TASKDEF ( serialTask,  SERIAL_TICKS, 2 ) /* handle debug messages from serial port (may write EEPROM) */ \
+  TASKDEF ( oneWireTask, OW_TICKS,     1 ) /* run one step of the 1-Wire temperature sensor read cycle (at most about 1.2 ms) */ \
+  TASKDEF ( dutyMapTask, DMAP_TICKS,   3 ) /* save a learned duty map setting, at most hourly (may write EEPROM) */
+
+/*******************************************************************************
+ * TYPE DEFINITION FOR TABLE OF TASKS
+ ******************************************************************************/
+typedef struct TASK_TABLE {
+  void ( *taskFunc )( void ); // function which runs the task
+  byte period;                // number of scheduler ticks between each run of the task
+  byte phase;                 // scheduler tick on which the task first runs (must be < period)
+} TASK_TABLE_TYPE;
+
+/*******************************************************************************
+ * FUNCTION DECLARATIONS
+ ******************************************************************************/
+#define TASKDEF( a, b, c ) void a ( void );
+TASKLIST
+#undef TASKDEF
+
+void taskSchedInit ( void );      // resets the task countdowns to their phase offsets
+void taskSchedRun ( byte ticks ); // runs every task which became due during the elapsed ticks
+
+#endif /* TASKSCHED_H_ */
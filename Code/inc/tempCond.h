@@ -0,0 +1,51 @@
+/*
+ * tempCond.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+
+#ifndef TEMPCOND_H_
+#define TEMPCOND_H_
+
+/*******************************************************************************
+ * INCLUDED HEADER FILES
+ ******************************************************************************/
+#include "Arduino.h"
+#include "fanControlUtils.h"
+
+/*******************************************************************************
+ * MACRO DEFINITIONS
+ ******************************************************************************/
+#define TEMPCOND_FRAC_BITS   6  // fraction bits kept in the filter state, so a slow filter doesn't stall short of the input
+#define TEMPCOND_CLEAR_LOOPS 20 // number of consecutive good readings needed to clear a sensor fault (control loops)
+
+/*******************************************************************************
+ * TYPE DEFINITIONS
+ ******************************************************************************/
+/* Conditioning stage of one temperature sensor, kept by the main loop.
+ * Starts out zeroed, and fills its history from the first reading. */
+typedef struct TEMP_COND {
+  unsigned int  hist [ TEMPCOND_MED_MAX ]; // newest raw readings, oldest overwritten first
+  byte          histIdx;                   // index of slot to write next
+  byte          histCnt;                   // number of readings in the history (up to TEMPCOND_MED_MAX)
+  unsigned int  lastMed;                   // median from the last update, for the rate of change check
+  unsigned long filt;                      // filter state (raw temperature << TEMPCOND_FRAC_BITS)
+  byte          fault;                     // high from when the sensor fails a check, until it passes TEMPCOND_CLEAR_LOOPS in a row
+  byte          goodCnt;                   // number of consecutive good readings while faulted
+  unsigned int  faults;                    // number of faults detected (wraps)
+} TEMP_COND_TYPE;
+
+/*******************************************************************************
+ * VARIABLE DECLARATIONS
+ ******************************************************************************/
+extern TEMP_COND_TYPE temp1Cond; // conditioning stage of temperature sensor 1
+extern TEMP_COND_TYPE temp2Cond; // conditioning stage of temperature sensor 2
+
+/*******************************************************************************
+ * FUNCTION DECLARATIONS
+ ******************************************************************************/
+unsigned int tempCondUpdate ( TEMP_COND_TYPE *cond, unsigned int raw ); // filters a new raw reading and checks it for a sensor fault, returning the filtered temperature
+byte         tempCondFault ( const TEMP_COND_TYPE *cond );               // returns high if the sensor is faulted
+
+#endif /* TEMPCOND_H_ */
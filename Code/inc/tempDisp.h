@@ -0,0 +1,39 @@
+/*
+ * tempDisp.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+
+#ifndef TEMPDISP_H_
+#define TEMPDISP_H_
+
+/*******************************************************************************
+ * INCLUDED HEADER FILES
+ ******************************************************************************/
+#include "Arduino.h"
+#include "fanControlUtils.h"
+
+/*******************************************************************************
+ * MACRO DEFINITIONS
+ ******************************************************************************/
+#define TEMPDISP_MAX_X10 16383 // largest magnitude of a displayed temperature times 10 (larger values are clamped)
+
+/*******************************************************************************
+ * TYPE DEFINITIONS
+ ******************************************************************************/
+/* Temperature sensors whose readings can be displayed */
+typedef enum TEMPDISP_ENUM
+{
+  TEMPDISP_1,  // temperature sensor 1 (Temp1Offset, Temp1DegCPer5V)
+  TEMPDISP_2,  // temperature sensor 2 (Temp2Offset, Temp2DegCPer5V)
+  TEMPDISP_NUM // number of sensors
+} TEMPDISP_ENUM_TYPE;
+
+/*******************************************************************************
+ * FUNCTION DECLARATIONS
+ ******************************************************************************/
+int  tempDispX10 ( TEMPDISP_ENUM_TYPE sensor, unsigned int raw );                            // converts a digital temperature to display units (degC or degF) times 10
+void tempDispSplit ( TEMPDISP_ENUM_TYPE sensor, unsigned int raw, int *whole, byte *tenth ); // converts a digital temperature to whole and tenths of display units
+
+#endif /* TEMPDISP_H_ */
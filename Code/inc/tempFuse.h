@@ -0,0 +1,49 @@
+/*
+ * tempFuse.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+
+#ifndef TEMPFUSE_H_
+#define TEMPFUSE_H_
+
+/*******************************************************************************
+ * INCLUDED HEADER FILES
+ ******************************************************************************/
+#include "Arduino.h"
+#include "fanControlUtils.h"
+
+/*******************************************************************************
+ * MACRO DEFINITIONS
+ ******************************************************************************/
+#define TFUSE_WT_BITS 8 // bits of the normalized weights, which sum to 1 << TFUSE_WT_BITS
+
+/*******************************************************************************
+ * TYPE DEFINITIONS
+ ******************************************************************************/
+/* Temperature inputs which can be fused */
+typedef enum TFUSE_IN_ENUM
+{
+  TFUSE_TMP1,   // analog temperature sensor 1 (Temp1)
+  TFUSE_TMP2,   // analog temperature sensor 2 (Temp2)
+  TFUSE_OW1,    // first 1-Wire sensor
+  TFUSE_OW2,    // second 1-Wire sensor
+  TFUSE_NUM_INS // number of inputs
+} TFUSE_IN_ENUM_TYPE;
+
+/* Fusion stage of one fan, built by tempFuseBuild() whenever its settings
+ * change, so reading it needs no checks or divides. */
+typedef struct TEMP_FUSE {
+  unsigned int wt [ TFUSE_NUM_INS ];  // normalized weight of each input (sum to 1 << TFUSE_WT_BITS, 0 if input unused)
+  int          ofs [ TFUSE_NUM_INS ]; // offset added to each input, stored digitally
+  byte         mode;                  // fusion mode (TFUSE_MEAN or TFUSE_MAX)
+} TEMP_FUSE_TYPE;
+
+/*******************************************************************************
+ * FUNCTION DECLARATIONS
+ ******************************************************************************/
+void         tempFuseBuild ( TEMP_FUSE_TYPE *fuse, unsigned int tmpsrc, const unsigned int *wt, const int *ofs, unsigned int mode ); // builds a fusion stage from a temperature source selection
+unsigned int tempFuseRead ( const TEMP_FUSE_TYPE *fuse, byte *fault );                                                         // returns the fused temperature, and whether any input used is faulted
+
+#endif /* TEMPFUSE_H_ */
@@ -0,0 +1,53 @@
+/*
+ * timeBase.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+
+#ifndef TIMEBASE_H_
+#define TIMEBASE_H_
+
+/*******************************************************************************
+ * INCLUDED HEADER FILES
+ ******************************************************************************/
+#include "Arduino.h"
+#include "sysTimer.h"
+
+/*******************************************************************************
+ * MACRO DEFINITIONS
+ *
+ * Timestamps returned by timeBaseNow() are 32-bit timer1 counts, which wrap
+ * about every 36 minutes.  They must only be compared using the interval
+ * macros below, which give the right answer across a wrap as long as the
+ * interval itself is shorter than half the wrap time.
+ ******************************************************************************/
+#define TIMEBASE_US_PER_SEC 1000000UL // number of microseconds in a second
+
+#define TIME_CNTS_TO_US( a ) \
+  /* Converts an interval from timer1 counts to microseconds */ \
+  ( ( a ) / SYSTIMER_CNTS_PER_US )
+
+#define TIME_US_TO_CNTS( a ) \
+  /* Converts an interval from microseconds to timer1 counts */ \
+  ( ( a ) * SYSTIMER_CNTS_PER_US )
+
+#define TIME_ELAPSED( now, since ) \
+  /* Returns the time elapsed from timestamp 'since' to timestamp 'now' (wrap-safe) */ \
+  ( (unsigned long) ( ( now ) - ( since ) ) )
+
+#define TIME_REACHED( now, deadline ) \
+  /* Returns true when timestamp 'now' is at or past timestamp 'deadline' (wrap-safe) */ \
+  ( (long) ( ( now ) - ( deadline ) ) >= 0 )
+
+/*******************************************************************************
+ * FUNCTION DECLARATIONS
+ ******************************************************************************/
+void               timeBaseTick ( byte ticks );  // advances the uptime clock by a number of scheduler ticks
+unsigned long      timeBaseUptimeSec ( void );   // returns whole seconds of uptime
+unsigned long      timeBaseUptimeSubUs ( void ); // returns microseconds of uptime since the last whole second
+unsigned long      timeBaseNow ( void );         // returns a 32-bit timestamp (timer1 counts), for measuring intervals
+unsigned long      timeBaseMicros ( void );      // returns microseconds since power-up, wrapping about every 71 minutes
+unsigned long long timeBaseMicros64 ( void );    // returns microseconds since power-up, never wrapping in practice
+
+#endif /* TIMEBASE_H_ */
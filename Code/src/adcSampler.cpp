@@ -0,0 +1,142 @@
+/*
+ * adcSampler.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+
+/*******************************************************************************
+ * INCLUDED HEADER FILES
+ ******************************************************************************/
+#include "adcSampler.h"
+#include "isrSnapshot.h"
+#include <avr/interrupt.h>
+
+/*******************************************************************************
+ * STATIC VARIABLE DEFINITIONS
+ ******************************************************************************/
+static const byte                  adcMux [ ADC_NUM_CHANS ]    = { TEMP1PIN, TEMP2PIN }; // ADC input of each channel
+static byte                        adcChan                     = 0;                      // channel being converted (interrupt only)
+static unsigned int                sampleSum [ ADC_NUM_CHANS ] = { 0 };                  // sum of samples towards the next reading of each channel (interrupt only)
+static byte                        sampleCnt [ ADC_NUM_CHANS ] = { 0 };                  // number of samples in each sum (interrupt only)
+static ADC_TOTAL_TYPE              isrTotal [ ADC_NUM_CHANS ];                           // running total of readings of each channel (interrupt only)
+static isrSnapshot<ADC_TOTAL_TYPE> adcTotal [ ADC_NUM_CHANS ];                           // running totals published to the main loop
+static ADC_TOTAL_TYPE              lastTotal [ ADC_NUM_CHANS ];                          // running totals at the last adcSamplerRead() of each channel (main loop only)
+
+/*******************************************************************************
+ * FUNCTION DEFINITIONS
+ ******************************************************************************/
+
+/******************************************************************************
+* Function:
+*   adcSamplerInit()
+*
+* Description:
+*   Starts converting the analog channels in turn, with AVcc as reference.
+*   From then on each conversion is started by the ADC interrupt as the last
+*   one finishes, so the ADC runs continuously without the main loop ever
+*   waiting on it (analogRead() spins for the whole 104 us conversion).  The
+*   digital input buffers of the analog pins are turned off, since they only
+*   add noise and current on an analog signal.
+*
+* Arguments:
+*   none
+*
+* Returns:
+*   none
+******************************************************************************/
+void adcSamplerInit ( void )
+{
+  byte chan; // channel count variable
+
+  for ( chan = 0; chan < ADC_NUM_CHANS; chan++ )
+    DIDR0 |= _BV ( adcMux [ chan ] ); // disable digital input buffer of this analog pin
+
+  adcChan = 0;
+  ADCSRB  = 0;                            // no auto trigger source
+  ADMUX   = _BV ( REFS0 ) | adcMux [ 0 ]; // AVcc reference, right-adjusted result, first channel
+  ADCSRA  = ADC_CSRA_RUN | _BV ( ADIF );  // enable, and clear any stale flag
+  ADCSRA  = ADC_CSRA_RUN | _BV ( ADSC );  // start the first conversion
+
+  return;
+} // end of adcSamplerInit()
+
+/******************************************************************************
+* Function:
+*   ISR(ADC_vect)
+*
+* Description:
+*   ADC conversion complete interrupt.  Starts converting the next channel
+*   straight away, then adds the finished sample to its channel's sum.  Each
+*   ADC_SAMPLES_PER_READING samples are decimated to one reading with
+*   ADC_OVERSAMPLE_BITS extra bits of resolution, which is added to the
+*   channel's running total and published to the main loop.  Oversampling
+*   only adds resolution because the sensor noise dithers the input across
+*   at least one 10-bit step.
+*
+*   The ADC's free-running mode isn't used, since it has already started the
+*   next conversion on the old channel by the time this runs, which would
+*   make every result belong to the channel before last.
+*
+* Arguments:
+*   none
+*
+* Returns:
+*   none
+******************************************************************************/
+ISR ( ADC_vect )
+{
+  unsigned int sample = ADC;     // result of the conversion just finished
+  byte         chan   = adcChan; // channel the result belongs to
+
+  /* Start the next channel, so the ADC is never left idle */
+  if ( ++adcChan >= ADC_NUM_CHANS )
+    adcChan = 0;
+  ADMUX  = _BV ( REFS0 ) | adcMux [ adcChan ];
+  ADCSRA = ADC_CSRA_RUN | _BV ( ADSC );
+
+  /* Add to the sum, and decimate to a reading once there are enough samples */
+  sampleSum [ chan ] += sample;
+  if ( ++sampleCnt [ chan ] >= ADC_SAMPLES_PER_READING )
+  {
+    isrTotal [ chan ].sum += sampleSum [ chan ] >> ADC_OVERSAMPLE_BITS;
+    isrTotal [ chan ].cnt++;
+    adcTotal [ chan ].publish ( isrTotal [ chan ] );
+    sampleSum [ chan ] = 0;
+    sampleCnt [ chan ] = 0;
+  }
+
+  return;
+} // end of ISR(ADC_vect)
+
+/******************************************************************************
+* Function:
+*   adcSamplerRead()
+*
+* Description:
+*   Gets the rounded mean of the readings of a channel published since the
+*   last call, so each control loop uses every reading taken during it.
+*   Never waits for the ADC.
+*
+* Arguments:
+*   chan - channel to read
+*   reading - set to the mean reading (0 to TEMP_DIG_MAX), if there was one
+*
+* Returns:
+*   newReading - high if there were any readings since the last call, in
+*                which case reading is updated
+******************************************************************************/
+byte adcSamplerRead ( ADC_CHAN_ENUM_TYPE chan, unsigned int *reading )
+{
+  ADC_TOTAL_TYPE total = adcTotal [ chan ].read ( );         // snapshot of running total
+  unsigned int   cnt   = total.cnt - lastTotal [ chan ].cnt; // number of new readings
+  unsigned long  sum   = total.sum - lastTotal [ chan ].sum; // sum of new readings
+
+  if ( cnt == 0 ) // no new readings, keep last value
+    return LOW;
+
+  *reading           = (unsigned int) ( ( sum + ( cnt >> 1 ) ) / cnt ); // rounded mean
+  lastTotal [ chan ] = total;                                           // start the next mean from here
+
+  return HIGH;
+} // end of adcSamplerRead()
@@ -0,0 +1,290 @@
+/*
+ * dsTemp.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+
+/*******************************************************************************
+ * INCLUDED HEADER FILES
+ ******************************************************************************/
+#include "dsTemp.h"
+#include "oneWire.h"
+#include "savedVars.h"
+
+/*******************************************************************************
+ * MACRO DEFINITIONS
+ ******************************************************************************/
+#define DS_FAMILY       0x28   // ROM family code of the DS18B20
+#define DS_CONVERT_T    0x44   // function command starting a temperature conversion
+#define DS_READ_SCRATCH 0xBE   // function command reading the scratchpad
+#define DS_MATCH_BYTES  10     // bytes sent to select a sensor and read its scratchpad (match ROM, ROM code, read scratchpad)
+#define DS_SCRATCH_LEN  9      // number of scratchpad bytes, including CRC
+#define DS_CFG_ONES     0x1F   // bits of the configuration register which always read as 1 (catches a bus stuck low, which passes the CRC)
+#define DS_POWER_ON_RAW 0x0550 // temperature register value at power-on (85 degC), before any conversion
+
+/*******************************************************************************
+ * TYPE DEFINITIONS
+ ******************************************************************************/
+/* Steps of the read cycle.  Each step takes at most one reset pulse or
+ * DS_BYTES_STEP bytes of bus time, so a tick is never held up for long. */
+typedef enum DS_STATE_ENUM
+{
+  DS_START,   // reset bus, at the start of a cycle
+  DS_CONVERT, // start a conversion in all sensors at once
+  DS_WAIT,    // wait for the conversion to finish
+  DS_SELECT,  // reset bus, before reading a sensor
+  DS_MATCH,   // select a sensor and ask for its scratchpad
+  DS_READ,    // read the scratchpad of a sensor
+  DS_BACKOFF  // wait after the bus failed to answer, before trying again
+} DS_STATE_ENUM_TYPE;
+
+/*******************************************************************************
+ * STATIC VARIABLE DEFINITIONS
+ ******************************************************************************/
+static byte               dsRoms [ DS_MAX_DEVS ][ OW_ROM_BYTES ];                        // ROM codes of the sensors found, in search order
+static byte               dsNumDevs;                                                     // number of sensors found
+static unsigned int       dsTemp [ DS_MAX_DEVS ];                                        // last good temperature of each sensor, stored digitally
+static byte               dsStale [ DS_MAX_DEVS ];                                       // conversions since each sensor was last read (saturates)
+static DS_STATE_ENUM_TYPE dsState;                                                       // current step of the read cycle
+static byte               dsDev;                                                         // sensor being read
+static byte               dsIdx;                                                         // byte count within the current step
+static byte               dsWait;                                                        // steps left to wait
+static byte               dsScratch [ DS_SCRATCH_LEN ];                                  // scratchpad being read
+static int *const         dsOfs [ DS_MAX_DEVS ]  = { &Temp1Offset, &Temp2Offset };       // saved offset of the analog sensor whose scale each sensor is stored in
+static int *const         dsGain [ DS_MAX_DEVS ] = { &Temp1DegCPer5V, &Temp2DegCPer5V }; // saved gain of the analog sensor whose scale each sensor is stored in
+
+/*******************************************************************************
+ * FUNCTION DEFINITIONS
+ ******************************************************************************/
+
+/******************************************************************************
+* Function:
+*   dsTempToDig()
+*
+* Description:
+*   Converts a temperature to the digital scale of the matching analog
+*   sensor (OW1 to sensor 1, OW2 to sensor 2), the same way as
+*   C10ToDigTemp1() and C10ToDigTemp2(), so the thresholds and display work
+*   unchanged.  Done once per reading, and clamped to the digital range.
+*
+* Arguments:
+*   dev - sensor number
+*   c10 - temperature in degC times 10
+*
+* Returns:
+*   dig - temperature, stored digitally (0-TEMP_DIG_MAX)
+******************************************************************************/
+static unsigned int dsTempToDig ( byte dev, int c10 )
+{
+  long int dig; // temperature, stored digitally (may be out of range)
+
+  dig = ( ( ( (long int) c10 << TEMP_DIG_BITS ) / (long int) *dsGain [ dev ] ) + ( ( (long int) *dsOfs [ dev ] << TEMP_DIG_BITS ) / 500 ) ) / 10;
+  if ( dig < 0 )
+    dig = 0;
+  else if ( dig > TEMP_DIG_MAX )
+    dig = TEMP_DIG_MAX;
+
+  return (unsigned int) dig;
+} // end of dsTempToDig()
+
+/******************************************************************************
+* Function:
+*   dsTempCheck()
+*
+* Description:
+*   Checks a scratchpad read from a sensor, and if it is good, converts the
+*   temperature and marks the sensor as fresh.  The power-on value is thrown
+*   away, since it means the sensor reset and missed the conversion.
+*
+* Arguments:
+*   dev - sensor the scratchpad was read from
+*
+* Returns:
+*   none
+******************************************************************************/
+static void dsTempCheck ( byte dev )
+{
+  int raw; // temperature register (degC times 16)
+
+  if ( owCrc8 ( dsScratch, DS_SCRATCH_LEN ) != 0 ) // corrupted
+    return;
+  if ( ( dsScratch [ 4 ] & DS_CFG_ONES ) != DS_CFG_ONES ) // not a real scratchpad
+    return;
+  raw = (int16_t) ( ( (unsigned int) dsScratch [ 1 ] << 8 ) | dsScratch [ 0 ] ); // two's complement, whatever the width of int
+  if ( raw == DS_POWER_ON_RAW ) // sensor reset since the conversion started
+    return;
+
+  dsTemp [ dev ]  = dsTempToDig ( dev, (int) ( ( (long int) raw * 10 ) / 16 ) );
+  dsStale [ dev ] = 0;
+
+  return;
+} // end of dsTempCheck()
+
+/******************************************************************************
+* Function:
+*   dsTempInit()
+*
+* Description:
+*   Releases the 1-Wire bus and finds the DS18B20 sensors on it.  The ROM
+*   search blocks for about 15 ms per sensor, which is fine at start-up but
+*   is never done again.  Every sensor starts out faulted until its first
+*   reading.
+*
+* Arguments:
+*   none
+*
+* Returns:
+*   none
+******************************************************************************/
+void dsTempInit ( void )
+{
+  byte dev; // sensor number
+
+  owInit ( );
+  dsNumDevs = owSearch ( dsRoms, DS_MAX_DEVS, DS_FAMILY );
+  for ( dev = 0; dev < DS_MAX_DEVS; dev++ )
+    dsStale [ dev ] = DS_STALE_CONVS + 1;
+  dsState = DS_START;
+
+  return;
+} // end of dsTempInit()
+
+/******************************************************************************
+* Function:
+*   dsTempStep()
+*
+* Description:
+*   Runs the next step of the read cycle, one every OW_TICKS scheduler
+*   ticks.  All the sensors convert at once, and the 750 ms conversion is
+*   waited out over steps instead of in a delay.  Then each sensor is
+*   selected by its ROM code and its scratchpad read, a couple of bytes per
+*   step.  A full cycle of two sensors takes about 1.4 s.
+*
+* Arguments:
+*   none
+*
+* Returns:
+*   none
+******************************************************************************/
+void dsTempStep ( void )
+{
+  byte cnt; // number of bytes sent or received this step
+  byte dev; // sensor number
+
+  if ( dsNumDevs == 0 ) // no sensors, so leave the bus alone
+    return;
+
+  switch ( dsState )
+  {
+  case DS_START: // start of a cycle
+    for ( dev = 0; dev < dsNumDevs; dev++ )
+      if ( dsStale [ dev ] <= DS_STALE_CONVS ) // count up to one past the fault limit
+        dsStale [ dev ]++;
+    if ( owReset ( ) )
+      dsState = DS_CONVERT;
+    else // no sensors answered
+    {
+      dsWait  = DS_CONV_STEPS;
+      dsState = DS_BACKOFF;
+    }
+    break;
+
+  case DS_CONVERT: // all sensors start converting
+    owWriteByte ( OW_SKIP_ROM );
+    owWriteByte ( DS_CONVERT_T );
+    dsWait  = DS_CONV_STEPS;
+    dsState = DS_WAIT;
+    break;
+
+  case DS_WAIT: // conversion in progress
+    if ( --dsWait == 0 )
+    {
+      dsDev   = 0;
+      dsState = DS_SELECT;
+    }
+    break;
+
+  case DS_SELECT: // start reading a sensor
+    dsIdx = 0;
+    if ( owReset ( ) )
+      dsState = DS_MATCH;
+    else if ( ++dsDev >= dsNumDevs ) // skip this sensor, it will go stale
+      dsState = DS_START;
+    break;
+
+  case DS_MATCH: // select the sensor and ask for its scratchpad
+    for ( cnt = 0; ( cnt < DS_BYTES_STEP ) && ( dsIdx < DS_MATCH_BYTES ); cnt++, dsIdx++ )
+    {
+      if ( dsIdx == 0 )
+        owWriteByte ( OW_MATCH_ROM );
+      else if ( dsIdx <= OW_ROM_BYTES )
+        owWriteByte ( dsRoms [ dsDev ][ dsIdx - 1 ] );
+      else
+        owWriteByte ( DS_READ_SCRATCH );
+    }
+    if ( dsIdx >= DS_MATCH_BYTES )
+    {
+      dsIdx   = 0;
+      dsState = DS_READ;
+    }
+    break;
+
+  case DS_READ: // read the scratchpad
+    for ( cnt = 0; ( cnt < DS_BYTES_STEP ) && ( dsIdx < DS_SCRATCH_LEN ); cnt++, dsIdx++ )
+      dsScratch [ dsIdx ] = owReadByte ( );
+    if ( dsIdx >= DS_SCRATCH_LEN )
+    {
+      dsTempCheck ( dsDev );
+      if ( ++dsDev >= dsNumDevs ) // all sensors read
+        dsState = DS_START;
+      else
+        dsState = DS_SELECT;
+    }
+    break;
+
+  default: // backing off after a bus failure
+    if ( --dsWait == 0 )
+      dsState = DS_START;
+  }
+
+  return;
+} // end of dsTempStep()
+
+/******************************************************************************
+* Function:
+*   dsTempRead()
+*
+* Description:
+*   Returns the last good temperature of a sensor.  Check dsTempFault()
+*   before trusting it.
+*
+* Arguments:
+*   dev - sensor number (0 for OW1, 1 for OW2)
+*
+* Returns:
+*   temp - temperature, stored digitally (0-TEMP_DIG_MAX)
+******************************************************************************/
+unsigned int dsTempRead ( byte dev )
+{
+  return dsTemp [ dev ];
+} // end of dsTempRead()
+
+/******************************************************************************
+* Function:
+*   dsTempFault()
+*
+* Description:
+*   Returns high if a sensor wasn't found by the ROM search, or hasn't given
+*   a good reading in more than DS_STALE_CONVS conversions.
+*
+* Arguments:
+*   dev - sensor number (0 for OW1, 1 for OW2)
+*
+* Returns:
+*   fault - high if the sensor's temperature can't be trusted
+******************************************************************************/
+byte dsTempFault ( byte dev )
+{
+  return ( dev >= dsNumDevs ) || ( dsStale [ dev ] > DS_STALE_CONVS );
+} // end of dsTempFault()
@@ -0,0 +1,178 @@
+/*
+ * dutyMap.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+
+/*******************************************************************************
+ * INCLUDED HEADER FILES
+ ******************************************************************************/
+#include "dutyMap.h"
+#include "piController.h"
+
+/*******************************************************************************
+ * MACRO DEFINITIONS
+ ******************************************************************************/
+#define DMAP_MIN_VXX  ( (long int) ( DMAP_MIN_SPREAD >> DMAP_DX_BITS ) * ( DMAP_MIN_SPREAD >> DMAP_DX_BITS ) ) // least speed variance for which the slope is fitted ((1 << DMAP_DX_BITS) rpm, squared)
+#define DMAP_MAX_DUTY ( MAXPIOUTPUT << 2 )                                                                     // largest duty feedforward (quarter duty counts)
+
+/*******************************************************************************
+ * FUNCTION DEFINITIONS
+ ******************************************************************************/
+
+/******************************************************************************
+* Function:
+*   dutyMapLearn()
+*
+* Description:
+*   Fits the duty map of a fan (duty = ofs + slope * rpm) to the duties it
+*   needs to hold its speeds.  The speed and duty are averaged over windows
+*   of DMAP_WIN_MS, and a window is only a sample if the fan was steady all
+*   through it and the one before: speed within the band of the reference,
+*   reference within the band of where it started, and duty not saturated.
+*
+*   The fit is recursive least squares with a forgetting factor, kept as
+*   running means, variance and covariance instead of a covariance matrix.
+*   This gives the same fit, needs no divides per control loop, fits in
+*   32 bits, and can't wind up while the fan sits at one speed.  Each
+*   sample is weighted 1/n at first (n samples so far), so the fit starts
+*   from the first sample, then 2^-DMAP_FORGET_BITS.  The slope is only
+*   fitted once the sample speeds spread by DMAP_MIN_SPREAD, and the offset
+*   is always fitted through the mean, so a fan held at one speed keeps its
+*   slope but still learns its duty there.  Call once per control loop,
+*   while the fan is regulating, with the duty last applied to it.
+*
+* Arguments:
+*   map - duty map learner of this fan
+*   ref - speed reference of this fan (rpm)
+*   rpm - measured speed of this fan (rpm)
+*   duty - duty applied to this fan over the last control loop
+*   ofs - map offset (quarter duty counts), updated by each sample
+*   slope - map slope (quarter duty counts per rpm << DMAP_SLOPE_BITS), updated by each sample
+*
+* Returns:
+*   none
+******************************************************************************/
+void dutyMapLearn ( DUTY_MAP_TYPE *map, unsigned int ref, unsigned int rpm, byte duty, int *ofs, int *slope )
+{
+  unsigned int band = ref >> DMAP_BAND_SHIFT; // speed error allowed while steady (rpm)
+  long int     dx;                            // sample speed less the mean (rpm << DMAP_FRAC_BITS)
+  long int     dy;                            // sample duty less the mean (quarter duty counts << DMAP_FRAC_BITS)
+  long int     prod;                          // product of the deviations
+  long int     num;                           // numerator of the slope
+  long int     den;                           // denominator of the slope
+  long int     fit;                           // fitted slope or offset
+  byte         n;                             // number of samples the mean is over
+  byte         sh;                            // shift left to apply to the slope
+
+  /* Check the fan is steady, and add this loop to the window */
+  if ( ( duty <= MINPIOUTPUT ) || ( duty >= MAXPIOUTPUT ) ||
+       ( (unsigned long) rpm + band < ref ) || ( rpm > (unsigned long) ref + band ) ||
+       ( ( map->loops > 0 ) && ( ( (unsigned long) ref + band < map->ref ) || ( ref > (unsigned long) map->ref + band ) ) ) )
+  {
+    map->loops   = 0;
+    map->settled = LOW;
+    return;
+  }
+  if ( map->loops == 0 ) // start of a window
+  {
+    map->ref     = ref;
+    map->sumRpm  = 0;
+    map->sumDuty = 0;
+  }
+  map->sumRpm  += rpm;
+  map->sumDuty += duty;
+  if ( ++map->loops < DMAP_WIN_LOOPS )
+    return;
+  map->loops = 0;
+  if ( !map->settled ) // the speed may still have been settling at the start of this window
+  {
+    map->settled = HIGH;
+    return;
+  }
+
+  /* Update the running means, variance and covariance */
+  if ( map->samples < ( 1 << DMAP_FORGET_BITS ) )
+    map->samples++;
+  n        = map->samples;
+  dx       = (long int) ( ( map->sumRpm << DMAP_FRAC_BITS ) / DMAP_WIN_LOOPS ) - map->mx;
+  dy       = (long int) ( ( (unsigned long) map->sumDuty << ( DMAP_FRAC_BITS + 2 ) ) / DMAP_WIN_LOOPS ) - map->my;
+  map->mx += dx / n;
+  map->my += dy / n;
+  dx     >>= DMAP_FRAC_BITS + DMAP_DX_BITS;
+  dy     >>= DMAP_FRAC_BITS - DMAP_DX_BITS;
+  prod     = dx * dx;
+  map->vxx += ( prod - prod / n - map->vxx ) / n;
+  prod      = dx * dy;
+  map->vxy += ( prod - prod / n - map->vxy ) / n;
+
+  /* Fit the slope, if the speeds spread enough, shifting the numerator up
+   * as far as it fits and the denominator down for the rest */
+  fit = *slope;
+  if ( map->vxx >= DMAP_MIN_VXX )
+  {
+    num = map->vxy;
+    den = map->vxx;
+    for ( sh = DMAP_SLOPE_BITS - 2 * DMAP_DX_BITS; sh > 0; sh-- )
+    {
+      if ( labs ( num ) < 0x40000000L )
+        num <<= 1;
+      else
+        den >>= 1;
+    }
+    fit = num / den;
+    if ( fit < 0 ) // duty never falls with speed, so this is noise
+      fit = 0;
+    else if ( fit > 32767 )
+      fit = 32767;
+  }
+  if ( fit != *slope )
+  {
+    *slope       = (int) fit;
+    map->changed = HIGH;
+  }
+
+  /* Fit the offset through the means */
+  fit = ( map->my >> DMAP_FRAC_BITS ) - ( ( *slope * ( map->mx >> DMAP_FRAC_BITS ) ) >> DMAP_SLOPE_BITS );
+  if ( fit < -DMAP_MAX_DUTY )
+    fit = -DMAP_MAX_DUTY;
+  else if ( fit > DMAP_MAX_DUTY )
+    fit = DMAP_MAX_DUTY;
+  if ( fit != *ofs )
+  {
+    *ofs         = (int) fit;
+    map->changed = HIGH;
+  }
+
+  return;
+} // end of dutyMapLearn()
+
+/******************************************************************************
+* Function:
+*   dutyMapEval()
+*
+* Description:
+*   Returns the duty feedforward of a fan at a speed, from its duty map,
+*   clamped to the PI output range.
+*
+* Arguments:
+*   ofs - map offset (quarter duty counts)
+*   slope - map slope (quarter duty counts per rpm << DMAP_SLOPE_BITS)
+*   rpm - speed (rpm)
+*
+* Returns:
+*   duty - duty feedforward (quarter duty counts)
+******************************************************************************/
+int dutyMapEval ( int ofs, int slope, unsigned int rpm )
+{
+  long int duty; // duty feedforward (quarter duty counts)
+
+  duty = (long int) ofs + ( ( (long int) slope * rpm ) >> DMAP_SLOPE_BITS );
+  if ( duty < 0 )
+    duty = 0;
+  else if ( duty > DMAP_MAX_DUTY )
+    duty = DMAP_MAX_DUTY;
+
+  return (int) duty;
+} // end of dutyMapEval()
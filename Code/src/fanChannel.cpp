@@ -0,0 +1,645 @@
+/*
+ * fanChannel.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+
+/*******************************************************************************
+ * INCLUDED HEADER FILES
+ ******************************************************************************/
+#include "fanChannel.h"
+#include "savedVars.h"
+#include "timeBase.h"
+#include "recipDiv.h"
+#include "pwmOut.h"
+
+/*******************************************************************************
+ * MACRO DEFINITIONS
+ ******************************************************************************/
+#define FAN_RPM_CNTS( ppr ) \
+  /* Fan speed (rpm) times full hall period (timer1 counts), at ppr pulses-per-revolution */ \
+  ( 60UL * TIME_US_TO_CNTS ( TIMEBASE_US_PER_SEC ) / ( ppr ) )
+#define FAN_MAX_PERIOD( minN, ppr ) \
+  /* Longest full hall period measured (timer1 counts), at minN minimum speed (rpm) */ \
+  ( FAN_RPM_CNTS ( ppr ) / ( minN ) )
+#define FAN_CFG_DEF( n ) \
+  /* Settings table entry of fan n, from its saved variables and hardware definitions */ \
+  { &minRpm##n, &maxRpm##n, &fan##n##Filt, &tmpsrc##n, &fan##n##TurnOffTmp, &fan##n##TurnOnTmp, \
+    { &fan##n##TblTmp1, &fan##n##TblTmp2, &fan##n##TblTmp3, &fan##n##TblTmp4 }, \
+    { &fan##n##TblSpd1, &fan##n##TblSpd2, &fan##n##TblSpd3, &fan##n##TblSpd4 }, \
+    &pi##n##Kp, &pi##n##Ki, &pi##n##Imax, &pi##n##Imin, &failsafeRpm##n, \
+    { &fuse##n##Wt1, &fuse##n##Wt2, &fuse##n##Wt3, &fuse##n##Wt4 }, \
+    { &fuse##n##Ofs1, &fuse##n##Ofs2, &fuse##n##Ofs3, &fuse##n##Ofs4 }, &fuse##n##Mode, \
+    &dmap##n##Ofs, &dmap##n##Slope, \
+    FAN_RPM_CNTS ( FAN##n##PPR ), FAN_MAX_PERIOD ( MINN##n, FAN##n##PPR ), MAXN##n }
+
+/* Each channel needs its own saved variables, PWM output and hall sensor
+ * interrupt, so adding one means extending the table below, PWMOUT_ENUM and
+ * hallInit(). */
+#if NUM_FANS != 2
+#error "fanCfgTbl[] initializer below must be updated to match NUM_FANS"
+#endif
+
+/*******************************************************************************
+ * GLOBAL VARIABLE DEFINITIONS
+ ******************************************************************************/
+const FAN_CFG_TYPE    fanCfgTbl [ NUM_FANS ] PROGMEM = { FAN_CFG_DEF ( 1 ), FAN_CFG_DEF ( 2 ) }; // settings of each fan channel (stored in flash)
+fanChannels<NUM_FANS> fans;                                                                       // the fan channels
+
+/*******************************************************************************
+ * FUNCTION DEFINITIONS
+ ******************************************************************************/
+
+/******************************************************************************
+* Function:
+*   calcFanRPM()
+*
+* Description:
+*   Calculates a fan speed from its hall period estimate.  Zero is returned
+*   if there is no estimate yet, if the period is too long, or if it has been
+*   too long since the last edge (the fan has stopped).  The glitch filter
+*   holds each edge back until the next one, so the newest edge seen here can
+*   be two edges (a full period) old, and the timeout is a full maxPeriod.
+*
+*   The speed is rpmCnts / period, which is worked out with recipDiv()
+*   rather than a 32-bit divide.  This is within 1 rpm of the exact value
+*   over the whole measured range (checked against every period from
+*   MAXN1 to MINN1), where the old ( 1000000 / period ) * 60 / ppr could be
+*   up to 30 rpm out from truncating the first divide.  The limits are worked
+*   out at compile time by FAN_RPM_CNTS() and FAN_MAX_PERIOD().
+*
+* Arguments:
+*   est - hall sensor period estimate
+*   thisTime - timestamp value at which this function call occurs (timer1 counts)
+*   rpmCnts - speed times full hall period, from FAN_RPM_CNTS() (rpm * timer1 counts)
+*   maxPeriod - longest period measured, from FAN_MAX_PERIOD() (timer1 counts)
+*   maxN - maximum speed measurement (rpm)
+*
+* Returns:
+*   rpm - fan speed (rpm)
+******************************************************************************/
+static unsigned int calcFanRPM ( HALL_EST_TYPE *est, unsigned long thisTime, unsigned long rpmCnts, unsigned long maxPeriod, unsigned int maxN )
+{
+  unsigned long rpm; // fan speed (rpm)
+
+  if ( ( est->numPrev > 0 ) &&
+    TIME_REACHED ( thisTime, est->prevStamp [ 1 ] + maxPeriod ) ) // if time since last edge is too large, the fan has stopped (an edge may be newer than thisTime)
+  {
+    est->numPrev = 0; // forget old edges, so a timestamp wrap can't make them look recent
+    est->period  = 0;
+  }
+
+  if ( ( est->numPrev == 0 ) || ( est->period == 0 ) || // if there is no period measurement
+    ( est->period >= maxPeriod ) )                       // or fan period is too large
+    rpm = 0;                                             // use zero RPM value
+  else
+    rpm = recipDiv ( rpmCnts, est->period ); // fan speed
+  if ( rpm > maxN )                          // if RPM is too large
+    rpm = maxN;                              // restrict to max value
+
+  return (unsigned int) rpm;
+} // end of calcFanRPM()
+
+/******************************************************************************
+* Function:
+*   fanChannels()
+*
+* Description:
+*   Constructor function for a fanChannels object.  All fans start stopped
+*   and off.  The PI gains are given to the controllers by setGains(), once
+*   the saved variables have been loaded.
+*
+* Arguments:
+*   none
+*
+* Returns:
+*   none
+******************************************************************************/
+template <byte N>
+fanChannels<N>::fanChannels ( void )
+{
+  byte chan; // fan channel
+
+  for ( chan = 0; chan < N; chan++ )
+  {
+    rpm [ chan ]       = 0;
+    rpmRef [ chan ]    = 0;
+    duty [ chan ]      = 0;
+    shape [ chan ].ref = 0;
+  }
+  cfgGen       = savedVarsGen - 1; // curves and fusion stages are built on first use, once the saved variables are loaded
+  dmapSaveIdx  = 2 * N;            // no duty map save pass running
+  dmapSlopeDue = LOW;              // no duty map slope waiting to be saved
+  bumpless     = LOW;              // controllers start out in control
+  dmapHeld     = N;                // every duty map learns
+} // end of fanChannels()
+
+/******************************************************************************
+* Function:
+*   measSpeeds()
+*
+* Description:
+*   Calculates fan speeds, in RPM.  The hall edges received since last time
+*   are read, the period estimates updated, and the speeds low-pass filtered.
+*
+* Arguments:
+*   thisTime - timestamp value at which this function call occurs (timer1 counts).
+*
+* Returns:
+*   none
+******************************************************************************/
+template <byte N>
+void fanChannels<N>::measSpeeds ( unsigned long thisTime )
+{
+  byte         chan;   // fan channel
+  unsigned int newRpm; // unfiltered fan speed (rpm)
+  unsigned int filt;   // speed filter gain (0-1023)
+
+  for ( chan = 0; chan < N; chan++ )
+  {
+    /* Read the hall edges received since last time, and update the period */
+    hallRingUpdate ( &ring [ chan ], &est [ chan ] );
+
+    /* Calculate fan speed in RPM */
+    newRpm = calcFanRPM ( &est [ chan ], thisTime,
+      pgm_read_dword ( &fanCfgTbl [ chan ].rpmCnts ),
+      pgm_read_dword ( &fanCfgTbl [ chan ].maxPeriod ),
+      pgm_read_word ( &fanCfgTbl [ chan ].maxN ) );
+
+    /* Low-pass filter the measured fan speed */
+    filt         = *FAN_CFG_U ( chan, filt );
+    rpm [ chan ] = (unsigned int) ( ( (unsigned long) rpm [ chan ] * filt + (unsigned long) newRpm * ( 1024 - filt ) ) >> 10 );
+  }
+
+  return;
+} // end of measSpeeds()
+
+/******************************************************************************
+* Function:
+*   setRefSpeeds()
+*
+* Description:
+*   sets reference fan speeds to track desired temperature.  Above the
+*   turn-on temperature, the speed is read off the fan curve, which starts
+*   from the turn-on point at minimum speed and runs through the lookup
+*   table.  While a temperature sensor the fan uses is faulted, it runs at
+*   its failsafe speed instead.  A running fan gets a boost on top while
+*   the temperature is rising.  The curves and fusion stages are rebuilt
+*   first if any saved variable has been loaded or saved since they were
+*   last built, so each pass normally costs one fusion and one curve lookup
+*   per fan, with no settings checks.
+*
+* Arguments:
+*   none
+*
+* Returns:
+*   none
+******************************************************************************/
+template <byte N>
+void fanChannels<N>::setRefSpeeds ( void )
+{
+  byte          chan;    // fan channel
+  unsigned int  tempRef; // reference temperature used for this fan
+  unsigned int  boost;   // feedforward speed boost for this fan (rpm)
+  unsigned long boosted; // reference speed with boost (rpm)
+  byte          fault;   // high if a temperature sensor used by this fan is faulted
+
+  /* Rebuild the curves and fusion stages if their settings may have changed */
+  if ( cfgGen != savedVarsGen )
+  {
+    cfgGen = savedVarsGen;
+    for ( chan = 0; chan < N; chan++ )
+    {
+      setCurve ( chan );
+      setFuse ( chan );
+    }
+  }
+
+  for ( chan = 0; chan < N; chan++ )
+  {
+    /* Calculate reference temperature based on source selection */
+    tempRef = tempFuseRead ( &fuse [ chan ], &fault );
+    boost   = feedFwdUpdate ( &ff [ chan ], tempRef );
+
+    /* Calculate reference fan speed */
+    if ( fault )                                           // temperature sensor faulted
+      rpmRef [ chan ] = *FAN_CFG_U ( chan, failsafeRpm );  // run at failsafe speed
+    else if ( tempRef <= *FAN_CFG_U ( chan, turnOffTmp ) ) // below turn-off temperature
+      rpmRef [ chan ] = 0;                                 // set speed to zero (turn off)
+    else if ( tempRef <= *FAN_CFG_U ( chan, turnOnTmp ) )  // between turn-off and turn-on temperature
+    {
+      if ( rpmRef [ chan ] > 0 )                         // if fan was previously on
+        rpmRef [ chan ] = *FAN_CFG_U ( chan, minRpm ); // set speed to minimum
+      // if fan was previously off, it will remain off until turn-on temperature is reached
+    }
+    else                                                           // above turn-on temperature
+      rpmRef [ chan ] = fanCurveEval ( &curve [ chan ], tempRef ); // read speed off the curve
+
+    /* Boost a running fan while the temperature is rising (the boost can't
+     * be trusted with a faulted sensor, and a stopped fan is left to the
+     * turn-on temperature) */
+    if ( !fault && ( rpmRef [ chan ] > 0 ) && ( boost > 0 ) )
+    {
+      boosted         = (unsigned long) rpmRef [ chan ] + boost;
+      rpmRef [ chan ] = ( boosted > 0xFFFF ) ? 0xFFFF : (unsigned int) boosted;
+    }
+  }
+
+  return;
+} // end of setRefSpeeds()
+
+/******************************************************************************
+* Function:
+*   shapeRefSpeeds()
+*
+* Description:
+*   Shapes the reference fan speeds set by setRefSpeeds(), limiting their
+*   slew rates and keeping them out of the skip bands.  Run between
+*   setRefSpeeds() and regSpeeds().
+*
+* Arguments:
+*   none
+*
+* Returns:
+*   none
+******************************************************************************/
+template <byte N>
+void fanChannels<N>::shapeRefSpeeds ( void )
+{
+  byte chan; // fan channel
+
+  for ( chan = 0; chan < N; chan++ )
+    rpmRef [ chan ] = refShapeUpdate ( &shape [ chan ], rpmRef [ chan ], *FAN_CFG_U ( chan, minRpm ) );
+
+  return;
+} // end of shapeRefSpeeds()
+
+/******************************************************************************
+* Function:
+*   regSpeeds()
+*
+* Description:
+*   regulates fan speeds to reference values.  Unless dmapMode is DMAP_OFF,
+*   the duty map of each fan gives a feedforward duty for its reference,
+*   so the PI controller only makes up the difference.  In DMAP_LEARN the
+*   map is also fitted to the duty last applied while the fan is steady,
+*   unless holdLearning() has held it.
+*
+*   A fan which is off has its integrator cleared, so it starts from the
+*   feedforward alone rather than from whatever was left from when it last
+*   ran.  After takeOver(), each running fan's integrator is first
+*   pre-loaded from the duty it is running at, so control is handed back
+*   without a bump, and a fan which was held off has its integrator
+*   cleared, as whatever it wound up to while held means nothing.
+*
+* Arguments:
+*   none
+*
+* Returns:
+*   none
+******************************************************************************/
+template <byte N>
+void fanChannels<N>::regSpeeds ( void )
+{
+  byte chan;   // fan channel
+  int  errVal; // speed error (rpm)
+  int  ffTerm; // duty feedforward (quarter duty counts)
+
+  for ( chan = 0; chan < N; chan++ )
+  {
+    /* make sure reference is within allowable range, and calculate duty */
+    if ( rpmRef [ chan ] < *FAN_CFG_U ( chan, minRpm ) )
+    {
+      rpmRef [ chan ] = 0;      // set speed command to zero
+      duty [ chan ]   = 0;      // set output to zero
+      pi [ chan ].resetInt ( ); // start from a clear integrator when turned back on
+    }
+    else
+    {
+      if ( rpmRef [ chan ] > *FAN_CFG_U ( chan, maxRpm ) )
+        rpmRef [ chan ] = *FAN_CFG_U ( chan, maxRpm );
+      errVal = (int) rpmRef [ chan ] - rpm [ chan ];
+      ffTerm = 0;
+      if ( dmapMode != DMAP_OFF )
+      {
+        if ( ( dmapMode == DMAP_LEARN ) && ( chan != dmapHeld ) )
+          dutyMapLearn ( &dmap [ chan ], rpmRef [ chan ], rpm [ chan ], duty [ chan ], FAN_CFG_S ( chan, dmapOfs ), FAN_CFG_S ( chan, dmapSlope ) );
+        ffTerm = dutyMapEval ( *FAN_CFG_S ( chan, dmapOfs ), *FAN_CFG_S ( chan, dmapSlope ), rpmRef [ chan ] );
+      }
+      if ( bumpless && ( duty [ chan ] > 0 ) ) // carry on from the duty the fan is running at
+        pi [ chan ].preload ( duty [ chan ], errVal, ffTerm );
+      else if ( bumpless ) // held off, so start from the feedforward as a fan turning on does
+        pi [ chan ].resetInt ( );
+      duty [ chan ] = pi [ chan ].piControl ( errVal, ffTerm );
+    }
+  }
+  bumpless = LOW;
+
+  return;
+} // end of regSpeeds()
+
+/******************************************************************************
+* Function:
+*   takeOver()
+*
+* Description:
+*   Hands the duties back to the speed controllers, after something else has
+*   been setting them (the debug states or an auto-tune).  The next
+*   regSpeeds() pre-loads the integrator of each running fan so it carries
+*   on from the duty it is at.  A stopped fan starts from a clear integrator.
+*   A duty map held by holdLearning() learns again.
+*
+* Arguments:
+*   none
+*
+* Returns:
+*   none
+******************************************************************************/
+template <byte N>
+void fanChannels<N>::takeOver ( void )
+{
+  bumpless = HIGH;
+  holdLearning ( N );
+
+  return;
+} // end of takeOver()
+
+/******************************************************************************
+* Function:
+*   holdLearning()
+*
+* Description:
+*   Stops the duty map of a channel learning while something other than its
+*   speed controller sets its duty (an auto-tune), as the speeds and duties
+*   then say nothing about the duty the fan needs.  A map held before, of
+*   another channel, learns again from a fresh window, so the loops run
+*   before it was held aren't averaged in with those after.
+*
+* Arguments:
+*   chan - fan channel to hold, or N to hold none
+*
+* Returns:
+*   none
+******************************************************************************/
+template <byte N>
+void fanChannels<N>::holdLearning ( byte chan )
+{
+  if ( ( dmapHeld < N ) && ( dmapHeld != chan ) )
+  {
+    dmap [ dmapHeld ].loops   = 0;   // start a fresh window
+    dmap [ dmapHeld ].settled = LOW; // which is only a sample once the one before it was steady
+  }
+  dmapHeld = chan;
+
+  return;
+} // end of holdLearning()
+
+/******************************************************************************
+* Function:
+*   monStalls()
+*
+* Description:
+*   Runs the stall monitor of each fan, using the final PWM duties set by
+*   the state machine.  A fan which is commanded on but not turning has its
+*   duty overridden to kick it back into motion, or turned off if it is
+*   faulted.  The hall glitch counts are copied over so they can be shown
+*   alongside the other fault counters.
+*
+* Arguments:
+*   none
+*
+* Returns:
+*   none
+******************************************************************************/
+template <byte N>
+void fanChannels<N>::monStalls ( void )
+{
+  byte chan; // fan channel
+
+  for ( chan = 0; chan < N; chan++ )
+  {
+    duty [ chan ]         = fanMonUpdate ( &mon [ chan ], duty [ chan ], rpm [ chan ] );
+    mon [ chan ].glitches = est [ chan ].glitches;
+  }
+
+  return;
+} // end of monStalls()
+
+/******************************************************************************
+* Function:
+*   stallFault()
+*
+* Description:
+*   Returns whether any fan has stalled and could not be restarted
+*
+* Arguments:
+*   none
+*
+* Returns:
+*   fault - high if a fan is faulted
+******************************************************************************/
+template <byte N>
+byte fanChannels<N>::stallFault ( void )
+{
+  byte chan; // fan channel
+
+  for ( chan = 0; chan < N; chan++ )
+  {
+    if ( fanMonFault ( &mon [ chan ] ) )
+      return HIGH;
+  }
+
+  return LOW;
+} // end of stallFault()
+
+/******************************************************************************
+* Function:
+*   setGains()
+*
+* Description:
+*   Gives the saved PI gains of a fan channel to its controller
+*
+* Arguments:
+*   chan - fan channel
+*
+* Returns:
+*   none
+******************************************************************************/
+template <byte N>
+void fanChannels<N>::setGains ( byte chan )
+{
+  pi [ chan ].setGains ( *FAN_CFG_S ( chan, imax ),
+    *FAN_CFG_S ( chan, imin ),
+    *FAN_CFG_S ( chan, kp ),
+    *FAN_CFG_S ( chan, ki ) );
+
+  return;
+} // end of setGains()
+
+/******************************************************************************
+* Function:
+*   setCurve()
+*
+* Description:
+*   Rebuilds the speed-temperature curve of a fan channel from its saved
+*   turn-on point and lookup table.  Called by setRefSpeeds() whenever a
+*   saved variable has changed.  Table points which aren't above the point
+*   before are left out of the curve.
+*
+* Arguments:
+*   chan - fan channel
+*
+* Returns:
+*   dropped - number of table points left out of the curve
+******************************************************************************/
+template <byte N>
+byte fanChannels<N>::setCurve ( byte chan )
+{
+  unsigned int x [ FAN_TBL_PTS + 1 ]; // temperatures of the curve points
+  unsigned int y [ FAN_TBL_PTS + 1 ]; // speeds of the curve points
+  byte         pt;                    // lookup table point
+
+  x [ 0 ] = *FAN_CFG_U ( chan, turnOnTmp ); // curve starts at the turn-on point, at minimum speed
+  y [ 0 ] = *FAN_CFG_U ( chan, minRpm );
+  for ( pt = 0; pt < FAN_TBL_PTS; pt++ )
+  {
+    x [ pt + 1 ] = *FAN_CFG_U ( chan, tblTmp [ pt ] );
+    y [ pt + 1 ] = *FAN_CFG_U ( chan, tblSpd [ pt ] );
+  }
+
+  return fanCurveBuild ( &curve [ chan ], x, y, FAN_TBL_PTS + 1 );
+} // end of setCurve()
+
+/******************************************************************************
+* Function:
+*   setFuse()
+*
+* Description:
+*   Rebuilds the temperature fusion stage of a fan channel from its saved
+*   temperature source selection, weights, offsets and mode.  Called by
+*   setRefSpeeds() whenever a saved variable has changed.
+*
+* Arguments:
+*   chan - fan channel
+*
+* Returns:
+*   none
+******************************************************************************/
+template <byte N>
+void fanChannels<N>::setFuse ( byte chan )
+{
+  unsigned int wt [ TFUSE_NUM_INS ];  // saved weight of each input
+  int          ofs [ TFUSE_NUM_INS ]; // saved offset of each input
+  byte         in;                    // temperature input
+
+  for ( in = 0; in < TFUSE_NUM_INS; in++ )
+  {
+    wt [ in ]  = *FAN_CFG_U ( chan, fuseWt [ in ] );
+    ofs [ in ] = *FAN_CFG_S ( chan, fuseOfs [ in ] );
+  }
+  tempFuseBuild ( &fuse [ chan ], *FAN_CFG_U ( chan, tmpsrc ), wt, ofs, *FAN_CFG_U ( chan, fuseMode ) );
+
+  return;
+} // end of setFuse()
+
+/******************************************************************************
+* Function:
+*   saveDutyMaps()
+*
+* Description:
+*   Saves the learned duty maps to EEPROM, at most every DMAP_SAVE_S, so
+*   the maps survive a reset without wearing out the EEPROM.  A save pass
+*   writes one setting per call, and skips the maps which haven't changed,
+*   so no call holds up the scheduler for long.  A map's changed flag is
+*   taken and cleared when its offset is saved, so a change made between
+*   the offset and slope saves is kept for the next pass, not lost.  Call
+*   from a task which doesn't share a tick with the control loop.
+*
+* Arguments:
+*   none
+*
+* Returns:
+*   none
+******************************************************************************/
+template <byte N>
+void fanChannels<N>::saveDutyMaps ( void )
+{
+  byte chan; // fan channel of the next setting
+
+  if ( dmapSaveIdx >= 2 * N ) // no pass running
+  {
+    if ( runTime_s - dmapSaveTime < DMAP_SAVE_S )
+      return;
+    dmapSaveTime = runTime_s;
+    dmapSaveIdx  = 0;
+  }
+
+  chan = dmapSaveIdx >> 1;
+  if ( ( dmapSaveIdx & 1 ) == 0 )
+  {
+    dmapSlopeDue = dmap [ chan ].changed; // the slope goes with this offset, even if the map changes before the next call
+    if ( dmapSlopeDue )
+    {
+      dmap [ chan ].changed = LOW; // any change from now on is saved next pass
+      saveVar ( FAN_CFG_S ( chan, dmapOfs ) );
+    }
+  }
+  else if ( dmapSlopeDue )
+    saveVar ( FAN_CFG_S ( chan, dmapSlope ) );
+  dmapSaveIdx++;
+
+  return;
+} // end of saveDutyMaps()
+
+/******************************************************************************
+* Function:
+*   allOff()
+*
+* Description:
+*   Sets all PWM duties to zero, turning the fans off
+*
+* Arguments:
+*   none
+*
+* Returns:
+*   none
+******************************************************************************/
+template <byte N>
+void fanChannels<N>::allOff ( void )
+{
+  byte chan; // fan channel
+
+  for ( chan = 0; chan < N; chan++ )
+    duty [ chan ] = 0; // set output to zero
+
+  return;
+} // end of allOff()
+
+/******************************************************************************
+* Function:
+*   setOutputs()
+*
+* Description:
+*   Sets each PWM output to the duty of its fan channel.  Channel n drives
+*   PWM output n.
+*
+* Arguments:
+*   none
+*
+* Returns:
+*   none
+******************************************************************************/
+template <byte N>
+void fanChannels<N>::setOutputs ( void )
+{
+  byte chan; // fan channel
+
+  for ( chan = 0; chan < N; chan++ )
+    pwmOutSet ( (PWMOUT_ENUM_TYPE) chan, duty [ chan ] );
+
+  return;
+} // end of setOutputs()
+
+/* Build the fan channels for this board */
+template class fanChannels<NUM_FANS>;
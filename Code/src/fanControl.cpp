@@ -27,6 +27,9 @@ void setup ( void )
   /* Reset state machine, which will initialize the system */
   stateMachine.reset ( );
 
+  /* Start the task countdowns */
+  taskSchedInit ( );
+
   return; // end of setup()
 }         // end of setup()
 
@@ -36,7 +39,8 @@ void setup ( void )
 *
 * Description:
 *   This is the main loop of the program.  It runs endlessly after
-*   initialization is complete.
+*   initialization is complete.  Each pass sleeps until the next scheduler
+*   tick, then runs the tasks which are due.
 *
 * Arguments:
 *   none
@@ -46,35 +50,175 @@ void setup ( void )
 ******************************************************************************/
 void loop ( void )
 {
-  static unsigned long lastTime = 0;          // time when last loop began (microseconds/64)
-  unsigned long        thisTime = micros ( ); // time now (in microseconds/64)
+  byte ticks; // number of scheduler ticks elapsed since last pass
+
+  /* Sleep until the next scheduler tick */
+  ticks = sysTimerWaitTick ( );
+  if ( ticks > 1 ) // previous pass overran into the following tick(s)
+    loopTimingMissedTicks ( ticks - 1 );
+
+  /* Advance the uptime clock */
+  timeBaseTick ( ticks );
 
-  /* Check to see if it is time to run a new loop, otherwise return */
-  if ( thisTime - lastTime >= LOOPTIME_US * 64 ) // enough time elapsed for new loop
-    lastTime = thisTime;                         // store loop time for next iteration
-  else
-    return; // skip this loop iteration
+  /* Run the tasks which are due */
+  TIMING_START ( tickStart );
+  taskSchedRun ( ticks );
+  TIMING_STOP ( TIM_TICK, tickStart );
+
+  return; // end of loop()
+}         // end of loop()
+
+/******************************************************************************
+* Function:
+*   controlTask()
+*
+* Description:
+*   Runs one iteration of the control loop.  Measures fan speeds and
+*   temperatures, checks buttons, runs the state machine, and sets the PWM
+*   outputs.
+*
+* Arguments:
+*   none
+*
+* Returns:
+*   none
+******************************************************************************/
+void controlTask ( void )
+{
+  unsigned long thisTime = timeBaseNow ( ); // time when this loop began (timer1 counts)
+  unsigned int  rawTemp;                    // mean raw temperature reading since last loop
+  TIMING_START ( ctrlStart );
 
   /* keep track of total program run time */
-  runTime_s = loopsRun * LOOPTIME_US / 1000000; // track runtime in seconds
-  loopsRun++;                                   // increment count of loops run
+  runTime_s = timeBaseUptimeSec ( ); // track runtime in seconds
 
   /* Calculate Fan speeds in RPM */
-  measFanSpeeds ( thisTime );
+  TIMING_START ( fansStart );
+  fans.measSpeeds ( thisTime );
+  TIMING_STOP ( TIM_FANS, fansStart );
 
-  /* Read temperature measurements */
-  Temp1 = analogRead ( TEMP1PIN ); // read temp sensor 1
-  Temp2 = analogRead ( TEMP2PIN ); // read temp sensor 2
+  /* Average temperature readings taken since last loop, then filter them
+   * and check for sensor faults (keeps last values if there were none) */
+  if ( adcSamplerRead ( ADC_TEMP1, &rawTemp ) )
+    Temp1 = tempCondUpdate ( &temp1Cond, rawTemp );
+  if ( adcSamplerRead ( ADC_TEMP2, &rawTemp ) )
+    Temp2 = tempCondUpdate ( &temp2Cond, rawTemp );
 
   /* Check for button clicks and update consecutive button press count */
+  TIMING_START ( btnsStart );
   checkButtonPress ( );
+  TIMING_STOP ( TIM_BTNS, btnsStart );
 
   /* Run state machine */
+  TIMING_START ( stateStart );
   stateMachine.run ( );
+  TIMING_STOP ( TIM_STATE, stateStart );
 
-  /* Set duty cycle for pwm outputs */
-  analogWrite ( PWM1PIN, Pwm1Duty ); // set pwm1 duty
-  analogWrite ( PWM2PIN, Pwm2Duty ); // set pwm2 duty
+  /* Set duty cycle for pwm outputs, after checking for stalled fans */
+  TIMING_START ( pwmStart );
+  fans.monStalls ( );
+  fans.setOutputs ( );
+  TIMING_STOP ( TIM_PWM, pwmStart );
 
-  return; // end of loop()
-}         // end of loop()
+  TIMING_STOP ( TIM_CTRL, ctrlStart );
+
+  return;
+} // end of controlTask()
+
+/******************************************************************************
+* Function:
+*   displayTask()
+*
+* Description:
+*   Updates the LCD screen
+*
+* Arguments:
+*   none
+*
+* Returns:
+*   none
+******************************************************************************/
+void displayTask ( void )
+{
+  TIMING_START ( lcdStart );
+  stateMachine.display ( );
+  TIMING_STOP ( TIM_LCD, lcdStart );
+
+  return;
+} // end of displayTask()
+
+/******************************************************************************
+* Function:
+*   serialTask()
+*
+* Description:
+*   Saves PI gains found by an auto-tune, if there are any waiting, handles
+*   debug messages received over the serial port, if there are any bytes
+*   waiting, and sends the next line of a timing report if one has been
+*   requested.
+*
+* Arguments:
+*   none
+*
+* Returns:
+*   none
+******************************************************************************/
+void serialTask ( void )
+{
+  TIMING_START ( serStart );
+
+  stateMachine.saveTunedGains ( ); // save auto-tuned PI gains (if any), whether or not a message is waiting
+
+  if ( Serial.available ( ) > 0 )
+    stateMachine.checkSerial ( );
+
+  loopTimingReport ( ); // send next line of timing report (if any)
+
+  TIMING_STOP ( TIM_SER, serStart );
+
+  return;
+} // end of serialTask()
+
+/******************************************************************************
+* Function:
+*   oneWireTask()
+*
+* Description:
+*   Runs one step of the 1-Wire temperature sensor read cycle.  Each step is
+*   short, and runs on a tick of its own between control loops, so the bus
+*   time never adds to the control loop's tick.  The conversion time is
+*   spread over many steps.
+*
+* Arguments:
+*   none
+*
+* Returns:
+*   none
+******************************************************************************/
+void oneWireTask ( void )
+{
+  dsTempStep ( );
+
+  return;
+} // end of oneWireTask()
+
+/******************************************************************************
+* Function:
+*   dutyMapTask()
+*
+* Description:
+*   Saves the next learned duty map setting to EEPROM, if a save is due.
+*   Each save writes one setting, so it fits in a tick of its own.
+*
+* Arguments:
+*   none
+*
+* Returns:
+*   none
+******************************************************************************/
+void dutyMapTask ( void )
+{
+  fans.saveDutyMaps ( );
+
+  return;
+} // end of dutyMapTask()
@@ -10,8 +10,12 @@
  ******************************************************************************/
 #include "FanControlUtils.h"
 #include "savedVars.h"
-#include "piController.h"
 #include "LiquidCrystal.h"
+#include "timeBase.h"
+#include "hallRing.h"
+#include "fanChannel.h"
+#include "pwmOut.h"
+#include <avr/interrupt.h>
 
 /*******************************************************************************
  * CLASS DEFINITIONS
@@ -24,83 +28,23 @@ LiquidCrystal lcd ( LCDRSPIN, // set the RS pin
   LCDD1PIN,                   // set the data 1 pin
   LCDD2PIN,                   // set the data 2 pin
   LCDD3PIN );                 // set the data 3 pin
-piController pi1 ( LOOPTIME_US,
-  pi1Imax,
-  pi1Imin,
-  pi1Kp,
-  pi1Ki ); // PI controller #1 class object
-piController pi2 ( LOOPTIME_US,
-  pi2Imax,
-  pi2Imin,
-  pi2Kp,
-  pi2Ki ); // PI controller #1 class object
 
 /*******************************************************************************
  * GLOBAL VARIABLE DEFINITIONS
  ******************************************************************************/
-volatile unsigned long lastEdgeTime1                       = 0;     // timestamp of previous edge of hall sensor 1
-volatile unsigned long lastEdgeTime2                       = 0;     // timestamp of previous edge of hall sensor 2
-volatile unsigned long hall1Period                         = 1;     // period count for hall sensor 1
-volatile unsigned long hall2Period                         = 1;     // period count for hall sensor 2
-unsigned int           Fan1RPM                             = 0;     // Fan 1 speed, in rpm
-unsigned int           Fan2RPM                             = 0;     // Fan 2 speed, in rpm
-unsigned int           Fan1RPMRef                          = 0;     // Fan 1 reference speed, in rpm
-unsigned int           Fan2RPMRef                          = 0;     // Fan 2 reference speed, in rpm
-byte                   Pwm1Duty                            = 0;     // PWM 1 duty cycle (0-255 maps to 0%-100%)
-byte                   Pwm2Duty                            = 0;     // PWM 2 duty cycle (0-255 maps to 0%-100%)
-unsigned int           Temp1                               = 0;     // Temperature 1 input, stored digitally (0-1023)
-unsigned int           Temp2                               = 0;     // Temperature 2 input, stored digitally (0-1023)
-unsigned long          loopsRun                            = 0;     // total number of loops run since reset
+unsigned int           Temp1                               = 0;     // Temperature 1 input, stored digitally (0-TEMP_DIG_MAX)
+unsigned int           Temp2                               = 0;     // Temperature 2 input, stored digitally (0-TEMP_DIG_MAX)
 unsigned long          runTime_s                           = 0;     // program run-time since reset (seconds)
 byte                   stateChange                         = 0;     // high when a state change occurs
 unsigned int           btn1PressCnt                        = 0;     // number of consecutive times button 1 was pressed
 unsigned int           btn2PressCnt                        = 0;     // number of consecutive times button 1 was pressed
 unsigned int           btn3PressCnt                        = 0;     // number of consecutive times button 1 was pressed
-byte                   lcdLoops                            = 0;     // number of loops run since last LCD update
 int                    debugDatWords [ DEBUGMSG_DATWORDS ] = { 0 }; // buffer of data words included in payload of debug messages
 
-/******************************************************************************
-* Function:
-*   measFanSpeeds()
-*
-* Description:
-*   Calculates fan speeds, in RPM
-*
-* Arguments:
-*   thisTime - timestamp value at which this function call occurs.
-*
-* Returns:
-*   none
-******************************************************************************/
-void measFanSpeeds ( unsigned long thisTime )
-{
-  static unsigned int lastFan1RPM = 0; // last measured fan1 rpm
-  static unsigned int lastFan2RPM = 0; // last measured fan2 rpm
-
-  /* Calculate Fan speeds in RPM */
-  if ( ( hall1Period >= ( ( (unsigned long) 1000000L / MINN1 ) * 60 / FAN1PPR ) ) ||                       // if fan period is too large
-    ( ( ( thisTime - lastEdgeTime1 ) >> 5 ) >= ( ( (unsigned long) 1000000L / MINN1 ) * 60 / FAN1PPR ) ) ) // or time since last edge is too large
-    Fan1RPM = 0;                                                                                           // use zero RPM value
-  else
-    Fan1RPM = (unsigned int) ( ( 1000000L / hall1Period ) * 60 / FAN1PPR );                                // Fan1 speed
-  if ( Fan1RPM > MAXN1 )                                                                                   // if RPM is too large
-    Fan1RPM = MAXN1;                                                                                       // restrict to max value
-  if ( ( hall2Period >= ( ( (unsigned long) 1000000L / MINN2 ) * 60 / FAN2PPR ) ) ||                       // if fan period is too large
-    ( ( ( thisTime - lastEdgeTime2 ) >> 5 ) >= ( ( (unsigned long) 1000000L / MINN2 ) * 60 / FAN2PPR ) ) ) // or time since last edge is too large
-    Fan2RPM = 0;                                                                                           // use zero RPM value
-  else
-    Fan2RPM = (unsigned int) ( ( 1000000L / hall2Period ) * 60 / FAN2PPR );  // Fan2 speed
-  if ( Fan2RPM > MAXN2 )                                                     // if RPM is too large
-    Fan2RPM = MAXN2;                                                         // restrict to max value
-
-  /* Low-pass filter the measured fan speeds */
-  Fan1RPM     = (unsigned int) ( ( (unsigned long) lastFan1RPM * fan1Filt + (unsigned long) Fan1RPM * ( 1024 - fan1Filt ) ) >> 10 );
-  lastFan1RPM = Fan1RPM;
-  Fan2RPM     = (unsigned int) ( ( (unsigned long) lastFan2RPM * fan2Filt + (unsigned long) Fan2RPM * ( 1024 - fan2Filt ) ) >> 10 );
-  lastFan2RPM = Fan2RPM;
-  return;
-} // end of measFanSpeeds()
-
+/* The hall sensors below are wired to fan channels 0 and 1 */
+#if NUM_FANS != 2
+#error "hallInit() and the hall interrupts must be updated to match NUM_FANS"
+#endif
 
 /******************************************************************************
 * Function:
@@ -142,10 +86,24 @@ void checkButtonPress ( void )
 
 /******************************************************************************
 * Function:
-*   setRefFanSpeeds()
+*   hallInit()
 *
 * Description:
-*   sets reference fan speeds to track desired temperature
+*   Starts timestamping hall sensor edges (both rising and falling), using
+*   the backend selected by HALL_BACKEND.  The system timer must already be
+*   running.
+*
+*   HALL_BACKEND_EXTINT timestamps both sensors in external interrupt
+*   handlers, so each timestamp is late by the interrupt latency, which
+*   varies with whatever other interrupt or critical section is running.
+*
+*   HALL_BACKEND_ICP1 has the timer1 input capture unit latch the timer count
+*   for hall sensor 1 in hardware on the edge itself, so its timestamps have
+*   no latency jitter.  There is only one capture unit, so hall sensor 2
+*   still uses its external interrupt.
+*
+*   Each ring is given the current hall level first, since edges which
+*   don't change the level are rejected as glitches.
 *
 * Arguments:
 *   none
@@ -153,158 +111,36 @@ void checkButtonPress ( void )
 * Returns:
 *   none
 ******************************************************************************/
-void setRefFanSpeeds ( void )
+void hallInit ( void )
 {
-  unsigned int tempRef1;       // reference temperature used for fan 1
-  unsigned int tempRef2;       // reference temperature used for fan 2
-  long int     x0, x2, y0, y2; // variables used for interpolation
-
-  /* Calculate reference temperatures based on source selection */
-  switch ( tmpsrc1 ) // switch on temperature source for fan 1
-  {
-  case TMPSRC_TMP1:   // temp sensor 1
-    tempRef1 = Temp1; // set temperature sensor 1
-    break;
-
-  case TMPSRC_TMP2:   // temp sensor 2
-    tempRef1 = Temp2; // set temperature sensor 2
-    break;
-
-  case TMPSRC_MAX:                                 // maximum temperature
-    tempRef1 = ( Temp1 >= Temp2 ) ? Temp1 : Temp2; // set maximum temperature
-    break;
-
-  case TMPSRC_MEAN:                    // mean temperature
-    tempRef1 = ( Temp1 + Temp2 ) >> 1; // set mean temperature
-    break;
-
-  default:                                         // invalid source selection
-    tmpsrc1  = TMPSRC_DEF;                         // set default (should be valid!)
-    saveVar ( &tmpsrc1 );                          // save default
-    tempRef1 = ( Temp1 >= Temp2 ) ? Temp1 : Temp2; // just use max temp for now - next time around it will use default (if default is different)
-  }
-  switch ( tmpsrc2 ) // switch on temperature source for fan 2
-  {
-  case TMPSRC_TMP1:   // temp sensor 1
-    tempRef2 = Temp1; // set temperature sensor 1
-    break;
-
-  case TMPSRC_TMP2:   // temp sensor 2
-    tempRef2 = Temp2; // set temperature sensor 2
-    break;
-
-  case TMPSRC_MAX:                                 // maximum temperature
-    tempRef2 = ( Temp1 >= Temp2 ) ? Temp1 : Temp2; // set maximum temperature
-    break;
-
-  case TMPSRC_MEAN:                    // mean temperature
-    tempRef2 = ( Temp1 + Temp2 ) >> 1; // set mean temperature
-    break;
-
-  default:                                         // invalid source selection
-    tmpsrc2  = TMPSRC_DEF;                         // set default (should be valid!)
-    saveVar ( &tmpsrc2 );                          // save default
-    tempRef2 = ( Temp1 >= Temp2 ) ? Temp1 : Temp2; // just use max temp for now - next time around it will use default (if default is different)
-  }
-
-  /* Calculate Reference Fan 1 speed */
-  if ( tempRef1 <= fan1TurnOffTmp )     // below turn-off temperature
-    Fan1RPMRef = 0;                     // set speed to zero (turn off)
-  else if ( tempRef1 <= fan1TurnOnTmp ) // between turn-off and turn-on temperature
-  {
-    if ( Fan1RPMRef > 0 )    // if fan was previously on
-      Fan1RPMRef = minRpm1;  // set speed to minimum
-    // if fan was previously off, it will remain off until turn-on temperature is reached
-  }
-  else if ( tempRef1 < fan1TblTmp4 ) // above turn-on temperature but below max table value
-  {
-    if ( tempRef1 < fan1TblTmp1 ) // below first table value, at or above turn-on point
-    {
-      x0 = (long int) fan1TurnOnTmp; // x-axis value at beginning of range
-      x2 = (long int) fan1TblTmp1;   // x-axis value at end of range
-      y0 = (long int) minRpm1;       // y-axis value at beginning of range
-      y2 = (long int) fan1TblSpd1;   // y-axis value at end of range
-    }
-    else if ( tempRef1 < fan1TblTmp2 ) // below second table value, at or above first value
-    {
-      x0 = (long int) fan1TblTmp1; // x-axis value at beginning of range
-      x2 = (long int) fan1TblTmp2; // x-axis value at end of range
-      y0 = (long int) fan1TblSpd1; // y-axis value at beginning of range
-      y2 = (long int) fan1TblSpd2; // y-axis value at end of range
-    }
-    else if ( tempRef1 < fan1TblTmp3 ) // below third table value, at or above second value
-    {
-      x0 = (long int) fan1TblTmp2; // x-axis value at beginning of range
-      x2 = (long int) fan1TblTmp3; // x-axis value at end of range
-      y0 = (long int) fan1TblSpd2; // y-axis value at beginning of range
-      y2 = (long int) fan1TblSpd3; // y-axis value at end of range
-    }
-    else // below fourth table value, at or above third value
-    {
-      x0 = (long int) fan1TblTmp3; // x-axis value at beginning of range
-      x2 = (long int) fan1TblTmp4; // x-axis value at end of range
-      y0 = (long int) fan1TblSpd3; // y-axis value at beginning of range
-      y2 = (long int) fan1TblSpd4; // y-axis value at end of range
-    }
-    Fan1RPMRef = (unsigned int) ( ( ( ( y2 - y0 ) * ( (long int) tempRef1 - x0 ) ) / ( x2 - x0 ) ) + y0 ); // interpolate to get results
-  }
-  else                         // at or above fourth table value
-    Fan1RPMRef = fan1TblSpd4;  // use fourth table value
-
-  /* Calculate Reference Fan 2 speed */
-  if ( tempRef2 <= fan2TurnOffTmp )     // below turn-off temperature
-    Fan2RPMRef = 0;                     // set speed to zero (turn off)
-  else if ( tempRef2 <= fan2TurnOnTmp ) // between turn-off and turn-on temperature
-  {
-    if ( Fan2RPMRef > 0 )    // if fan was previously on
-      Fan2RPMRef = minRpm2;  // set speed to minimum
-    // if fan was previously off, it will remain off until turn-on temperature is reached
-  }
-  else if ( tempRef2 < fan2TblTmp4 ) // above turn-on temperature but below max table value
-  {
-    if ( tempRef2 < fan2TblTmp1 ) // below first table value, at or above turn-on point
-    {
-      x0 = (long int) fan2TurnOnTmp; // x-axis value at beginning of range
-      x2 = (long int) fan2TblTmp1;   // x-axis value at end of range
-      y0 = (long int) minRpm2;       // y-axis value at beginning of range
-      y2 = (long int) fan2TblSpd1;   // y-axis value at end of range
-    }
-    else if ( tempRef2 < fan2TblTmp2 ) // below second table value, at or above first value
-    {
-      x0 = (long int) fan2TblTmp1; // x-axis value at beginning of range
-      x2 = (long int) fan2TblTmp2; // x-axis value at end of range
-      y0 = (long int) fan2TblSpd1; // y-axis value at beginning of range
-      y2 = (long int) fan2TblSpd2; // y-axis value at end of range
-    }
-    else if ( tempRef2 < fan2TblTmp3 ) // below third table value, at or above second value
-    {
-      x0 = (long int) fan2TblTmp2; // x-axis value at beginning of range
-      x2 = (long int) fan2TblTmp3; // x-axis value at end of range
-      y0 = (long int) fan2TblSpd2; // y-axis value at beginning of range
-      y2 = (long int) fan2TblSpd3; // y-axis value at end of range
-    }
-    else // below fourth table value, at or above third value
-    {
-      x0 = (long int) fan2TblTmp3; // x-axis value at beginning of range
-      x2 = (long int) fan2TblTmp4; // x-axis value at end of range
-      y0 = (long int) fan2TblSpd3; // y-axis value at beginning of range
-      y2 = (long int) fan2TblSpd4; // y-axis value at end of range
-    }
-    Fan2RPMRef = (unsigned int) ( ( ( ( y2 - y0 ) * ( (long int) tempRef2 - x0 ) ) / ( x2 - x0 ) ) + y0 ); // interpolate to get results
-  }
-  else                         // at or above fourth table value
-    Fan2RPMRef = fan2TblSpd4;  // use fourth table value
+  hallRingInit ( &fans.ring [ 0 ], HALL1_READ ( ) );
+  hallRingInit ( &fans.ring [ 1 ], HALL2_READ ( ) );
+
+#if HALL_BACKEND == HALL_BACKEND_ICP1
+  pinMode ( HALL1PIN, INPUT ); // ICP1 pin is an input
+  sysTimerCaptureInit ( );     // timestamp hall 1 edges in hardware
+  if ( HALL1_READ ( ) )
+    TCCR1B &= ~_BV ( ICES1 );  // high, so capture the falling edge first
+#else
+  attachInterrupt ( digitalPinToInterrupt ( HALL1PIN ), hall1ISR, CHANGE );
+#endif
+  attachInterrupt ( digitalPinToInterrupt ( HALL2PIN ), hall2ISR, CHANGE );
 
   return;
-} // end of setRefFanSpeeds()
-
+} // end of hallInit()
 
+#if HALL_BACKEND == HALL_BACKEND_ICP1
 /******************************************************************************
 * Function:
-*   regFanSpeeds()
+*   ISR(TIMER1_CAPT_vect)
 *
 * Description:
-*   regulates fan speeds to reference values
+*   Timer1 input capture interrupt, used for hall sensor 1 when the ICP1
+*   backend is selected.  The capture unit only sees one edge direction at a
+*   time, so after each capture it is set to catch the edge leaving the
+*   level the pin is at now (sampled clear of PWM switching noise).  A spike
+*   which has already ended then leaves the capture edge unchanged, rather
+*   than getting it out of step with the hall signal.
 *
 * Arguments:
 *   none
@@ -312,38 +148,26 @@ void setRefFanSpeeds ( void )
 * Returns:
 *   none
 ******************************************************************************/
-void regFanSpeeds ( void )
+ISR ( TIMER1_CAPT_vect )
 {
-  /* make sure fan1 reference is within allowable range, and calculate duty */
-  if ( Fan1RPMRef < minRpm1 )
-  {
-    Fan1RPMRef = 0; // set speed command to zero
-    Pwm1Duty   = 0; // set output to zero
-  }
-  else if ( Fan1RPMRef > maxRpm1 )
-  {
-    Fan1RPMRef = maxRpm1;
-    Pwm1Duty   = pi1.piControl ( (int) Fan1RPMRef - Fan1RPM ); // use constant duty for now
-  }
-  else
-    Pwm1Duty = pi1.piControl ( (int) Fan1RPMRef - Fan1RPM ); // use constant duty for now
+  unsigned int capture = ICR1; // timer1 count latched on the edge
+  byte         level;          // hall level after the edge
 
-  /* make sure fan2 reference is within allowable range, and calculate duty */
-  if ( Fan2RPMRef < minRpm2 )
-  {
-    Fan2RPMRef = 0; // set speed command to zero
-    Pwm2Duty   = 0; // set output to zero
-  }
-  else if ( Fan2RPMRef > maxRpm2 )
-  {
-    Fan2RPMRef = maxRpm2;
-    Pwm2Duty   = pi2.piControl ( (int) Fan2RPMRef - Fan2RPM ); // use constant duty for now
-  }
+  pwmOutQuiet ( );
+  level = HALL1_READ ( );
+  if ( level )
+    TCCR1B &= ~_BV ( ICES1 ); // high, so capture the falling edge next
   else
-    Pwm2Duty = pi2.piControl ( (int) Fan2RPMRef - Fan2RPM ); // use constant duty for now
+    TCCR1B |= _BV ( ICES1 );  // low, so capture the rising edge next
+  TIFR1 = _BV ( ICF1 );       // changing the edge may set the capture flag, so clear it
+
+  /* Save timestamp of this edge for the main loop, which measures the
+   * period between edges */
+  hallRingPush ( &fans.ring [ 0 ], sysTimerExtend ( capture ), level );
 
   return;
-} // end of regFanSpeeds()
+} // end of ISR(TIMER1_CAPT_vect)
+#endif
 
 /******************************************************************************
 * Function:
@@ -352,7 +176,8 @@ void regFanSpeeds ( void )
 * Description:
 *   Interrupt Service Routine called whenever the hall-effect sensor for Fan1
 *   changes state.  Used to track timing of the hall sensor pulses, which
-*   indicates fan speed.
+*   indicates fan speed.  The hall level is sampled clear of PWM switching
+*   noise, so spikes can be told apart from real edges.
 *
 * Arguments:
 *   none
@@ -362,17 +187,12 @@ void regFanSpeeds ( void )
 ******************************************************************************/
 void hall1ISR ( void )
 {
-  unsigned long thisEdgeTime = micros ( ); // timestamp of current edge
+  unsigned long stamp = timeBaseNow ( ); // time of the edge (timer1 counts)
 
-  /* Hall Period (microseconds) calculated using the difference between
-   * rising and falling edges, multiplied by two.  The multiply by two
-   * is required because we are counting between any rising and falling
-   * edge, which counts the time length of half a period. Since the timer0
-   * speed is increased by 64, we need to also divide by 64.  So, right bit
-   * shifting by 5 yields the overall divide by 32.*/
-  hall1Period   = ( thisEdgeTime - lastEdgeTime1 ) >> 5; // calculate period in microseconds
-
-  lastEdgeTime1 = thisEdgeTime; // save current edge time for next iteration
+  /* Save timestamp of this edge for the main loop, which measures the
+   * period between edges */
+  pwmOutQuiet ( );
+  hallRingPush ( &fans.ring [ 0 ], stamp, HALL1_READ ( ) );
 
   return; // end of hall1ISR()
 }         // end of hall1ISR()
@@ -384,7 +204,8 @@ void hall1ISR ( void )
 * Description:
 *   Interrupt Service Routine called whenever the hall-effect sensor for Fan2
 *   changes state.  Used to track timing of the hall sensor pulses, which
-*   indicates fan speed.
+*   indicates fan speed.  The hall level is sampled clear of PWM switching
+*   noise, so spikes can be told apart from real edges.
 *
 * Arguments:
 *   none
@@ -394,17 +215,12 @@ void hall1ISR ( void )
 ******************************************************************************/
 void hall2ISR ( void )
 {
-  unsigned long thisEdgeTime = micros ( ); // timestamp of current edge
-
-  /* Hall Period (microseconds) calculated using the difference between
-   * rising and falling edges, multiplied by two.  The multiply by two
-   * is required because we are counting between any rising and falling
-   * edge, which counts the time length of half a period. Since the timer0
-   * speed is increased by 64, we need to also divide by 64.  So, right bit
-   * shifting by 5 yields the overall divide by 32.*/
-  hall2Period   = ( thisEdgeTime - lastEdgeTime2 ) >> 5; // calculate period in microseconds
+  unsigned long stamp = timeBaseNow ( ); // time of the edge (timer1 counts)
 
-  lastEdgeTime2 = thisEdgeTime; // save current edge time for next iteration
+  /* Save timestamp of this edge for the main loop, which measures the
+   * period between edges */
+  pwmOutQuiet ( );
+  hallRingPush ( &fans.ring [ 1 ], stamp, HALL2_READ ( ) );
 
   return; // end of hall2ISR()
 }         // end of hall2ISR()
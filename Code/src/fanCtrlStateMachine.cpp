@@ -11,28 +11,141 @@
 #include "LiquidCrystal.h"
 #include "savedVars.h"
 #include "piController.h"
+#include "sysTimer.h"
+#include "loopTiming.h"
+#include "pwmOut.h"
+#include "fanMonitor.h"
+#include "fanChannel.h"
+#include "adcSampler.h"
+#include "tempDisp.h"
+#include "dsTemp.h"
+#include "relayTune.h"
 
 /* Declare the class objects, which are defined elsewhere */
 extern LiquidCrystal lcd;
-extern piController  pi1;
-extern piController  pi2;
+
+/* The NORMAL and FAULT screens show one fan per column or line, and the
+ * DEBUG_FON message has four words per fan */
+#if NUM_FANS != 2
+#error "normalDisplay(), faultDisplay() and debugFonApply() must be updated to match NUM_FANS"
+#endif
+
+/*******************************************************************************
+ * STATIC VARIABLE DEFINITIONS
+ ******************************************************************************/
+static int          numDebugLoops = 0;   // number of consecutive loops in same debug mode without getting new message
+static byte         newDebugMsg   = LOW; // high when a new debug message has been received, but its data not yet applied
+static unsigned int btn1EdgCnt    = 0;   // Number of rising edges in button 1 since beginning debug
+static unsigned int btn2EdgCnt    = 0;   // Number of rising edges in button 2 since beginning debug
+static unsigned int btn3EdgCnt    = 0;   // Number of rising edges in button 3 since beginning debug
+static byte         debugChan     = 0;   // fan channel of the DEBUG_PI, DEBUG_TB and AUTOTUNE modes
+static byte         autoTuneSave  = LOW; // high when an auto-tune has set new PI gains, which are still to be saved
+static RELAY_TUNE_TYPE autoTune;         // relay experiment of the AUTOTUNE mode
 
 /*******************************************************************************
  * FUNCTION DEFINITIONS
  ******************************************************************************/
 
+/******************************************************************************
+* Function:
+*   debugHeadChan()
+*
+* Description:
+*   Checks whether a debug message header is the keyword of a debug mode for
+*   one fan, followed by a valid fan number.
+*
+* Arguments:
+*   msgHeader - message header read
+*   keyword - keyword of the debug mode, without the fan number
+*
+* Returns:
+*   chan - fan channel given by the header, or NUM_FANS if the header doesn't match
+******************************************************************************/
+static byte debugHeadChan ( const char *msgHeader, const char *keyword )
+{
+  byte chan = (byte) ( msgHeader [ DEBUGHEADSIZE - 1 ] - '1' ); // fan number is the last character of the header, and fan 1 is channel 0
+
+  if ( ( strncmp ( msgHeader, keyword, DEBUGHEADSIZE - 1 ) != 0 ) || ( chan >= NUM_FANS ) )
+    return NUM_FANS;
+
+  return chan;
+} // end of debugHeadChan()
+
+/******************************************************************************
+* Function:
+*   debugApplyWord()
+*
+* Description:
+*   Sets a saved variable to a data word of the debug message, and saves it
+*   to EEPROM, if it is different.
+*
+* Arguments:
+*   var - saved variable to set (a signed or unsigned int)
+*   word - index of the data word in debugDatWords[]
+*
+* Returns:
+*   none
+******************************************************************************/
+static void debugApplyWord ( void *var, byte word )
+{
+  if ( *(unsigned int *) var != *(unsigned int *) ( debugDatWords + word ) )
+  {
+    *(unsigned int *) var = *(unsigned int *) ( debugDatWords + word );
+    saveVar ( var );
+  }
+
+  return;
+} // end of debugApplyWord()
+
+/******************************************************************************
+* Function:
+*   printTempLine()
+*
+* Description:
+*   Formats a line of two temperatures for the LCD, in degC or degF as set
+*   by useFtemp.  The first is converted with the offset and gain of sensor
+*   1, and the second with those of sensor 2.  The conversions are cached by
+*   tempDisp, so this doesn't divide.
+*
+* Arguments:
+*   lcdBuff - buffer to print the line into
+*   prefix - character at the start of the line
+*   tmpA - first temperature, stored digitally (0-TEMP_DIG_MAX)
+*   tmpB - second temperature, stored digitally (0-TEMP_DIG_MAX)
+*
+* Returns:
+*   none
+******************************************************************************/
+static void printTempLine ( char *lcdBuff, char prefix, unsigned int tmpA, unsigned int tmpB )
+{
+  int  wholeA, wholeB; // whole part of each temperature
+  byte tenthA, tenthB; // tenths of each temperature
+
+  tempDispSplit ( TEMPDISP_1, tmpA, &wholeA, &tenthA );
+  tempDispSplit ( TEMPDISP_2, tmpB, &wholeB, &tenthB );
+  sprintf ( lcdBuff, "%c%c%c: %3hu.%hu %3hu.%hu",
+    prefix,
+    0xDF,
+    useFtemp ? 'F' : 'C',
+    wholeA,
+    tenthA,
+    wholeB,
+    tenthB );
+
+  return;
+} // end of printTempLine()
+
 /******************************************************************************
 * Function:
 *   checkDebugMsgs()
 *
 * Description:
 *   Checks serial input for commands to enter a debug mode.  If no message is
-*   received, and there is no debug timeout, it will remain in same state.  If
-*   already in debug mode, and a debug timeout occurs, it will return to normal
-*   state.
+*   received, it will remain in same state.  When a valid debug message is
+*   found, its data words are copied into debugDatWords[].
 *
 * Arguments:
-*   none
+*   thisState - current state
 *
 * Returns:
 *   nextState - state to enter on next loop.
@@ -44,8 +157,8 @@ static FANCTRLSTATE_ENUM_TYPE checkDebugMsgs ( FANCTRLSTATE_ENUM_TYPE thisState
   byte                   readBuffer [ DEBUGBUFFSIZE ];            // buffer for storing serial input
   int                    serialBytesAvail = Serial.available ( ); // number of bytes available to read
   int                    bytesRead;                               // number of bytes read
-  static int             numDebugLoops;                           // number of consecutive loops in same debug mode without getting new message
   char                   msgHeader [ DEBUGHEADSIZE + 1 ];         // string containing message header read
+  byte                   chan;                                    // fan channel given by message header
 
   /* Make sure we don't read more bytes than our buffer can store */
   if ( serialBytesAvail > DEBUGBUFFSIZE )
@@ -57,7 +170,8 @@ static FANCTRLSTATE_ENUM_TYPE checkDebugMsgs ( FANCTRLSTATE_ENUM_TYPE thisState
   /* Read serial data if enough bytes are available */
   if ( serialBytesAvail >= ( DEBUGMSG_DATWORDS * 2 + DEBUGHEADSIZE ) )
   {
-    bytesRead = Serial.readBytes ( readBuffer, serialBytesAvail ); // read until all data is read, or buffer is full
+    for ( bytesRead = 0; bytesRead < serialBytesAvail; bytesRead++ ) // read all available data, or until buffer is full (readBytes() can't be used, since its timeout relies on millis())
+      readBuffer [ bytesRead ] = (byte) Serial.read ( );
 
     for ( cnt = 0;
       cnt <= ( bytesRead - ( DEBUGMSG_DATWORDS * 2 + DEBUGHEADSIZE ) );
@@ -71,39 +185,72 @@ static FANCTRLSTATE_ENUM_TYPE checkDebugMsgs ( FANCTRLSTATE_ENUM_TYPE thisState
         nextState = NORMAL; // set next state to return to normal
         break;              // exit loop, don't load debug message data
       }
-      else if ( strcmp ( msgHeader, DEBUGPI1_HEAD ) == 0 )
-        nextState = DEBUG_PI1; // set next state to requested debug state
-      else if ( strcmp ( msgHeader, DEBUGPI2_HEAD ) == 0 )
-        nextState = DEBUG_PI2; // set next state to requested debug state
+      else if ( strcmp ( msgHeader, DEBUGTIM_HEAD ) == 0 )
+      {
+        loopTimingStartReport ( readBuffer [ cnt + DEBUGHEADSIZE ] != 0 || readBuffer [ cnt + DEBUGHEADSIZE + 1 ] != 0 ); // send timing report, clearing statistics afterwards if first data word is nonzero
+        break;                                                                                                            // exit loop, stay in same state and don't load debug message data
+      }
+      else if ( ( chan = debugHeadChan ( msgHeader, DEBUGPI_HEAD ) ) < NUM_FANS )
+      {
+        nextState = DEBUG_PI; // set next state to requested debug state
+        debugChan = chan;     // for the requested fan
+      }
       else if ( strcmp ( msgHeader, DEBUGBTN_HEAD ) == 0 )
         nextState = DEBUG_BTNS; // set next state to requested debug state
       else if ( strcmp ( msgHeader, DEBUGTMP_HEAD ) == 0 )
         nextState = DEBUG_TMP; // set next state to requested debug state
       else if ( strcmp ( msgHeader, DEBUGFON_HEAD ) == 0 )
         nextState = DEBUG_FON; // set next state to requested debug state
-      else if ( strcmp ( msgHeader, DEBUGTB1_HEAD ) == 0 )
-        nextState = DEBUG_TB1; // set next state to requested debug state
-      else if ( strcmp ( msgHeader, DEBUGTB2_HEAD ) == 0 )
-        nextState = DEBUG_TB2; // set next state to requested debug state
+      else if ( ( chan = debugHeadChan ( msgHeader, DEBUGTB_HEAD ) ) < NUM_FANS )
+      {
+        nextState = DEBUG_TB; // set next state to requested debug state
+        debugChan = chan;     // for the requested fan
+      }
+      else if ( ( chan = debugHeadChan ( msgHeader, AUTOTUNE_HEAD ) ) < NUM_FANS )
+      {
+        nextState = AUTOTUNE; // set next state to auto-tuning
+        debugChan = chan;     // for the requested fan
+      }
       else
         continue; // did not find valid message, skip to next buffer value
 
       /* If we made it to this point, a valid debug message was found */
       memcpy ( debugDatWords, readBuffer + cnt + DEBUGHEADSIZE, DEBUGMSG_DATWORDS * 2 ); // copy data payload into debug words buffer
       numDebugLoops = 0;                                                                 // reset counter of consecutive debug loops without getting new message
+      newDebugMsg   = HIGH;                                                              // flag that new message data should be applied
 
       break; // exit loop, since we found the valid message
     }
   }
 
+  return nextState;
+} // end of checkDebugMsgs();
+
+/******************************************************************************
+* Function:
+*   checkDebugTimeout()
+*
+* Description:
+*   Counts consecutive control loops spent in a debug mode without receiving a
+*   new debug message.  If a debug timeout occurs, it will return to normal
+*   state.
+*
+* Arguments:
+*   thisState - current state
+*
+* Returns:
+*   nextState - state to enter on next loop.
+******************************************************************************/
+static FANCTRLSTATE_ENUM_TYPE checkDebugTimeout ( FANCTRLSTATE_ENUM_TYPE thisState )
+{
+  FANCTRLSTATE_ENUM_TYPE nextState = thisState; // By default, remain in same state
+
   /* Check number of consecutive debug loops, and exit to normal mode if timeout occurred */
-  if ( nextState == DEBUG_PI1 ||
-    nextState == DEBUG_PI2 ||
+  if ( nextState == DEBUG_PI ||
     nextState == DEBUG_BTNS ||
     nextState == DEBUG_TMP ||
     nextState == DEBUG_FON ||
-    nextState == DEBUG_TB1 ||
-    nextState == DEBUG_TB2 ) // if we are in (or entering) debug state
+    nextState == DEBUG_TB ) // if we are in debug state
   {
     if ( numDebugLoops++ >= DEBUG_TIMEOUT ) // increment count of debug loops, and check for timeout
     {
@@ -113,7 +260,7 @@ static FANCTRLSTATE_ENUM_TYPE checkDebugMsgs ( FANCTRLSTATE_ENUM_TYPE thisState
   }
 
   return nextState;
-} // end of checkDebugMsgs();
+} // end of checkDebugTimeout();
 
 /******************************************************************************
 * Function:
@@ -130,8 +277,12 @@ static FANCTRLSTATE_ENUM_TYPE checkDebugMsgs ( FANCTRLSTATE_ENUM_TYPE thisState
 ******************************************************************************/
 static FANCTRLSTATE_ENUM_TYPE initState ( FANCTRLSTATE_ENUM_TYPE thisState )
 {
-  /* Load all variables from EEPROM */
+  byte chan; // fan channel
+
+  /* Load all variables from EEPROM, and give the PI gains to the controllers */
   loadAllVars ( );
+  for ( chan = 0; chan < NUM_FANS; chan++ )
+    fans.setGains ( chan );
 
   /* Initialize the LCD Screen and print initialization message */
   lcd.begin ( LCDCOLS, LCDROWS );  // initialize LCD display (16 cols, 2 rows)
@@ -151,33 +302,22 @@ static FANCTRLSTATE_ENUM_TYPE initState ( FANCTRLSTATE_ENUM_TYPE thisState )
   pinMode ( BTN2PIN, INPUT ); // button 2 is an input
   pinMode ( BTN3PIN, INPUT ); // button 3 is an input
 
-  /* Configure PWM pins and start with low output */
-  digitalWrite ( PWM1PIN, LOW ); // start with pwm1 pin low
-  digitalWrite ( PWM2PIN, LOW ); // start with pwm2 pin low
-  analogWrite ( PWM1PIN, 0x00 ); // set pwm1 to 0% duty
-  analogWrite ( PWM2PIN, 0x00 ); // set pwm2 to 0% duty
-  pinMode ( PWM1PIN, OUTPUT );   // set pin 5 as an output (PWM1)
-  pinMode ( PWM2PIN, OUTPUT );   // set pin 6 as an output (PWM2)
-
-  /* Change Timer0 clock divider to achieve higher speed (for 62500Hz PWM).
-   * This effectively increases the frequency of the Timer0 clock by a factor
-   * of 64.
-   *
-   * IMPORTANT: when changing this timer0 clock speed, it changes the number
-   * of timer0 overflows which occur each microsecond.  This, in turn, changes
-   * the behavior of micros(), millis(), delay(), etc timing functions.  To
-   * correct for this, values returned by micros() or millis() need to be
-   * divided by 64.  When using delay(), multiply the time by 64.
-   * */
-  TCCR0A = _BV ( COM0A1 ) |
-    _BV ( COM0B1 ) |
-    _BV ( WGM01 ) |
-    _BV ( WGM00 );       // set pins 5 and 6 as PWM controlled by timer0
-  TCCR0B = _BV ( CS00 ); // set timer0 frequency for 62500 Hz PWM on pins 5 & 6
-
-  /* Attach interrupts to hall sensor input pins (both rising/falling edges) */
-  attachInterrupt ( digitalPinToInterrupt ( HALL1PIN ), hall1ISR, CHANGE );
-  attachInterrupt ( digitalPinToInterrupt ( HALL2PIN ), hall2ISR, CHANGE );
+  /* Configure PWM pins and start with 0% duty.  This takes over timer0, so
+   * micros(), millis() and delay() stop working from here on; use the
+   * timeBase functions instead. */
+  pwmOutInit ( );
+
+  /* Start the timer1 loop tick, which paces the main loop */
+  sysTimerInit ( );
+
+  /* Start timestamping hall sensor edges (both rising/falling edges) */
+  hallInit ( );
+
+  /* Start sampling the temperature sensors in the background */
+  adcSamplerInit ( );
+
+  /* Find the 1-Wire temperature sensors (blocks for a few ms per sensor) */
+  dsTempInit ( );
 
   /* Clear LCD screen and set to display default info screen */
   lcd.clear ( );                    // clear LCD screen and move cursor to start
@@ -193,7 +333,8 @@ static FANCTRLSTATE_ENUM_TYPE initState ( FANCTRLSTATE_ENUM_TYPE thisState )
 *   normalState()
 *
 * Description:
-*   Runs the NORMAL state routine
+*   Runs the NORMAL state routine.  On entry, the speed controllers take
+*   the duties back over from the state before without a bump.
 *
 * Arguments:
 *   none
@@ -203,69 +344,70 @@ static FANCTRLSTATE_ENUM_TYPE initState ( FANCTRLSTATE_ENUM_TYPE thisState )
 ******************************************************************************/
 static FANCTRLSTATE_ENUM_TYPE normalState ( FANCTRLSTATE_ENUM_TYPE thisState )
 {
-  FANCTRLSTATE_ENUM_TYPE nextState = NORMAL;            // by default, stay in normal state
-  char                   lcdBuff [ LCDCOLS * LCDROWS ]; // buffer of chars used for LCD printing
+  FANCTRLSTATE_ENUM_TYPE nextState = NORMAL; // by default, stay in normal state
 
   /* If this is the first time entering this state, send message */
   if ( stateChange )
   {
     Serial.print ( "ENTERING NORMAL STATE\n" ); // write initializing message on serial
+    fans.takeOver ( );                          // carry on from the duties set before, without a bump
   }
 
-  /* Update LCD if needed */
-  if ( ++lcdLoops >= LCD_DEC || stateChange ) // if enough loops have occured or if this is first instance of NORMAL state, update LCD
-  {
-    lcdLoops = 0;                   // reset LCD loop counter
-    lcd.begin ( LCDCOLS, LCDROWS ); // initialize LCD display (16 cols, 2 rows)
-    lcd.noAutoscroll ( );
-    lcd.home ( );
+  /* Set desired fan speeds based on temperature, then limit their slew rates and skip resonances */
+  fans.setRefSpeeds ( );
+  fans.shapeRefSpeeds ( );
 
-    /* Mark Temperature on first line of LCD display */
-    if ( useFtemp )
-    {
-      sprintf ( lcdBuff, " %cF: %3hu.%hu %3hu.%hu",
-        0xDF,
-        DigTemp1ToF10 ( Temp1 ) / 10,
-        abs ( DigTemp1ToF10 ( Temp1 ) ) % 10,
-        DigTemp2ToF10 ( Temp2 ) / 10,
-        abs ( DigTemp2ToF10 ( Temp2 ) ) % 10 ); // set temperatures as first line
-    }
-    else
-    {
-      sprintf ( lcdBuff, " %cC: %3hu.%hu %3hu.%hu",
-        0xDF,
-        DigTemp1ToC10 ( Temp1 ) / 10,
-        abs ( DigTemp1ToC10 ( Temp1 ) ) % 10,
-        DigTemp2ToC10 ( Temp2 ) / 10,
-        abs ( DigTemp2ToC10 ( Temp2 ) ) % 10 ); // set temperatures as first line
-    }
-    lcd.setCursor ( 0, 0 ); // set cursor to start of first line on LCD
-    lcd.print ( lcdBuff );  // print first line
+  /* Regulate Fan Speeds to Track Reference Values */
+  fans.regSpeeds ( );
 
-    /* Mark hall-sensor period values on second line of LCD display */
-    sprintf ( lcdBuff, "RPM:  %4hu  %4hu", Fan1RPM, Fan2RPM ); // set fan speeds
-    lcd.setCursor ( 0, 1 );                                    // set cursor to start of second line on LCD
-    lcd.print ( lcdBuff );                                     // print second line
+  /* Go to fault state if a fan has stalled and can't be restarted */
+  if ( fans.stallFault ( ) )
+    nextState = FAULT;
 
-  }
+  return nextState;
+} // end of normalState()
 
-  /* Set desired fan speeds based on temperature */
-  setRefFanSpeeds ( );
+/******************************************************************************
+* Function:
+*   normalDisplay()
+*
+* Description:
+*   Updates the LCD screen for the NORMAL state.  The LCD is set up once in
+*   initState(), so this only moves the cursor and prints (a few ms), and
+*   never blocks the control loop for a full re-initialization.
+*
+* Arguments:
+*   none
+*
+* Returns:
+*   none
+******************************************************************************/
+static void normalDisplay ( void )
+{
+  char lcdBuff [ LCDCOLS * LCDROWS ]; // buffer of chars used for LCD printing
 
-  /* Regulate Fan Speeds to Track Reference Values */
-  regFanSpeeds ( );
+  /* Mark Temperature on first line of LCD display */
+  printTempLine ( lcdBuff, ' ', Temp1, Temp2 ); // set temperatures as first line
+  lcd.setCursor ( 0, 0 );                       // set cursor to start of first line on LCD
+  lcd.print ( lcdBuff );                        // print first line
 
-  return nextState;
-} // end of normalState()
+  /* Mark hall-sensor period values on second line of LCD display */
+  sprintf ( lcdBuff, "RPM:  %4hu  %4hu", fans.rpm [ 0 ], fans.rpm [ 1 ] ); // set fan speeds
+  lcd.setCursor ( 0, 1 );                                                  // set cursor to start of second line on LCD
+  lcd.print ( lcdBuff );                                                   // print second line
 
+  return;
+} // end of normalDisplay()
 
 
 /******************************************************************************
 * Function:
-*   debugPi1State()
+*   faultState()
 *
 * Description:
-*   Runs the DEBUG_PI1 state routine
+*   Runs the FAULT state routine.  Control carries on as in the NORMAL state,
+*   so the fan which is still working keeps regulating, and the stall monitor
+*   keeps retrying the faulted fan.  Returns to NORMAL once no fan is faulted.
 *
 * Arguments:
 *   none
@@ -273,91 +415,74 @@ static FANCTRLSTATE_ENUM_TYPE normalState ( FANCTRLSTATE_ENUM_TYPE thisState )
 * Returns:
 *   nextState - state to enter upon exiting this function
 ******************************************************************************/
-static FANCTRLSTATE_ENUM_TYPE debugPi1State ( FANCTRLSTATE_ENUM_TYPE thisState )
+static FANCTRLSTATE_ENUM_TYPE faultState ( FANCTRLSTATE_ENUM_TYPE thisState )
 {
-  char lcdBuff [ LCDCOLS * LCDROWS ]; // buffer of chars used for LCD printing
+  FANCTRLSTATE_ENUM_TYPE nextState = FAULT; // by default, stay in fault state
 
   /* If this is the first time entering this state, send message */
   if ( stateChange )
   {
-    Serial.print ( "ENTERING DEBUG PI1 STATE\n" ); // write initializing message on serial
+    Serial.print ( "ENTERING FAULT STATE\n" ); // write fault message on serial
   }
 
-  /* Update LCD if needed */
-  if ( ++lcdLoops >= LCD_DEC || stateChange ) // if enough loops have occured or if this is first instance of NORMAL state, update LCD
-  {
-    lcdLoops = 0; // reset LCD loop counter
-
-    /* First line has Int Term (quarter counts), Int State (tenths of error count times seconds), output duty (counts) */
-    sprintf ( lcdBuff, "%5d %6d %3u", pi1.getIntTerm ( ), pi1.getIntState ( ), Pwm1Duty ); // set fan info
-    lcd.setCursor ( 0, 0 );                                                                // set cursor to start of first line on LCD
-    lcd.print ( lcdBuff );                                                                 // print first line
+  /* Set desired fan speeds based on temperature, then limit their slew rates and skip resonances */
+  fans.setRefSpeeds ( );
+  fans.shapeRefSpeeds ( );
 
-    /* Second line has Prop Term (quarter counts), Error (rpm), speed feedback (rpm) */
-    sprintf ( lcdBuff, "%5d %5d %4u", pi1.getPropTerm ( ), (int) Fan1RPMRef - Fan1RPM, Fan1RPM ); // set fan info
-    lcd.setCursor ( 0, 1 );                                                                       // set cursor to start of second line on LCD
-    lcd.print ( lcdBuff );
+  /* Regulate Fan Speeds to Track Reference Values */
+  fans.regSpeeds ( );
 
-  }
+  /* Go back to normal state once the faulted fan turns again (or is turned off) */
+  if ( !fans.stallFault ( ) )
+    nextState = NORMAL;
 
-  /* Set desired fan speeds based on temperature */
-  setRefFanSpeeds ( );
+  return nextState;
+} // end of faultState()
 
-  /* Replace Fan1 reference speed with first data word */
-  Fan1RPMRef = *(unsigned int *) ( debugDatWords + 0 );
+/******************************************************************************
+* Function:
+*   faultDisplay()
+*
+* Description:
+*   Updates the LCD screen for the FAULT state, with a line of fault counters
+*   for each fan: stalls, kicks and hall glitches (each shown modulo 1000).
+*   A '!' after the fan number marks the faulted fan.
+*
+* Arguments:
+*   none
+*
+* Returns:
+*   none
+******************************************************************************/
+static void faultDisplay ( void )
+{
+  char lcdBuff [ LCDCOLS * LCDROWS ]; // buffer of chars used for LCD printing
+  byte chan;                          // fan channel
 
-  /* Update PI1 gains with those specified in message (if different) */
-  if ( pi1Kp != debugDatWords [ 1 ] ) // second word is Kp
-  {
-    pi1Kp = debugDatWords [ 1 ];
-    saveVar ( &pi1Kp );
-  }
-  if ( pi1Ki != debugDatWords [ 2 ] ) // third word is Ki
-  {
-    pi1Ki = debugDatWords [ 2 ];
-    saveVar ( &pi1Ki );
-  }
-  if ( pi1Imax != debugDatWords [ 3 ] ) // fourth word is Imax
-  {
-    pi1Imax = debugDatWords [ 3 ];
-    saveVar ( &pi1Imax );
-  }
-  if ( pi1Imin != debugDatWords [ 4 ] ) // fifth word is Imin
-  {
-    pi1Imin = debugDatWords [ 4 ];
-    saveVar ( &pi1Imin );
-  }
-  if ( fan1Filt != *(unsigned int *) ( debugDatWords + 5 ) ) // sixth word is Filt gain
-  {
-    fan1Filt = *(unsigned int *) ( debugDatWords + 5 );
-    saveVar ( &fan1Filt );
-  }
-  if ( minRpm1 != *(unsigned int *) ( debugDatWords + 6 ) ) // seventh word is min rpm setting
-  {
-    minRpm1 = *(unsigned int *) ( debugDatWords + 6 );
-    saveVar ( &minRpm1 );
-  }
-  if ( maxRpm1 != *(unsigned int *) ( debugDatWords + 7 ) ) // eighth word is max rpm setting
+  /* Each line has the fault counters of one fan */
+  for ( chan = 0; chan < NUM_FANS; chan++ )
   {
-    maxRpm1 = *(unsigned int *) ( debugDatWords + 7 );
-    saveVar ( &maxRpm1 );
+    sprintf ( lcdBuff, "%u%cS%3u K%3u G%3u",
+      chan + 1,
+      fanMonFault ( &fans.mon [ chan ] ) ? '!' : ' ',
+      fans.mon [ chan ].stalls % 1000,
+      fans.mon [ chan ].kickCnt % 1000,
+      fans.mon [ chan ].glitches % 1000 ); // set fan fault info
+    lcd.setCursor ( 0, chan );             // set cursor to start of this fan's line on LCD
+    lcd.print ( lcdBuff );                 // print line
   }
 
-
-  /* Regulate Fan Speeds to Track Reference Values */
-  regFanSpeeds ( );
-  Pwm2Duty = 0; // set output to zero
-
-  return thisState; // remain in same state
-}                   // end of debugPi1State()
+  return;
+} // end of faultDisplay()
 
 
 /******************************************************************************
 * Function:
-*   debugPi2State()
+*   debugPiState()
 *
 * Description:
-*   Runs the DEBUG_PI2 state routine
+*   Runs the DEBUG_PI state routine, for the fan given by debugChan.  The
+*   other fans are turned off.
 *
 * Arguments:
 *   none
@@ -365,82 +490,95 @@ static FANCTRLSTATE_ENUM_TYPE debugPi1State ( FANCTRLSTATE_ENUM_TYPE thisState )
 * Returns:
 *   nextState - state to enter upon exiting this function
 ******************************************************************************/
-static FANCTRLSTATE_ENUM_TYPE debugPi2State ( FANCTRLSTATE_ENUM_TYPE thisState )
+static FANCTRLSTATE_ENUM_TYPE debugPiState ( FANCTRLSTATE_ENUM_TYPE thisState )
 {
-  char lcdBuff [ LCDCOLS * LCDROWS ]; // buffer of chars used for LCD printing
+  byte chan; // fan channel
 
   /* If this is the first time entering this state, send message */
   if ( stateChange )
   {
-    Serial.print ( "ENTERING DEBUG PI2 STATE\n" ); // write initializing message on serial
+    Serial.print ( "ENTERING DEBUG PI" ); // write initializing message on serial
+    Serial.print ( debugChan + 1 );
+    Serial.print ( " STATE\n" );
   }
 
-  /* Update LCD if needed */
-  if ( ++lcdLoops >= LCD_DEC || stateChange ) // if enough loops have occured or if this is first instance of NORMAL state, update LCD
-  {
-    lcdLoops = 0; // reset LCD loop counter
-
-    /* First line has Int Term (quarter counts), Int State (tenths of error count times seconds), output duty (counts) */
-    sprintf ( lcdBuff, "%5d %6d %3u", pi2.getIntTerm ( ), pi2.getIntState ( ), Pwm2Duty ); // set fan info
-    lcd.setCursor ( 0, 0 );                                                                // set cursor to start of first line on LCD
-    lcd.print ( lcdBuff );                                                                 // print first line
+  /* Set desired fan speeds based on temperature */
+  fans.setRefSpeeds ( );
 
-    /* Second line has Prop Term (quarter counts), Error (rpm), speed feedback (rpm) */
-    sprintf ( lcdBuff, "%5d %5d %4u", pi2.getPropTerm ( ), (int) Fan2RPMRef - Fan2RPM, Fan2RPM ); // set fan info
-    lcd.setCursor ( 0, 1 );                                                                       // set cursor to start of second line on LCD
-    lcd.print ( lcdBuff );
+  /* Replace reference speed of the fan being debugged with first data word */
+  fans.rpmRef [ debugChan ] = *(unsigned int *) ( debugDatWords + 0 );
 
+  /* Regulate Fan Speeds to Track Reference Values */
+  fans.regSpeeds ( );
+  for ( chan = 0; chan < NUM_FANS; chan++ )
+  {
+    if ( chan != debugChan )
+      fans.duty [ chan ] = 0; // set output to zero
   }
 
-  /* Set desired fan speeds based on temperature */
-  setRefFanSpeeds ( );
+  return thisState; // remain in same state
+}                   // end of debugPiState()
+
+/******************************************************************************
+* Function:
+*   debugPiDisplay()
+*
+* Description:
+*   Updates the LCD screen for the DEBUG_PI state
+*
+* Arguments:
+*   none
+*
+* Returns:
+*   none
+******************************************************************************/
+static void debugPiDisplay ( void )
+{
+  char          lcdBuff [ LCDCOLS * LCDROWS ]; // buffer of chars used for LCD printing
+  piController *pi = &fans.pi [ debugChan ];    // PI controller being debugged
 
-  /* Replace Fan2 reference speed with first data word */
-  Fan2RPMRef = *(unsigned int *) ( debugDatWords + 0 );
+  /* First line has Int Term (quarter counts), Int State (tenths of error count times seconds), output duty (counts) */
+  sprintf ( lcdBuff, "%5d %6d %3u", pi->getIntTerm ( ), pi->getIntState ( ), fans.duty [ debugChan ] ); // set fan info
+  lcd.setCursor ( 0, 0 );                                                                               // set cursor to start of first line on LCD
+  lcd.print ( lcdBuff );                                                                                // print first line
 
-  /* Update PI2 gains with those specified in message (if different) */
-  if ( pi2Kp != debugDatWords [ 1 ] ) // second word is Kp
-  {
-    pi2Kp = debugDatWords [ 1 ];
-    saveVar ( &pi2Kp );
-  }
-  if ( pi2Ki != debugDatWords [ 2 ] ) // third word is Ki
-  {
-    pi2Ki = debugDatWords [ 2 ];
-    saveVar ( &pi2Ki );
-  }
-  if ( pi2Imax != debugDatWords [ 3 ] ) // fourth word is Imax
-  {
-    pi2Imax = debugDatWords [ 3 ];
-    saveVar ( &pi2Imax );
-  }
-  if ( pi2Imin != debugDatWords [ 4 ] ) // fifth word is Imin
-  {
-    pi2Imin = debugDatWords [ 4 ];
-    saveVar ( &pi2Imin );
-  }
-  if ( fan2Filt != *(unsigned int *) ( debugDatWords + 5 ) ) // sixth word is Filt gain
-  {
-    fan2Filt = *(unsigned int *) ( debugDatWords + 5 );
-    saveVar ( &fan2Filt );
-  }
-  if ( minRpm2 != *(unsigned int *) ( debugDatWords + 6 ) ) // seventh word is min rpm setting
-  {
-    minRpm2 = *(unsigned int *) ( debugDatWords + 6 );
-    saveVar ( &minRpm2 );
-  }
-  if ( maxRpm2 != *(unsigned int *) ( debugDatWords + 7 ) ) // eighth word is max rpm setting
-  {
-    maxRpm2 = *(unsigned int *) ( debugDatWords + 7 );
-    saveVar ( &maxRpm2 );
-  }
+  /* Second line has Prop Term (quarter counts), Error (rpm), speed feedback (rpm) */
+  sprintf ( lcdBuff, "%5d %5d %4u", pi->getPropTerm ( ), (int) fans.rpmRef [ debugChan ] - fans.rpm [ debugChan ], fans.rpm [ debugChan ] ); // set fan info
+  lcd.setCursor ( 0, 1 );                                                                                                                   // set cursor to start of second line on LCD
+  lcd.print ( lcdBuff );
 
-  /* Regulate Fan Speeds to Track Reference Values */
-  regFanSpeeds ( );
-  Pwm1Duty = 0; // set output to zero
+  return;
+} // end of debugPiDisplay()
 
-  return thisState; // remain in same state
-}                   // end of debugPi2State()
+/******************************************************************************
+* Function:
+*   debugPiApply()
+*
+* Description:
+*   Applies the data words of a new DEBUG_PI message
+*
+* Arguments:
+*   none
+*
+* Returns:
+*   none
+******************************************************************************/
+static void debugPiApply ( void )
+{
+  /* Update PI gains with those specified in message (if different) */
+  debugApplyWord ( FAN_CFG_S ( debugChan, kp ), 1 );     // second word is Kp
+  debugApplyWord ( FAN_CFG_S ( debugChan, ki ), 2 );     // third word is Ki
+  debugApplyWord ( FAN_CFG_S ( debugChan, imax ), 3 );   // fourth word is Imax
+  debugApplyWord ( FAN_CFG_S ( debugChan, imin ), 4 );   // fifth word is Imin
+  debugApplyWord ( FAN_CFG_U ( debugChan, filt ), 5 );   // sixth word is Filt gain
+  debugApplyWord ( FAN_CFG_U ( debugChan, minRpm ), 6 ); // seventh word is min rpm setting
+  debugApplyWord ( FAN_CFG_U ( debugChan, maxRpm ), 7 ); // eighth word is max rpm setting
+
+  /* Give the new gains to the controller */
+  fans.setGains ( debugChan );
+
+  return;
+} // end of debugPiApply()
 
 
 /******************************************************************************
@@ -458,12 +596,6 @@ static FANCTRLSTATE_ENUM_TYPE debugPi2State ( FANCTRLSTATE_ENUM_TYPE thisState )
 ******************************************************************************/
 static FANCTRLSTATE_ENUM_TYPE debugBtnState ( FANCTRLSTATE_ENUM_TYPE thisState )
 {
-
-  static unsigned int btn1EdgCnt = 0;                // Number of rising edges in button 1 since beginning debug
-  static unsigned int btn2EdgCnt = 0;                // Number of rising edges in button 1 since beginning debug
-  static unsigned int btn3EdgCnt = 0;                // Number of rising edges in button 1 since beginning debug
-  char                lcdBuff [ LCDCOLS * LCDROWS ]; // buffer of chars used for LCD printing
-
   /* If this is the first time entering this state, reset button edge counts */
   if ( stateChange )
   {
@@ -481,29 +613,41 @@ static FANCTRLSTATE_ENUM_TYPE debugBtnState ( FANCTRLSTATE_ENUM_TYPE thisState )
   if ( btn3PressCnt == 1 )
     btn3EdgCnt++;
 
-  /* Update LCD if needed */
-  if ( ++lcdLoops >= LCD_DEC || stateChange ) // if enough loops have occured or if this is first instance of NORMAL state, update LCD
-  {
-    lcdLoops = 0; // reset LCD loop counter
+  /* Turn off fans */
+  fans.allOff ( ); // set outputs to zero
 
-    /* First line has button rising edge counts */
-    sprintf ( lcdBuff, "  %4u %4u %4u", btn1EdgCnt, btn2EdgCnt, btn3EdgCnt ); // set button info
-    lcd.setCursor ( 0, 0 );                                                   // set cursor to start of first line on LCD
-    lcd.print ( lcdBuff );                                                    // print first line
+  return thisState; // remain in same state
+}                   // end of debugBtnState()
 
-    /* Second line has button consecutive counts */
-    sprintf ( lcdBuff, "  %4u %4u %4u", btn1PressCnt, btn2PressCnt, btn3PressCnt ); // set button info
-    lcd.setCursor ( 0, 1 );                                                         // set cursor to start of second line on LCD
-    lcd.print ( lcdBuff );
+/******************************************************************************
+* Function:
+*   debugBtnDisplay()
+*
+* Description:
+*   Updates the LCD screen for the DEBUG_BTN state
+*
+* Arguments:
+*   none
+*
+* Returns:
+*   none
+******************************************************************************/
+static void debugBtnDisplay ( void )
+{
+  char lcdBuff [ LCDCOLS * LCDROWS ]; // buffer of chars used for LCD printing
 
-  }
+  /* First line has button rising edge counts */
+  sprintf ( lcdBuff, "  %4u %4u %4u", btn1EdgCnt, btn2EdgCnt, btn3EdgCnt ); // set button info
+  lcd.setCursor ( 0, 0 );                                                   // set cursor to start of first line on LCD
+  lcd.print ( lcdBuff );                                                    // print first line
 
-  /* Turn off fans */
-  Pwm1Duty = 0; // set output to zero
-  Pwm2Duty = 0; // set output to zero
+  /* Second line has button consecutive counts */
+  sprintf ( lcdBuff, "  %4u %4u %4u", btn1PressCnt, btn2PressCnt, btn3PressCnt ); // set button info
+  lcd.setCursor ( 0, 1 );                                                         // set cursor to start of second line on LCD
+  lcd.print ( lcdBuff );
 
-  return thisState; // remain in same state
-}                   // end of debugBtnState()
+  return;
+} // end of debugBtnDisplay()
 
 
 /******************************************************************************
@@ -521,572 +665,461 @@ static FANCTRLSTATE_ENUM_TYPE debugBtnState ( FANCTRLSTATE_ENUM_TYPE thisState )
 ******************************************************************************/
 static FANCTRLSTATE_ENUM_TYPE debugTmpState ( FANCTRLSTATE_ENUM_TYPE thisState )
 {
-  char lcdBuff [ LCDCOLS * LCDROWS ]; // buffer of chars used for LCD printing
-
-  /* If this is the first time entering this state, reset button edge counts */
+  /* If this is the first time entering this state, send message */
   if ( stateChange )
   {
     Serial.print ( "ENTERING DEBUG TEMP SENSORS STATE\n" ); // write initializing message on serial
   }
 
-  /* Update Temp Sensor Parameters with those specified in message (if different) */
-  if ( useFtemp != *(unsigned int *) ( debugDatWords + 0 ) ) // first word is whether or not to use fahrenheit units
-  {
-    useFtemp = *(unsigned int *) ( debugDatWords + 0 );
-    saveVar ( &useFtemp );
-  }
-  if ( Temp1Offset != debugDatWords [ 1 ] ) // second word is offset for temp sensor 1
-  {
-    Temp1Offset = debugDatWords [ 1 ];
-    saveVar ( &Temp1Offset );
-  }
-  if ( Temp1DegCPer5V != debugDatWords [ 2 ] ) // third word is gain for temp sensor 1
-  {
-    Temp1DegCPer5V = debugDatWords [ 2 ];
-    saveVar ( &Temp1DegCPer5V );
-  }
-  if ( Temp2Offset != debugDatWords [ 3 ] ) // fourth word is offset for temp sensor 2
-  {
-    Temp2Offset = debugDatWords [ 3 ];
-    saveVar ( &Temp2Offset );
-  }
-  if ( Temp2DegCPer5V != debugDatWords [ 4 ] ) // fifth word is gain for temp sensor 2
-  {
-    Temp2DegCPer5V = debugDatWords [ 4 ];
-    saveVar ( &Temp2DegCPer5V );
-  }
-
-  /* Update LCD if needed */
-  if ( ++lcdLoops >= LCD_DEC || stateChange ) // if enough loops have occured or if this is first instance of NORMAL state, update LCD
-  {
-    lcdLoops = 0; // reset LCD loop counter
-
-    /* Mark Temperature on first line of LCD display */
-    if ( useFtemp )
-    {
-      sprintf ( lcdBuff, " %cF: %3hu.%hu %3hu.%hu",
-        0xDF,
-        DigTemp1ToF10 ( Temp1 ) / 10,
-        abs ( DigTemp1ToF10 ( Temp1 ) ) % 10,
-        DigTemp2ToF10 ( Temp2 ) / 10,
-        abs ( DigTemp2ToF10 ( Temp2 ) ) % 10 ); // set temperatures as first line
-    }
-    else
-    {
-      sprintf ( lcdBuff, " %cC: %3hu.%hu %3hu.%hu",
-        0xDF,
-        DigTemp1ToC10 ( Temp1 ) / 10,
-        abs ( DigTemp1ToC10 ( Temp1 ) ) % 10,
-        DigTemp2ToC10 ( Temp2 ) / 10,
-        abs ( DigTemp2ToC10 ( Temp2 ) ) % 10 ); // set temperatures as first line
-    }
-    lcd.setCursor ( 0, 0 ); // set cursor to start of first line on LCD
-    lcd.print ( lcdBuff );  // print first line
-
-    /* Second line has raw temp readings */
-    sprintf ( lcdBuff, "Raw: %5u %5u", Temp1, Temp2 ); // set raw temp info
-    lcd.setCursor ( 0, 1 );                            // set cursor to start of second line on LCD
-    lcd.print ( lcdBuff );
-
-  }
-
   /* Turn off fans */
-  Pwm1Duty = 0; // set output to zero
-  Pwm2Duty = 0; // set output to zero
+  fans.allOff ( ); // set outputs to zero
 
   return thisState; // remain in same state
 }                   // end of debugTmpState()
 
-
 /******************************************************************************
 * Function:
-*   debugFonState()
+*   debugTmpDisplay()
 *
 * Description:
-*   Runs the DEBUG_FON state routine
+*   Updates the LCD screen for the DEBUG_TMP state
 *
 * Arguments:
 *   none
 *
 * Returns:
-*   nextState - state to enter upon exiting this function
+*   none
 ******************************************************************************/
-static FANCTRLSTATE_ENUM_TYPE debugFonState ( FANCTRLSTATE_ENUM_TYPE thisState )
+static void debugTmpDisplay ( void )
 {
-  char                lcdBuff [ LCDCOLS * LCDROWS ]; // buffer of chars used for LCD printing
-  static unsigned int dispCnt  = 0;                  // count of how many times displayed the same message.  Will swap between displaying fan1 and fan2 info as count increases.
-  static byte         dispFan2 = 0;                  // display fan 2 when high.  otherwise, display fan 1.
+  char lcdBuff [ LCDCOLS * LCDROWS ]; // buffer of chars used for LCD printing
 
-  /* If this is the first time entering this state, reset button edge counts */
-  if ( stateChange )
-  {
-    Serial.print ( "ENTERING DEBUG FAN ON/OFF SETTINGS STATE\n" ); // write initializing message on serial
-  }
+  /* Mark Temperature on first line of LCD display */
+  printTempLine ( lcdBuff, ' ', Temp1, Temp2 ); // set temperatures as first line
+  lcd.setCursor ( 0, 0 );                       // set cursor to start of first line on LCD
+  lcd.print ( lcdBuff );                        // print first line
 
-  /* Update Fan on/off control Parameters with those specified in message (if different) */
-  if ( tmpsrc1 != *(unsigned int *) ( debugDatWords + 0 ) ) // first word gives setting of which temp sensor is used for fan 1 control
-  {
-    tmpsrc1 = *(unsigned int *) ( debugDatWords + 0 );
-    saveVar ( &tmpsrc1 );
-  }
-  if ( fan1TurnOffTmp != *(unsigned int *) ( debugDatWords + 1 ) ) // second word gives fan 1 turnoff temp
-  {
-    fan1TurnOffTmp = *(unsigned int *) ( debugDatWords + 1 );
-    saveVar ( &fan1TurnOffTmp );
-  }
-  if ( fan1TurnOnTmp != *(unsigned int *) ( debugDatWords + 2 ) ) // third word gives fan 1 turnon temp
-  {
-    fan1TurnOnTmp = *(unsigned int *) ( debugDatWords + 2 );
-    saveVar ( &fan1TurnOnTmp );
-  }
-  if ( minRpm1 != *(unsigned int *) ( debugDatWords + 3 ) ) // fourth word gives fan 1 min speed (turn-on speed)
-  {
-    minRpm1 = *(unsigned int *) ( debugDatWords + 3 );
-    saveVar ( &minRpm1 );
-  }
-  if ( tmpsrc2 != *(unsigned int *) ( debugDatWords + 4 ) ) // fifth word gives setting of which temp sensor is used for fan 2 control
-  {
-    tmpsrc2 = *(unsigned int *) ( debugDatWords + 4 );
-    saveVar ( &tmpsrc2 );
-  }
-  if ( fan2TurnOffTmp != *(unsigned int *) ( debugDatWords + 5 ) ) // sixth word gives fan 2 turnoff temp
-  {
-    fan2TurnOffTmp = *(unsigned int *) ( debugDatWords + 5 );
-    saveVar ( &fan2TurnOffTmp );
-  }
-  if ( fan2TurnOnTmp != *(unsigned int *) ( debugDatWords + 6 ) ) // seventh word gives fan 2 turnon temp
-  {
-    fan2TurnOnTmp = *(unsigned int *) ( debugDatWords + 6 );
-    saveVar ( &fan2TurnOnTmp );
-  }
-  if ( minRpm2 != *(unsigned int *) ( debugDatWords + 7 ) ) // eighth word gives fan 2 min speed (turn-on speed)
-  {
-    minRpm2 = *(unsigned int *) ( debugDatWords + 7 );
-    saveVar ( &minRpm2 );
-  }
-
-  /* Update LCD if needed */
-  if ( ++lcdLoops >= LCD_DEC || stateChange ) // if enough loops have occured or if this is first instance of NORMAL state, update LCD
-  {
-    lcdLoops = 0; // reset LCD loop counter
+  /* Second line has raw temp readings */
+  sprintf ( lcdBuff, "Raw: %5u %5u", Temp1, Temp2 ); // set raw temp info
+  lcd.setCursor ( 0, 1 );                            // set cursor to start of second line on LCD
+  lcd.print ( lcdBuff );
 
-    if ( ++dispCnt > DEBUG_DISPSWITCH )
-    {
-      dispCnt   = 0; // reset display count
-      dispFan2 ^= 1; // toggle fan display
-    }
-
-    if ( dispFan2 ) // display fan 2 data
-    {
-      /* Mark Temperature on first line of LCD display */
-      if ( useFtemp )
-      {
-        sprintf ( lcdBuff, "2%cF: %3hu.%hu %3hu.%hu",
-          0xDF,
-          DigTemp1ToF10 ( fan2TurnOffTmp ) / 10,
-          abs ( DigTemp1ToF10 ( fan2TurnOffTmp ) ) % 10,
-          DigTemp2ToF10 ( fan2TurnOnTmp ) / 10,
-          abs ( DigTemp2ToF10 ( fan2TurnOnTmp ) ) % 10 ); // set temperatures as first line
-      }
-      else
-      {
-        sprintf ( lcdBuff, "2%cC: %3hu.%hu %3hu.%hu",
-          0xDF,
-          DigTemp1ToC10 ( fan2TurnOffTmp ) / 10,
-          abs ( DigTemp1ToC10 ( fan2TurnOffTmp ) ) % 10,
-          DigTemp2ToC10 ( fan2TurnOnTmp ) / 10,
-          abs ( DigTemp2ToC10 ( fan2TurnOnTmp ) ) % 10 ); // set temperatures as first line
-      }
-      lcd.setCursor ( 0, 0 ); // set cursor to start of first line on LCD
-      lcd.print ( lcdBuff );  // print first line
-
-      /* Second line has temp source and min speed */
-      switch ( tmpsrc2 )
-      {
-      case TMPSRC_TMP1:                                 // temp sensor 1
-        sprintf ( lcdBuff, "2: TEMP1   %5u", minRpm2 ); /// set control info
-        break;
-
-      case TMPSRC_TMP2:                                 // temp sensor 2
-        sprintf ( lcdBuff, "2: TEMP2   %5u", minRpm2 ); // set control info
-        break;
-
-      case TMPSRC_MAX:                                  // Max Temp
-        sprintf ( lcdBuff, "2: MAX     %5u", minRpm2 ); // set control info
-        break;
-
-      case TMPSRC_MEAN:                                 // Mean Temp
-        sprintf ( lcdBuff, "2: MEAN    %5u", minRpm2 ); // set control info
-        break;
-
-      default:                                          // invalid selection
-        tmpsrc2 = TMPSRC_DEF;                           // set default (should be valid!)
-        saveVar ( &tmpsrc2 );                           // save default
-        sprintf ( lcdBuff, "2: MAX     %5u", minRpm2 ); // set control info
-      }
-      lcd.setCursor ( 0, 1 ); // set cursor to start of second line on LCD
-      lcd.print ( lcdBuff );
+  return;
+} // end of debugTmpDisplay()
 
-    }
-    else // display fan 1 data
-    {
-      /* Mark Temperature on first line of LCD display */
-      if ( useFtemp )
-      {
-        sprintf ( lcdBuff, "1%cF: %3hu.%hu %3hu.%hu",
-          0xDF,
-          DigTemp1ToF10 ( fan1TurnOffTmp ) / 10,
-          abs ( DigTemp1ToF10 ( fan1TurnOffTmp ) ) % 10,
-          DigTemp2ToF10 ( fan1TurnOnTmp ) / 10,
-          abs ( DigTemp2ToF10 ( fan1TurnOnTmp ) ) % 10 ); // set temperatures as first line
-      }
-      else
-      {
-        sprintf ( lcdBuff, "1%cC: %3hu.%hu %3hu.%hu",
-          0xDF,
-          DigTemp1ToC10 ( fan1TurnOffTmp ) / 10,
-          abs ( DigTemp1ToC10 ( fan1TurnOffTmp ) ) % 10,
-          DigTemp2ToC10 ( fan1TurnOnTmp ) / 10,
-          abs ( DigTemp2ToC10 ( fan1TurnOnTmp ) ) % 10 ); // set temperatures as first line
-      }
-      lcd.setCursor ( 0, 0 ); // set cursor to start of first line on LCD
-      lcd.print ( lcdBuff );  // print first line
+/******************************************************************************
+* Function:
+*   debugTmpApply()
+*
+* Description:
+*   Applies the data words of a new DEBUG_TMP message
+*
+* Arguments:
+*   none
+*
+* Returns:
+*   none
+******************************************************************************/
+static void debugTmpApply ( void )
+{
+  /* Update Temp Sensor Parameters with those specified in message (if different) */
+  debugApplyWord ( &useFtemp, 0 );       // first word is whether or not to use fahrenheit units
+  debugApplyWord ( &Temp1Offset, 1 );    // second word is offset for temp sensor 1
+  debugApplyWord ( &Temp1DegCPer5V, 2 ); // third word is gain for temp sensor 1
+  debugApplyWord ( &Temp2Offset, 3 );    // fourth word is offset for temp sensor 2
+  debugApplyWord ( &Temp2DegCPer5V, 4 ); // fifth word is gain for temp sensor 2
 
-      /* Second line has temp source and min speed */
-      switch ( tmpsrc1 )
-      {
-      case TMPSRC_TMP1:                                 // temp sensor 1
-        sprintf ( lcdBuff, "1: TEMP1   %5u", minRpm1 ); /// set control info
-        break;
-
-      case TMPSRC_TMP2:                                 // temp sensor 2
-        sprintf ( lcdBuff, "1: TEMP2   %5u", minRpm1 ); // set control info
-        break;
-
-      case TMPSRC_MAX:                                  // Max Temp
-        sprintf ( lcdBuff, "1: MAX     %5u", minRpm1 ); // set control info
-        break;
-
-      case TMPSRC_MEAN:                                 // Mean Temp
-        sprintf ( lcdBuff, "1: MEAN    %5u", minRpm1 ); // set control info
-        break;
-
-      default:                                          // invalid selection
-        tmpsrc1 = TMPSRC_DEF;                           // set default (should be valid!)
-        saveVar ( &tmpsrc1 );                           // save default
-        sprintf ( lcdBuff, "1: MAX     %5u", minRpm1 ); // set control info
-      }
-      lcd.setCursor ( 0, 1 ); // set cursor to start of second line on LCD
-      lcd.print ( lcdBuff );
+  return;
+} // end of debugTmpApply()
 
-    }
 
+/******************************************************************************
+* Function:
+*   debugFonState()
+*
+* Description:
+*   Runs the DEBUG_FON state routine
+*
+* Arguments:
+*   none
+*
+* Returns:
+*   nextState - state to enter upon exiting this function
+******************************************************************************/
+static FANCTRLSTATE_ENUM_TYPE debugFonState ( FANCTRLSTATE_ENUM_TYPE thisState )
+{
+  /* If this is the first time entering this state, send message */
+  if ( stateChange )
+  {
+    Serial.print ( "ENTERING DEBUG FAN ON/OFF SETTINGS STATE\n" ); // write initializing message on serial
   }
 
   /* Turn off fans */
-  Pwm1Duty = 0; // set output to zero
-  Pwm2Duty = 0; // set output to zero
+  fans.allOff ( ); // set outputs to zero
 
   return thisState; // remain in same state
 }                   // end of debugFonState()
 
-
 /******************************************************************************
 * Function:
-*   debugTb1State()
+*   debugFonDisplay()
 *
 * Description:
-*   Runs the DEBUG_TB1 state routine
+*   Updates the LCD screen for the DEBUG_FON state
 *
 * Arguments:
 *   none
 *
 * Returns:
-*   nextState - state to enter upon exiting this function
+*   none
 ******************************************************************************/
-static FANCTRLSTATE_ENUM_TYPE debugTb1State ( FANCTRLSTATE_ENUM_TYPE thisState )
+static void debugFonDisplay ( void )
 {
   char                lcdBuff [ LCDCOLS * LCDROWS ]; // buffer of chars used for LCD printing
-  static unsigned int dispCnt     = 0;               // count of how many times displayed the same message.  Will swap between displaying fan1 and fan2 info as count increases.
-  static byte         dispSecHalf = 0;               // display second half of table when high.  otherwise, display first half of table.
+  static unsigned int dispCnt  = 0;                  // count of how many times displayed the same message.  Will move on to the next fan as count increases.
+  static byte         dispChan = 0;                  // fan channel being displayed
+  unsigned int        turnOffTmp;                    // turn-off temperature of the fan displayed
+  unsigned int        turnOnTmp;                     // turn-on temperature of the fan displayed
+  const char         *srcName;                       // name of the temperature source of the fan displayed
 
-  /* If this is the first time entering this state, reset button edge counts */
-  if ( stateChange )
+  if ( ++dispCnt > DEBUG_DISPSWITCH )
   {
-    Serial.print ( "ENTERING DEBUG LOOKUP TABLE 1 STATE\n" ); // write initializing message on serial
+    dispCnt = 0;                   // reset display count
+    if ( ++dispChan >= NUM_FANS ) // move on to next fan
+      dispChan = 0;
   }
+  turnOffTmp = *FAN_CFG_U ( dispChan, turnOffTmp );
+  turnOnTmp  = *FAN_CFG_U ( dispChan, turnOnTmp );
 
-  /* Update Fan Lookup Table 1 Parameters with those specified in message (if different) */
-  if ( fan1TblTmp1 != *(unsigned int *) ( debugDatWords + 0 ) ) // first word gives first temp value in table
-  {
-    fan1TblTmp1 = *(unsigned int *) ( debugDatWords + 0 );
-    saveVar ( &fan1TblTmp1 );
-  }
-  if ( fan1TblTmp2 != *(unsigned int *) ( debugDatWords + 1 ) ) // second word gives second temp value in table
-  {
-    fan1TblTmp2 = *(unsigned int *) ( debugDatWords + 1 );
-    saveVar ( &fan1TblTmp2 );
-  }
-  if ( fan1TblTmp3 != *(unsigned int *) ( debugDatWords + 2 ) ) // third word gives third temp value in table
-  {
-    fan1TblTmp3 = *(unsigned int *) ( debugDatWords + 2 );
-    saveVar ( &fan1TblTmp3 );
-  }
-  if ( fan1TblTmp4 != *(unsigned int *) ( debugDatWords + 3 ) ) // fourth word gives fourth temp value in table
-  {
-    fan1TblTmp4 = *(unsigned int *) ( debugDatWords + 3 );
-    saveVar ( &fan1TblTmp4 );
-  }
-  if ( fan1TblSpd1 != *(unsigned int *) ( debugDatWords + 4 ) ) // fifth word gives first speed value in table
-  {
-    fan1TblSpd1 = *(unsigned int *) ( debugDatWords + 4 );
-    saveVar ( &fan1TblSpd1 );
-  }
-  if ( fan1TblSpd2 != *(unsigned int *) ( debugDatWords + 5 ) ) // sixth word gives second speed value in table
-  {
-    fan1TblSpd2 = *(unsigned int *) ( debugDatWords + 5 );
-    saveVar ( &fan1TblSpd2 );
-  }
-  if ( fan1TblSpd3 != *(unsigned int *) ( debugDatWords + 6 ) ) // seventh word gives third speed value in table
-  {
-    fan1TblSpd3 = *(unsigned int *) ( debugDatWords + 6 );
-    saveVar ( &fan1TblSpd3 );
-  }
-  if ( fan1TblSpd4 != *(unsigned int *) ( debugDatWords + 7 ) ) // eighth word gives fourth speed value in table
-  {
-    fan1TblSpd4 = *(unsigned int *) ( debugDatWords + 7 );
-    saveVar ( &fan1TblSpd4 );
-  }
+  /* Mark Temperature on first line of LCD display */
+  printTempLine ( lcdBuff, '1' + dispChan, turnOffTmp, turnOnTmp ); // set temperatures as first line
+  lcd.setCursor ( 0, 0 );                                           // set cursor to start of first line on LCD
+  lcd.print ( lcdBuff );                                            // print first line
 
-  /* Update LCD if needed */
-  if ( ++lcdLoops >= LCD_DEC || stateChange ) // if enough loops have occured or if this is first instance of NORMAL state, update LCD
+  /* Second line has temp source and min speed */
+  switch ( *FAN_CFG_U ( dispChan, tmpsrc ) )
   {
-    lcdLoops = 0; // reset LCD loop counter
+  case TMPSRC_TMP1:    // temp sensor 1
+    srcName = "TEMP1"; // set source name
+    break;
 
-    if ( ++dispCnt > DEBUG_DISPSWITCH )
-    {
-      dispCnt      = 0; // reset display count
-      dispSecHalf ^= 1; // toggle fan display
-    }
+  case TMPSRC_TMP2:    // temp sensor 2
+    srcName = "TEMP2"; // set source name
+    break;
 
-    if ( dispSecHalf ) // display second half of table
-    {
-      /* Mark Temperature on first line of LCD display */
-      if ( useFtemp )
-      {
-        sprintf ( lcdBuff, " %cF: %3hu.%hu %3hu.%hu",
-          0xDF,
-          DigTemp1ToF10 ( fan1TblTmp3 ) / 10,
-          abs ( DigTemp1ToF10 ( fan1TblTmp3 ) ) % 10,
-          DigTemp2ToF10 ( fan1TblTmp4 ) / 10,
-          abs ( DigTemp2ToF10 ( fan1TblTmp4 ) ) % 10 ); // set temperatures as first line
-      }
-      else
-      {
-        sprintf ( lcdBuff, " %cC: %3hu.%hu %3hu.%hu",
-          0xDF,
-          DigTemp1ToC10 ( fan1TblTmp3 ) / 10,
-          abs ( DigTemp1ToC10 ( fan1TblTmp3 ) ) % 10,
-          DigTemp2ToC10 ( fan1TblTmp4 ) / 10,
-          abs ( DigTemp2ToC10 ( fan1TblTmp4 ) ) % 10 ); // set temperatures as first line
-      }
-      lcd.setCursor ( 0, 0 ); // set cursor to start of first line on LCD
-      lcd.print ( lcdBuff );  // print first line
+  case TMPSRC_MEAN:   // Mean Temp
+    srcName = "MEAN"; // set source name
+    break;
 
-      /* Mark hall-sensor period values on second line of LCD display */
-      sprintf ( lcdBuff, "RPM:  %4hu  %4hu", fan1TblSpd3, fan1TblSpd4 ); // set fan speeds
-      lcd.setCursor ( 0, 1 );                                            // set cursor to start of second line on LCD
-      lcd.print ( lcdBuff );                                             // print second line
+  case TMPSRC_OW1:   // 1-Wire sensor 1
+    srcName = "OW1"; // set source name
+    break;
 
-    }
-    else // display first half of table
-    {
-      /* Mark Temperature on first line of LCD display */
-      if ( useFtemp )
-      {
-        sprintf ( lcdBuff, " %cF: %3hu.%hu %3hu.%hu",
-          0xDF,
-          DigTemp1ToF10 ( fan1TblTmp1 ) / 10,
-          abs ( DigTemp1ToF10 ( fan1TblTmp1 ) ) % 10,
-          DigTemp2ToF10 ( fan1TblTmp2 ) / 10,
-          abs ( DigTemp2ToF10 ( fan1TblTmp2 ) ) % 10 ); // set temperatures as first line
-      }
-      else
-      {
-        sprintf ( lcdBuff, " %cC: %3hu.%hu %3hu.%hu",
-          0xDF,
-          DigTemp1ToC10 ( fan1TblTmp1 ) / 10,
-          abs ( DigTemp1ToC10 ( fan1TblTmp1 ) ) % 10,
-          DigTemp2ToC10 ( fan1TblTmp2 ) / 10,
-          abs ( DigTemp2ToC10 ( fan1TblTmp2 ) ) % 10 ); // set temperatures as first line
-      }
-      lcd.setCursor ( 0, 0 ); // set cursor to start of first line on LCD
-      lcd.print ( lcdBuff );  // print first line
+  case TMPSRC_OW2:   // 1-Wire sensor 2
+    srcName = "OW2"; // set source name
+    break;
+
+  case TMPSRC_FUSE:   // fusion of all sensors
+    srcName = "FUSE"; // set source name
+    break;
+
+  default:           // Max Temp, or invalid selection
+    srcName = "MAX"; // set source name
+  }
+  sprintf ( lcdBuff, "%u: %-5s   %5u", dispChan + 1, srcName, *FAN_CFG_U ( dispChan, minRpm ) ); // set control info
+  lcd.setCursor ( 0, 1 );                                                                          // set cursor to start of second line on LCD
+  lcd.print ( lcdBuff );
 
-      /* Mark hall-sensor period values on second line of LCD display */
-      sprintf ( lcdBuff, "RPM:  %4hu  %4hu", fan1TblSpd1, fan1TblSpd2 ); // set fan speeds
-      lcd.setCursor ( 0, 1 );                                            // set cursor to start of second line on LCD
-      lcd.print ( lcdBuff );                                             // print second line
+  return;
+} // end of debugFonDisplay()
 
+/******************************************************************************
+* Function:
+*   debugFonApply()
+*
+* Description:
+*   Applies the data words of a new DEBUG_FON message.  Each fan has four
+*   words, fan 1 first.
+*
+* Arguments:
+*   none
+*
+* Returns:
+*   none
+******************************************************************************/
+static void debugFonApply ( void )
+{
+  byte          chan;   // fan channel
+  byte          word;   // first data word of this fan
+  unsigned int *tmpsrc; // temperature source selection of this fan
+
+  for ( chan = 0; chan < NUM_FANS; chan++ )
+  {
+    /* Update Fan on/off control Parameters with those specified in message (if different) */
+    word   = chan * 4;
+    tmpsrc = FAN_CFG_U ( chan, tmpsrc );
+    debugApplyWord ( tmpsrc, word + 0 );                         // first word gives setting of which temp sensor is used for fan control
+    debugApplyWord ( FAN_CFG_U ( chan, turnOffTmp ), word + 1 ); // second word gives fan turnoff temp
+    debugApplyWord ( FAN_CFG_U ( chan, turnOnTmp ), word + 2 );  // third word gives fan turnon temp
+    debugApplyWord ( FAN_CFG_U ( chan, minRpm ), word + 3 );     // fourth word gives fan min speed (turn-on speed)
+
+    /* Make sure temperature source is valid */
+    if ( *tmpsrc > TMPSRC_LAST ) // invalid selection
+    {
+      *tmpsrc = TMPSRC_DEF; // set default (should be valid!)
+      saveVar ( tmpsrc );   // save default
     }
+  }
 
+  return;
+} // end of debugFonApply()
+
+
+/******************************************************************************
+* Function:
+*   debugTbState()
+*
+* Description:
+*   Runs the DEBUG_TB state routine, for the fan given by debugChan
+*
+* Arguments:
+*   none
+*
+* Returns:
+*   nextState - state to enter upon exiting this function
+******************************************************************************/
+static FANCTRLSTATE_ENUM_TYPE debugTbState ( FANCTRLSTATE_ENUM_TYPE thisState )
+{
+  /* If this is the first time entering this state, send message */
+  if ( stateChange )
+  {
+    Serial.print ( "ENTERING DEBUG LOOKUP TABLE " ); // write initializing message on serial
+    Serial.print ( debugChan + 1 );
+    Serial.print ( " STATE\n" );
   }
 
   /* Turn off fans */
-  Pwm1Duty = 0; // set output to zero
-  Pwm2Duty = 0; // set output to zero
+  fans.allOff ( );
 
   return thisState; // remain in same state
-}                   // end of debugTb1State()
-
+}                   // end of debugTbState()
 
 /******************************************************************************
 * Function:
-*   debugTb2State()
+*   debugTbDisplay()
 *
 * Description:
-*   Runs the DEBUG_TB2 state routine
+*   Updates the LCD screen for the DEBUG_TB state, showing two points of the
+*   lookup table at a time
 *
 * Arguments:
 *   none
 *
 * Returns:
-*   nextState - state to enter upon exiting this function
+*   none
 ******************************************************************************/
-static FANCTRLSTATE_ENUM_TYPE debugTb2State ( FANCTRLSTATE_ENUM_TYPE thisState )
+static void debugTbDisplay ( void )
 {
   char                lcdBuff [ LCDCOLS * LCDROWS ]; // buffer of chars used for LCD printing
-  static unsigned int dispCnt     = 0;               // count of how many times displayed the same message.  Will swap between displaying fan1 and fan2 info as count increases.
-  static byte         dispSecHalf = 0;               // display second half of table when high.  otherwise, display first half of table.
+  static unsigned int dispCnt = 0;                   // count of how many times displayed the same message.  Will move on to the next points as count increases.
+  static byte         dispPt  = 0;                   // first table point displayed
+  unsigned int        tmpA;                          // temperature of first point displayed
+  unsigned int        tmpB;                          // temperature of second point displayed
 
-  /* If this is the first time entering this state, reset button edge counts */
-  if ( stateChange )
+  if ( ++dispCnt > DEBUG_DISPSWITCH )
   {
-    Serial.print ( "ENTERING DEBUG LOOKUP TABLE 2 STATE\n" ); // write initializing message on serial
+    dispCnt = 0;                             // reset display count
+    if ( ( dispPt += 2 ) >= FAN_TBL_PTS ) // move on to next points
+      dispPt = 0;
   }
+  tmpA = *FAN_CFG_U ( debugChan, tblTmp [ dispPt ] );
+  tmpB = *FAN_CFG_U ( debugChan, tblTmp [ dispPt + 1 ] );
 
-  /* Update Fan Lookup Table 2 Parameters with those specified in message (if different) */
-  if ( fan2TblTmp1 != *(unsigned int *) ( debugDatWords + 0 ) ) // first word gives first temp value in table
-  {
-    fan2TblTmp1 = *(unsigned int *) ( debugDatWords + 0 );
-    saveVar ( &fan2TblTmp1 );
-  }
-  if ( fan2TblTmp2 != *(unsigned int *) ( debugDatWords + 1 ) ) // second word gives second temp value in table
-  {
-    fan2TblTmp2 = *(unsigned int *) ( debugDatWords + 1 );
-    saveVar ( &fan2TblTmp2 );
-  }
-  if ( fan2TblTmp3 != *(unsigned int *) ( debugDatWords + 2 ) ) // third word gives third temp value in table
-  {
-    fan2TblTmp3 = *(unsigned int *) ( debugDatWords + 2 );
-    saveVar ( &fan2TblTmp3 );
-  }
-  if ( fan2TblTmp4 != *(unsigned int *) ( debugDatWords + 3 ) ) // fourth word gives fourth temp value in table
-  {
-    fan2TblTmp4 = *(unsigned int *) ( debugDatWords + 3 );
-    saveVar ( &fan2TblTmp4 );
-  }
-  if ( fan2TblSpd1 != *(unsigned int *) ( debugDatWords + 4 ) ) // fifth word gives first speed value in table
-  {
-    fan2TblSpd1 = *(unsigned int *) ( debugDatWords + 4 );
-    saveVar ( &fan2TblSpd1 );
-  }
-  if ( fan2TblSpd2 != *(unsigned int *) ( debugDatWords + 5 ) ) // sixth word gives second speed value in table
-  {
-    fan2TblSpd2 = *(unsigned int *) ( debugDatWords + 5 );
-    saveVar ( &fan2TblSpd2 );
-  }
-  if ( fan2TblSpd3 != *(unsigned int *) ( debugDatWords + 6 ) ) // seventh word gives third speed value in table
+  /* Mark Temperature on first line of LCD display */
+  printTempLine ( lcdBuff, ' ', tmpA, tmpB ); // set temperatures as first line
+  lcd.setCursor ( 0, 0 );                     // set cursor to start of first line on LCD
+  lcd.print ( lcdBuff );                      // print first line
+
+  /* Mark table speeds on second line of LCD display */
+  sprintf ( lcdBuff, "RPM:  %4hu  %4hu",
+    *FAN_CFG_U ( debugChan, tblSpd [ dispPt ] ),
+    *FAN_CFG_U ( debugChan, tblSpd [ dispPt + 1 ] ) ); // set fan speeds
+  lcd.setCursor ( 0, 1 );                              // set cursor to start of second line on LCD
+  lcd.print ( lcdBuff );                               // print second line
+
+  return;
+} // end of debugTbDisplay()
+
+/******************************************************************************
+* Function:
+*   debugTbApply()
+*
+* Description:
+*   Applies the data words of a new DEBUG_TB message.  The first four words
+*   give the table temperatures, and the last four give the table speeds.
+*
+* Arguments:
+*   none
+*
+* Returns:
+*   none
+******************************************************************************/
+static void debugTbApply ( void )
+{
+  byte pt; // lookup table point
+
+  /* Update Fan Lookup Table Parameters with those specified in message (if different) */
+  for ( pt = 0; pt < FAN_TBL_PTS; pt++ )
   {
-    fan2TblSpd3 = *(unsigned int *) ( debugDatWords + 6 );
-    saveVar ( &fan2TblSpd3 );
+    debugApplyWord ( FAN_CFG_U ( debugChan, tblTmp [ pt ] ), pt );
+    debugApplyWord ( FAN_CFG_U ( debugChan, tblSpd [ pt ] ), FAN_TBL_PTS + pt );
   }
-  if ( fan2TblSpd4 != *(unsigned int *) ( debugDatWords + 7 ) ) // eighth word gives fourth speed value in table
+
+  return;
+} // end of debugTbApply()
+
+/******************************************************************************
+* Function:
+*   autoTuneState()
+*
+* Description:
+*   Runs the AUTOTUNE state routine, for the fan given by debugChan.  The
+*   other fans carry on as in the NORMAL state.  The fan being tuned is held
+*   at the experiment speed by its PI controller, then the relay experiment
+*   takes over its duty.  Once the experiment finishes, the new gains are
+*   given to the controller (and saved by saveTunedGains()), and the state
+*   returns to NORMAL.  A failed experiment leaves the gains alone.  The
+*   duty map of the fan being tuned doesn't learn until NORMAL takes its
+*   duty back.  The experiment times itself out, so this mode has no debug
+*   timeout.
+*
+* Arguments:
+*   none
+*
+* Returns:
+*   nextState - state to enter upon exiting this function
+******************************************************************************/
+static FANCTRLSTATE_ENUM_TYPE autoTuneState ( FANCTRLSTATE_ENUM_TYPE thisState )
+{
+  FANCTRLSTATE_ENUM_TYPE nextState = thisState; // by default, stay in auto-tune state
+  int                    kp;                    // proportional gain found
+  int                    ki;                    // integral gain found
+
+  /* If this is the first time entering this state, send message */
+  if ( stateChange )
   {
-    fan2TblSpd4 = *(unsigned int *) ( debugDatWords + 7 );
-    saveVar ( &fan2TblSpd4 );
+    Serial.print ( "ENTERING AUTOTUNE" ); // write initializing message on serial
+    Serial.print ( debugChan + 1 );
+    Serial.print ( " STATE\n" );
   }
 
-  /* Update LCD if needed */
-  if ( ++lcdLoops >= LCD_DEC || stateChange ) // if enough loops have occured or if this is first instance of NORMAL state, update LCD
-  {
-    lcdLoops = 0; // reset LCD loop counter
+  /* Set desired fan speeds based on temperature, but hold the fan being tuned at the experiment speed */
+  fans.setRefSpeeds ( );
+  fans.shapeRefSpeeds ( );
+  fans.rpmRef [ debugChan ] = autoTune.ref;
 
-    if ( ++dispCnt > DEBUG_DISPSWITCH )
+  /* Regulate Fan Speeds to Track Reference Values, then let the experiment set the duty of the fan being tuned */
+  fans.holdLearning ( debugChan ); // its duty map mustn't learn the experiment (learns again once NORMAL takes over)
+  fans.regSpeeds ( );
+  switch ( relayTuneStep ( &autoTune, fans.rpm [ debugChan ], &fans.duty [ debugChan ] ) )
+  {
+  case RTUNE_DONE: // experiment finished
+    if ( relayTuneGains ( &autoTune, &kp, &ki ) )
     {
-      dispCnt      = 0; // reset display count
-      dispSecHalf ^= 1; // toggle fan display
+      *FAN_CFG_S ( debugChan, kp ) = kp;
+      *FAN_CFG_S ( debugChan, ki ) = ki;
+      fans.setGains ( debugChan );
+      autoTuneSave = HIGH;
+      Serial.print ( "AUTOTUNE DONE, KP " );
+      Serial.print ( kp );
+      Serial.print ( " KI " );
+      Serial.print ( ki );
+      Serial.print ( "\n" );
     }
+    else
+      Serial.print ( "AUTOTUNE FAILED, OSCILLATION TOO SMALL\n" );
+    nextState = NORMAL;
+    break;
 
-    if ( dispSecHalf ) // display second half of table
-    {
-      /* Mark Temperature on first line of LCD display */
-      if ( useFtemp )
-      {
-        sprintf ( lcdBuff, " %cF: %3hu.%hu %3hu.%hu",
-          0xDF,
-          DigTemp1ToF10 ( fan2TblTmp3 ) / 10,
-          abs ( DigTemp1ToF10 ( fan2TblTmp3 ) ) % 10,
-          DigTemp2ToF10 ( fan2TblTmp4 ) / 10,
-          abs ( DigTemp2ToF10 ( fan2TblTmp4 ) ) % 10 ); // set temperatures as first line
-      }
-      else
-      {
-        sprintf ( lcdBuff, " %cC: %3hu.%hu %3hu.%hu",
-          0xDF,
-          DigTemp1ToC10 ( fan2TblTmp3 ) / 10,
-          abs ( DigTemp1ToC10 ( fan2TblTmp3 ) ) % 10,
-          DigTemp2ToC10 ( fan2TblTmp4 ) / 10,
-          abs ( DigTemp2ToC10 ( fan2TblTmp4 ) ) % 10 ); // set temperatures as first line
-      }
-      lcd.setCursor ( 0, 0 ); // set cursor to start of first line on LCD
-      lcd.print ( lcdBuff );  // print first line
+  case RTUNE_FAILED: // no steady oscillation
+    Serial.print ( "AUTOTUNE FAILED\n" );
+    nextState = NORMAL;
+    break;
 
-      /* Mark hall-sensor period values on second line of LCD display */
-      sprintf ( lcdBuff, "RPM:  %4hu  %4hu", fan2TblSpd3, fan2TblSpd4 ); // set fan speeds
-      lcd.setCursor ( 0, 1 );                                            // set cursor to start of second line on LCD
-      lcd.print ( lcdBuff );                                             // print second line
+  default: // still running
+    break;
+  }
 
-    }
-    else // display first half of table
-    {
-      /* Mark Temperature on first line of LCD display */
-      if ( useFtemp )
-      {
-        sprintf ( lcdBuff, " %cF: %3hu.%hu %3hu.%hu",
-          0xDF,
-          DigTemp1ToF10 ( fan2TblTmp1 ) / 10,
-          abs ( DigTemp1ToF10 ( fan2TblTmp1 ) ) % 10,
-          DigTemp2ToF10 ( fan2TblTmp2 ) / 10,
-          abs ( DigTemp2ToF10 ( fan2TblTmp2 ) ) % 10 ); // set temperatures as first line
-      }
-      else
-      {
-        sprintf ( lcdBuff, " %cC: %3hu.%hu %3hu.%hu",
-          0xDF,
-          DigTemp1ToC10 ( fan2TblTmp1 ) / 10,
-          abs ( DigTemp1ToC10 ( fan2TblTmp1 ) ) % 10,
-          DigTemp2ToC10 ( fan2TblTmp2 ) / 10,
-          abs ( DigTemp2ToC10 ( fan2TblTmp2 ) ) % 10 ); // set temperatures as first line
-      }
-      lcd.setCursor ( 0, 0 ); // set cursor to start of first line on LCD
-      lcd.print ( lcdBuff );  // print first line
+  /* Give up and go to fault state if a fan has stalled and can't be restarted */
+  if ( fans.stallFault ( ) )
+    nextState = FAULT;
 
-      /* Mark hall-sensor period values on second line of LCD display */
-      sprintf ( lcdBuff, "RPM:  %4hu  %4hu", fan2TblSpd1, fan2TblSpd2 ); // set fan speeds
-      lcd.setCursor ( 0, 1 );                                            // set cursor to start of second line on LCD
-      lcd.print ( lcdBuff );                                             // print second line
+  return nextState;
+} // end of autoTuneState()
 
-    }
+/******************************************************************************
+* Function:
+*   autoTuneDisplay()
+*
+* Description:
+*   Updates the LCD screen for the AUTOTUNE state, with the phase of the
+*   experiment and the relay cycles so far on the first line, and the speed
+*   and duty of the fan being tuned on the second
+*
+* Arguments:
+*   none
+*
+* Returns:
+*   none
+******************************************************************************/
+static void autoTuneDisplay ( void )
+{
+  char lcdBuff [ LCDCOLS * LCDROWS ]; // buffer of chars used for LCD printing
 
-  }
+  /* First line has the phase and relay cycles */
+  sprintf ( lcdBuff, "TUNE%hu %-6s %3hu", debugChan + 1, ( autoTune.phase == RTUNE_SETTLE ) ? "SETTLE" : "RELAY", autoTune.cycles ); // set experiment info
+  lcd.setCursor ( 0, 0 );                                                                                                              // set cursor to start of first line on LCD
+  lcd.print ( lcdBuff );                                                                                                               // print first line
 
-  /* Turn off fans */
-  Pwm1Duty = 0; // set output to zero
-  Pwm2Duty = 0; // set output to zero
+  /* Second line has speed feedback (rpm) and output duty (counts) */
+  sprintf ( lcdBuff, "RPM:  %4hu  %3u ", fans.rpm [ debugChan ], fans.duty [ debugChan ] ); // set fan info
+  lcd.setCursor ( 0, 1 );                                                                   // set cursor to start of second line on LCD
+  lcd.print ( lcdBuff );                                                                    // print second line
 
-  return thisState; // remain in same state
-}                   // end of debugTb2State()
+  return;
+} // end of autoTuneDisplay()
+
+/******************************************************************************
+* Function:
+*   autoTuneApply()
+*
+* Description:
+*   Applies the data words of a new AUTOTUNE message, starting a new relay
+*   experiment.  The first word gives the speed to tune at (kept within the
+*   fan's speed limits), the second the relay amplitude, and the third the
+*   relay hysteresis.
+*
+* Arguments:
+*   none
+*
+* Returns:
+*   none
+******************************************************************************/
+static void autoTuneApply ( void )
+{
+  unsigned int ref = *(unsigned int *) ( debugDatWords + 0 ); // speed to tune at (rpm)
+  unsigned int amp = *(unsigned int *) ( debugDatWords + 1 ); // relay amplitude (duty counts)
+
+  if ( ref < *FAN_CFG_U ( debugChan, minRpm ) )
+    ref = *FAN_CFG_U ( debugChan, minRpm );
+  if ( ref > *FAN_CFG_U ( debugChan, maxRpm ) )
+    ref = *FAN_CFG_U ( debugChan, maxRpm );
+  if ( amp > MAXPIOUTPUT )
+    amp = MAXPIOUTPUT;
+  relayTuneStart ( &autoTune, ref, (byte) amp, *(unsigned int *) ( debugDatWords + 2 ) );
+
+  return;
+} // end of autoTuneApply()
 
 /******************************************************************************
 * Function:
@@ -1103,7 +1136,8 @@ static FANCTRLSTATE_ENUM_TYPE debugTb2State ( FANCTRLSTATE_ENUM_TYPE thisState )
 ******************************************************************************/
 fanCtrlStateMachine :: fanCtrlStateMachine ( void )
 {
-  state = INIT;
+  state     = INIT;
+  lastState = INIT;
 } // end of fanCtrlStateMachine()
 
 
@@ -1141,8 +1175,9 @@ FANCTRLSTATE_ENUM_TYPE fanCtrlStateMachine :: getState ( void )
 ******************************************************************************/
 void fanCtrlStateMachine :: reset ( void )
 {
-  state = INIT; // set state to initialize
-  run ( );      // runs initialization state step
+  state     = INIT; // set state to initialize
+  lastState = INIT; // initialization is not a state change
+  run ( );          // runs initialization state step
 
   return;
 } // end of reset()
@@ -1153,7 +1188,9 @@ void fanCtrlStateMachine :: reset ( void )
 *   run()
 *
 * Description:
-*   runs the fan control state machine
+*   runs the control step of the fan control state machine.  LCD updates and
+*   serial message handling are done separately, by display() and
+*   checkSerial(), so they can be scheduled in different loop ticks.
 *
 * Arguments:
 *   none
@@ -1165,6 +1202,13 @@ void fanCtrlStateMachine :: run ( void )
 {
   FANCTRLSTATE_ENUM_TYPE thisState = state;
 
+  /* Check to see if state changed since last run.  If so, raise state change flag */
+  if ( thisState != lastState )
+    stateChange = HIGH;
+  else
+    stateChange = LOW;
+  lastState = thisState;
+
   switch ( thisState )
   {
   case INIT:
@@ -1175,12 +1219,12 @@ void fanCtrlStateMachine :: run ( void )
     state = normalState ( thisState ); // run normal state then move on to next state
     break;
 
-  case DEBUG_PI1:
-    state = debugPi1State ( thisState ); // run debug PI1 state then move on to next state
+  case FAULT:
+    state = faultState ( thisState ); // run fault state then move on to next state
     break;
 
-  case DEBUG_PI2:
-    state = debugPi2State ( thisState ); // run debug PI2  state then move on to next state
+  case DEBUG_PI:
+    state = debugPiState ( thisState ); // run debug PI state then move on to next state
     break;
 
   case DEBUG_BTNS:
@@ -1195,26 +1239,160 @@ void fanCtrlStateMachine :: run ( void )
     state = debugFonState ( thisState ); // run fan on/off settings debug state then move on to next state
     break;
 
-  case DEBUG_TB1:
-    state = debugTb1State ( thisState ); // run fan on/off settings debug state then move on to next state
+  case DEBUG_TB:
+    state = debugTbState ( thisState ); // run lookup table debug state then move on to next state
     break;
 
-  case DEBUG_TB2:
-    state = debugTb2State ( thisState ); // run fan on/off settings debug state then move on to next state
+  case AUTOTUNE:
+    state = autoTuneState ( thisState ); // run auto-tune state then move on to next state
     break;
 
   default:
     reset ( ); // reset device, invalid state reached
   }
 
+  /* Check for debug mode timeout */
+  state = checkDebugTimeout ( state );
+
+  return;
+} // end of run
+
+
+/******************************************************************************
+* Function:
+*   display()
+*
+* Description:
+*   updates the LCD screen for the current state
+*
+* Arguments:
+*   none
+*
+* Returns:
+*   none
+******************************************************************************/
+void fanCtrlStateMachine :: display ( void )
+{
+  switch ( state )
+  {
+  case NORMAL:
+    normalDisplay ( );
+    break;
+
+  case FAULT:
+    faultDisplay ( );
+    break;
+
+  case DEBUG_PI:
+    debugPiDisplay ( );
+    break;
+
+  case DEBUG_BTNS:
+    debugBtnDisplay ( );
+    break;
+
+  case DEBUG_TMP:
+    debugTmpDisplay ( );
+    break;
+
+  case DEBUG_FON:
+    debugFonDisplay ( );
+    break;
+
+  case DEBUG_TB:
+    debugTbDisplay ( );
+    break;
+
+  case AUTOTUNE:
+    autoTuneDisplay ( );
+    break;
+
+  default: // nothing to display
+    break;
+  }
+
+  return;
+} // end of display
+
+
+/******************************************************************************
+* Function:
+*   saveTunedGains()
+*
+* Description:
+*   Saves the PI gains found by an auto-tune to EEPROM, if there are any
+*   waiting.  Called from a task of its own rather than the control loop,
+*   as the EEPROM writes take several milliseconds.
+*
+* Arguments:
+*   none
+*
+* Returns:
+*   none
+******************************************************************************/
+void fanCtrlStateMachine :: saveTunedGains ( void )
+{
+  if ( autoTuneSave )
+  {
+    autoTuneSave = LOW;
+    saveVar ( FAN_CFG_S ( debugChan, kp ) );
+    saveVar ( FAN_CFG_S ( debugChan, ki ) );
+  }
+
+  return;
+} // end of saveTunedGains()
+
+/******************************************************************************
+* Function:
+*   checkSerial()
+*
+* Description:
+*   checks for debug messages on the serial port.  If one is found, the state
+*   is switched and the message data is applied (which may write EEPROM).
+*
+* Arguments:
+*   none
+*
+* Returns:
+*   none
+******************************************************************************/
+void fanCtrlStateMachine :: checkSerial ( void )
+{
   /* Check to see if any debug messages are present.  If so, switch states. */
-  state = checkDebugMsgs ( state );
+  if ( state != INIT )
+    state = checkDebugMsgs ( state );
 
-  /* Check to see if state changed.  If so, raise state change flag */
-  if ( state != thisState )
-    stateChange = HIGH;
-  else
-    stateChange = LOW;
+  /* Apply data of a new debug message */
+  if ( newDebugMsg )
+  {
+    newDebugMsg = LOW;
+
+    switch ( state )
+    {
+    case DEBUG_PI:
+      debugPiApply ( );
+      break;
+
+    case DEBUG_TMP:
+      debugTmpApply ( );
+      break;
+
+    case DEBUG_FON:
+      debugFonApply ( );
+      break;
+
+    case DEBUG_TB:
+      debugTbApply ( );
+      break;
+
+    case AUTOTUNE:
+      autoTuneApply ( );
+      break;
+
+    default: // no data to apply
+      break;
+    }
+  }
 
   return;
-} // end of run
+} // end of checkSerial
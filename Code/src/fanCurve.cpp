@@ -0,0 +1,135 @@
+/*
+ * fanCurve.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+
+/*******************************************************************************
+ * INCLUDED HEADER FILES
+ ******************************************************************************/
+#include "fanCurve.h"
+
+/*******************************************************************************
+ * FUNCTION DEFINITIONS
+ ******************************************************************************/
+
+/******************************************************************************
+* Function:
+*   fanCurveBuild()
+*
+* Description:
+*   Builds a fan curve from its points, and works out the slope of each
+*   segment, so evaluating the curve needs no divide.  A point whose
+*   temperature isn't above the last point kept is dropped, since it would
+*   give a vertical or backward segment (and a divide by zero).  The slopes
+*   are rounded to nearest.  Then the segment index is filled in, by walking
+*   the buckets and segments together.
+*
+* Arguments:
+*   curve - curve to build
+*   x - temperatures of the points, stored digitally, in increasing order
+*   y - speeds of the points (rpm)
+*   num - number of points (at most FAN_CURVE_MAX_PTS; any more are dropped)
+*
+* Returns:
+*   dropped - number of points dropped as invalid
+******************************************************************************/
+byte fanCurveBuild ( FAN_CURVE_TYPE *curve, const unsigned int *x, const unsigned int *y, byte num )
+{
+  byte     pt;      // point number in the input
+  byte     bkt;     // temperature bucket
+  byte     dropped; // number of points dropped
+  long int dx;      // temperature change across a segment
+  long int dy;      // speed change across a segment
+
+  if ( num > FAN_CURVE_MAX_PTS ) // too many points, so drop the end of the curve
+  {
+    dropped = num - FAN_CURVE_MAX_PTS;
+    num     = FAN_CURVE_MAX_PTS;
+  }
+  else
+    dropped = 0;
+
+  curve->num = 0;
+  for ( pt = 0; pt < num; pt++ )
+  {
+    if ( ( curve->num > 0 ) && ( x [ pt ] <= curve->x [ curve->num - 1 ] ) ) // not above the last point kept
+    {
+      dropped++;
+      continue;
+    }
+    curve->x [ curve->num ] = x [ pt ];
+    curve->y [ curve->num ] = y [ pt ];
+    if ( curve->num > 0 ) // work out the slope of the segment ending at this point
+    {
+      dx = (long int) x [ pt ] - curve->x [ curve->num - 1 ];
+      dy = (long int) y [ pt ] - curve->y [ curve->num - 1 ];
+      if ( dy >= 0 )
+        curve->slope [ curve->num - 1 ] = ( ( dy << FAN_CURVE_SLOPE_BITS ) + ( dx >> 1 ) ) / dx;
+      else
+        curve->slope [ curve->num - 1 ] = -( ( ( -dy << FAN_CURVE_SLOPE_BITS ) + ( dx >> 1 ) ) / dx );
+    }
+    curve->num++;
+  }
+
+  /* Fill in the segment index, with the last segment whose start is at or
+   * below the bottom of each bucket (segment 0 for buckets below the curve) */
+  pt = 0;
+  for ( bkt = 0; bkt < FAN_CURVE_BKTS; bkt++ )
+  {
+    while ( ( pt + 2 < curve->num ) && ( curve->x [ pt + 1 ] <= ( (unsigned int) bkt << FAN_CURVE_BKT_SHIFT ) ) )
+      pt++;
+    curve->seg [ bkt ] = pt;
+  }
+
+  return dropped;
+} // end of fanCurveBuild()
+
+/******************************************************************************
+* Function:
+*   fanCurveEval()
+*
+* Description:
+*   Returns the speed on a fan curve at a temperature.  The segment is found
+*   from the segment index, stepping past any points inside the bucket, and
+*   the speed interpolated along it with one multiply and shift, rounding
+*   toward the start of the segment (as the divide used to).  Below the
+*   first point the curve gives the first speed, and above the last point
+*   the last speed.
+*
+* Arguments:
+*   curve - curve built by fanCurveBuild()
+*   x - temperature, stored digitally
+*
+* Returns:
+*   y - speed at this temperature (rpm), or 0 if the curve has no points
+******************************************************************************/
+unsigned int fanCurveEval ( const FAN_CURVE_TYPE *curve, unsigned int x )
+{
+  unsigned int bkt;   // temperature bucket
+  byte         pt;    // point at the start of the segment
+  long int     delta; // speed change from the start of the segment (rpm << FAN_CURVE_SLOPE_BITS)
+
+  if ( curve->num == 0 ) // empty curve
+    return 0;
+  if ( x <= curve->x [ 0 ] ) // at or below the first point
+    return curve->y [ 0 ];
+  if ( x >= curve->x [ curve->num - 1 ] ) // at or above the last point
+    return curve->y [ curve->num - 1 ];
+
+  /* Find the segment with x [ pt ] <= x < x [ pt + 1 ] (the last point is
+   * above x, so this stops before it) */
+  bkt = x >> FAN_CURVE_BKT_SHIFT;
+  if ( bkt >= FAN_CURVE_BKTS ) // above the digital range, only possible if the curve is too
+    bkt = FAN_CURVE_BKTS - 1;
+  pt = curve->seg [ bkt ];
+  while ( curve->x [ pt + 1 ] <= x )
+    pt++;
+
+  delta = curve->slope [ pt ] * (long int) ( x - curve->x [ pt ] );
+  if ( delta >= 0 )
+    return curve->y [ pt ] + (unsigned int) ( delta >> FAN_CURVE_SLOPE_BITS );
+  else
+    return curve->y [ pt ] - (unsigned int) ( -delta >> FAN_CURVE_SLOPE_BITS );
+} // end of fanCurveEval()
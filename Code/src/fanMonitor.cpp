@@ -0,0 +1,155 @@
+/*
+ * fanMonitor.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+
+/*******************************************************************************
+ * INCLUDED HEADER FILES
+ ******************************************************************************/
+#include "fanMonitor.h"
+
+/*******************************************************************************
+ * FUNCTION DEFINITIONS
+ ******************************************************************************/
+
+/******************************************************************************
+* Function:
+*   fanMonStall()
+*
+* Description:
+*   Handles a stall: kicks the fan if it has not been kicked too many times
+*   already, or faults it otherwise.
+*
+* Arguments:
+*   mon - stall monitor of the fan
+*
+* Returns:
+*   none
+******************************************************************************/
+static void fanMonStall ( FAN_MON_TYPE *mon )
+{
+  mon->stalls++;
+  mon->loops = 0;
+  if ( mon->kicks < FANMON_MAX_KICKS ) // try to restart it
+  {
+    mon->kicks++;
+    mon->kickCnt++;
+    mon->state = FANMON_KICK;
+  }
+  else // give up until the retry time
+  {
+    mon->state = FANMON_FAULT;
+    mon->fault = HIGH;
+  }
+
+  return;
+} // end of fanMonStall()
+
+/******************************************************************************
+* Function:
+*   fanMonUpdate()
+*
+* Description:
+*   Runs the stall monitor for one fan, once each control loop.  A fan which
+*   is commanded off is never stalled, since no hall edges are expected.  A
+*   fan which is commanded on, but shows no speed after FANMON_SPINUP_MS (or
+*   stops while running), is stalled.  A stalled fan is kicked at full duty
+*   for FANMON_KICK_MS, then given another spin-up time.  After
+*   FANMON_MAX_KICKS failed kicks it is faulted: the output is turned off, so
+*   a locked rotor isn't left driven, and one more kick is tried every
+*   FANMON_RETRY_MS.  Turning the fan off clears the fault.
+*
+* Arguments:
+*   mon - stall monitor of the fan
+*   duty - commanded duty cycle (0-255 maps to 0%-100%)
+*   rpm - measured fan speed (rpm), zero if no hall edges
+*
+* Returns:
+*   duty - duty cycle to output (0-255 maps to 0%-100%)
+******************************************************************************/
+byte fanMonUpdate ( FAN_MON_TYPE *mon, byte duty, unsigned int rpm )
+{
+  if ( duty == 0 ) // commanded off
+  {
+    mon->state = FANMON_OFF;
+    mon->kicks = 0;
+    mon->fault = LOW;
+    return 0;
+  }
+
+  mon->loops++;
+  switch ( mon->state )
+  {
+  case FANMON_OFF: // just turned on
+    mon->state = FANMON_SPINUP;
+    mon->loops = 0;
+    break;
+
+  case FANMON_SPINUP:
+    if ( rpm > 0 ) // started turning
+    {
+      mon->state = FANMON_RUN;
+      mon->kicks = 0;
+      mon->fault = LOW;
+    }
+    else if ( mon->loops >= FANMON_MS_TO_LOOPS ( FANMON_SPINUP_MS ) ) // didn't start
+      fanMonStall ( mon );
+    break;
+
+  case FANMON_RUN:
+    if ( rpm == 0 ) // stopped while driven
+      fanMonStall ( mon );
+    break;
+
+  case FANMON_KICK:
+    if ( mon->loops >= FANMON_MS_TO_LOOPS ( FANMON_KICK_MS ) ) // kick finished, see if it starts
+    {
+      mon->state = FANMON_SPINUP;
+      mon->loops = 0;
+    }
+    break;
+
+  case FANMON_FAULT:
+    if ( mon->loops >= FANMON_MS_TO_LOOPS ( FANMON_RETRY_MS ) ) // try one more kick, faulting again straight after if it fails
+    {
+      mon->kickCnt++;
+      mon->state = FANMON_KICK;
+      mon->loops = 0;
+    }
+    break;
+
+  default: // invalid state, start again
+    mon->state = FANMON_OFF;
+    break;
+  }
+
+  /* Override the commanded duty while kicking or faulted */
+  if ( mon->state == FANMON_KICK )
+    duty = FANMON_KICK_DUTY;
+  else if ( mon->state == FANMON_FAULT )
+    duty = 0;
+
+  return duty;
+} // end of fanMonUpdate()
+
+/******************************************************************************
+* Function:
+*   fanMonFault()
+*
+* Description:
+*   Returns whether the fan is faulted (stalled, and could not be restarted).
+*   This stays high through the retry kicks, until the fan turns again or is
+*   commanded off.
+*
+* Arguments:
+*   mon - stall monitor of the fan
+*
+* Returns:
+*   fault - high if the fan is faulted
+******************************************************************************/
+byte fanMonFault ( const FAN_MON_TYPE *mon )
+{
+  return mon->fault;
+} // end of fanMonFault()
@@ -0,0 +1,66 @@
+/*
+ * feedFwd.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+
+/*******************************************************************************
+ * INCLUDED HEADER FILES
+ ******************************************************************************/
+#include "feedFwd.h"
+#include "savedVars.h"
+
+/*******************************************************************************
+ * FUNCTION DEFINITIONS
+ ******************************************************************************/
+
+/******************************************************************************
+* Function:
+*   feedFwdUpdate()
+*
+* Description:
+*   Tracks the rise rate of a fan's reference temperature, and returns the
+*   speed boost for it, so the fan speeds up while the load is ramping
+*   instead of waiting for the temperature to overshoot.  The temperature
+*   is sampled every FF_SAMPLE_MS, since it changes by only a few counts a
+*   minute, and the rise per minute is low-pass filtered (ffFilt).  The
+*   boost is ffGain rpm per raw count per minute of rise, up to ffMax, and
+*   decays back to zero with the filter once the temperature levels off.
+*   Falling temperatures give no boost.  Call once per control loop.
+*
+* Arguments:
+*   ff - feedforward stage of this fan
+*   temp - reference temperature of this fan, stored digitally
+*
+* Returns:
+*   boost - speed to add to the reference (rpm)
+******************************************************************************/
+unsigned int feedFwdUpdate ( FEED_FWD_TYPE *ff, unsigned int temp )
+{
+  long int boost; // speed boost (rpm)
+  long int rise;  // rise rate over the last sample (raw counts per minute << FF_FRAC_BITS)
+
+  /* Sample the temperature, and filter its rise rate */
+  if ( ff->loops == 0 )
+  {
+    ff->loops = FF_SAMPLE_LOOPS;
+    if ( ff->primed )
+    {
+      rise      = ( ( (long int) temp - ff->lastTemp ) * (long int) FF_PER_MIN ) << FF_FRAC_BITS;
+      ff->rate += ( ( rise - ff->rate ) * (long int) ( 1024 - ffFilt ) ) >> 10;
+    }
+    ff->lastTemp = temp;
+    ff->primed   = HIGH;
+  }
+  ff->loops--;
+
+  /* Work out boost from the rise rate */
+  if ( ff->rate <= 0 ) // steady or falling
+    return 0;
+  boost = ( ff->rate >> FF_FRAC_BITS ) * (long int) ffGain;
+  if ( boost > (long int) ffMax )
+    boost = ffMax;
+
+  return (unsigned int) boost;
+} // end of feedFwdUpdate()
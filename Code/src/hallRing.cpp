@@ -0,0 +1,313 @@
+/*
+ * hallRing.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+
+/*******************************************************************************
+ * INCLUDED HEADER FILES
+ ******************************************************************************/
+#include "hallRing.h"
+#include "timeBase.h"
+
+/*******************************************************************************
+ * FUNCTION DEFINITIONS
+ ******************************************************************************/
+
+/******************************************************************************
+* Function:
+*   hallRingInit()
+*
+* Description:
+*   Sets the starting hall level of a ring, so the first real edge isn't
+*   taken for a glitch.  Call before enabling the ring's interrupt.
+*
+* Arguments:
+*   ring - ring buffer to set up
+*   level - current hall sensor level (zero for low, nonzero for high)
+*
+* Returns:
+*   none
+******************************************************************************/
+void hallRingInit ( HALL_RING_TYPE *ring, byte level )
+{
+  ring->lastLevel = ( level != 0 );
+
+  return;
+} // end of hallRingInit()
+
+/******************************************************************************
+* Function:
+*   hallRingAccept()
+*
+* Description:
+*   Adds an accepted edge timestamp to a hall sensor ring buffer.  If the ring
+*   is full, the edge is dropped and counted, so the main loop knows there is
+*   a gap in the edges.  In edge counting mode, the edge is just counted and
+*   its timestamp kept.  Mode changes requested by the main loop are made
+*   here, so they always fall exactly between two edges.
+*
+* Arguments:
+*   ring - ring buffer to add the timestamp to
+*   stamp - timestamp of the edge (timer1 counts)
+*
+* Returns:
+*   none
+******************************************************************************/
+static void hallRingAccept ( HALL_RING_TYPE *ring, unsigned long stamp )
+{
+  byte head = ring->head; // index of slot to write
+
+  if ( ring->countModeReq != ring->isrCount.countMode ) // main loop asked for a mode change, so make it at this edge
+  {
+    ring->isrCount.countMode = ring->countModeReq;
+    if ( ring->isrCount.countMode )   // entering edge counting mode
+      ring->isrCount.edgeCnt = 0;     // count from this edge
+    else                              // leaving edge counting mode
+      ring->count.publish ( ring->isrCount ); // publish mode change, this edge goes in the ring
+  }
+
+  if ( ring->isrCount.countMode ) // edge counting mode
+  {
+    ring->isrCount.edgeCnt++;
+    ring->isrCount.lastStamp = stamp;
+    ring->count.publish ( ring->isrCount );
+    return;
+  }
+
+  if ( (byte) ( head - ring->tail ) >= HALL_RING_SIZE ) // ring is full
+  {
+    ring->drops++; // flag a gap in the edges
+    return;
+  }
+
+  ring->stamp [ head & HALL_RING_MASK ] = stamp;    // write timestamp first...
+  ring->head                            = head + 1; // ...then publish it to the main loop
+
+  return;
+} // end of hallRingAccept()
+
+/******************************************************************************
+* Function:
+*   hallRingPush()
+*
+* Description:
+*   Passes a hall sensor edge through the glitch filter, and on to the ring
+*   buffer if it is real.  This must only be called from the hall sensor
+*   interrupt.
+*
+*   A PWM spike gives two edges in quick succession.  A short spike has
+*   usually ended by the time the level is sampled, so both of its edges
+*   leave the level where it was, and are rejected straight away.  A longer
+*   glitch does change the sampled level, so it can't be told from a real
+*   edge until the next edge arrives.  So each edge is held back as pending
+*   until the next one: if that comes within HALL_MIN_EDGE_US and puts the
+*   level back, both are rejected, otherwise the pending edge is accepted.
+*   This delays each edge by one edge, which only matters when the fan stops
+*   (see calcFanRPM()).
+*
+* Arguments:
+*   ring - ring buffer to add the timestamp to
+*   stamp - timestamp of the edge (timer1 counts)
+*   level - hall sensor level sampled after the edge (zero for low, nonzero for high)
+*
+* Returns:
+*   none
+******************************************************************************/
+void hallRingPush ( HALL_RING_TYPE *ring, unsigned long stamp, byte level )
+{
+  level = ( level != 0 );
+  if ( level == ring->lastLevel ) // level hasn't changed, so the edge was a spike which has already ended
+  {
+    ring->glitches++;
+    return;
+  }
+  ring->lastLevel = level;
+
+  if ( ring->pending )
+  {
+    if ( stamp - ring->pendStamp < TIME_US_TO_CNTS ( (unsigned long) HALL_MIN_EDGE_US ) ) // too soon, so the pending edge was a glitch and this one ends it
+    {
+      ring->pending   = LOW;
+      ring->glitches += 2;
+      return;
+    }
+    hallRingAccept ( ring, ring->pendStamp ); // pending edge was real
+  }
+  ring->pendStamp = stamp; // hold this edge until the next one shows whether it is real
+  ring->pending   = HIGH;
+
+  return;
+} // end of hallRingPush()
+
+/******************************************************************************
+* Function:
+*   hallUpdatePeriodMode()
+*
+* Description:
+*   Reads all the edges received since the last call, and updates the period
+*   estimate to the median of the full hall periods in this batch.  A full
+*   period is measured between every second edge (rising to rising, or
+*   falling to falling), so an uneven hall duty cycle doesn't add noise, and
+*   the median rejects the odd noisy edge without needing a slow filter.
+*   The last two edges of each batch are kept, so every new edge gives a
+*   period measurement.
+*
+*   If edges were dropped because the ring filled up, the edge history is
+*   cleared, since a period measured across the gap would be wrong.  Edges
+*   are only dropped while the ring is full, and the ring is only emptied
+*   here, so the dropped edges always came after the last edge of the batch,
+*   and the edges within a batch are always consecutive.  So the batch itself
+*   is still used, and the history is cleared after it.  The drop count is
+*   read just after the slots are released, so it can't include a drop from
+*   after an edge of the next batch.  This matters when the fan is fast
+*   enough to fill the ring every loop before edge counting mode takes over.
+*
+* Arguments:
+*   ring - ring buffer of edge timestamps
+*   est - period estimate to update
+*
+* Returns:
+*   numEdges - number of new edges read from the ring
+******************************************************************************/
+static byte hallUpdatePeriodMode ( HALL_RING_TYPE *ring, HALL_EST_TYPE *est )
+{
+  unsigned long periods [ HALL_RING_SIZE ]; // full periods measured in this batch (timer1 counts)
+  byte          numPeriods = 0;             // number of periods measured in this batch
+  byte          head       = ring->head;    // snapshot of head index (edges after this are read next time)
+  byte          tail       = ring->tail;    // index of next slot to read
+  byte          numEdges   = head - tail;   // number of new edges
+  byte          cnt;                        // loop count variable
+  byte          pos;                        // position for insertion sort
+  unsigned long stamp;                      // timestamp of current edge
+  byte          drops;                      // snapshot of drop count
+
+  for ( cnt = 0; cnt < numEdges; cnt++ ) // read each new edge
+  {
+    stamp = ring->stamp [ (byte) ( tail + cnt ) & HALL_RING_MASK ];
+
+    if ( est->numPrev >= 2 ) // have the edge before last, so can measure a full period
+    {
+      /* Insertion sort, so median can be picked out after */
+      pos = numPeriods++;
+      while ( pos > 0 && periods [ pos - 1 ] > stamp - est->prevStamp [ 0 ] )
+      {
+        periods [ pos ] = periods [ pos - 1 ];
+        pos--;
+      }
+      periods [ pos ] = stamp - est->prevStamp [ 0 ];
+    }
+    else
+      est->numPrev++;
+
+    est->prevStamp [ 0 ] = est->prevStamp [ 1 ]; // shift edge history
+    est->prevStamp [ 1 ] = stamp;
+  }
+  ring->tail = head; // release slots back to the interrupt
+
+  drops = ring->drops;
+  if ( drops != est->lastDrops ) // edges were dropped after this batch filled the ring
+  {
+    est->lastDrops = drops;
+    est->numPrev   = 0; // don't measure across the gap
+  }
+
+  if ( numPeriods > 0 ) // update estimate with median of this batch
+    est->period = periods [ numPeriods >> 1 ];
+
+  return numEdges;
+} // end of hallUpdatePeriodMode()
+
+/******************************************************************************
+* Function:
+*   hallUpdateCountMode()
+*
+* Description:
+*   Updates the period estimate from the number of edges counted since the
+*   last call, and the time between the newest edge of the last call and the
+*   newest edge now.  Timing from edge to edge (rather than over the control
+*   loop window itself) means the result is only limited by the timer
+*   resolution, not by where the window boundaries fall between edges.
+*
+* Arguments:
+*   count - snapshot of edge count and newest timestamp
+*   est - period estimate to update
+*
+* Returns:
+*   numEdges - number of new edges counted
+******************************************************************************/
+static unsigned int hallUpdateCountMode ( const HALL_COUNT_TYPE *count, HALL_EST_TYPE *est )
+{
+  unsigned int numEdges = count->edgeCnt - est->lastCnt; // number of new edges
+
+  if ( numEdges == 0 ) // no new edges, keep last estimate
+    return 0;
+
+  if ( est->numPrev > 0 ) // have the newest edge of the last window to time from
+    est->period = ( count->lastStamp - est->prevStamp [ 1 ] ) * HALL_EDGES_PER_PERIOD / numEdges;
+  else
+    est->numPrev = 1;
+  est->prevStamp [ 1 ] = count->lastStamp;
+  est->lastCnt         = count->edgeCnt;
+
+  return numEdges;
+} // end of hallUpdateCountMode()
+
+/******************************************************************************
+* Function:
+*   hallRingUpdate()
+*
+* Description:
+*   Updates the period estimate using the current measurement mode, and
+*   requests a mode change if the speed has crossed a threshold.  The
+*   interrupt makes the change on its next edge and reports it in the count
+*   snapshot.  The snapshot is read before the ring, so when it shows that
+*   counting has started, the ring already holds every edge from before.
+*   None of this needs interrupts to be disabled.
+*
+* Arguments:
+*   ring - ring buffer of edge timestamps
+*   est - period estimate to update
+*
+* Returns:
+*   numEdges - number of new edges read
+******************************************************************************/
+unsigned int hallRingUpdate ( HALL_RING_TYPE *ring, HALL_EST_TYPE *est )
+{
+  HALL_COUNT_TYPE count    = ring->count.read ( ); // snapshot of edge count and interrupt mode
+  unsigned int    numEdges = 0;                    // number of new edges
+  byte            glitches = ring->glitches;       // snapshot of glitch count
+
+  /* Add up glitches rejected since last time */
+  est->glitches    += (byte) ( glitches - est->lastGlitches );
+  est->lastGlitches = glitches;
+
+  if ( est->countMode ) // reading edge counts
+  {
+    numEdges = hallUpdateCountMode ( &count, est );
+    if ( !count.countMode ) // interrupt has gone back to the ring, starting with the edge after the last one counted
+    {
+      est->countMode = LOW;
+      est->numPrev   = 1; // only the last edge counted is known, so the first edge from the ring gives no full period
+    }
+  }
+
+  if ( !est->countMode ) // reading edge timestamps from the ring
+  {
+    numEdges += hallUpdatePeriodMode ( ring, est );
+    if ( count.countMode ) // interrupt has started counting, and the ring held everything before that
+    {
+      est->countMode = HIGH;
+      est->lastCnt   = 0;
+    }
+  }
+
+  /* Request a mode change if speed has crossed a threshold */
+  if ( ( est->period != 0 ) && ( est->period < TIME_US_TO_CNTS ( (unsigned long) HALL_COUNT_ENTER_US ) ) ) // sped up
+    ring->countModeReq = HIGH;
+  else if ( ( est->period == 0 ) || ( est->period > TIME_US_TO_CNTS ( (unsigned long) HALL_COUNT_EXIT_US ) ) ) // slowed down (or stopped)
+    ring->countModeReq = LOW;
+
+  return numEdges;
+} // end of hallRingUpdate()
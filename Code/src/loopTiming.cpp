@@ -0,0 +1,231 @@
+/*
+ * loopTiming.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+
+/*******************************************************************************
+ * INCLUDED HEADER FILES
+ ******************************************************************************/
+#include "loopTiming.h"
+#include <avr/pgmspace.h>
+
+#if LOOP_TIMING_ENABLE
+
+/*******************************************************************************
+ * MACRO DEFINITIONS
+ ******************************************************************************/
+#define TIMING_LINE_BINS   6  // number of histogram bins sent on each line of a report
+#define TIMING_LINE_LEN    48 // max length of one line of a report
+#define TIMING_REPORT_IDLE 0  // value of reportStep when no report is in progress
+
+/*******************************************************************************
+ * TYPE DEFINITION FOR TIMING STATISTICS OF ONE PHASE
+ ******************************************************************************/
+typedef struct TIMING_STATS {
+  unsigned int  hist [ TIMING_HIST_BINS ]; // log2 histogram of execution times (saturates at 0xFFFF)
+  unsigned long maxCnts;                   // longest execution time (timer1 counts)
+  unsigned int  overruns;                  // number of executions longer than one scheduler tick (saturates at 0xFFFF)
+} TIMING_STATS_TYPE;
+
+/*******************************************************************************
+ * STATIC VARIABLE DEFINITIONS
+ ******************************************************************************/
+#define TIMINGDEF( a, b ) static const char a ## _NAME [] PROGMEM = b;
+TIMINGLIST
+#undef TIMINGDEF
+#define TIMINGDEF( a, b ) a ## _NAME,
+static const char *const timingNames [ NUM_TIMINGS ] = { TIMINGLIST }; // names of timed phases (strings stored in flash)
+#undef TIMINGDEF
+
+static TIMING_STATS_TYPE timingStats [ NUM_TIMINGS ]; // timing statistics of each phase
+static unsigned int      missedTicks      = 0;        // number of scheduler ticks missed because of overruns (saturates at 0xFFFF)
+static byte              reportStep       = 0;        // next line of report to send (0 when not reporting)
+static byte              reportClearAfter = LOW;      // high when statistics are cleared after a report is sent
+
+/*******************************************************************************
+ * FUNCTION DEFINITIONS
+ ******************************************************************************/
+
+/******************************************************************************
+* Function:
+*   loopTimingRecord()
+*
+* Description:
+*   Adds one execution time to the histogram of a phase, and updates the max
+*   time and overrun count of that phase.
+*
+* Arguments:
+*   id - phase which was timed
+*   cnts - execution time (timer1 counts)
+*
+* Returns:
+*   none
+******************************************************************************/
+void loopTimingRecord ( TIMING_ENUM_TYPE id, unsigned long cnts )
+{
+  TIMING_STATS_TYPE *stats = &timingStats [ id ];          // statistics of this phase
+  unsigned long      scaled = cnts >> TIMING_HIST_SHIFT;   // execution time, scaled for binning
+  byte               bin    = 0;                           // histogram bin
+
+  /* Find log2 bin, which is the number of significant bits of the scaled time */
+  while ( scaled != 0 && bin < TIMING_HIST_BINS - 1 )
+  {
+    scaled >>= 1;
+    bin++;
+  }
+
+  if ( stats->hist [ bin ] != 0xFFFF ) // saturate count
+    stats->hist [ bin ]++;
+  if ( cnts > stats->maxCnts ) // track max time
+    stats->maxCnts = cnts;
+  if ( cnts > SYSTICK_CNTS && stats->overruns != 0xFFFF ) // longer than a whole tick
+    stats->overruns++;
+
+  return;
+} // end of loopTimingRecord()
+
+/******************************************************************************
+* Function:
+*   loopTimingMissedTicks()
+*
+* Description:
+*   Adds to the count of scheduler ticks which were missed because the tasks
+*   of a previous tick overran.
+*
+* Arguments:
+*   ticks - number of ticks missed
+*
+* Returns:
+*   none
+******************************************************************************/
+void loopTimingMissedTicks ( byte ticks )
+{
+  if ( missedTicks > 0xFFFFU - ticks ) // saturate count
+    missedTicks = 0xFFFF;
+  else
+    missedTicks += ticks;
+
+  return;
+} // end of loopTimingMissedTicks()
+
+/******************************************************************************
+* Function:
+*   loopTimingClear()
+*
+* Description:
+*   Clears all timing statistics
+*
+* Arguments:
+*   none
+*
+* Returns:
+*   none
+******************************************************************************/
+void loopTimingClear ( void )
+{
+  memset ( timingStats, 0, sizeof ( timingStats ) );
+  missedTicks = 0;
+
+  return;
+} // end of loopTimingClear()
+
+/******************************************************************************
+* Function:
+*   loopTimingStartReport()
+*
+* Description:
+*   Starts sending a timing report over serial.  The report is sent a line at
+*   a time by loopTimingReport(), so that sending it never blocks waiting for
+*   room in the serial transmit buffer.
+*
+* Arguments:
+*   clearAfter - when high, statistics are cleared once the report is sent
+*
+* Returns:
+*   none
+******************************************************************************/
+void loopTimingStartReport ( byte clearAfter )
+{
+  reportStep       = 1;          // start with the first line
+  reportClearAfter = clearAfter; // remember whether to clear statistics afterwards
+
+  return;
+} // end of loopTimingStartReport()
+
+/******************************************************************************
+* Function:
+*   loopTimingReport()
+*
+* Description:
+*   Sends the next line of a timing report, if one is in progress and there is
+*   room in the serial transmit buffer.  Three lines are sent for each phase:
+*     <name> max <us> ovr <count> [miss <count>]
+*     <name> h0 <bins 0-5>
+*     <name> h6 <bins 6-11>
+*
+* Arguments:
+*   none
+*
+* Returns:
+*   none
+******************************************************************************/
+void loopTimingReport ( void )
+{
+  char               lineBuff [ TIMING_LINE_LEN ]; // line of report
+  char               name [ 5 ];                   // name of phase
+  byte               id;                           // phase reported on this line
+  byte               line;                         // which line of this phase is reported
+  byte               firstBin;                     // first histogram bin on this line
+  TIMING_STATS_TYPE *stats;                        // statistics of this phase
+
+  if ( reportStep == TIMING_REPORT_IDLE || Serial.availableForWrite ( ) < TIMING_LINE_LEN )
+    return; // nothing to send, or no room to send it without blocking
+
+  id    = ( reportStep - 1 ) / 3; // three lines per phase
+  line  = ( reportStep - 1 ) % 3;
+  stats = &timingStats [ id ];
+  strncpy_P ( name, timingNames [ id ], sizeof ( name ) - 1 );
+  name [ sizeof ( name ) - 1 ] = '\0';
+
+  if ( line == 0 ) // summary line
+  {
+    sprintf ( lineBuff, "%s max %lu ovr %u", name, stats->maxCnts / SYSTIMER_CNTS_PER_US, stats->overruns );
+    Serial.print ( lineBuff );
+    if ( id == TIM_TICK )
+    {
+      sprintf ( lineBuff, " miss %u", missedTicks );
+      Serial.print ( lineBuff );
+    }
+    Serial.print ( "\n" );
+  }
+  else // histogram line
+  {
+    firstBin = ( line - 1 ) * TIMING_LINE_BINS;
+    sprintf ( lineBuff, "%s h%u %u %u %u %u %u %u\n", name, firstBin,
+      stats->hist [ firstBin + 0 ], stats->hist [ firstBin + 1 ], stats->hist [ firstBin + 2 ],
+      stats->hist [ firstBin + 3 ], stats->hist [ firstBin + 4 ], stats->hist [ firstBin + 5 ] );
+    Serial.print ( lineBuff );
+  }
+
+  if ( ++reportStep > NUM_TIMINGS * 3 ) // report finished
+  {
+    reportStep = TIMING_REPORT_IDLE;
+    if ( reportClearAfter )
+      loopTimingClear ( );
+  }
+
+  return;
+} // end of loopTimingReport()
+
+#else /* LOOP_TIMING_ENABLE */
+
+/* Loop timing compiled out, so these do nothing */
+void loopTimingRecord ( TIMING_ENUM_TYPE id, unsigned long cnts ) { }
+void loopTimingMissedTicks ( byte ticks ) { }
+void loopTimingClear ( void ) { }
+void loopTimingStartReport ( byte clearAfter ) { }
+void loopTimingReport ( void ) { }
+
+#endif /* LOOP_TIMING_ENABLE */
@@ -0,0 +1,325 @@
+/*
+ * oneWire.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+
+/*******************************************************************************
+ * INCLUDED HEADER FILES
+ ******************************************************************************/
+#include "oneWire.h"
+#include <avr/interrupt.h>
+
+/*******************************************************************************
+ * MACRO DEFINITIONS
+ ******************************************************************************/
+#define OW_RESET_LOW_US   480 // reset pulse length (us)
+#define OW_PRESENCE_US    70  // time from releasing the reset pulse to sampling the presence pulse (us)
+#define OW_RESET_END_US   410 // rest of the reset time slot after sampling the presence pulse (us)
+#define OW_WRITE1_LOW_US  6   // low time starting a write 1 or read slot (us)
+#define OW_WRITE0_LOW_US  60  // low time of a write 0 slot (us)
+#define OW_SLOT_US        70  // length of a time slot, including recovery (us)
+#define OW_READ_SAMPLE_US 9   // time from releasing the bus to sampling it in a read slot (us)
+
+/*******************************************************************************
+ * FUNCTION DEFINITIONS
+ ******************************************************************************/
+
+/******************************************************************************
+* Function:
+*   owInit()
+*
+* Description:
+*   Releases the 1-Wire bus, leaving the output latch low, so that the bus is
+*   driven low just by setting the pin to an output.
+*
+* Arguments:
+*   none
+*
+* Returns:
+*   none
+******************************************************************************/
+void owInit ( void )
+{
+  digitalWrite ( OWPIN, LOW ); // output latch low, and no internal pull-up
+  OW_RELEASE ( );              // pin is an input, bus is pulled high externally
+
+  return;
+} // end of owInit()
+
+/******************************************************************************
+* Function:
+*   owReset()
+*
+* Description:
+*   Sends a reset pulse, and checks for a presence pulse from any device.
+*   Interrupts are only held off from the end of the reset pulse to the
+*   presence sample, since interrupts just lengthen the rest of the slot
+*   (which the devices allow).  Takes about 1 ms.
+*
+* Arguments:
+*   none
+*
+* Returns:
+*   present - high if any device answered
+******************************************************************************/
+byte owReset ( void )
+{
+  byte oldSREG; // saved interrupt state
+  byte present; // high if a device answered
+
+  OW_DRIVE_LOW ( );
+  delayMicroseconds ( OW_RESET_LOW_US );
+  oldSREG = SREG;
+  cli ( );
+  OW_RELEASE ( );
+  delayMicroseconds ( OW_PRESENCE_US );
+  present = !OW_READ ( ); // devices pull the bus low to answer
+  SREG    = oldSREG;
+  delayMicroseconds ( OW_RESET_END_US );
+
+  return present;
+} // end of owReset()
+
+/******************************************************************************
+* Function:
+*   owWriteBit()
+*
+* Description:
+*   Writes one bit in a time slot.  A 1 is a short low pulse, which the
+*   devices sample about 15 us in, so interrupts are held off until it is
+*   released.  A 0 is a long low pulse, which an interrupt can safely
+*   stretch, so interrupts are only held off while the bus is pulled low.
+*
+* Arguments:
+*   bit - bit to write (zero or nonzero)
+*
+* Returns:
+*   none
+******************************************************************************/
+static void owWriteBit ( byte bit )
+{
+  byte oldSREG = SREG; // saved interrupt state
+
+  cli ( );
+  OW_DRIVE_LOW ( );
+  if ( bit )
+  {
+    delayMicroseconds ( OW_WRITE1_LOW_US );
+    OW_RELEASE ( );
+    SREG = oldSREG;
+    delayMicroseconds ( OW_SLOT_US - OW_WRITE1_LOW_US );
+  }
+  else
+  {
+    SREG = oldSREG;
+    delayMicroseconds ( OW_WRITE0_LOW_US );
+    OW_RELEASE ( );
+    delayMicroseconds ( OW_SLOT_US - OW_WRITE0_LOW_US );
+  }
+
+  return;
+} // end of owWriteBit()
+
+/******************************************************************************
+* Function:
+*   owReadBit()
+*
+* Description:
+*   Reads one bit in a time slot.  The device's answer is only valid for
+*   about 15 us from the start of the slot, so interrupts are held off until
+*   it is sampled.
+*
+* Arguments:
+*   none
+*
+* Returns:
+*   bit - bit read (0 or 1)
+******************************************************************************/
+static byte owReadBit ( void )
+{
+  byte oldSREG = SREG; // saved interrupt state
+  byte bit;            // bit read
+
+  cli ( );
+  OW_DRIVE_LOW ( );
+  delayMicroseconds ( OW_WRITE1_LOW_US );
+  OW_RELEASE ( );
+  delayMicroseconds ( OW_READ_SAMPLE_US );
+  bit  = OW_READ ( ) ? 1 : 0;
+  SREG = oldSREG;
+  delayMicroseconds ( OW_SLOT_US - OW_WRITE1_LOW_US - OW_READ_SAMPLE_US );
+
+  return bit;
+} // end of owReadBit()
+
+/******************************************************************************
+* Function:
+*   owWriteByte()
+*
+* Description:
+*   Writes a byte to the bus, least significant bit first.  Takes about
+*   0.56 ms.
+*
+* Arguments:
+*   val - byte to write
+*
+* Returns:
+*   none
+******************************************************************************/
+void owWriteByte ( byte val )
+{
+  byte cnt; // loop count variable
+
+  for ( cnt = 0; cnt < 8; cnt++ )
+  {
+    owWriteBit ( val & 0x01 );
+    val >>= 1;
+  }
+
+  return;
+} // end of owWriteByte()
+
+/******************************************************************************
+* Function:
+*   owReadByte()
+*
+* Description:
+*   Reads a byte from the bus, least significant bit first.  Takes about
+*   0.56 ms.
+*
+* Arguments:
+*   none
+*
+* Returns:
+*   val - byte read
+******************************************************************************/
+byte owReadByte ( void )
+{
+  byte val = 0; // byte read
+  byte cnt;     // loop count variable
+
+  for ( cnt = 0; cnt < 8; cnt++ )
+  {
+    val >>= 1;
+    if ( owReadBit ( ) )
+      val |= 0x80;
+  }
+
+  return val;
+} // end of owReadByte()
+
+/******************************************************************************
+* Function:
+*   owCrc8()
+*
+* Description:
+*   Works out the 1-Wire CRC (polynomial x^8 + x^5 + x^4 + 1) of a buffer,
+*   a bit at a time, to save the 256-byte table.  Running it over a buffer
+*   which ends in its own CRC gives zero.
+*
+* Arguments:
+*   buf - buffer of bytes
+*   len - number of bytes
+*
+* Returns:
+*   crc - CRC of the buffer
+******************************************************************************/
+byte owCrc8 ( const byte *buf, byte len )
+{
+  byte crc = 0; // CRC so far
+  byte val;     // byte being shifted in
+  byte cnt;     // bit count variable
+
+  while ( len-- > 0 )
+  {
+    val = *buf++;
+    for ( cnt = 0; cnt < 8; cnt++ )
+    {
+      if ( ( crc ^ val ) & 0x01 )
+        crc = ( crc >> 1 ) ^ 0x8C;
+      else
+        crc >>= 1;
+      val >>= 1;
+    }
+  }
+
+  return crc;
+} // end of owCrc8()
+
+/******************************************************************************
+* Function:
+*   owSearch()
+*
+* Description:
+*   Finds the ROM codes of the devices of one family on the bus, with the
+*   1-Wire ROM search.  Each pass reads every ROM bit and its complement from
+*   all the devices at once: if both are 0, devices differ at this bit, so
+*   the pass takes the 0 branch the first time and the 1 branch after that.
+*   The writes drop the devices which don't match the branch taken.  Each
+*   pass finds one device, in about 14 ms, so this is only run at start-up.
+*   Codes with a bad CRC or another family code are skipped.
+*
+* Arguments:
+*   roms - set to the ROM codes found
+*   maxDevs - largest number of ROM codes to find
+*   family - family code of the devices to find
+*
+* Returns:
+*   numDevs - number of ROM codes found
+******************************************************************************/
+byte owSearch ( byte roms [ ][ OW_ROM_BYTES ], byte maxDevs, byte family )
+{
+  byte rom [ OW_ROM_BYTES ] = { 0 }; // ROM code of the current pass
+  byte numDevs              = 0;     // number of ROM codes found
+  byte lastFork             = 0;     // bit number (from 1) of the last fork where the 0 branch was taken on the last pass, or 0 if none
+  byte fork;                         // bit number of the last fork where the 0 branch was taken on this pass
+  byte bitNum;                       // bit number in ROM code (from 1)
+  byte bitVal;                       // ROM bit read from the devices
+  byte cmpVal;                       // complement of the ROM bit read from the devices
+  byte dir;                          // branch taken at this bit
+  byte mask;                         // mask of this bit within its byte
+
+  do
+  {
+    if ( !owReset ( ) ) // no devices on the bus
+      break;
+    owWriteByte ( OW_SEARCH_ROM );
+
+    fork = 0;
+    for ( bitNum = 1; bitNum <= OW_ROM_BYTES * 8; bitNum++ )
+    {
+      bitVal = owReadBit ( );
+      cmpVal = owReadBit ( );
+      mask   = 1 << ( ( bitNum - 1 ) & 7 );
+      if ( bitVal && cmpVal ) // no device answered, so they have all dropped out
+        return numDevs;
+      if ( bitVal != cmpVal ) // all remaining devices agree on this bit
+        dir = bitVal;
+      else // devices differ at this bit
+      {
+        if ( bitNum < lastFork ) // before the last fork, so follow the last pass
+          dir = ( rom [ ( bitNum - 1 ) >> 3 ] & mask ) ? 1 : 0;
+        else // take the 1 branch at the last fork, and the 0 branch at new ones
+          dir = ( bitNum == lastFork ) ? 1 : 0;
+        if ( dir == 0 )
+          fork = bitNum;
+      }
+      if ( dir )
+        rom [ ( bitNum - 1 ) >> 3 ] |= mask;
+      else
+        rom [ ( bitNum - 1 ) >> 3 ] &= ~mask;
+      owWriteBit ( dir );
+    }
+    lastFork = fork;
+
+    if ( ( owCrc8 ( rom, OW_ROM_BYTES ) == 0 ) && ( rom [ 0 ] == family ) ) // valid code of the right family
+    {
+      memcpy ( roms [ numDevs ], rom, OW_ROM_BYTES );
+      numDevs++;
+    }
+  } while ( ( lastFork != 0 ) && ( numDevs < maxDevs ) ); // stop when no forks are left to try
+
+  return numDevs;
+} // end of owSearch()
@@ -16,34 +16,61 @@
 
 /******************************************************************************
 * Function:
-*   piController()
+*   piControllerQ()
+*
+* Description:
+*   Constructor function for a piController object, with all gains and
+*   limits zero.  setGains() must be called before the controller is used.
+*
+* Arguments:
+*   none
+*
+* Returns:
+*   none
+******************************************************************************/
+template <byte KP_Q, byte KI_Q, byte OUT_Q, unsigned long SAMPLE_US>
+piControllerQ<KP_Q, KI_Q, OUT_Q, SAMPLE_US>::piControllerQ ( void )
+{
+  errIntegral = 0; // integral of error (PI_INT_US times error count)
+  maxErrInt   = 0; // maximum value of errIntegral (PI_INT_US times error count)
+  minErrInt   = 0; // minimum value of errIntegral (PI_INT_US times error count)
+  kp          = 0; // Proportional gain (2^-KP_Q duty counts per error count)
+  ki          = 0; // Integral gain (2^-KI_Q duty counts per error count per PI_INT_US)
+  IntTerm     = 0; // start with integral term = 0
+  PropTerm    = 0; // start with proportional term = 0
+
+  return; // exit function
+}         // end of piControllerQ()
+
+/******************************************************************************
+* Function:
+*   piControllerQ()
 *
 * Description:
 *   Constructor function for a piController object
 *
 * Arguments:
-*   sampleTimeSet - sets sample time (microseconds)
-*   maxErrIntSet - sets max integrator value (tenths of error count times seconds)
-*   minErrIntSet - sets min integrator value (tenths of error count times seconds)
-*   kpSet - sets proportional gain (2^-13 duty counts per error count)
-*   kiSet - sets integral gain (2^-17 duty counts per error count per 100 milliseconds)
+*   maxErrIntSet - sets max integrator value (PI_INT_US times error count)
+*   minErrIntSet - sets min integrator value (PI_INT_US times error count)
+*   kpSet - sets proportional gain (2^-KP_Q duty counts per error count)
+*   kiSet - sets integral gain (2^-KI_Q duty counts per error count per PI_INT_US)
 *
 * Returns:
 *   none
 ******************************************************************************/
-piController :: piController ( unsigned long sampleTimeSet, int maxErrIntSet, int minErrIntSet, int kpSet, int kiSet )
+template <byte KP_Q, byte KI_Q, byte OUT_Q, unsigned long SAMPLE_US>
+piControllerQ<KP_Q, KI_Q, OUT_Q, SAMPLE_US>::piControllerQ ( int maxErrIntSet, int minErrIntSet, int kpSet, int kiSet )
 {
-  sampleTime  = sampleTimeSet; // set sample time (microseconds)
-  errIntegral = 0;             // integral of error (tenths of error count times seconds)
-  maxErrInt   = maxErrIntSet;  // maximum value of errIntegral (tenths of error count times seconds)
-  minErrInt   = minErrIntSet;  // maximum value of errIntegral (tenths of error count times seconds)
-  kp          = kpSet;         // Proportional gain (2^-13 duty counts per error count)
-  ki          = kiSet;         // Integral gain (2^-17 duty counts per error count per 100 milliseconds)
-  IntTerm     = 0;             // start with integral term = 0
-  PropTerm    = 0;             // start with proportional term = 0
+  errIntegral = 0;            // integral of error (PI_INT_US times error count)
+  maxErrInt   = maxErrIntSet; // maximum value of errIntegral (PI_INT_US times error count)
+  minErrInt   = minErrIntSet; // minimum value of errIntegral (PI_INT_US times error count)
+  kp          = kpSet;        // Proportional gain (2^-KP_Q duty counts per error count)
+  ki          = kiSet;        // Integral gain (2^-KI_Q duty counts per error count per PI_INT_US)
+  IntTerm     = 0;            // start with integral term = 0
+  PropTerm    = 0;            // start with proportional term = 0
 
   return; // exit function
-}         // end of piController()
+}         // end of piControllerQ()
 
 /******************************************************************************
 * Function:
@@ -53,22 +80,21 @@ piController :: piController ( unsigned long sampleTimeSet, int maxErrIntSet, in
 *   Updates gains in the piController object
 *
 * Arguments:
-*   sampleTimeSet - sets sample time (microseconds)
-*   maxErrIntSet - sets max integrator value (tenths of error count times seconds)
-*   minErrIntSet - sets min integrator value (tenths of error count times seconds)
-*   kpSet - sets proportional gain (2^-13 duty counts per error count)
-*   kiSet - sets integral gain (2^-17 duty counts per error count per 100 milliseconds)
+*   maxErrIntSet - sets max integrator value (PI_INT_US times error count)
+*   minErrIntSet - sets min integrator value (PI_INT_US times error count)
+*   kpSet - sets proportional gain (2^-KP_Q duty counts per error count)
+*   kiSet - sets integral gain (2^-KI_Q duty counts per error count per PI_INT_US)
 *
 * Returns:
 *   none
 ******************************************************************************/
-void piController :: setGains ( unsigned long sampleTimeSet, int maxErrIntSet, int minErrIntSet, int kpSet, int kiSet )
+template <byte KP_Q, byte KI_Q, byte OUT_Q, unsigned long SAMPLE_US>
+void piControllerQ<KP_Q, KI_Q, OUT_Q, SAMPLE_US>::setGains ( int maxErrIntSet, int minErrIntSet, int kpSet, int kiSet )
 {
-  sampleTime = sampleTimeSet; // set sample time (microseconds)
-  maxErrInt  = maxErrIntSet;  // maximum value of errIntegral (tenths of error count times seconds)
-  minErrInt  = minErrIntSet;  // maximum value of errIntegral (tenths of error count times seconds)
-  kp         = kpSet;         // Proportional gain (2^-13 duty counts per error count)
-  ki         = kiSet;         // Integral gain (2^-17 duty counts per error count per 100 milliseconds)
+  maxErrInt = maxErrIntSet; // maximum value of errIntegral (PI_INT_US times error count)
+  minErrInt = minErrIntSet; // minimum value of errIntegral (PI_INT_US times error count)
+  kp        = kpSet;        // Proportional gain (2^-KP_Q duty counts per error count)
+  ki        = kiSet;        // Integral gain (2^-KI_Q duty counts per error count per PI_INT_US)
 
   return; // exit function
 }         // end of setGains()
@@ -87,9 +113,10 @@ void piController :: setGains ( unsigned long sampleTimeSet, int maxErrIntSet, i
 * Returns:
 *   none
 ******************************************************************************/
-void piController :: resetInt ( void )
+template <byte KP_Q, byte KI_Q, byte OUT_Q, unsigned long SAMPLE_US>
+void piControllerQ<KP_Q, KI_Q, OUT_Q, SAMPLE_US>::resetInt ( void )
 {
-  errIntegral = 0; // set integrator to zero (tenths of error count times seconds)
+  errIntegral = 0; // set integrator to zero (PI_INT_US times error count)
 
   return; // exit function
 }         // end of resetInt()
@@ -102,74 +129,138 @@ void piController :: resetInt ( void )
 *   Resets integrator to specified value
 *
 * Arguments:
-*   errInt - value to set integrator to (tenths of error count times seconds)
+*   errInt - value to set integrator to (PI_INT_US times error count)
 *
 * Returns:
 *   none
 ******************************************************************************/
-void piController :: resetInt ( int errInt )
+template <byte KP_Q, byte KI_Q, byte OUT_Q, unsigned long SAMPLE_US>
+void piControllerQ<KP_Q, KI_Q, OUT_Q, SAMPLE_US>::resetInt ( int errInt )
 {
-  errIntegral = errInt; // set integrator to specified value (tenths of error count times seconds)
+  errIntegral = errInt; // set integrator to specified value (PI_INT_US times error count)
 
   return; // exit function
 }         // end of resetInt()
 
 /******************************************************************************
 * Function:
-*   piControl()
+*   preload()
 *
 * Description:
-*   Executes PI control step
+*   Pre-loads the integrator for a bumpless handover, so that the next
+*   control step gives the duty the fan is already running at (if the error
+*   and feedforward are unchanged).  The integrator is set short of the
+*   state which gives the duty by what that step will add to it, and the
+*   state is rounded up, so the integral term doesn't come out a count low.
+*   Used when control is handed back to the controller after something
+*   else has been setting the duty.
 *
 * Arguments:
+*   dutyNow - duty the fan is running at
 *   errVal - error term input to PI
+*   ffTerm - feedforward term (2^-OUT_Q duty counts)
 *
 * Returns:
 *   none
 ******************************************************************************/
-byte piController :: piControl ( int errVal )
+template <byte KP_Q, byte KI_Q, byte OUT_Q, unsigned long SAMPLE_US>
+void piControllerQ<KP_Q, KI_Q, OUT_Q, SAMPLE_US>::preload ( byte dutyNow, int errVal, int ffTerm )
 {
-  byte dutyOut; // output duty
+  long int intTarget; // integral term needed (2^-OUT_Q duty counts)
+  long int intState;  // integrator state which gives it (PI_INT_US times error count)
 
-  errIntegral = (int) constrain (
-    ( ( (long int) errIntegral ) + ( ( ( (long int) errVal ) * (long int) sampleTime ) / 100000L ) ), // add to integrator, which holds error in tenths of rpm times seconds
-    ( (long int) minErrInt ), ( (long int) maxErrInt ) );                                             // constrain to stay within integrator limits
+  if ( ki <= 0 ) // integrator can't be set through a zero gain
+    return;
 
-  PropTerm = (int) constrain ( ( (long) errVal * kp ) >> 11, -16384, 16383 );      // proportional term, in quarter of duty counts
-  IntTerm  = (int) constrain ( ( (long) errIntegral * ki ) >> 15, -16384, 16383 ); // integral term, in quarter of duty counts
+  PropTerm  = piSat<int> ( ( (long) errVal * kp ) >> KP_SHIFT, -TERM_MAX - 1, TERM_MAX ); // proportional term
+  intTarget = ( (long) dutyNow << OUT_Q ) - PropTerm - ffTerm;                            // integral term which gives the duty
+  intState  = intTarget << KI_SHIFT;
+  if ( intState > 0 )
+    intState = ( intState + ki - 1 ) / ki; // round up (the divide rounds toward zero)
+  else
+    intState = intState / ki;
+  errIntegral = piSat<int> ( intState - (long) errVal * INT_NUM / INT_DEN, minErrInt, maxErrInt ); // less what the next step adds
+  IntTerm     = piSat<int> ( ( (long) errIntegral * ki ) >> KI_SHIFT, -TERM_MAX - 1, TERM_MAX );   // integral term
 
-  dutyOut  = (byte) constrain ( ( PropTerm + IntTerm ) >> 2, MINPIOUTPUT, MAXPIOUTPUT ); // set output duty
-
-  return dutyOut; // exit function
-}                 // end of piControl()
+  return; // exit function
+}         // end of preload()
 
+/******************************************************************************
+* Function:
+*   piControl()
+*
+* Description:
+*   Executes PI control step
+*
+* Arguments:
+*   errVal - error term input to PI
+*
+* Returns:
+*   none
+******************************************************************************/
+template <byte KP_Q, byte KI_Q, byte OUT_Q, unsigned long SAMPLE_US>
+byte piControllerQ<KP_Q, KI_Q, OUT_Q, SAMPLE_US>::piControl ( int errVal )
+{
+  return piControl ( errVal, 0 ); // exit function
+} // end of piControl()
 
 /******************************************************************************
 * Function:
-*   piControlIntOff()
+*   piControl()
 *
 * Description:
-*   Executes PI control step without updating integrator.  This can be useful
-*   to avoid anti-windup.  It does not set integrator term to zero, it just
-*   neglects to update the integral of error.
+*   Executes PI control step, with a feedforward term added to the output.
+*   The feedforward gives most of the duty needed for a new speed at once,
+*   so the integrator only has to make up the difference.
+*
+*   Anti-windup is by back-calculation: whenever the output saturates, the
+*   amount it is over the limit is fed back into the integrator, pulling
+*   the output back towards the limit with a tracking time constant equal
+*   to the integral time (kp / ki).  So the integrator never winds up past
+*   what the output can use, and the output comes off the limit as soon as
+*   the error reverses, instead of waiting for the integrator to unwind.
+*   A shorter time constant drags the integrator down while a large step
+*   saturates the proportional term, and the speed then creeps in.  With
+*   no proportional gain, the integrator is held at the limit instead.
 *
 * Arguments:
 *   errVal - error term input to PI
+*   ffTerm - feedforward term (2^-OUT_Q duty counts)
 *
 * Returns:
 *   none
 ******************************************************************************/
-byte piController :: piControlIntOff ( int errVal )
+template <byte KP_Q, byte KI_Q, byte OUT_Q, unsigned long SAMPLE_US>
+byte piControllerQ<KP_Q, KI_Q, OUT_Q, SAMPLE_US>::piControl ( int errVal, int ffTerm )
 {
-  byte dutyOut; // output duty
+  long int dutyOut; // output duty, before limiting (2^-OUT_Q duty counts)
+  long int excess;  // amount the output is over its limits (2^-OUT_Q duty counts)
 
-  PropTerm = (int) constrain ( ( (long) errVal * kp ) >> 11, -16384, 16383 );      // proportional term, in quarter of duty counts
-  IntTerm  = (int) constrain ( ( (long) errIntegral * ki ) >> 15, -16384, 16383 ); // integral term, in quarter of duty counts
+  errIntegral = piSat<int> ( (long) errIntegral + (long) errVal * INT_NUM / INT_DEN, minErrInt, maxErrInt ); // add to integrator, within its limits
 
-  dutyOut  = (byte) constrain ( ( PropTerm + IntTerm ) >> 2, MINPIOUTPUT, MAXPIOUTPUT ); // set output duty
+  PropTerm = piSat<int> ( ( (long) errVal * kp ) >> KP_SHIFT, -TERM_MAX - 1, TERM_MAX );      // proportional term
+  IntTerm  = piSat<int> ( ( (long) errIntegral * ki ) >> KI_SHIFT, -TERM_MAX - 1, TERM_MAX ); // integral term
+  dutyOut  = (long) PropTerm + IntTerm + ffTerm;                                              // output duty
 
-  return dutyOut; // exit function
-}                 // end of piControlIntOff()
+  /* Feed the saturation back into the integrator */
+  if ( dutyOut > OUT_HI )
+    excess = dutyOut - OUT_HI;
+  else if ( dutyOut < OUT_LO )
+    excess = dutyOut - OUT_LO;
+  else
+    excess = 0;
+  if ( ( excess != 0 ) && ( ki > 0 ) )
+  {
+    if ( kp > 0 )
+      excess = ( excess * AW_GAIN ) / kp;   // pull integrator back towards the limit over the integral time
+    else
+      excess = ( excess << KI_SHIFT ) / ki; // hold integrator at the limit
+    errIntegral = piSat<int> ( errIntegral - excess, minErrInt, maxErrInt );                       // feed back into integrator
+    IntTerm     = piSat<int> ( ( (long) errIntegral * ki ) >> KI_SHIFT, -TERM_MAX - 1, TERM_MAX ); // integral term
+  }
+
+  return piSat<byte> ( dutyOut >> OUT_Q, MINPIOUTPUT, MAXPIOUTPUT ); // exit function
+} // end of piControl()
 
 
 /******************************************************************************
@@ -183,9 +274,10 @@ byte piController :: piControlIntOff ( int errVal )
 *   none
 *
 * Returns:
-*   PropTerm - proportional term, in quarters of duty count
+*   PropTerm - proportional term (2^-OUT_Q duty counts)
 ******************************************************************************/
-int piController :: getPropTerm ( void )
+template <byte KP_Q, byte KI_Q, byte OUT_Q, unsigned long SAMPLE_US>
+int piControllerQ<KP_Q, KI_Q, OUT_Q, SAMPLE_US>::getPropTerm ( void )
 {
   return PropTerm;
 } // end of getPropTerm()
@@ -201,9 +293,10 @@ int piController :: getPropTerm ( void )
 *   none
 *
 * Returns:
-*   IntTerm - integral term, in quarters of duty count
+*   IntTerm - integral term (2^-OUT_Q duty counts)
 ******************************************************************************/
-int piController :: getIntTerm ( void )
+template <byte KP_Q, byte KI_Q, byte OUT_Q, unsigned long SAMPLE_US>
+int piControllerQ<KP_Q, KI_Q, OUT_Q, SAMPLE_US>::getIntTerm ( void )
 {
   return IntTerm;
 } // end of getIntTerm()
@@ -219,9 +312,13 @@ int piController :: getIntTerm ( void )
 *   none
 *
 * Returns:
-*   errIntegral - integrator state, (tenths of error count times seconds)
+*   errIntegral - integrator state (PI_INT_US times error count)
 ******************************************************************************/
-int piController :: getIntState ( void )
+template <byte KP_Q, byte KI_Q, byte OUT_Q, unsigned long SAMPLE_US>
+int piControllerQ<KP_Q, KI_Q, OUT_Q, SAMPLE_US>::getIntState ( void )
 {
   return errIntegral;
 } // end of getIntState()
+
+/* Build the PI controller of the fans */
+template class piControllerQ<PI_KP_Q, PI_KI_Q, PI_OUT_Q, LOOPTIME_US>;
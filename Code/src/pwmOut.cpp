@@ -0,0 +1,130 @@
+/*
+ * pwmOut.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+
+/*******************************************************************************
+ * INCLUDED HEADER FILES
+ ******************************************************************************/
+#include "pwmOut.h"
+
+/*******************************************************************************
+ * FUNCTION DEFINITIONS
+ ******************************************************************************/
+
+/******************************************************************************
+* Function:
+*   pwmOutInit()
+*
+* Description:
+*   Sets up timer0 for 62500 Hz fast PWM on pins 5 & 6, with both outputs at
+*   0% duty.  Timer0 is the only timer which can drive these pins (timer1 and
+*   timer2 outputs are on the LCD and hall sensor pins), so it is taken over
+*   completely here.
+*
+*   The Arduino core uses the timer0 overflow interrupt for micros(), millis()
+*   and delay().  Running timer0 64 times faster made those run 64 times fast,
+*   and also woke the processor 62500 times a second.  So, the overflow
+*   interrupt is disabled, and micros(), millis() and delay() must NOT be
+*   used.  Use the timeBase functions instead, which count real microseconds.
+*
+* Arguments:
+*   none
+*
+* Returns:
+*   none
+******************************************************************************/
+void pwmOutInit ( void )
+{
+  /* Start with pins low, and outputs disconnected from the timer */
+  digitalWrite ( PWM1PIN, LOW ); // pwm1 pin is low when disconnected from timer
+  digitalWrite ( PWM2PIN, LOW ); // pwm2 pin is low when disconnected from timer
+  pinMode ( PWM1PIN, OUTPUT );   // set pin 5 as an output (PWM1)
+  pinMode ( PWM2PIN, OUTPUT );   // set pin 6 as an output (PWM2)
+
+  TIMSK0 = 0;                                            // disable timer0 interrupts (stops the core's millis() overflow interrupt)
+  TCCR0A = _BV ( WGM01 ) | _BV ( WGM00 );                // fast PWM mode, counting 0 to 0xFF, outputs disconnected
+  TCCR0B = _BV ( CS00 );                                 // no prescaling, for 62500 Hz PWM on pins 5 & 6
+  OCR0A  = 0;                                            // pwm2 compare value
+  OCR0B  = 0;                                            // pwm1 compare value
+  TIFR0  = _BV ( TOV0 ) | _BV ( OCF0A ) | _BV ( OCF0B ); // clear any pending flags
+
+  return;
+} // end of pwmOutInit()
+
+/******************************************************************************
+* Function:
+*   pwmOutSet()
+*
+* Description:
+*   Sets the duty cycle of a PWM output by writing the timer0 compare
+*   register directly.  Fast PWM always gives a one-count high pulse even with
+*   a compare value of zero, so 0% duty disconnects the output from the timer
+*   instead, leaving the pin driven low.
+*
+* Arguments:
+*   chan - PWM output to set
+*   duty - duty cycle (0-255 maps to 0%-100%)
+*
+* Returns:
+*   none
+******************************************************************************/
+void pwmOutSet ( PWMOUT_ENUM_TYPE chan, byte duty )
+{
+  if ( chan == PWMOUT_1 ) // pin 5, output compare B
+  {
+    OCR0B = duty;
+    if ( duty == 0 )
+      TCCR0A &= ~_BV ( COM0B1 ); // disconnect, pin stays low
+    else
+      TCCR0A |= _BV ( COM0B1 );  // non-inverting PWM
+  }
+  else // pin 6, output compare A
+  {
+    OCR0A = duty;
+    if ( duty == 0 )
+      TCCR0A &= ~_BV ( COM0A1 ); // disconnect, pin stays low
+    else
+      TCCR0A |= _BV ( COM0A1 );  // non-inverting PWM
+  }
+
+  return;
+} // end of pwmOutSet()
+
+/******************************************************************************
+* Function:
+*   pwmOutQuiet()
+*
+* Description:
+*   Waits until timer0 is clear of the blanking window after each PWM
+*   switching instant (the bottom of the count, where both outputs turn on,
+*   and each compare match, where one turns off).  The switching noise on
+*   the fan wiring dies out within the window, so an input sampled after this
+*   returns sees the real level.  Each window starts PWMOUT_LEAD_CNTS before
+*   its instant, so an input sampled just after this returns can't land on
+*   the instant itself.  The windows take up at most 6 of the 16 us PWM
+*   period, so allowing for the polling loop, this never waits longer than
+*   about 7 us.  Used by the hall sensor interrupts to sample the tach level
+*   clear of PWM noise.
+*
+* Arguments:
+*   none
+*
+* Returns:
+*   none
+******************************************************************************/
+void pwmOutQuiet ( void )
+{
+  byte cnt; // timer0 count by the time the caller samples its input, at the latest
+
+  do
+  {
+    cnt = TCNT0 + PWMOUT_LEAD_CNTS;
+  } while ( ( cnt < PWMOUT_BLANK_CNTS + PWMOUT_LEAD_CNTS ) ||            // about when both outputs turn on
+    ( (byte) ( cnt - OCR0A ) < PWMOUT_BLANK_CNTS + PWMOUT_LEAD_CNTS ) || // about when pwm2 turns off
+    ( (byte) ( cnt - OCR0B ) < PWMOUT_BLANK_CNTS + PWMOUT_LEAD_CNTS ) ); // about when pwm1 turns off
+
+  return;
+} // end of pwmOutQuiet()
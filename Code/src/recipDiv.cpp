@@ -0,0 +1,109 @@
+/*
+ * recipDiv.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+
+/*******************************************************************************
+ * INCLUDED HEADER FILES
+ ******************************************************************************/
+#include "recipDiv.h"
+#include <avr/pgmspace.h>
+
+/*******************************************************************************
+ * MACROS USED FOR GENERATING RECIPROCAL TABLE
+ *
+ * Entry i is 2^30 divided by the normalized divisor m = 32768 + i*256,
+ * rounded to nearest, so entries run from 32768 (m = 32768) down to 16384
+ * (m = 65536).  The table is built by the compiler, so it always matches
+ * RECIP_TBL_BITS.
+ ******************************************************************************/
+#if RECIP_TBL_BITS != 7
+#error "recipTbl[] initializer below must be updated to match RECIP_TBL_BITS"
+#endif
+
+#define RECIP_M( i ) ( 32768UL + ( (unsigned long) ( i ) << RECIP_TBL_SHIFT ) )
+#define RECIP_ENTRY( i ) ( (unsigned int) ( ( ( 1UL << 30 ) + ( RECIP_M ( i ) >> 1 ) ) / RECIP_M ( i ) ) ),
+#define RECIP_ENTRY4( i ) RECIP_ENTRY ( i ) RECIP_ENTRY ( i + 1 ) RECIP_ENTRY ( i + 2 ) RECIP_ENTRY ( i + 3 )
+#define RECIP_ENTRY16( i ) RECIP_ENTRY4 ( i ) RECIP_ENTRY4 ( i + 4 ) RECIP_ENTRY4 ( i + 8 ) RECIP_ENTRY4 ( i + 12 )
+#define RECIP_ENTRY64( i ) RECIP_ENTRY16 ( i ) RECIP_ENTRY16 ( i + 16 ) RECIP_ENTRY16 ( i + 32 ) RECIP_ENTRY16 ( i + 48 )
+
+/*******************************************************************************
+ * STATIC VARIABLE DEFINITIONS
+ ******************************************************************************/
+static const unsigned int recipTbl [ RECIP_TBL_SIZE ] PROGMEM = { RECIP_ENTRY64 ( 0 ) RECIP_ENTRY64 ( 64 ) RECIP_ENTRY ( 128 ) }; // 2^30 / normalized divisor (stored in flash)
+
+/*******************************************************************************
+ * FUNCTION DEFINITIONS
+ ******************************************************************************/
+
+/******************************************************************************
+* Function:
+*   recipDiv()
+*
+* Description:
+*   Divides two unsigned longs without a 32-bit divide, which costs around
+*   600 cycles on this processor.  The divisor is normalized (shifted) to a
+*   16-bit value m with its top bit set, its reciprocal is looked up in a
+*   table and linearly interpolated, and the dividend is multiplied by that
+*   using 16x16 bit multiplies.  Result is rounded to nearest.
+*
+*   Error bound: the interpolated reciprocal is within 2^-14 (relative) of
+*   the exact one (interpolation error is below 2^-16 with 128 intervals,
+*   table rounding is below 2^-15, and truncating a divisor wider than 16 bits
+*   is below 2^-15).  Hence the result is within num/den * 2^-13, plus 1,
+*   of the exact quotient.  For RPM from hall period this is under 1.3 rpm at
+*   9999 rpm, and well under 1 rpm below 5000 rpm.
+*
+* Arguments:
+*   num - dividend
+*   den - divisor
+*
+* Returns:
+*   quotient - num / den (0xFFFFFFFF if den is zero)
+******************************************************************************/
+unsigned long recipDiv ( unsigned long num, unsigned long den )
+{
+  signed char   shift = 0; // power of 2 the divisor was scaled by during normalization
+  unsigned int  m;         // normalized divisor (0x8000 to 0xFFFF)
+  byte          idx;       // table index
+  unsigned int  frac;      // position of m between table entries idx and idx+1
+  unsigned int  r0;        // reciprocal at table entry idx
+  unsigned int  r1;        // reciprocal at table entry idx+1
+  unsigned int  r;         // interpolated reciprocal, 2^30 / m
+  unsigned long sum;       // num * r / 2^16
+  byte          sh;        // remaining right shift to get quotient
+
+  if ( den == 0 ) // don't divide by zero
+    return 0xFFFFFFFF;
+  if ( den < RECIP_MIN_DEN ) // normalization shift would be too large, just divide
+    return num / den;
+
+  /* Normalize divisor to 16 bits with top bit set, m = den * 2^shift */
+  while ( den >= 0x10000UL )
+  {
+    den >>= 1;
+    shift--;
+  }
+  m = (unsigned int) den;
+  while ( !( m & 0x8000 ) )
+  {
+    m <<= 1;
+    shift++;
+  }
+
+  /* Look up and interpolate reciprocal */
+  idx  = ( m - 0x8000 ) >> RECIP_TBL_SHIFT;
+  frac = m & ( ( 1 << RECIP_TBL_SHIFT ) - 1 );
+  r0   = pgm_read_word ( &recipTbl [ idx ] );
+  r1   = pgm_read_word ( &recipTbl [ idx + 1 ] );
+  r    = r0 - (unsigned int) ( ( ( r0 - r1 ) * frac + ( 1 << ( RECIP_TBL_SHIFT - 1 ) ) ) >> RECIP_TBL_SHIFT );
+
+  /* num / den = num * r * 2^(shift - 30).  Multiply in 16 bit halves, so only
+   * 16x16 bit multiplies are needed, dropping the lowest 16 bits. */
+  sum = (unsigned long) (unsigned int) ( num >> 16 ) * r + ( ( (unsigned long) (unsigned int) ( num & 0xFFFF ) * r ) >> 16 );
+  sh  = 14 - shift; // between 1 and 30, since den >= RECIP_MIN_DEN
+
+  return ( sum + ( 1UL << ( sh - 1 ) ) ) >> sh;
+} // end of recipDiv()
@@ -0,0 +1,110 @@
+/*
+ * refShape.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+
+/*******************************************************************************
+ * INCLUDED HEADER FILES
+ ******************************************************************************/
+#include "refShape.h"
+#include "savedVars.h"
+
+/*******************************************************************************
+ * STATIC VARIABLE DEFINITIONS
+ ******************************************************************************/
+static unsigned int *const skipLo [ REF_SKIP_BANDS ] = { &refSkipLo1, &refSkipLo2 }; // saved bottom speed of each skip band
+static unsigned int *const skipHi [ REF_SKIP_BANDS ] = { &refSkipHi1, &refSkipHi2 }; // saved top speed of each skip band
+
+/*******************************************************************************
+ * FUNCTION DEFINITIONS
+ ******************************************************************************/
+
+/******************************************************************************
+* Function:
+*   refShapeUpdate()
+*
+* Description:
+*   Moves the shaped reference of a fan toward a new target, for one control
+*   loop.  The reference changes by at most refSlewUp or refSlewDn rpm/s
+*   (zero for no limit), so the PI controller isn't handed a step each time
+*   the temperature crosses a table point.  Turning on and off skip the ramp
+*   below minRpm, since the fan is off there anyway.  A target inside a skip band is moved to the band
+*   edge on the side the reference is already on, so the reference never
+*   settles inside the band.  If the ramp lands inside a band, the reference
+*   jumps straight across it in the direction it is moving.  A band is
+*   disabled when its top isn't above its bottom.  Bands shouldn't overlap.
+*
+* Arguments:
+*   shape - reference shaping stage of this fan
+*   target - reference speed set from the temperature (rpm)
+*   minRpm - minimum speed setpoint of this fan (rpm), below which it is off
+*
+* Returns:
+*   ref - shaped reference speed (rpm)
+******************************************************************************/
+unsigned int refShapeUpdate ( REF_SHAPE_TYPE *shape, unsigned int target, unsigned int minRpm )
+{
+  unsigned int  cur;    // shaped reference speed at the start of this loop (rpm)
+  unsigned int  lo;     // bottom of a skip band (rpm)
+  unsigned int  hi;     // top of a skip band (rpm)
+  unsigned long goal;   // target (rpm << REF_SHAPE_FRAC_BITS)
+  unsigned long step;   // largest change allowed this loop (rpm << REF_SHAPE_FRAC_BITS)
+  byte          rising; // high if the reference is moving up
+  byte          band;   // skip band number
+
+  /* Turning off is immediate, and turning on starts from minimum speed */
+  if ( target < minRpm )
+  {
+    shape->ref = 0;
+    return 0;
+  }
+  if ( ( shape->ref >> REF_SHAPE_FRAC_BITS ) < minRpm )
+    shape->ref = (unsigned long) minRpm << REF_SHAPE_FRAC_BITS;
+  cur = shape->ref >> REF_SHAPE_FRAC_BITS;
+
+  /* Keep the target out of the skip bands */
+  for ( band = 0; band < REF_SKIP_BANDS; band++ )
+  {
+    lo = *skipLo [ band ];
+    hi = *skipHi [ band ];
+    if ( ( hi > lo ) && ( target > lo ) && ( target < hi ) ) // target inside an enabled band
+      target = ( ( cur >= hi ) || ( lo < minRpm ) ) ? hi : lo;
+  }
+
+  /* Ramp toward the target */
+  goal   = (unsigned long) target << REF_SHAPE_FRAC_BITS;
+  rising = ( goal > shape->ref );
+  if ( rising )
+  {
+    step = REF_SLEW_STEP ( refSlewUp );
+    if ( ( refSlewUp == 0 ) || ( goal - shape->ref <= step ) ) // no limit, or close enough to get there this loop
+      shape->ref = goal;
+    else
+      shape->ref += step;
+  }
+  else
+  {
+    step = REF_SLEW_STEP ( refSlewDn );
+    if ( ( refSlewDn == 0 ) || ( shape->ref - goal <= step ) ) // no limit, or close enough to get there this loop
+      shape->ref = goal;
+    else
+      shape->ref -= step;
+  }
+
+  /* Jump across a band the ramp has landed in */
+  cur = shape->ref >> REF_SHAPE_FRAC_BITS;
+  for ( band = 0; band < REF_SKIP_BANDS; band++ )
+  {
+    lo = *skipLo [ band ];
+    hi = *skipHi [ band ];
+    if ( ( hi > lo ) && ( cur > lo ) && ( cur < hi ) ) // inside an enabled band
+    {
+      cur        = rising ? hi : lo;
+      shape->ref = (unsigned long) cur << REF_SHAPE_FRAC_BITS;
+    }
+  }
+
+  return cur;
+} // end of refShapeUpdate()
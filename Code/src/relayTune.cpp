@@ -0,0 +1,200 @@
+/*
+ * relayTune.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+
+/*******************************************************************************
+ * INCLUDED HEADER FILES
+ ******************************************************************************/
+#include "relayTune.h"
+#include "piController.h"
+
+/*******************************************************************************
+ * MACRO DEFINITIONS
+ ******************************************************************************/
+#define RTUNE_KU_SCALE 20861UL                    // ultimate gain (2^-13 duty counts per rpm) per duty count of relay amplitude over rpm of peak-to-peak swing (2^13 * 8 / pi)
+#define RTUNE_KI_SCALE ( 1600000UL / LOOPTIME_US ) // integral gain per proportional gain, times the integral time (control loops)
+#define RTUNE_KP_PCT   31                          // proportional gain, in percent of the ultimate gain (Tyreus-Luyben)
+#define RTUNE_TI_PCT   220                         // integral time, in percent of the ultimate period (Tyreus-Luyben)
+
+/*******************************************************************************
+ * FUNCTION DEFINITIONS
+ ******************************************************************************/
+
+/******************************************************************************
+* Function:
+*   relayTuneStart()
+*
+* Description:
+*   Sets up a relay experiment about a speed.  The experiment starts by
+*   letting the PI controller settle the fan at the speed, to find the duty
+*   the relay switches about.
+*
+* Arguments:
+*   tune - relay experiment to set up
+*   ref - speed to switch about (rpm)
+*   amp - relay amplitude (duty counts), or 0 for RTUNE_DEF_AMP
+*   hyst - relay hysteresis (rpm), or 0 for RTUNE_DEF_HYST
+*
+* Returns:
+*   none
+******************************************************************************/
+void relayTuneStart ( RELAY_TUNE_TYPE *tune, unsigned int ref, byte amp, unsigned int hyst )
+{
+  tune->ref       = ref;
+  tune->amp       = ( amp != 0 ) ? amp : RTUNE_DEF_AMP;
+  tune->hyst      = ( hyst != 0 ) ? hyst : RTUNE_DEF_HYST;
+  tune->phase     = RTUNE_SETTLE;
+  tune->loops     = 0;
+  tune->steady    = 0;
+  tune->sumDuty   = 0;
+  tune->sumPeriod = 0;
+  tune->sumSwing  = 0;
+  tune->cycles    = 0;
+
+  return;
+} // end of relayTuneStart()
+
+/******************************************************************************
+* Function:
+*   relayTuneStep()
+*
+* Description:
+*   Runs one control loop of a relay experiment (Astrom-Hagglund).  While
+*   settling, the PI duty is left alone, and averaged over the last
+*   RTUNE_BIAS_LOOPS for the bias.  Those loops must all have the speed
+*   within the settling band of the reference, since a duty averaged while
+*   the fan is still getting there puts the relay off to one side, and it
+*   never switches.  A slow fan can take well over RTUNE_SETTLE_LOOPS to
+*   settle from a standstill, so settling goes on until it does, for up to
+*   RTUNE_MAX_LOOPS.
+*   Then the relay sets the duty to the
+*   bias plus or minus the amplitude, switching down once the speed rises
+*   above the reference by the hysteresis, and up once it falls below by
+*   the hysteresis.  That drives the fan into a steady oscillation at its
+*   ultimate period.  Each cycle runs from one upward switch to the next,
+*   and its period and peak-to-peak speed are summed, once the first
+*   RTUNE_SKIP_CYCLES have let the oscillation build up.
+*
+* Arguments:
+*   tune - relay experiment
+*   rpm - measured speed of the fan (rpm)
+*   duty - PI duty while settling, set to the relay duty after that
+*
+* Returns:
+*   phase - phase of the experiment (RTUNE_xxx)
+******************************************************************************/
+byte relayTuneStep ( RELAY_TUNE_TYPE *tune, unsigned int rpm, byte *duty )
+{
+  switch ( tune->phase )
+  {
+  case RTUNE_SETTLE: // PI controller holds the fan at the reference
+    if ( ( ++tune->loops <= RTUNE_SETTLE_LOOPS - RTUNE_BIAS_LOOPS ) ||
+         ( (unsigned long) rpm + ( tune->ref >> RTUNE_BAND_SHIFT ) < tune->ref ) || ( rpm > (unsigned long) tune->ref + ( tune->ref >> RTUNE_BAND_SHIFT ) ) )
+    {
+      tune->steady  = 0;
+      tune->sumDuty = 0;
+    }
+    else
+    {
+      tune->steady++;
+      tune->sumDuty += *duty;
+    }
+    if ( tune->loops > RTUNE_MAX_LOOPS )
+      tune->phase = RTUNE_FAILED;
+    if ( tune->steady < RTUNE_BIAS_LOOPS )
+      break;
+
+    /* Start the relay, keeping it symmetric about the bias */
+    tune->bias = (byte) ( tune->sumDuty / RTUNE_BIAS_LOOPS );
+    if ( tune->amp > MAXPIOUTPUT - tune->bias )
+      tune->amp = MAXPIOUTPUT - tune->bias;
+    if ( tune->bias <= MINPIOUTPUT ) // fan can't be held at this speed
+      tune->amp = 0;
+    else if ( tune->amp > tune->bias - MINPIOUTPUT )
+      tune->amp = tune->bias - MINPIOUTPUT;
+    tune->high   = ( rpm < tune->ref );
+    tune->loops  = 0;
+    tune->rpmMax = rpm;
+    tune->rpmMin = rpm;
+    tune->phase  = ( tune->amp > 0 ) ? RTUNE_RELAY : RTUNE_FAILED;
+    break;
+
+  case RTUNE_RELAY: // relay drives the fan into oscillation
+    if ( rpm > tune->rpmMax )
+      tune->rpmMax = rpm;
+    if ( rpm < tune->rpmMin )
+      tune->rpmMin = rpm;
+    if ( tune->high && ( rpm > (unsigned long) tune->ref + tune->hyst ) )
+      tune->high = LOW;
+    else if ( !tune->high && ( (unsigned long) rpm + tune->hyst < tune->ref ) ) // upward switch, ending a cycle
+    {
+      tune->high = HIGH;
+      if ( tune->cycles > RTUNE_SKIP_CYCLES )
+      {
+        tune->sumPeriod += tune->loops - tune->lastUp;
+        tune->sumSwing  += tune->rpmMax - tune->rpmMin;
+      }
+      if ( ++tune->cycles > RTUNE_SKIP_CYCLES + RTUNE_MEAS_CYCLES )
+        tune->phase = RTUNE_DONE;
+      tune->lastUp = tune->loops;
+      tune->rpmMax = rpm;
+      tune->rpmMin = rpm;
+    }
+    if ( ++tune->loops > RTUNE_MAX_LOOPS )
+      tune->phase = RTUNE_FAILED;
+    *duty = tune->high ? tune->bias + tune->amp : tune->bias - tune->amp;
+    break;
+
+  default: // finished
+    break;
+  }
+
+  return tune->phase;
+} // end of relayTuneStep()
+
+/******************************************************************************
+* Function:
+*   relayTuneGains()
+*
+* Description:
+*   Works out PI gains from a finished relay experiment.  The ultimate gain
+*   is the describing function of the relay, 4 * amp / ( pi * a ), where a
+*   is half the mean peak-to-peak swing, and the ultimate period is the mean
+*   cycle period.  The gains follow Tyreus-Luyben, RTUNE_KP_PCT of the
+*   ultimate gain with an integral time of RTUNE_TI_PCT of the ultimate
+*   period.  Ziegler-Nichols (45% and 83%) overshoots badly on the fans,
+*   since the speed filter and the loop delay make them lag-dominant.
+*   Gains too large for the controller are clamped.
+*
+* Arguments:
+*   tune - relay experiment, in the RTUNE_DONE phase
+*   kp - set to the proportional gain (2^-13 duty counts per rpm)
+*   ki - set to the integral gain (2^-17 duty counts per rpm per 100 milliseconds)
+*
+* Returns:
+*   valid - high if the experiment gave gains, low if it didn't finish or the swing was within the hysteresis
+******************************************************************************/
+byte relayTuneGains ( const RELAY_TUNE_TYPE *tune, int *kp, int *ki )
+{
+  unsigned long gain; // gain being worked out
+
+  if ( ( tune->phase != RTUNE_DONE ) ||
+       ( tune->sumSwing <= 2UL * tune->hyst * RTUNE_MEAS_CYCLES ) || ( tune->sumPeriod == 0 ) )
+    return LOW;
+
+  gain = RTUNE_KU_SCALE * tune->amp * RTUNE_MEAS_CYCLES / tune->sumSwing; // ultimate gain
+  gain = gain * RTUNE_KP_PCT / 100;
+  if ( gain > 32767 )
+    gain = 32767;
+  *kp = (int) gain;
+
+  gain = gain * RTUNE_KI_SCALE * 100 * RTUNE_MEAS_CYCLES / ( (unsigned long) RTUNE_TI_PCT * tune->sumPeriod );
+  if ( gain > 32767 )
+    gain = 32767;
+  *ki = (int) gain;
+
+  return HIGH;
+} // end of relayTuneGains()
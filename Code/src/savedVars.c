@@ -12,6 +12,7 @@
 #include <stddef.h>
 #include <string.h>
 #include <avr/eeprom.h>
+#include <avr/pgmspace.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -20,10 +21,11 @@ extern "C" {
 /*******************************************************************************
  * DEFINE THE SAVED VARIABLES TABLE DEFINITION
  ******************************************************************************/
-#define SAVEDVARDEF( a, b, c, d, e, f ) { &a, strcmp (# b, "unsigned" ), sizeof ( b c ), d, e, f },
-const SAVED_VAR_TABLE_TYPE savedVarsTbl [] = { SAVEDVARLIST };
+#define SAVEDVARDEF( a, b, c, d, e, f ) { &a, ( sizeof ( # b ) != sizeof ( "unsigned" ) ), sizeof ( b c ), d, e, f },
+const SAVED_VAR_TABLE_TYPE savedVarsTbl [] PROGMEM = { SAVEDVARLIST }; // stored in flash, read through the SVTBL_xxx() macros
 #undef SAVEDVARDEF
 const size_t               savedVarsTblSize = sizeof ( savedVarsTbl ) / sizeof ( SAVED_VAR_TABLE_TYPE );
+unsigned char              savedVarsGen     = 0; // changes whenever a saved variable is loaded or saved
 
 
 /*******************************************************************************
@@ -67,46 +69,46 @@ static int checkVarRange ( void *varPtr, unsigned int tblInd )
   }
 
   /* Check to make sure data is within valid ranges */
-  if ( savedVarsTbl [ tblInd ].varSigned ) // if this is a signed value
+  if ( SVTBL_SIGNED ( tblInd ) ) // if this is a signed value
   {
-    switch ( savedVarsTbl [ tblInd ].varSize )
+    switch ( SVTBL_SIZE ( tblInd ) )
     {
     case 1:
-      if ( *(int8_t *) varPtr > (int8_t) savedVarsTbl [ tblInd ].varMax )
+      if ( *(int8_t *) varPtr > (int8_t) SVTBL_MAX ( tblInd ) )
       {
-        rtnCode           |= SAVEDVAR_OOR;                            // set return code to indciate variable is outside valid range
-        *(int8_t *) varPtr = (int8_t) savedVarsTbl [ tblInd ].varMax; // set variable to max value
+        rtnCode           |= SAVEDVAR_OOR;                  // set return code to indciate variable is outside valid range
+        *(int8_t *) varPtr = (int8_t) SVTBL_MAX ( tblInd ); // set variable to max value
       }
-      else if ( *(int8_t *) varPtr < (int8_t) savedVarsTbl [ tblInd ].varMin )
+      else if ( *(int8_t *) varPtr < (int8_t) SVTBL_MIN ( tblInd ) )
       {
-        rtnCode           |= SAVEDVAR_OOR;                            // set return code to indciate variable is outside valid range
-        *(int8_t *) varPtr = (int8_t) savedVarsTbl [ tblInd ].varMin; // set variable to min value
+        rtnCode           |= SAVEDVAR_OOR;                  // set return code to indciate variable is outside valid range
+        *(int8_t *) varPtr = (int8_t) SVTBL_MIN ( tblInd ); // set variable to min value
       }
       break;
 
     case 2:
-      if ( *(int *) varPtr > (int) savedVarsTbl [ tblInd ].varMax )
+      if ( *(int *) varPtr > (int) SVTBL_MAX ( tblInd ) )
       {
-        rtnCode        |= SAVEDVAR_OOR;                         // set return code to indciate variable is outside valid range
-        *(int *) varPtr = (int) savedVarsTbl [ tblInd ].varMax; // set variable to max value
+        rtnCode        |= SAVEDVAR_OOR;               // set return code to indciate variable is outside valid range
+        *(int *) varPtr = (int) SVTBL_MAX ( tblInd ); // set variable to max value
       }
-      else if ( *(int *) varPtr < (int) savedVarsTbl [ tblInd ].varMin )
+      else if ( *(int *) varPtr < (int) SVTBL_MIN ( tblInd ) )
       {
-        rtnCode        |= SAVEDVAR_OOR;                         // set return code to indciate variable is outside valid range
-        *(int *) varPtr = (int) savedVarsTbl [ tblInd ].varMin; // set variable to min value
+        rtnCode        |= SAVEDVAR_OOR;               // set return code to indciate variable is outside valid range
+        *(int *) varPtr = (int) SVTBL_MIN ( tblInd ); // set variable to min value
       }
       break;
 
     case 4:
-      if ( *(long *) varPtr > savedVarsTbl [ tblInd ].varMax )
+      if ( *(long *) varPtr > SVTBL_MAX ( tblInd ) )
       {
-        rtnCode         |= SAVEDVAR_OOR;                   // set return code to indciate variable is outside valid range
-        *(long *) varPtr = savedVarsTbl [ tblInd ].varMax; // set variable to max value
+        rtnCode         |= SAVEDVAR_OOR;         // set return code to indciate variable is outside valid range
+        *(long *) varPtr = SVTBL_MAX ( tblInd ); // set variable to max value
       }
-      else if ( *(long *) varPtr < savedVarsTbl [ tblInd ].varMin )
+      else if ( *(long *) varPtr < SVTBL_MIN ( tblInd ) )
       {
-        rtnCode         |= SAVEDVAR_OOR;                   // set return code to indciate variable is outside valid range
-        *(long *) varPtr = savedVarsTbl [ tblInd ].varMin; // set variable to min value
+        rtnCode         |= SAVEDVAR_OOR;         // set return code to indciate variable is outside valid range
+        *(long *) varPtr = SVTBL_MIN ( tblInd ); // set variable to min value
       }
       break;
 
@@ -116,44 +118,44 @@ static int checkVarRange ( void *varPtr, unsigned int tblInd )
   }
   else // if this is an unsigned value
   {
-    switch ( savedVarsTbl [ tblInd ].varSize )
+    switch ( SVTBL_SIZE ( tblInd ) )
     {
     case 1:
-      if ( *(uint8_t *) varPtr > (uint8_t) *(unsigned long *) &( savedVarsTbl [ tblInd ].varMax ) )
+      if ( *(uint8_t *) varPtr > (uint8_t) (unsigned long) SVTBL_MAX ( tblInd ) )
       {
-        rtnCode            |= SAVEDVAR_OOR;                                                     // set return code to indciate variable is outside valid range
-        *(uint8_t *) varPtr = (uint8_t) *(unsigned long *) &( savedVarsTbl [ tblInd ].varMax ); // set variable to max value
+        rtnCode            |= SAVEDVAR_OOR;                                   // set return code to indciate variable is outside valid range
+        *(uint8_t *) varPtr = (uint8_t) (unsigned long) SVTBL_MAX ( tblInd ); // set variable to max value
       }
-      else if ( *(uint8_t *) varPtr < (uint8_t) *(unsigned long *) &( savedVarsTbl [ tblInd ].varMin ) )
+      else if ( *(uint8_t *) varPtr < (uint8_t) (unsigned long) SVTBL_MIN ( tblInd ) )
       {
-        rtnCode            |= SAVEDVAR_OOR;                                                     // set return code to indciate variable is outside valid range
-        *(uint8_t *) varPtr = (uint8_t) *(unsigned long *) &( savedVarsTbl [ tblInd ].varMin ); // set variable to min value
+        rtnCode            |= SAVEDVAR_OOR;                                   // set return code to indciate variable is outside valid range
+        *(uint8_t *) varPtr = (uint8_t) (unsigned long) SVTBL_MIN ( tblInd ); // set variable to min value
       }
       break;
 
     case 2:
-      if ( *(unsigned int *) varPtr > (unsigned int) *(unsigned long *) &( savedVarsTbl [ tblInd ].varMax ) )
+      if ( *(unsigned int *) varPtr > (unsigned int) (unsigned long) SVTBL_MAX ( tblInd ) )
       {
-        rtnCode                 |= SAVEDVAR_OOR;                                                          // set return code to indciate variable is outside valid range
-        *(unsigned int *) varPtr = (unsigned int) *(unsigned long *) &( savedVarsTbl [ tblInd ].varMax ); // set variable to max value
+        rtnCode                 |= SAVEDVAR_OOR;                                        // set return code to indciate variable is outside valid range
+        *(unsigned int *) varPtr = (unsigned int) (unsigned long) SVTBL_MAX ( tblInd ); // set variable to max value
       }
-      else if ( *(unsigned int *) varPtr < (unsigned int) *(unsigned long *) &( savedVarsTbl [ tblInd ].varMin ) )
+      else if ( *(unsigned int *) varPtr < (unsigned int) (unsigned long) SVTBL_MIN ( tblInd ) )
       {
-        rtnCode                 |= SAVEDVAR_OOR;                                                          // set return code to indciate variable is outside valid range
-        *(unsigned int *) varPtr = (unsigned int) *(unsigned long *) &( savedVarsTbl [ tblInd ].varMin ); // set variable to min value
+        rtnCode                 |= SAVEDVAR_OOR;                                        // set return code to indciate variable is outside valid range
+        *(unsigned int *) varPtr = (unsigned int) (unsigned long) SVTBL_MIN ( tblInd ); // set variable to min value
       }
       break;
 
     case 4:
-      if ( *(unsigned long *) varPtr > (unsigned long) *(unsigned long *) &( savedVarsTbl [ tblInd ].varMax ) )
+      if ( *(unsigned long *) varPtr > (unsigned long) SVTBL_MAX ( tblInd ) )
       {
-        rtnCode                  |= SAVEDVAR_OOR;                                                           // set return code to indciate variable is outside valid range
-        *(unsigned long *) varPtr = (unsigned long) *(unsigned long *) &( savedVarsTbl [ tblInd ].varMax ); // set variable to max value
+        rtnCode                  |= SAVEDVAR_OOR;                         // set return code to indciate variable is outside valid range
+        *(unsigned long *) varPtr = (unsigned long) SVTBL_MAX ( tblInd ); // set variable to max value
       }
-      else if ( *(unsigned long *) varPtr < (unsigned long) *(unsigned long *) &( savedVarsTbl [ tblInd ].varMin ) )
+      else if ( *(unsigned long *) varPtr < (unsigned long) SVTBL_MIN ( tblInd ) )
       {
-        rtnCode                  |= SAVEDVAR_OOR;                                                           // set return code to indciate variable is outside valid range
-        *(unsigned long *) varPtr = (unsigned long) *(unsigned long *) &( savedVarsTbl [ tblInd ].varMin ); // set variable to min value
+        rtnCode                  |= SAVEDVAR_OOR;                         // set return code to indciate variable is outside valid range
+        *(unsigned long *) varPtr = (unsigned long) SVTBL_MIN ( tblInd ); // set variable to min value
       }
       break;
 
@@ -191,25 +193,26 @@ int loadVar ( void *varPtr ) // if the pointer matches one of the items in the t
 
   for ( tblCnt = 0; tblCnt < savedVarsTblSize; tblCnt++ ) // look at each table entry
   {
-    if ( savedVarsTbl [ tblCnt ].varPtr == varPtr ) // check to see if the pointer matches one from the table
+    if ( SVTBL_PTR ( tblCnt ) == varPtr ) // check to see if the pointer matches one from the table
     {
       rtnCode = SAVEVAR_SUCCESS; // set return code to indicate successfully found variable
-      if ( savedVarsTbl [ tblCnt ].varSize > MAXVARSIZE )
+      if ( SVTBL_SIZE ( tblCnt ) > MAXVARSIZE )
       {
         rtnCode |= INVALID_SIZE; // set return code to indciate variable is too large
         return rtnCode;          // exit the function
       }
-      if ( ( tblCnt * MAXVARSIZE ) + savedVarsTbl [ tblCnt ].varSize > EEPRMAXBYTES )
+      if ( ( tblCnt * MAXVARSIZE ) + SVTBL_SIZE ( tblCnt ) > EEPRMAXBYTES )
       {
         rtnCode |= INVALID_ADDR; // set return code to indciate variable has invalid EEPROM address
         return rtnCode;          // exit the function
       }
 
       /* Read the data */
-      eeprom_read_block ( varPtr, (const void *) ( tblCnt * MAXVARSIZE ), savedVarsTbl [ tblCnt ].varSize );
+      eeprom_read_block ( varPtr, (const void *) ( tblCnt * MAXVARSIZE ), SVTBL_SIZE ( tblCnt ) );
 
       /* check to ensure the data is within valid range */
       rtnCode |= checkVarRange ( varPtr, tblCnt ); // check variable range
+      savedVarsGen++;                              // values worked out from this variable are stale
 
       break; // exit the loop, since we already found the table item and loaded it
     }
@@ -244,15 +247,15 @@ int saveVar ( void *varPtr ) // if the pointer matches one of the items in the t
 
   for ( tblCnt = 0; tblCnt < savedVarsTblSize; tblCnt++ ) // look at each table entry
   {
-    if ( savedVarsTbl [ tblCnt ].varPtr == varPtr ) // check to see if the pointer matches one from the table
+    if ( SVTBL_PTR ( tblCnt ) == varPtr ) // check to see if the pointer matches one from the table
     {
       rtnCode = SAVEVAR_SUCCESS; // set return code to indicate successfully found variable
-      if ( savedVarsTbl [ tblCnt ].varSize > MAXVARSIZE )
+      if ( SVTBL_SIZE ( tblCnt ) > MAXVARSIZE )
       {
         rtnCode |= INVALID_SIZE; // set return code to indciate variable is too large
         return rtnCode;          // exit the function
       }
-      if ( ( tblCnt * MAXVARSIZE ) + savedVarsTbl [ tblCnt ].varSize > EEPRMAXBYTES )
+      if ( ( tblCnt * MAXVARSIZE ) + SVTBL_SIZE ( tblCnt ) > EEPRMAXBYTES )
       {
         rtnCode |= INVALID_ADDR; // set return code to indciate variable has invalid EEPROM address
         return rtnCode;          // exit the function
@@ -262,7 +265,8 @@ int saveVar ( void *varPtr ) // if the pointer matches one of the items in the t
       rtnCode |= checkVarRange ( varPtr, tblCnt ); // check variable range
 
       /* Write the data */
-      eeprom_write_block ( varPtr, (void *) ( tblCnt * MAXVARSIZE ), savedVarsTbl [ tblCnt ].varSize );
+      eeprom_write_block ( varPtr, (void *) ( tblCnt * MAXVARSIZE ), SVTBL_SIZE ( tblCnt ) );
+      savedVarsGen++; // values worked out from this variable are stale
 
       break; // exit the loop, since we already found the table item and loaded it
     }
@@ -302,9 +306,9 @@ int loadAllVars ( void )
   /* Check code version variable to see if it has changed, and variables need re-loaded */
   for ( tblCnt = 0; tblCnt < savedVarsTblSize; tblCnt++ ) // look at each table entry
   {
-    if ( savedVarsTbl [ tblCnt ].varPtr == &codeVer ) // if we are looking at the codeVer entry
+    if ( SVTBL_PTR ( tblCnt ) == &codeVer ) // if we are looking at the codeVer entry
     {
-      if ( codeVer != *(unsigned long *) &( savedVarsTbl [ tblCnt ].varDef ) ) // if code versions don't match table default
+      if ( codeVer != (unsigned long) SVTBL_DEF ( tblCnt ) ) // if code versions don't match table default
       {
         rtnCode |= saveDefVars ( ); // load and save default values for all variables
         return rtnCode;             // exit function
@@ -316,7 +320,7 @@ int loadAllVars ( void )
   /* Code version matched, so we can go ahead and load all variables from EEPROM */
   for ( tblCnt = 0; tblCnt < savedVarsTblSize; tblCnt++ ) // look at each table entry
   {
-    rtnCode |= loadVar ( savedVarsTbl [ tblCnt ].varPtr ); // load the value from this table entry
+    rtnCode |= loadVar ( SVTBL_PTR ( tblCnt ) ); // load the value from this table entry
   }
 
   return rtnCode;
@@ -345,27 +349,29 @@ int saveDefVars ( void )
 {
   int          rtnCode = SAVEVAR_SUCCESS; // value to return upon exit.  start assuming we don't find the table entry
   unsigned int tblCnt;                    // loop count variable
+  void        *varPtr;                    // pointer to RAM variable of the table entry
 
   for ( tblCnt = 0; tblCnt < savedVarsTblSize; tblCnt++ ) // look at each table entry
   {
+    varPtr = SVTBL_PTR ( tblCnt );
 
-    if ( savedVarsTbl [ tblCnt ].varSigned ) // if this is a signed value
+    if ( SVTBL_SIGNED ( tblCnt ) ) // if this is a signed value
     {
-      switch ( savedVarsTbl [ tblCnt ].varSize )
+      switch ( SVTBL_SIZE ( tblCnt ) )
       {
       case 1:
-        *(int8_t *) savedVarsTbl [ tblCnt ].varPtr = (int8_t) savedVarsTbl [ tblCnt ].varDef;    // set default value
-        rtnCode                                   |= saveVar ( savedVarsTbl [ tblCnt ].varPtr ); // save value in EEPROM
+        *(int8_t *) varPtr = (int8_t) SVTBL_DEF ( tblCnt ); // set default value
+        rtnCode           |= saveVar ( varPtr );            // save value in EEPROM
         break;
 
       case 2:
-        *(int *) savedVarsTbl [ tblCnt ].varPtr = (int) savedVarsTbl [ tblCnt ].varDef;       // set default value
-        rtnCode                                |= saveVar ( savedVarsTbl [ tblCnt ].varPtr ); // save value in EEPROM
+        *(int *) varPtr = (int) SVTBL_DEF ( tblCnt ); // set default value
+        rtnCode        |= saveVar ( varPtr );         // save value in EEPROM
         break;
 
       case 4:
-        *(long *) savedVarsTbl [ tblCnt ].varPtr = savedVarsTbl [ tblCnt ].varDef;             // set default value
-        rtnCode                                 |= saveVar ( savedVarsTbl [ tblCnt ].varPtr ); // save value in EEPROM
+        *(long *) varPtr = SVTBL_DEF ( tblCnt ); // set default value
+        rtnCode         |= saveVar ( varPtr );   // save value in EEPROM
         break;
 
       default:
@@ -374,21 +380,21 @@ int saveDefVars ( void )
     }
     else // if this is an unsigned value
     {
-      switch ( savedVarsTbl [ tblCnt ].varSize )
+      switch ( SVTBL_SIZE ( tblCnt ) )
       {
       case 1:
-        *(uint8_t *) savedVarsTbl [ tblCnt ].varPtr = (uint8_t) savedVarsTbl [ tblCnt ].varDef;   // set default value
-        rtnCode                                    |= saveVar ( savedVarsTbl [ tblCnt ].varPtr ); // save value in EEPROM
+        *(uint8_t *) varPtr = (uint8_t) SVTBL_DEF ( tblCnt ); // set default value
+        rtnCode            |= saveVar ( varPtr );             // save value in EEPROM
         break;
 
       case 2:
-        *(unsigned int *) savedVarsTbl [ tblCnt ].varPtr = (unsigned int) savedVarsTbl [ tblCnt ].varDef; // set default value
-        rtnCode                                         |= saveVar ( savedVarsTbl [ tblCnt ].varPtr );    // save value in EEPROM
+        *(unsigned int *) varPtr = (unsigned int) SVTBL_DEF ( tblCnt ); // set default value
+        rtnCode                 |= saveVar ( varPtr );                  // save value in EEPROM
         break;
 
       case 4:
-        *(unsigned long *) savedVarsTbl [ tblCnt ].varPtr = (unsigned long) savedVarsTbl [ tblCnt ].varDef; // set default value
-        rtnCode                                          |= saveVar ( savedVarsTbl [ tblCnt ].varPtr );     // save value in EEPROM
+        *(unsigned long *) varPtr = (unsigned long) SVTBL_DEF ( tblCnt ); // set default value
+        rtnCode                  |= saveVar ( varPtr );                   // save value in EEPROM
         break;
 
       default:
@@ -0,0 +1,287 @@
+/*
+ * sysTimer.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+
+/*******************************************************************************
+ * INCLUDED HEADER FILES
+ ******************************************************************************/
+#include "sysTimer.h"
+#include <avr/interrupt.h>
+#include <avr/sleep.h>
+
+/*******************************************************************************
+ * GLOBAL VARIABLE DEFINITIONS
+ ******************************************************************************/
+static volatile byte          sysTicksPending = 0; // number of scheduler ticks which have occurred but not yet been handled by the main loop
+static volatile unsigned long sysTimerOvfCnt  = 0; // number of timer1 overflows, used to extend timer1 count to 48 bits
+static volatile unsigned int  sysTimerEpoch   = 0; // number of times the overflow count has wrapped (about every 4.5 years), used to extend timer1 count to 64 bits
+
+/*******************************************************************************
+ * FUNCTION DEFINITIONS
+ ******************************************************************************/
+
+/******************************************************************************
+* Function:
+*   sysTimerInit()
+*
+* Description:
+*   Configures timer1 as a free-running 16-bit counter, and uses output compare
+*   A to generate an interrupt once every scheduler tick (SYSTICK_US).  The
+*   compare value is advanced by a fixed amount in each interrupt, so the tick
+*   period does not depend on interrupt latency or on how long the previous
+*   tick's tasks took.
+*
+*   The Arduino core sets timer1 up for 8-bit PWM on pins 9 & 10.  Those pins
+*   are used by the LCD, so timer1 is free to be re-purposed here.
+*
+* Arguments:
+*   none
+*
+* Returns:
+*   none
+******************************************************************************/
+void sysTimerInit ( void )
+{
+  byte oldSREG = SREG; // save interrupt state
+
+  cli ( ); // don't allow interrupts while configuring the timer
+
+  TCCR1A = 0;                              // normal mode, OC1A/OC1B disconnected from pins
+  TCCR1B = _BV ( CS11 );                   // prescale by 8, counting continuously from 0 to 0xFFFF
+  OCR1A  = TCNT1 + SYSTICK_CNTS;           // first tick occurs one tick period from now
+  TIFR1  = _BV ( OCF1A ) | _BV ( TOV1 );   // clear any pending compare and overflow flags
+  TIMSK1 = _BV ( OCIE1A ) | _BV ( TOIE1 ); // enable compare A interrupt (the scheduler tick) and overflow interrupt (count extension)
+
+  sysTicksPending = 0; // no ticks pending yet
+
+  SREG = oldSREG; // restore interrupt state
+
+  return;
+} // end of sysTimerInit()
+
+/******************************************************************************
+* Function:
+*   sysTimerWaitTick()
+*
+* Description:
+*   Puts the processor in idle sleep mode until the next scheduler tick occurs.
+*   Other interrupts (hall sensors, serial, etc) will wake the core, but it is
+*   put back to sleep until the tick has arrived.  If one or more ticks have
+*   already occurred since the last call, this returns immediately.
+*
+* Arguments:
+*   none
+*
+* Returns:
+*   ticks - number of scheduler ticks since the last call.  Anything larger
+*           than one means the previous tick's tasks overran the tick period.
+******************************************************************************/
+byte sysTimerWaitTick ( void )
+{
+  byte ticks; // number of ticks elapsed
+
+  set_sleep_mode ( SLEEP_MODE_IDLE ); // idle mode keeps timers, serial and external interrupts running
+
+  cli ( ); // check the pending count with interrupts off, so a tick cannot sneak in before sleeping
+  while ( sysTicksPending == 0 )
+  {
+    sleep_enable ( );
+    sei ( );           // the instruction following sei() always executes, so the core sleeps before any interrupt is serviced
+    sleep_cpu ( );     // sleep until an interrupt occurs
+    sleep_disable ( );
+    cli ( );
+  }
+  ticks           = sysTicksPending; // read number of ticks elapsed
+  sysTicksPending = 0;               // mark them as handled
+  sei ( );
+
+  return ticks;
+} // end of sysTimerWaitTick()
+
+/******************************************************************************
+* Function:
+*   ISR(TIMER1_COMPA_vect)
+*
+* Description:
+*   Timer1 compare A interrupt.  Schedules the next tick exactly one tick
+*   period after this one and flags the tick for the main loop.
+*
+* Arguments:
+*   none
+*
+* Returns:
+*   none
+******************************************************************************/
+ISR ( TIMER1_COMPA_vect )
+{
+  OCR1A += SYSTICK_CNTS; // schedule next tick (wraps along with the 16-bit counter)
+
+  if ( sysTicksPending < 0xFF ) // don't let pending count overflow
+    sysTicksPending++;
+
+  return;
+} // end of ISR(TIMER1_COMPA_vect)
+
+/******************************************************************************
+* Function:
+*   sysTimerRead()
+*
+* Description:
+*   Reads the timer1 count along with the overflow count and epoch which
+*   extend it.  If an overflow has happened but its interrupt has not been
+*   serviced yet (we may be inside another interrupt, or interrupts may be
+*   off), it is accounted for here.
+*
+* Arguments:
+*   ovfCnt - returns the overflow count (bits 16-47 of extended count)
+*   epoch - returns the epoch (bits 48-63 of extended count)
+*
+* Returns:
+*   countLo - timer1 hardware count (bits 0-15 of extended count)
+******************************************************************************/
+static unsigned int sysTimerRead ( unsigned long *ovfCnt, unsigned int *epoch )
+{
+  byte         oldSREG = SREG; // save interrupt state
+  unsigned int countLo;        // timer1 hardware count
+
+  cli ( );
+  countLo = TCNT1;
+  *ovfCnt = sysTimerOvfCnt;
+  *epoch  = sysTimerEpoch;
+  if ( ( TIFR1 & _BV ( TOV1 ) ) && ( countLo < 0x8000 ) ) // overflow pending, and TCNT1 was read after it occurred
+  {
+    if ( ++( *ovfCnt ) == 0 ) // account for pending overflow, and for the overflow count wrapping
+      ( *epoch )++;
+  }
+  SREG = oldSREG; // restore interrupt state
+
+  return countLo;
+} // end of sysTimerRead()
+
+/******************************************************************************
+* Function:
+*   sysTimerCount()
+*
+* Description:
+*   Returns the timer1 count, extended to 32 bits using the count of timer1
+*   overflows.  This wraps about every 36 minutes, so it should only be used
+*   for measuring intervals.
+*
+* Arguments:
+*   none
+*
+* Returns:
+*   count - 32-bit timer1 count (SYSTIMER_PRESCALE cpu cycles per count)
+******************************************************************************/
+unsigned long sysTimerCount ( void )
+{
+  unsigned long ovfCnt;  // overflow count
+  unsigned int  epoch;   // epoch (not used)
+  unsigned int  countLo; // timer1 hardware count
+
+  countLo = sysTimerRead ( &ovfCnt, &epoch );
+
+  return ( ovfCnt << 16 ) | countLo;
+} // end of sysTimerCount()
+
+/******************************************************************************
+* Function:
+*   sysTimerCount64()
+*
+* Description:
+*   Returns the timer1 count, extended to 64 bits using the count of timer1
+*   overflows and the epoch.  This never wraps in practice.  64-bit arithmetic
+*   is slow on this processor, so sysTimerCount() is preferred for intervals.
+*
+* Arguments:
+*   none
+*
+* Returns:
+*   count - 64-bit timer1 count (SYSTIMER_PRESCALE cpu cycles per count)
+******************************************************************************/
+unsigned long long sysTimerCount64 ( void )
+{
+  unsigned long ovfCnt;  // overflow count
+  unsigned int  epoch;   // epoch
+  unsigned int  countLo; // timer1 hardware count
+
+  countLo = sysTimerRead ( &ovfCnt, &epoch );
+
+  return ( (unsigned long long) epoch << 48 ) | ( (unsigned long long) ovfCnt << 16 ) | countLo;
+} // end of sysTimerCount64()
+
+/******************************************************************************
+* Function:
+*   sysTimerExtend()
+*
+* Description:
+*   Extends a 16-bit timer1 value captured in hardware (eg. ICR1) to a 32-bit
+*   count, by taking the current 32-bit count and stepping back by the 16-bit
+*   difference.  The capture must have happened less than one timer1 wrap
+*   (32.768 ms) ago.
+*
+* Arguments:
+*   capture - 16-bit timer1 value
+*
+* Returns:
+*   count - 32-bit timer1 count at which the value was captured
+******************************************************************************/
+unsigned long sysTimerExtend ( unsigned int capture )
+{
+  unsigned long now = sysTimerCount ( ); // current 32-bit count
+
+  return now - ( ( now - capture ) & 0xFFFF ); // step back by the counts since the capture, which wrap at 16 bits like timer1
+} // end of sysTimerExtend()
+
+/******************************************************************************
+* Function:
+*   sysTimerCaptureInit()
+*
+* Description:
+*   Enables the timer1 input capture unit on the ICP1 pin (pin 8), with the
+*   noise canceller on, capturing rising edges first.  The capture interrupt
+*   (TIMER1_CAPT_vect) must be defined by the user of the capture unit.
+*
+* Arguments:
+*   none
+*
+* Returns:
+*   none
+******************************************************************************/
+void sysTimerCaptureInit ( void )
+{
+  byte oldSREG = SREG; // save interrupt state
+
+  cli ( );
+  TCCR1B |= _BV ( ICNC1 ) | _BV ( ICES1 ); // noise canceller on (adds 4 cpu cycles of fixed delay), capture on rising edge
+  TIFR1   = _BV ( ICF1 );                  // clear any pending capture
+  TIMSK1 |= _BV ( ICIE1 );                 // enable capture interrupt
+  SREG    = oldSREG;                       // restore interrupt state
+
+  return;
+} // end of sysTimerCaptureInit()
+
+/******************************************************************************
+* Function:
+*   ISR(TIMER1_OVF_vect)
+*
+* Description:
+*   Timer1 overflow interrupt.  Counts overflows, and epochs of the overflow
+*   count, to extend timer1 to 64 bits.
+*
+* Arguments:
+*   none
+*
+* Returns:
+*   none
+******************************************************************************/
+ISR ( TIMER1_OVF_vect )
+{
+  if ( ++sysTimerOvfCnt == 0 ) // overflow count wrapped
+    sysTimerEpoch++;
+
+  return;
+} // end of ISR(TIMER1_OVF_vect)
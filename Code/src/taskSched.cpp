@@ -0,0 +1,92 @@
+/*
+ * taskSched.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+
+/*******************************************************************************
+ * INCLUDED HEADER FILES
+ ******************************************************************************/
+#include "taskSched.h"
+
+/*******************************************************************************
+ * DEFINE THE TASK TABLE
+ ******************************************************************************/
+#define TASKDEF( a, b, c ) { a, b, c },
+static const TASK_TABLE_TYPE taskTbl [] = { TASKLIST };
+#undef TASKDEF
+#define NUMTASKS ( sizeof ( taskTbl ) / sizeof ( TASK_TABLE_TYPE ) )
+
+/*******************************************************************************
+ * STATIC VARIABLE DEFINITIONS
+ ******************************************************************************/
+static byte taskCnt [ NUMTASKS ]; // number of ticks remaining until each task is due
+
+/*******************************************************************************
+ * FUNCTION DEFINITIONS
+ ******************************************************************************/
+
+/******************************************************************************
+* Function:
+*   taskSchedInit()
+*
+* Description:
+*   Resets the countdown of each task, so it first runs on the tick given by
+*   its phase offset.
+*
+* Arguments:
+*   none
+*
+* Returns:
+*   none
+******************************************************************************/
+void taskSchedInit ( void )
+{
+  byte cnt; // loop count variable
+
+  for ( cnt = 0; cnt < NUMTASKS; cnt++ )
+    taskCnt [ cnt ] = taskTbl [ cnt ].phase + 1; // first tick counted is tick number zero
+
+  return;
+} // end of taskSchedInit()
+
+/******************************************************************************
+* Function:
+*   taskSchedRun()
+*
+* Description:
+*   Counts down each task by the number of elapsed ticks, and runs the tasks
+*   which became due.  If ticks were missed because of an overrun, a task is
+*   still only run once, rather than being run back-to-back to catch up.
+*
+* Arguments:
+*   ticks - number of scheduler ticks elapsed since the last call
+*
+* Returns:
+*   none
+******************************************************************************/
+void taskSchedRun ( byte ticks )
+{
+  byte cnt;  // loop count variable
+  byte tick; // loop count variable
+  byte due;  // high when the task is due to run
+
+  for ( cnt = 0; cnt < NUMTASKS; cnt++ ) // look at each task
+  {
+    due = LOW;
+    for ( tick = 0; tick < ticks; tick++ ) // count down once for each elapsed tick
+    {
+      if ( --taskCnt [ cnt ] == 0 )
+      {
+        taskCnt [ cnt ] = taskTbl [ cnt ].period; // reload countdown
+        due             = HIGH;                   // task is due
+      }
+    }
+
+    if ( due )
+      taskTbl [ cnt ].taskFunc ( ); // run the task
+  }
+
+  return;
+} // end of taskSchedRun()
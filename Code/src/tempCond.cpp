@@ -0,0 +1,158 @@
+/*
+ * tempCond.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+
+/*******************************************************************************
+ * INCLUDED HEADER FILES
+ ******************************************************************************/
+#include "tempCond.h"
+#include "savedVars.h"
+
+/*******************************************************************************
+ * GLOBAL VARIABLE DEFINITIONS
+ ******************************************************************************/
+TEMP_COND_TYPE temp1Cond; // conditioning stage of temperature sensor 1
+TEMP_COND_TYPE temp2Cond; // conditioning stage of temperature sensor 2
+
+/*******************************************************************************
+ * FUNCTION DEFINITIONS
+ ******************************************************************************/
+
+/******************************************************************************
+* Function:
+*   tempCondMedian()
+*
+* Description:
+*   Returns the median of the newest readings in the history.  At most
+*   TEMPCOND_MED_MAX readings are sorted, so this runs in bounded time.
+*
+* Arguments:
+*   cond - conditioning stage holding the history
+*   num - number of newest readings to take the median of (1 to histCnt)
+*
+* Returns:
+*   median - median raw reading
+******************************************************************************/
+static unsigned int tempCondMedian ( const TEMP_COND_TYPE *cond, byte num )
+{
+  unsigned int sorted [ TEMPCOND_MED_MAX ]; // newest readings, in order
+  unsigned int val;                         // reading being inserted
+  byte         cnt;                         // loop count variable
+  byte         pos;                         // position for insertion sort
+
+  for ( cnt = 0; cnt < num; cnt++ )
+  {
+    val = cond->hist [ ( cond->histIdx + TEMPCOND_MED_MAX - 1 - cnt ) % TEMPCOND_MED_MAX ]; // cnt readings back from the newest
+    pos = cnt;
+    while ( pos > 0 && sorted [ pos - 1 ] > val )
+    {
+      sorted [ pos ] = sorted [ pos - 1 ];
+      pos--;
+    }
+    sorted [ pos ] = val;
+  }
+
+  return sorted [ num >> 1 ];
+} // end of tempCondMedian()
+
+/******************************************************************************
+* Function:
+*   tempCondUpdate()
+*
+* Description:
+*   Runs a new raw reading through the conditioning stage.  A median of the
+*   last tmpMedN readings throws out single-reading spikes, and a first order
+*   filter with gain tmpFilt smooths what is left.  The filter state has
+*   TEMPCOND_FRAC_BITS fraction bits, and always moves by at least one of
+*   them towards the median, so even the slowest setting settles on it.
+*
+*   The median is checked against the tmpMinRaw and tmpMaxRaw limits (an
+*   open or shorted sensor reads near a rail), and against a change of more
+*   than tmpMaxStep since the last update (a loose connection jumps around).
+*   A failed check faults the sensor, and the filter output is held at its
+*   last good value.  The fault clears after TEMPCOND_CLEAR_LOOPS good
+*   readings in a row, and the filter restarts from the median, so it doesn't
+*   have to slew back from the held value.
+*
+* Arguments:
+*   cond - conditioning stage of the sensor
+*   raw - new raw temperature reading (0-TEMP_DIG_MAX)
+*
+* Returns:
+*   temp - filtered temperature, stored digitally (0-TEMP_DIG_MAX)
+******************************************************************************/
+unsigned int tempCondUpdate ( TEMP_COND_TYPE *cond, unsigned int raw )
+{
+  unsigned int med;    // median of the newest readings
+  byte         num;    // number of readings to take the median of
+  byte         bad;    // high if this reading fails a check
+  unsigned int step;   // change in median since the last update
+  long int     delta;  // median less the filter state
+  long int     change; // change in the filter state
+
+  /* Add the reading to the history */
+  cond->hist [ cond->histIdx ] = raw;
+  cond->histIdx                = ( cond->histIdx + 1 ) % TEMPCOND_MED_MAX;
+  if ( cond->histCnt < TEMPCOND_MED_MAX )
+    cond->histCnt++;
+
+  /* Take the median of the newest readings */
+  num = ( tmpMedN < cond->histCnt ) ? tmpMedN : cond->histCnt;
+  med = tempCondMedian ( cond, num );
+
+  /* Check for an open or shorted sensor */
+  step = ( med >= cond->lastMed ) ? med - cond->lastMed : cond->lastMed - med;
+  bad  = ( med < tmpMinRaw ) || ( med > tmpMaxRaw ) ||   // reading near a rail
+    ( ( cond->histCnt > 1 ) && ( step > tmpMaxStep ) ); // reading jumped since last time
+  cond->lastMed = med;
+
+  if ( bad )
+  {
+    if ( !cond->fault ) // new fault
+      cond->faults++;
+    cond->fault   = HIGH;
+    cond->goodCnt = 0;
+  }
+  else if ( cond->fault ) // faulted, but this reading is good
+  {
+    if ( ++cond->goodCnt >= TEMPCOND_CLEAR_LOOPS )
+    {
+      cond->fault = LOW;
+      cond->filt  = (unsigned long) med << TEMPCOND_FRAC_BITS; // restart filter from here
+    }
+  }
+  else if ( cond->histCnt == 1 )                             // first reading
+    cond->filt = (unsigned long) med << TEMPCOND_FRAC_BITS; // start filter from here
+  else
+  {
+    delta  = (long int) ( (unsigned long) med << TEMPCOND_FRAC_BITS ) - (long int) cond->filt;
+    change = ( delta * (long int) ( 1024 - tmpFilt ) ) >> 10; // shift rounds down, so a fall always moves
+    if ( ( change == 0 ) && ( delta > 0 ) )                   // rise too small to move a slow filter
+      change = 1;
+    cond->filt += change;
+  }
+
+  return (unsigned int) ( ( cond->filt + ( 1UL << ( TEMPCOND_FRAC_BITS - 1 ) ) ) >> TEMPCOND_FRAC_BITS ); // rounded filter output
+} // end of tempCondUpdate()
+
+/******************************************************************************
+* Function:
+*   tempCondFault()
+*
+* Description:
+*   Returns high if the sensor is faulted, in which case the filtered
+*   temperature is only the last good value.
+*
+* Arguments:
+*   cond - conditioning stage of the sensor
+*
+* Returns:
+*   fault - high if the sensor is faulted
+******************************************************************************/
+byte tempCondFault ( const TEMP_COND_TYPE *cond )
+{
+  return cond->fault;
+} // end of tempCondFault()
@@ -0,0 +1,114 @@
+/*
+ * tempDisp.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+
+/*******************************************************************************
+ * INCLUDED HEADER FILES
+ ******************************************************************************/
+#include "tempDisp.h"
+#include "savedVars.h"
+
+/*******************************************************************************
+ * TYPE DEFINITIONS
+ ******************************************************************************/
+/* Cached conversion of one sensor, along with the settings it was built from */
+typedef struct TEMP_DISP {
+  long int     slope; // digital value multiplier
+  long int     zero;  // subtracted from the product (sensor offset times slope)
+  int          ofs;   // sensor offset the cache was built from
+  int          gain;  // sensor gain the cache was built from
+  byte         valid; // high once the cache has been built
+} TEMP_DISP_TYPE;
+
+/*******************************************************************************
+ * STATIC VARIABLE DEFINITIONS
+ ******************************************************************************/
+static int *const     dispOfs [ TEMPDISP_NUM ]  = { &Temp1Offset, &Temp2Offset };       // saved offset of each sensor
+static int *const     dispGain [ TEMPDISP_NUM ] = { &Temp1DegCPer5V, &Temp2DegCPer5V }; // saved gain of each sensor
+static TEMP_DISP_TYPE dispCache [ TEMPDISP_NUM ];                                       // cached conversion of each sensor
+
+/*******************************************************************************
+ * FUNCTION DEFINITIONS
+ ******************************************************************************/
+
+/******************************************************************************
+* Function:
+*   tempDispX10()
+*
+* Description:
+*   Converts a digital temperature to display units times 10, giving exactly
+*   the same result as the DigTempXToC10() and DigTempXToF10() macros.  Up to
+*   its shift, DigTempToC10x16() is linear in the reading, so its constants
+*   (including the divide by 500 in the offset) are worked out once and
+*   cached.  The cache is rebuilt only when the sensor offset or gain
+*   changes, so each conversion after that is one multiply, subtract and
+*   shift, and for degF the same "* 9 / 5" after the shift as the macro.
+*
+* Arguments:
+*   sensor - sensor whose offset and gain the reading is converted with
+*   raw - digital temperature (0-TEMP_DIG_MAX)
+*
+* Returns:
+*   tempX10 - temperature in degC or degF (as set by useFtemp) times 10
+******************************************************************************/
+int tempDispX10 ( TEMPDISP_ENUM_TYPE sensor, unsigned int raw )
+{
+  TEMP_DISP_TYPE *cache = &dispCache [ sensor ]; // cached conversion of this sensor
+  long int        c10x16;                        // temperature in degC times 160, as DigTempToC10x16()
+  int             tempX10;                       // temperature in display units times 10
+
+  if ( !cache->valid || ( cache->ofs != *dispOfs [ sensor ] ) || ( cache->gain != *dispGain [ sensor ] ) ) // settings have changed, so rebuild cache
+  {
+    cache->ofs   = *dispOfs [ sensor ];
+    cache->gain  = *dispGain [ sensor ];
+    cache->valid = HIGH;
+    cache->slope = 10L * cache->gain;
+    cache->zero  = ( ( (long int) cache->ofs << TEMP_DIG_BITS ) / 500 ) * cache->gain; // same offset as DigTempToC10x16()
+  }
+
+  c10x16 = ( (long int) raw * cache->slope - cache->zero ) >> ( TEMP_DIG_BITS - 4 );
+  if ( useFtemp )
+    tempX10 = (int) ( ( ( c10x16 * 9 / 5 ) >> 4 ) + 320 ); // as DigTempXToF10()
+  else
+    tempX10 = (int) ( c10x16 >> 4 );                       // as DigTempXToC10()
+
+  return tempX10;
+} // end of tempDispX10()
+
+/******************************************************************************
+* Function:
+*   tempDispSplit()
+*
+* Description:
+*   Converts a digital temperature to whole and tenths of display units,
+*   for printing as "%3hu.%hu".  The whole part is rounded toward zero, as
+*   with "/ 10", and the tenths are always positive.  The divide by 10 is
+*   done as a multiply by 6554 / 65536, which is exact up to
+*   TEMPDISP_MAX_X10.
+*
+* Arguments:
+*   sensor - sensor whose offset and gain the reading is converted with
+*   raw - digital temperature (0-TEMP_DIG_MAX)
+*   whole - set to the whole part
+*   tenth - set to the tenths (0-9)
+*
+* Returns:
+*   none
+******************************************************************************/
+void tempDispSplit ( TEMPDISP_ENUM_TYPE sensor, unsigned int raw, int *whole, byte *tenth )
+{
+  int          tempX10 = tempDispX10 ( sensor, raw );          // temperature times 10
+  unsigned int mag     = ( tempX10 < 0 ) ? -tempX10 : tempX10; // magnitude of temperature times 10
+  unsigned int quot;                                           // magnitude divided by 10
+
+  if ( mag > TEMPDISP_MAX_X10 ) // too large for the divide below, and wouldn't fit on the screen anyway
+    mag = TEMPDISP_MAX_X10;
+  quot   = (unsigned int) ( ( (unsigned long) mag * 6554UL ) >> 16 );
+  *tenth = (byte) ( mag - quot * 10 );
+  *whole = ( tempX10 < 0 ) ? -(int) quot : (int) quot;
+
+  return;
+} // end of tempDispSplit()
@@ -0,0 +1,203 @@
+/*
+ * tempFuse.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+
+/*******************************************************************************
+ * INCLUDED HEADER FILES
+ ******************************************************************************/
+#include "tempFuse.h"
+#include "tempCond.h"
+#include "dsTemp.h"
+
+/*******************************************************************************
+ * FUNCTION DEFINITIONS
+ ******************************************************************************/
+
+/******************************************************************************
+* Function:
+*   tempFuseInput()
+*
+* Description:
+*   Reads one temperature input, and whether it is faulted
+*
+* Arguments:
+*   in - input to read
+*   fault - set high if the input is faulted (left alone otherwise)
+*
+* Returns:
+*   temp - temperature of the input, stored digitally (0-TEMP_DIG_MAX)
+******************************************************************************/
+static unsigned int tempFuseInput ( byte in, byte *fault )
+{
+  switch ( in )
+  {
+  case TFUSE_TMP1: // analog sensor 1
+    if ( tempCondFault ( &temp1Cond ) )
+      *fault = HIGH;
+    return Temp1;
+
+  case TFUSE_TMP2: // analog sensor 2
+    if ( tempCondFault ( &temp2Cond ) )
+      *fault = HIGH;
+    return Temp2;
+
+  case TFUSE_OW1: // first 1-Wire sensor
+    if ( dsTempFault ( 0 ) )
+      *fault = HIGH;
+    return dsTempRead ( 0 );
+
+  default: // second 1-Wire sensor
+    if ( dsTempFault ( 1 ) )
+      *fault = HIGH;
+    return dsTempRead ( 1 );
+  }
+} // end of tempFuseInput()
+
+/******************************************************************************
+* Function:
+*   tempFuseBuild()
+*
+* Description:
+*   Builds the fusion stage of a fan from its temperature source selection.
+*   The fixed selections are built as fusions too (TMP1 is TMP1 alone, MEAN
+*   is TMP1 and TMP2 weighted equally, and so on), so they read exactly as
+*   before.  TMPSRC_FUSE uses the fan's saved weights, offsets and mode.
+*   All the checking is done here, once, rather than every control loop:
+*   an invalid selection, or a fusion with no weights, falls back to
+*   TMPSRC_DEF (without saving it).  The weights are normalized to sum to
+*   1 << TFUSE_WT_BITS, with the rounding left over given to the heaviest
+*   input, so the mean needs no divide.
+*
+* Arguments:
+*   fuse - fusion stage to build
+*   tmpsrc - temperature source selection (TMPSRC_xxx)
+*   wt - saved weight of each input (0 for unused), for TMPSRC_FUSE
+*   ofs - saved offset of each input, stored digitally, for TMPSRC_FUSE
+*   mode - saved fusion mode (TFUSE_MEAN or TFUSE_MAX), for TMPSRC_FUSE
+*
+* Returns:
+*   none
+******************************************************************************/
+void tempFuseBuild ( TEMP_FUSE_TYPE *fuse, unsigned int tmpsrc, const unsigned int *wt, const int *ofs, unsigned int mode )
+{
+  unsigned int raw [ TFUSE_NUM_INS ] = { 0 }; // weight of each input before normalizing
+  unsigned int sum;                           // sum of the weights
+  unsigned int left;                          // normalized weight left over from rounding
+  byte         in;                            // temperature input
+  byte         big;                           // input with the heaviest weight
+
+  /* Work out the inputs, weights and mode of the selection */
+  for ( in = 0; in < TFUSE_NUM_INS; in++ )
+    fuse->ofs [ in ] = 0;
+  fuse->mode = TFUSE_MEAN;
+  sum        = 0;
+  if ( tmpsrc == TMPSRC_FUSE )
+  {
+    for ( in = 0; in < TFUSE_NUM_INS; in++ )
+    {
+      raw [ in ]       = wt [ in ];
+      fuse->ofs [ in ] = ofs [ in ];
+      sum             += wt [ in ];
+    }
+    fuse->mode = ( mode == TFUSE_MAX ) ? TFUSE_MAX : TFUSE_MEAN;
+  }
+  if ( sum == 0 ) // a fixed selection, or a fusion with nothing in it
+  {
+    switch ( tmpsrc )
+    {
+    case TMPSRC_TMP1: // temp sensor 1
+      raw [ TFUSE_TMP1 ] = 1;
+      break;
+
+    case TMPSRC_TMP2: // temp sensor 2
+      raw [ TFUSE_TMP2 ] = 1;
+      break;
+
+    case TMPSRC_MEAN: // mean temperature
+      raw [ TFUSE_TMP1 ] = 1;
+      raw [ TFUSE_TMP2 ] = 1;
+      break;
+
+    case TMPSRC_OW1: // 1-Wire sensor 1
+      raw [ TFUSE_OW1 ] = 1;
+      break;
+
+    case TMPSRC_OW2: // 1-Wire sensor 2
+      raw [ TFUSE_OW2 ] = 1;
+      break;
+
+    default: // maximum temperature, empty fusion or invalid selection (TMPSRC_DEF)
+      raw [ TFUSE_TMP1 ] = 1;
+      raw [ TFUSE_TMP2 ] = 1;
+      fuse->mode         = TFUSE_MAX;
+      for ( in = 0; in < TFUSE_NUM_INS; in++ )
+        fuse->ofs [ in ] = 0;
+    }
+    for ( in = 0; in < TFUSE_NUM_INS; in++ )
+      sum += raw [ in ];
+  }
+
+  /* Normalize the weights */
+  left = 1 << TFUSE_WT_BITS;
+  big  = 0;
+  for ( in = 0; in < TFUSE_NUM_INS; in++ )
+  {
+    fuse->wt [ in ] = (unsigned int) ( ( (unsigned long) raw [ in ] << TFUSE_WT_BITS ) / sum );
+    left           -= fuse->wt [ in ];
+    if ( raw [ in ] > raw [ big ] )
+      big = in;
+  }
+  fuse->wt [ big ] += left;
+
+  return;
+} // end of tempFuseBuild()
+
+/******************************************************************************
+* Function:
+*   tempFuseRead()
+*
+* Description:
+*   Returns the fused temperature of a fan.  Each input used has its offset
+*   added (clamped to the digital range), so in maximum mode a hot-spot
+*   sensor with a negative offset only takes over once it is that much
+*   hotter than the others.  In mean mode the inputs are weighted and
+*   summed, with one shift for the divide.  The fusion is faulted if any
+*   input used is, since a dead sensor could be the one at the hot spot.
+*
+* Arguments:
+*   fuse - fusion stage built by tempFuseBuild()
+*   fault - set high if an input used is faulted, low otherwise
+*
+* Returns:
+*   temp - fused temperature, stored digitally (0-TEMP_DIG_MAX)
+******************************************************************************/
+unsigned int tempFuseRead ( const TEMP_FUSE_TYPE *fuse, byte *fault )
+{
+  unsigned long sum = 0; // weighted sum of the inputs, or the maximum
+  long int      temp;    // temperature of an input, with offset
+  byte          in;      // temperature input
+
+  *fault = LOW;
+  for ( in = 0; in < TFUSE_NUM_INS; in++ )
+  {
+    if ( fuse->wt [ in ] == 0 ) // input not used
+      continue;
+    temp = (long int) tempFuseInput ( in, fault ) + fuse->ofs [ in ];
+    if ( temp < 0 )
+      temp = 0;
+    else if ( temp > TEMP_DIG_MAX )
+      temp = TEMP_DIG_MAX;
+    if ( fuse->mode == TFUSE_MAX )
+    {
+      if ( (unsigned long) temp > sum )
+        sum = temp;
+    }
+    else
+      sum += (unsigned long) temp * fuse->wt [ in ];
+  }
+
+  return ( fuse->mode == TFUSE_MAX ) ? (unsigned int) sum : (unsigned int) ( sum >> TFUSE_WT_BITS );
+} // end of tempFuseRead()
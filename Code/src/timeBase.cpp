@@ -0,0 +1,148 @@
+/*
+ * timeBase.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+
+/*******************************************************************************
+ * INCLUDED HEADER FILES
+ ******************************************************************************/
+#include "timeBase.h"
+
+/*******************************************************************************
+ * STATIC VARIABLE DEFINITIONS
+ ******************************************************************************/
+static unsigned long uptimeSec   = 0; // whole seconds of uptime (wraps after 136 years)
+static unsigned long uptimeSubUs = 0; // microseconds of uptime since the last whole second (always < TIMEBASE_US_PER_SEC)
+
+/*******************************************************************************
+ * FUNCTION DEFINITIONS
+ ******************************************************************************/
+
+/******************************************************************************
+* Function:
+*   timeBaseTick()
+*
+* Description:
+*   Advances the uptime clock by a number of scheduler ticks.  Each tick is
+*   exactly SYSTICK_US long, so the clock is kept as whole seconds plus a
+*   sub-second microsecond remainder, using only adds and compares.  It never
+*   drifts and never needs a multiply or divide.
+*
+* Arguments:
+*   ticks - number of scheduler ticks elapsed since the last call
+*
+* Returns:
+*   none
+******************************************************************************/
+void timeBaseTick ( byte ticks )
+{
+  while ( ticks-- > 0 )
+  {
+    uptimeSubUs += SYSTICK_US;
+    if ( uptimeSubUs >= TIMEBASE_US_PER_SEC ) // carry into seconds
+    {
+      uptimeSubUs -= TIMEBASE_US_PER_SEC;
+      uptimeSec++;
+    }
+  }
+
+  return;
+} // end of timeBaseTick()
+
+/******************************************************************************
+* Function:
+*   timeBaseUptimeSec()
+*
+* Description:
+*   Returns the whole seconds of uptime
+*
+* Arguments:
+*   none
+*
+* Returns:
+*   seconds - uptime (seconds)
+******************************************************************************/
+unsigned long timeBaseUptimeSec ( void )
+{
+  return uptimeSec;
+} // end of timeBaseUptimeSec()
+
+/******************************************************************************
+* Function:
+*   timeBaseUptimeSubUs()
+*
+* Description:
+*   Returns the microseconds of uptime since the last whole second.  This is
+*   updated once per scheduler tick, so it has a resolution of SYSTICK_US.
+*
+* Arguments:
+*   none
+*
+* Returns:
+*   microseconds - sub-second part of uptime (microseconds)
+******************************************************************************/
+unsigned long timeBaseUptimeSubUs ( void )
+{
+  return uptimeSubUs;
+} // end of timeBaseUptimeSubUs()
+
+/******************************************************************************
+* Function:
+*   timeBaseNow()
+*
+* Description:
+*   Returns a 32-bit timestamp, in timer1 counts.  This is cheap enough to
+*   call from an interrupt.  Use TIME_ELAPSED() and TIME_REACHED() to compare
+*   timestamps, and TIME_CNTS_TO_US() to convert intervals to microseconds.
+*
+* Arguments:
+*   none
+*
+* Returns:
+*   timestamp - current time (timer1 counts)
+******************************************************************************/
+unsigned long timeBaseNow ( void )
+{
+  return sysTimerCount ( );
+} // end of timeBaseNow()
+
+/******************************************************************************
+* Function:
+*   timeBaseMicros()
+*
+* Description:
+*   Returns the number of microseconds since power-up, as a 32-bit value which
+*   wraps through the full 32-bit range (about every 71 minutes).  This
+*   replaces micros(), which stops once pwmOutInit() takes over timer0.
+*
+* Arguments:
+*   none
+*
+* Returns:
+*   time - time since power-up (microseconds)
+******************************************************************************/
+unsigned long timeBaseMicros ( void )
+{
+  return (unsigned long) TIME_CNTS_TO_US ( sysTimerCount64 ( ) );
+} // end of timeBaseMicros()
+
+/******************************************************************************
+* Function:
+*   timeBaseMicros64()
+*
+* Description:
+*   Returns the number of microseconds since power-up, as a 64-bit value
+*   which never wraps in practice.
+*
+* Arguments:
+*   none
+*
+* Returns:
+*   time - time since power-up (microseconds)
+******************************************************************************/
+unsigned long long timeBaseMicros64 ( void )
+{
+  return TIME_CNTS_TO_US ( sysTimerCount64 ( ) );
+} // end of timeBaseMicros64()
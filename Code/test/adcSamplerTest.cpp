@@ -0,0 +1,228 @@
+/*
+ * adcSamplerTest.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+
+/* Runs the ADC interrupt against a model of the ADC, which latches the
+ * channel from ADMUX as each conversion is started, as the hardware does.
+ * The channels must be converted strictly in turn, each conversion started
+ * by the interrupt of the one before, and every sample must be summed to
+ * the channel it was taken from.  The readings, each the sum of
+ * ADC_SAMPLES_PER_READING samples shifted down by ADC_OVERSAMPLE_BITS, are
+ * checked through adcSamplerRead() against a model of the decimation, at
+ * random intervals, so reads find none, one or many new readings.
+ *
+ * This file includes adcSampler.cpp itself, rather than linking it, so it
+ * can start the running totals just short of wrapping.  The sums of
+ * readings and the reading counts must wrap through zero without a
+ * reading being lost or counted twice. */
+
+/*******************************************************************************
+ * INCLUDED HEADER FILES
+ ******************************************************************************/
+#include "../src/adcSampler.cpp"
+#include "testUtil.h"
+
+/*******************************************************************************
+ * MACRO DEFINITIONS
+ ******************************************************************************/
+#define CONVERSIONS  400000 // conversions run in each pass
+#define MAX_READ_GAP 200    // most conversions between reads
+#define SUM_LEAD     50000  // distance of the running sums from wrapping at the start of the wrap pass
+#define CNT_LEAD     20     // distance of the reading counts from wrapping at the start of the wrap pass
+
+/*******************************************************************************
+ * TYPE DEFINITIONS
+ ******************************************************************************/
+/* Model of the decimation of one channel */
+typedef struct CHAN_MODEL {
+  unsigned int  sampleSum; // sum of samples towards the next reading
+  byte          samples;   // number of samples in the sum
+  unsigned long readSum;   // sum of readings since the last read
+  unsigned int  readCnt;   // number of readings since the last read
+  unsigned int  reading;   // value last read
+} CHAN_MODEL_TYPE;
+
+/*******************************************************************************
+ * STATIC VARIABLE DEFINITIONS
+ ******************************************************************************/
+static CHAN_MODEL_TYPE model [ ADC_NUM_CHANS ]; // model of each channel
+static byte            convMux;                 // analog input of the conversion running
+static byte            converting;              // high while a conversion is running
+static unsigned long   badStarts;               // conversions started while one was running, or with the wrong reference
+
+/*******************************************************************************
+ * FUNCTION DEFINITIONS
+ ******************************************************************************/
+
+/* Write hook of ADCSRA, which latches the channel as a conversion starts */
+static void adcStart ( uint8_t val )
+{
+  if ( val & _BV ( ADSC ) )
+  {
+    if ( converting || ( ( ADMUX.val & ~0x0F ) != _BV ( REFS0 ) ) )
+      badStarts++;
+    convMux    = ADMUX.val & 0x0F;
+    converting = HIGH;
+  }
+
+  return;
+} // end of adcStart()
+
+/******************************************************************************
+* Function:
+*   checkRead()
+*
+* Description:
+*   Reads a channel, and checks the result against the model
+*
+* Arguments:
+*   chan - channel to read
+*
+* Returns:
+*   wrong - high if the read didn't match the model
+******************************************************************************/
+static byte checkRead ( ADC_CHAN_ENUM_TYPE chan )
+{
+  CHAN_MODEL_TYPE *m       = &model [ chan ];
+  unsigned int     reading = m->reading; // value read
+  byte             fresh;                // high if there were new readings
+  byte             wrong;
+
+  fresh = adcSamplerRead ( chan, &reading );
+  if ( m->readCnt == 0 )
+    wrong = ( fresh != LOW ) || ( reading != m->reading );
+  else
+  {
+    wrong      = ( fresh != HIGH ) || ( reading != ( m->readSum + ( m->readCnt >> 1 ) ) / m->readCnt );
+    m->reading = reading;
+  }
+  if ( wrong )
+    printf ( "  chan %u: read %u (%u) after %u readings\n", chan, reading, fresh, m->readCnt );
+  m->readSum = 0;
+  m->readCnt = 0;
+
+  return wrong;
+} // end of checkRead()
+
+/******************************************************************************
+* Function:
+*   runConversions()
+*
+* Description:
+*   Runs the ADC and its interrupt for a number of conversions, with a
+*   random sample from each, and reads the channels at random intervals.
+*   The samples of TEMP1PIN are kept apart from those of TEMP2PIN, so a
+*   sample summed to the wrong channel shows.
+*
+* Arguments:
+*   conversions - number of conversions to run
+*
+* Returns:
+*   none
+******************************************************************************/
+static void runConversions ( unsigned long conversions )
+{
+  unsigned long   wrongOrder = 0; // conversions not of the channel after the last one
+  unsigned long   stalls     = 0; // interrupts which didn't start another conversion
+  unsigned long   wrongReads = 0; // reads which didn't match the model
+  unsigned long   nextRead   = testRandom ( MAX_READ_GAP );
+  unsigned long   conv;
+  byte            lastMux    = adcMux [ ADC_NUM_CHANS - 1 ];
+  byte            chan;
+  unsigned int    sample;
+  CHAN_MODEL_TYPE *m;
+
+  for ( conv = 0; conv < conversions; conv++ )
+  {
+    if ( !converting )
+    {
+      stalls++;
+      break;
+    }
+
+    /* Finish the conversion */
+    chan = ( convMux == TEMP1PIN ) ? ADC_TEMP1 : ADC_TEMP2;
+    if ( convMux != adcMux [ ( lastMux == adcMux [ 0 ] ) ? 1 : 0 ] )
+      wrongOrder++;
+    lastMux = convMux;
+    if ( testRandom ( 64 ) == 0 )
+      sample = testRandom ( 2 ) ? 1023 : 0; // the rails now and then
+    else
+      sample = ( chan == ADC_TEMP1 ) ? 100 + testRandom ( 300 ) : 600 + testRandom ( 424 );
+    ADC.val    = sample;
+    converting = LOW;
+    ADCSRA.val = (uint8_t) ( ADCSRA.val & ~_BV ( ADSC ) );
+    ADC_vect ( );
+    if ( !converting )
+      stalls++;
+
+    /* Decimate in the model */
+    m             = &model [ chan ];
+    m->sampleSum += sample;
+    if ( ++m->samples == ADC_SAMPLES_PER_READING )
+    {
+      m->readSum  += m->sampleSum >> ADC_OVERSAMPLE_BITS;
+      m->readCnt++;
+      m->sampleSum = 0;
+      m->samples   = 0;
+    }
+
+    if ( conv == nextRead )
+    {
+      chan = (ADC_CHAN_ENUM_TYPE) testRandom ( ADC_NUM_CHANS );
+      wrongReads += checkRead ( (ADC_CHAN_ENUM_TYPE) chan );
+      nextRead   += 1 + testRandom ( MAX_READ_GAP );
+    }
+  }
+  for ( chan = 0; chan < ADC_NUM_CHANS; chan++ )
+    wrongReads += checkRead ( (ADC_CHAN_ENUM_TYPE) chan );
+  for ( chan = 0; chan < ADC_NUM_CHANS; chan++ )
+    wrongReads += checkRead ( (ADC_CHAN_ENUM_TYPE) chan ); // nothing new
+
+  TEST_EQUAL ( wrongOrder, 0 );
+  TEST_EQUAL ( stalls, 0 );
+  TEST_EQUAL ( wrongReads, 0 );
+  TEST_EQUAL ( badStarts, 0 );
+
+  return;
+} // end of runConversions()
+
+int main ( void )
+{
+  byte chan;
+
+  /* Start up, from registers left dirty */
+  ADMUX            = 0xCF;
+  ADCSRB           = 0x07;
+  ADCSRA.writeHook = adcStart;
+  adcSamplerInit ( );
+  TEST_EQUAL ( DIDR0.val, _BV ( TEMP1PIN ) | _BV ( TEMP2PIN ) );
+  TEST_EQUAL ( ADMUX.val, _BV ( REFS0 ) | TEMP1PIN );
+  TEST_EQUAL ( ADCSRA.val, ADC_CSRA_RUN | _BV ( ADSC ) );
+  TEST_EQUAL ( ADCSRB.val, 0 );
+  TEST_EQUAL ( converting, HIGH );
+  TEST_EQUAL ( convMux, TEMP1PIN );
+
+  runConversions ( CONVERSIONS );
+
+  /* Again, with the running totals about to wrap.  The model's readings
+   * were all read, so the totals can be moved without losing any. */
+  for ( chan = 0; chan < ADC_NUM_CHANS; chan++ )
+  {
+    isrTotal [ chan ].sum  = 0UL - SUM_LEAD;
+    isrTotal [ chan ].cnt  = 0U - CNT_LEAD;
+    adcTotal [ chan ].publish ( isrTotal [ chan ] );
+    lastTotal [ chan ]     = isrTotal [ chan ];
+  }
+  runConversions ( CONVERSIONS );
+  for ( chan = 0; chan < ADC_NUM_CHANS; chan++ )
+  {
+    TEST_CHECK ( isrTotal [ chan ].sum < 0UL - SUM_LEAD );
+    TEST_CHECK ( isrTotal [ chan ].cnt < 0U - CNT_LEAD );
+  }
+
+  return testResult ( "adcSamplerTest" );
+}
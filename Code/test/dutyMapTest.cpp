@@ -0,0 +1,624 @@
+/*
+ * dutyMapTest.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+
+/* Checks the duty map learner on its own, then in the loop with the PI
+ * controller and the fan model.  A window must only become a sample once
+ * it and the window before it were steady: a speed off the band of the
+ * reference, a reference moving off where its window started, or a
+ * saturated duty must hold the map as it is and start the count again,
+ * while a speed just inside the band must not.  On exact straight-line
+ * data the fit must find the line, and a fan held at one speed must keep
+ * its slope while the offset follows its duty there.  The fan channels
+ * must save a changed map, and save it again on the next pass if the
+ * learner moves it between its offset and slope saves.  A map held for an
+ * auto-tune must not learn, and must start from a fresh window when it
+ * learns again.
+ *
+ * In the loop, learning over a varying speed profile must give a map close
+ * to the duties the model needs, and using it must settle large speed
+ * steps faster than the PI controller alone, with its anti-windup. */
+
+/*******************************************************************************
+ * INCLUDED HEADER FILES
+ ******************************************************************************/
+#include "dutyMap.h"
+#include "piController.h"
+#include "fanChannel.h"
+#include "fanControlUtils.h"
+#include "savedVars.h"
+#include "fanPlant.h"
+#include "testUtil.h"
+
+/*******************************************************************************
+ * MACRO DEFINITIONS
+ ******************************************************************************/
+#define WIN         DMAP_WIN_LOOPS // control loops in a window
+#define FAN_TAU     1.2            // time constant of the fan model (seconds)
+#define LEVEL_LOOPS 400            // control loops each speed of the learning profile is held
+#define LEVELS      100            // speeds in the learning profile
+#define HOLD_LOOPS  600            // control loops each speed is held before a step
+#define STEP_LOOPS  300            // control loops a step is watched for
+#define SETTLE_BAND 50             // speed error for a step to have settled, as a fraction 1 / SETTLE_BAND of the reference (2%)
+#define NO_MOVE     0xFF           // savePass() call after which no map moves
+#define HOLD_RPM    900            // speed of the fan channels in the learning hold check (rpm)
+#define HOLD_OFS    400            // duty map offset of the fan channels in the learning hold check (quarter duty counts)
+
+/*******************************************************************************
+ * TYPE DEFINITIONS
+ ******************************************************************************/
+/* A fan under PI control, with its duty map */
+typedef struct FAN_LOOP {
+  FAN_PLANT_TYPE plant; // model of the fan
+  piController   pi;    // speed controller
+  DUTY_MAP_TYPE  map;   // duty map learner
+  int            ofs;   // duty map offset (quarter duty counts)
+  int            slope; // duty map slope (quarter duty counts per rpm << DMAP_SLOPE_BITS)
+  unsigned int   rpm;   // measured speed (rpm)
+  byte           duty;  // duty applied over the last control loop
+} FAN_LOOP_TYPE;
+
+/*******************************************************************************
+ * STATIC VARIABLE DEFINITIONS
+ ******************************************************************************/
+static DUTY_MAP_TYPE map;   // duty map learner under test on its own
+static int           ofs;   // its map offset
+static int           slope; // its map slope
+static FAN_LOOP_TYPE fan;   // fan in the loop
+
+/*******************************************************************************
+ * FUNCTION DEFINITIONS
+ ******************************************************************************/
+
+/******************************************************************************
+* Function:
+*   dutyNeeded()
+*
+* Description:
+*   Returns the duty the fan model needs to hold a speed, the inverse of
+*   fanPlantSteady()
+*
+* Arguments:
+*   rpm - speed (rpm)
+*
+* Returns:
+*   duty - duty needed (quarter duty counts)
+******************************************************************************/
+static double dutyNeeded ( double rpm )
+{
+  return 4 * ( FAN_PLANT_STALL + ( 255.0 - FAN_PLANT_STALL ) * pow ( ( rpm - 400 ) / 2600, 1 / 0.75 ) );
+} // end of dutyNeeded()
+
+/******************************************************************************
+* Function:
+*   feed()
+*
+* Description:
+*   Feeds the learner on its own the same speed and duty for a number of
+*   control loops, and counts the loops which fitted a sample
+*
+* Arguments:
+*   ref - speed reference (rpm)
+*   rpm - measured speed (rpm)
+*   duty - duty applied (duty counts)
+*   loops - number of control loops
+*
+* Returns:
+*   fits - number of loops which fitted a sample
+******************************************************************************/
+static unsigned int feed ( unsigned int ref, unsigned int rpm, byte duty, unsigned int loops )
+{
+  unsigned int fits = 0; // loops which fitted a sample
+  unsigned int loop;
+  byte         settled;  // settled flag before the loop
+
+  for ( loop = 0; loop < loops; loop++ )
+  {
+    settled = map.settled;
+    dutyMapLearn ( &map, ref, rpm, duty, &ofs, &slope );
+    if ( settled && map.settled && ( map.loops == 0 ) ) // a settled window ended steady
+      fits++;
+  }
+
+  return fits;
+} // end of feed()
+
+/******************************************************************************
+* Function:
+*   checkUpset()
+*
+* Description:
+*   Feeds the learner on its own a steady window with an upset in its last
+*   loop, and checks neither that window nor the next becomes a sample, and
+*   the map is held, then that the window after them does.  Call with the
+*   learner settled at 1500 rpm, at the start of a window.
+*
+* Arguments:
+*   ref - speed reference in the upset (rpm)
+*   rpm - measured speed in the upset (rpm)
+*   duty - duty applied in the upset (duty counts)
+*
+* Returns:
+*   none
+******************************************************************************/
+static void checkUpset ( unsigned int ref, unsigned int rpm, byte duty )
+{
+  unsigned int fits; // loops which fitted a sample
+
+  map.changed = LOW;
+  ofs         = 123;
+  slope       = 4567;
+  fits        = feed ( 1500, 1500, 100, WIN - 1 ) + feed ( ref, rpm, duty, 1 ) + feed ( 1500, 1500, 100, 2 * WIN - 1 );
+  if ( fits != 0 )
+    printf ( "  upset %u rpm, %u ref, %u duty: sampled\n", rpm, ref, duty );
+  TEST_EQUAL ( fits, 0 );
+  TEST_EQUAL ( ofs, 123 );
+  TEST_EQUAL ( slope, 4567 );
+  TEST_EQUAL ( map.changed, LOW );
+  fits = feed ( 1500, 1500, 100, 1 ); // steady again
+  TEST_EQUAL ( fits, 1 );
+
+  return;
+} // end of checkUpset()
+
+/******************************************************************************
+* Function:
+*   checkGate()
+*
+* Description:
+*   Checks which windows become samples, and that the map is left alone
+*   while the fan isn't steady
+*
+* Arguments:
+*   none
+*
+* Returns:
+*   none
+******************************************************************************/
+static void checkGate ( void )
+{
+  unsigned int band = 1500 >> DMAP_BAND_SHIFT; // speed error allowed at 1500 rpm
+  unsigned int fits;                           // loops which fitted a sample
+
+  /* The first window only settles, and the second is the first sample */
+  memset ( &map, 0, sizeof ( map ) );
+  ofs   = 123;
+  slope = 4567;
+  fits = feed ( 1500, 1500, 100, 2 * WIN - 1 );
+  TEST_EQUAL ( fits, 0 );
+  TEST_EQUAL ( ofs, 123 );
+  TEST_EQUAL ( slope, 4567 );
+  TEST_EQUAL ( map.changed, LOW );
+  fits = feed ( 1500, 1500, 100, 1 );
+  TEST_EQUAL ( fits, 1 );
+  TEST_EQUAL ( map.samples, 1 );
+  TEST_EQUAL ( ofs + ( ( 4567L * 1500 ) >> DMAP_SLOPE_BITS ), 400 ); // through the sample, slope kept
+  TEST_EQUAL ( slope, 4567 );
+  TEST_EQUAL ( map.changed, HIGH );
+  fits = feed ( 1500, 1500, 100, 3 * WIN );
+  TEST_EQUAL ( fits, 3 );
+
+  /* Speeds at the edges of the band are steady, and the reference may wander
+   * within the band of where its window started */
+  fits = feed ( 1500, 1500 + band, 100, WIN / 2 );
+  TEST_EQUAL ( fits, 0 );
+  fits = feed ( 1500, 1500 - band, 100, WIN - WIN / 2 );
+  TEST_EQUAL ( fits, 1 );
+  fits = feed ( 1500, 1500, 100, WIN / 2 ) + feed ( 1500 + band, 1500 + band, 100, WIN - WIN / 2 );
+  TEST_EQUAL ( fits, 1 );
+  fits = feed ( 1500, 1500, 100, WIN / 2 ) + feed ( 1500 - band / 2, 1500 - band / 2, 100, WIN - WIN / 2 );
+  TEST_EQUAL ( fits, 1 );
+  fits = feed ( 1500, 1500, MINPIOUTPUT + 1, WIN );
+  TEST_EQUAL ( fits, 1 );
+  fits = feed ( 1500, 1500, MAXPIOUTPUT - 1, WIN );
+  TEST_EQUAL ( fits, 1 );
+
+  /* Each upset, in the last loop of a window, holds the map and throws
+   * away that window and the next */
+  checkUpset ( 1500, 1500 + band + 1, 100 );
+  checkUpset ( 1500, 1500 - band - 1, 100 );
+  checkUpset ( 1500, 1500, MINPIOUTPUT );
+  checkUpset ( 1500, 1500, MAXPIOUTPUT );
+  checkUpset ( 1500 + 2 * band, 1500 + 2 * band, 100 );
+  checkUpset ( 1500 - 2 * band, 1500 - 2 * band, 100 );
+
+  /* Held saturated, or away from the reference, it never learns */
+  map.changed = LOW;
+  ofs         = 123;
+  slope       = 4567;
+  fits = feed ( 2500, 2500, MAXPIOUTPUT, 50 * WIN );
+  TEST_EQUAL ( fits, 0 );
+  fits = feed ( 500, 500, MINPIOUTPUT, 50 * WIN );
+  TEST_EQUAL ( fits, 0 );
+  fits = feed ( 2500, 2000, 200, 50 * WIN );
+  TEST_EQUAL ( fits, 0 );
+  TEST_EQUAL ( ofs, 123 );
+  TEST_EQUAL ( slope, 4567 );
+  TEST_EQUAL ( map.changed, LOW );
+
+  return;
+} // end of checkGate()
+
+/******************************************************************************
+* Function:
+*   checkFit()
+*
+* Description:
+*   Feeds the learner on its own steady windows at random speeds, with the
+*   duty of a known straight line rounded to whole counts, and checks it
+*   finds the line.  Then holds one speed until the slope is no longer
+*   fitted, and checks it is kept while the offset moves the map onto
+*   another duty there.  A duty falling with speed must give no slope.
+*
+* Arguments:
+*   none
+*
+* Returns:
+*   none
+******************************************************************************/
+static void checkFit ( void )
+{
+  unsigned long wrong = 0; // speeds at which the map is off the line
+  unsigned int  rpm;
+  unsigned int  i;
+  int           fitSlope;  // slope of the fitted line
+  double        err;       // error of the map at a speed (quarter duty counts)
+
+  memset ( &map, 0, sizeof ( map ) );
+  ofs   = 0;
+  slope = 0;
+  for ( i = 0; i < 500; i++ )
+  {
+    rpm = 800 + testRandom ( 2001 );
+    feed ( rpm, rpm, (byte) lround ( 20 + 0.08 * rpm ), 2 * WIN );
+  }
+  TEST_CHECK ( abs ( slope - (int) lround ( 4 * 0.08 * ( 1 << DMAP_SLOPE_BITS ) ) ) < 30 );
+  for ( rpm = 800; rpm <= 2800; rpm += 100 )
+  {
+    err = dutyMapEval ( ofs, slope, rpm ) - 4 * ( 20 + 0.08 * rpm );
+    if ( ( fabs ( err ) > 3 ) && ( wrong++ == 0 ) )
+      printf ( "  %u rpm: off the line by %.1f quarter counts\n", rpm, err );
+  }
+  TEST_EQUAL ( wrong, 0 );
+
+  /* Held at one speed, until the spread of the samples has gone, then
+   * with the duty there moved up */
+  feed ( 1800, 1800, (byte) lround ( 20 + 0.08 * 1800 ), 800 * WIN );
+  TEST_CHECK ( map.vxx < DMAP_MIN_SPREAD * DMAP_MIN_SPREAD >> 2 * DMAP_DX_BITS );
+  fitSlope = slope;
+  feed ( 1800, 1800, (byte) lround ( 20 + 0.08 * 1800 ) + 12, 400 * WIN );
+  TEST_EQUAL ( slope, fitSlope );
+  err = dutyMapEval ( ofs, slope, 1800 ) - 4 * ( 20 + 0.08 * 1800 + 12 );
+  TEST_CHECK ( fabs ( err ) <= 2 );
+
+  /* A duty which falls with speed is taken as noise, and gives no slope */
+  for ( i = 0; i < 100; i++ )
+  {
+    rpm = 800 + testRandom ( 2001 );
+    feed ( rpm, rpm, (byte) lround ( 250 - 0.05 * rpm ), 2 * WIN );
+  }
+  TEST_EQUAL ( slope, 0 );
+
+  return;
+} // end of checkFit()
+
+/******************************************************************************
+* Function:
+*   runLoop()
+*
+* Description:
+*   Runs the fan in the loop for a number of control loops, as regSpeeds()
+*   does for each dmapMode
+*
+* Arguments:
+*   ref - speed reference (rpm)
+*   mode - DMAP_OFF, DMAP_USE or DMAP_LEARN
+*   loops - number of control loops
+*   settled - set to the number of loops since the speed was last off the
+*     reference by more than 1 / SETTLE_BAND of it, if not NULL
+*
+* Returns:
+*   none
+******************************************************************************/
+static void runLoop ( unsigned int ref, byte mode, unsigned int loops, unsigned int *settled )
+{
+  unsigned int loop;
+
+  for ( loop = 0; loop < loops; loop++ )
+  {
+    fan.rpm = fanPlantStep ( &fan.plant, fan.duty );
+    if ( mode == DMAP_OFF )
+      fan.duty = fan.pi.piControl ( (int) ref - fan.rpm );
+    else
+    {
+      if ( mode == DMAP_LEARN )
+        dutyMapLearn ( &fan.map, ref, fan.rpm, fan.duty, &fan.ofs, &fan.slope );
+      fan.duty = fan.pi.piControl ( (int) ref - fan.rpm, dutyMapEval ( fan.ofs, fan.slope, ref ) );
+    }
+    if ( settled != NULL )
+    {
+      if ( abs ( (int) ref - (int) fan.rpm ) * SETTLE_BAND > (int) ref )
+        *settled = 0;
+      else
+        ( *settled )++;
+    }
+  }
+
+  return;
+} // end of runLoop()
+
+/******************************************************************************
+* Function:
+*   checkLearn()
+*
+* Description:
+*   Learns the map in the loop over a varying speed profile, and checks it
+*   is close to the duties the fan model needs, then that holding one
+*   speed brings the map onto the duty there
+*
+* Arguments:
+*   none
+*
+* Returns:
+*   none
+******************************************************************************/
+static void checkLearn ( void )
+{
+  unsigned long wrong = 0; // speeds at which the map is too far off
+  unsigned int  rpm;
+  unsigned int  i;
+  double        err;       // error of the map at a speed (quarter duty counts)
+
+  for ( i = 0; i < LEVELS; i++ )
+    runLoop ( 900 + testRandom ( 1901 ), DMAP_LEARN, LEVEL_LOOPS, NULL );
+  for ( rpm = 1000; rpm <= 2600; rpm += 100 )
+  {
+    err = dutyMapEval ( fan.ofs, fan.slope, rpm ) - dutyNeeded ( rpm );
+    if ( ( fabs ( err ) > 4 * 6 ) && ( wrong++ == 0 ) )
+      printf ( "  %u rpm: map off by %.1f quarter counts\n", rpm, err );
+  }
+  TEST_EQUAL ( wrong, 0 );
+
+  runLoop ( 1700, DMAP_LEARN, 200 * WIN, NULL );
+  err = dutyMapEval ( fan.ofs, fan.slope, 1700 ) - dutyNeeded ( 1700 );
+  TEST_CHECK ( fabs ( err ) <= 4 );
+
+  return;
+} // end of checkLearn()
+
+/******************************************************************************
+* Function:
+*   settleStep()
+*
+* Description:
+*   Holds the fan at one speed, then steps the reference, and returns the
+*   time the speed took to stay within the settling band of the new one
+*
+* Arguments:
+*   from - speed to hold (rpm)
+*   to - speed to step to (rpm)
+*   mode - DMAP_OFF or DMAP_USE
+*
+* Returns:
+*   loops - control loops to settle (STEP_LOOPS if it never did)
+******************************************************************************/
+static unsigned int settleStep ( unsigned int from, unsigned int to, byte mode )
+{
+  unsigned int settled = 0; // loops the speed has stayed in the band
+
+  runLoop ( from, mode, HOLD_LOOPS, NULL );
+  runLoop ( to, mode, STEP_LOOPS, &settled );
+
+  return STEP_LOOPS - settled;
+} // end of settleStep()
+
+/******************************************************************************
+* Function:
+*   checkSettle()
+*
+* Description:
+*   Checks large speed steps, both ways, settle no slower with the learned
+*   map than with the PI controller alone, and take at least a quarter
+*   less time all together
+*
+* Arguments:
+*   none
+*
+* Returns:
+*   none
+******************************************************************************/
+static void checkSettle ( void )
+{
+  static const unsigned int steps [ ] [ 2 ] = { { 1200, 2400 }, { 2400, 1200 }, { 1500, 2800 }, { 2800, 900 } }; // steps tried (rpm)
+  unsigned int              off, use;                                                                                 // loops to settle without and with the map
+  unsigned int              offSum = 0, useSum = 0;                                                                   // loops to settle every step, without and with the map
+  byte                      i;
+
+  for ( i = 0; i < sizeof ( steps ) / sizeof ( steps [ 0 ] ); i++ )
+  {
+    off = settleStep ( steps [ i ] [ 0 ], steps [ i ] [ 1 ], DMAP_OFF );
+    use = settleStep ( steps [ i ] [ 0 ], steps [ i ] [ 1 ], DMAP_USE );
+    printf ( "  %u to %u rpm: %.2f s with PI alone, %.2f s with the map\n", steps [ i ] [ 0 ], steps [ i ] [ 1 ], off * FAN_PLANT_DT, use * FAN_PLANT_DT );
+    TEST_CHECK ( use < STEP_LOOPS );
+    TEST_CHECK ( use <= off );
+    offSum += off;
+    useSum += use;
+  }
+  TEST_CHECK ( 4 * useSum < 3 * offSum );
+
+  return;
+} // end of checkSettle()
+
+/******************************************************************************
+* Function:
+*   savePass()
+*
+* Description:
+*   Runs a save pass of the fan channels' duty maps, one call per setting,
+*   at a run time, and can have the learner move a map part way through
+*
+* Arguments:
+*   now - run time of the pass (seconds)
+*   moveAfter - call after which the map of that setting's channel changes,
+*               or NO_MOVE
+*
+* Returns:
+*   saved - bit i high if setting i (offset then slope of each channel) was
+*           saved
+******************************************************************************/
+static byte savePass ( unsigned long now, byte moveAfter )
+{
+  unsigned char gen;       // savedVarsGen before the call
+  byte          saved = 0; // settings saved
+  byte          i;
+
+  runTime_s = now;
+  for ( i = 0; i < 2 * NUM_FANS; i++ )
+  {
+    gen = savedVarsGen;
+    fans.saveDutyMaps ( );
+    if ( savedVarsGen != gen )
+      saved |= 1 << i;
+    if ( i == moveAfter )
+      fans.dmap [ i >> 1 ].changed = HIGH;
+  }
+
+  return saved;
+} // end of savePass()
+
+/******************************************************************************
+* Function:
+*   checkSave()
+*
+* Description:
+*   Checks the duty map saves of the fan channels.  Nothing is saved before
+*   DMAP_SAVE_S, a changed map has its offset and slope saved and an
+*   unchanged one neither.  A map the learner moves between its offset and
+*   slope saves must be saved again on the next pass, or the new offset is
+*   lost.
+*
+* Arguments:
+*   none
+*
+* Returns:
+*   none
+******************************************************************************/
+static void checkSave ( void )
+{
+  byte saved; // settings saved by a pass
+
+  fans.dmap [ 0 ].changed = HIGH;
+  saved = savePass ( DMAP_SAVE_S - 1, NO_MOVE );
+  TEST_EQUAL ( saved, 0 ); // too soon
+
+  saved = savePass ( DMAP_SAVE_S, 0 );
+  TEST_EQUAL ( saved, 0x3 ); // fan 1 only, moved after its offset save
+  saved = savePass ( DMAP_SAVE_S + 1, NO_MOVE );
+  TEST_EQUAL ( saved, 0 );   // not due yet
+  saved = savePass ( 2 * DMAP_SAVE_S, 2 );
+  TEST_EQUAL ( saved, 0x3 ); // fan 1 again, and fan 2 moved after its offset save, so not saved
+  saved = savePass ( 3 * DMAP_SAVE_S, NO_MOVE );
+  TEST_EQUAL ( saved, 0xC ); // fan 2
+  saved = savePass ( 4 * DMAP_SAVE_S, NO_MOVE );
+  TEST_EQUAL ( saved, 0 );   // nothing changed
+
+  return;
+} // end of checkSave()
+
+/******************************************************************************
+* Function:
+*   regLoops()
+*
+* Description:
+*   Runs the speed regulation of the fan channels for a number of control
+*   loops, with each fan steady on its reference
+*
+* Arguments:
+*   loops - number of control loops
+*
+* Returns:
+*   none
+******************************************************************************/
+static void regLoops ( unsigned int loops )
+{
+  byte chan;
+
+  while ( loops-- > 0 )
+  {
+    for ( chan = 0; chan < NUM_FANS; chan++ )
+    {
+      fans.rpmRef [ chan ] = HOLD_RPM;
+      fans.rpm [ chan ]    = HOLD_RPM;
+    }
+    fans.regSpeeds ( );
+  }
+
+  return;
+} // end of regLoops()
+
+/******************************************************************************
+* Function:
+*   checkHold()
+*
+* Description:
+*   Checks a duty map held by holdLearning(), as for an auto-tune, doesn't
+*   learn while the other does, and learns again from a fresh window when
+*   another map is held or the controllers take over
+*
+* Arguments:
+*   none
+*
+* Returns:
+*   none
+******************************************************************************/
+static void checkHold ( void )
+{
+  byte samples; // samples fitted by a map before a step
+
+  dmap1Ofs = HOLD_OFS; // so the controllers, with no gains, hold a duty
+  dmap2Ofs = HOLD_OFS;
+  regLoops ( 1 + WIN + WIN / 2 ); // the first loop, from duty 0, isn't steady
+  TEST_CHECK ( fans.dmap [ 0 ].settled && ( fans.dmap [ 0 ].loops == WIN / 2 ) );
+  TEST_CHECK ( fans.dmap [ 1 ].settled && ( fans.dmap [ 1 ].loops == WIN / 2 ) );
+
+  /* Fan 1 tuned, part way through a window */
+  fans.holdLearning ( 0 );
+  regLoops ( 3 * WIN );
+  TEST_EQUAL ( fans.dmap [ 0 ].samples, 0 );
+  TEST_EQUAL ( fans.dmap [ 0 ].loops, WIN / 2 );
+  TEST_CHECK ( fans.dmap [ 1 ].samples > 0 );
+
+  /* Then fan 2, so fan 1 starts afresh */
+  fans.holdLearning ( 1 );
+  TEST_CHECK ( !fans.dmap [ 0 ].settled && ( fans.dmap [ 0 ].loops == 0 ) );
+  samples = fans.dmap [ 1 ].samples;
+  regLoops ( 2 * WIN + WIN / 2 );
+  TEST_EQUAL ( fans.dmap [ 0 ].samples, 1 ); // the first window only settles
+  TEST_EQUAL ( fans.dmap [ 1 ].samples, samples );
+
+  /* Handed back, so fan 2 starts afresh too */
+  fans.takeOver ( );
+  TEST_CHECK ( !fans.dmap [ 1 ].settled && ( fans.dmap [ 1 ].loops == 0 ) );
+  regLoops ( 2 * WIN );
+  TEST_EQUAL ( fans.dmap [ 1 ].samples, samples + 1 );
+
+  return;
+} // end of checkHold()
+
+int main ( void )
+{
+  checkGate ( );
+  checkFit ( );
+  checkSave ( );
+  checkHold ( );
+
+  fan.plant.tau = FAN_TAU;
+  fan.pi.setGains ( pi1Imax, pi1Imin, pi1Kp, pi1Ki );
+  checkLearn ( );
+  checkSettle ( );
+
+  return testResult ( "dutyMapTest" );
+}
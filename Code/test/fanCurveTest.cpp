@@ -0,0 +1,281 @@
+/*
+ * fanCurveTest.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+
+/* Checks fan curve evaluation through the segment index against a plain
+ * search of the segments, at every temperature of random curves, and
+ * against the table interpolation the curves replaced, which divided on
+ * every call.  Also checks which points are dropped from invalid tables. */
+
+/*******************************************************************************
+ * INCLUDED HEADER FILES
+ ******************************************************************************/
+#include "fanCurve.h"
+#include "testUtil.h"
+
+/*******************************************************************************
+ * MACRO DEFINITIONS
+ ******************************************************************************/
+#define RANDOM_CURVES 20000 // number of random curves tried in each check
+
+/*******************************************************************************
+ * FUNCTION DEFINITIONS
+ ******************************************************************************/
+
+/******************************************************************************
+* Function:
+*   sortPoints()
+*
+* Description:
+*   Sorts temperatures into increasing order (insertion sort)
+*
+* Arguments:
+*   x - temperatures
+*   num - number of temperatures
+*
+* Returns:
+*   none
+******************************************************************************/
+static void sortPoints ( unsigned int *x, byte num )
+{
+  unsigned int val; // temperature being placed
+  byte         i, j;
+
+  for ( i = 1; i < num; i++ )
+  {
+    val = x [ i ];
+    for ( j = i; ( j > 0 ) && ( x [ j - 1 ] > val ); j-- )
+      x [ j ] = x [ j - 1 ];
+    x [ j ] = val;
+  }
+
+  return;
+} // end of sortPoints()
+
+/******************************************************************************
+* Function:
+*   searchEval()
+*
+* Description:
+*   Evaluates a curve by searching its segments from the start, with the
+*   same slopes and rounding as fanCurveEval(), but no segment index
+*
+* Arguments:
+*   curve - curve built by fanCurveBuild()
+*   x - temperature, stored digitally
+*
+* Returns:
+*   y - speed at this temperature (rpm)
+******************************************************************************/
+static unsigned int searchEval ( const FAN_CURVE_TYPE *curve, unsigned int x )
+{
+  long int delta; // speed change from the start of the segment
+  byte     pt = 0;
+
+  if ( curve->num == 0 )
+    return 0;
+  if ( x <= curve->x [ 0 ] )
+    return curve->y [ 0 ];
+  if ( x >= curve->x [ curve->num - 1 ] )
+    return curve->y [ curve->num - 1 ];
+  while ( curve->x [ pt + 1 ] <= x )
+    pt++;
+
+  delta = curve->slope [ pt ] * (long int) ( x - curve->x [ pt ] );
+  if ( delta >= 0 )
+    return (unsigned int) ( curve->y [ pt ] + ( delta >> FAN_CURVE_SLOPE_BITS ) ) & 0xFFFF;
+  else
+    return (unsigned int) ( curve->y [ pt ] - ( -delta >> FAN_CURVE_SLOPE_BITS ) ) & 0xFFFF;
+} // end of searchEval()
+
+/******************************************************************************
+* Function:
+*   tableEval()
+*
+* Description:
+*   Evaluates a speed table the way it was done before the fan curves: the
+*   fan on temperature and minimum speed, then four points, interpolated
+*   with a divide
+*
+* Arguments:
+*   t - temperature, stored digitally
+*   x - temperatures of the five points
+*   y - speeds of the five points (rpm)
+*
+* Returns:
+*   y - speed at this temperature (rpm)
+******************************************************************************/
+static unsigned int tableEval ( unsigned int t, const unsigned int *x, const unsigned int *y )
+{
+  long int x0 = x [ 0 ], y0 = y [ 0 ], x2 = 0, y2 = 0;
+  byte     pt;
+
+  if ( t >= x [ 4 ] )
+    return y [ 4 ];
+  for ( pt = 1; pt < 5; pt++ )
+  {
+    x2 = x [ pt ];
+    y2 = y [ pt ];
+    if ( (long int) t < x2 )
+      break;
+    x0 = x2;
+    y0 = y2;
+  }
+
+  return (unsigned int) ( ( ( y2 - y0 ) * ( (long int) t - x0 ) ) / ( x2 - x0 ) + y0 );
+} // end of tableEval()
+
+/******************************************************************************
+* Function:
+*   checkIndex()
+*
+* Description:
+*   Checks evaluation through the segment index against searchEval(), at
+*   every temperature of random curves of 2 to FAN_CURVE_MAX_PTS points,
+*   including repeated temperatures (which are dropped)
+*
+* Arguments:
+*   none
+*
+* Returns:
+*   none
+******************************************************************************/
+static void checkIndex ( void )
+{
+  FAN_CURVE_TYPE curve;                   // curve being checked
+  unsigned int   x [ FAN_CURVE_MAX_PTS ]; // temperatures of the points
+  unsigned int   y [ FAN_CURVE_MAX_PTS ]; // speeds of the points
+  unsigned long  bad = 0;                 // temperatures evaluated wrongly
+  unsigned int   t;                       // temperature
+  byte           num, pt;
+  int            it;
+
+  for ( it = 0; it < RANDOM_CURVES; it++ )
+  {
+    num = 2 + testRandom ( FAN_CURVE_MAX_PTS - 1 );
+    for ( pt = 0; pt < num; pt++ )
+    {
+      x [ pt ] = testRandom ( TEMP_DIG_MAX + 1 );
+      y [ pt ] = testRandom ( 8000 );
+    }
+    sortPoints ( x, num );
+    fanCurveBuild ( &curve, x, y, num );
+    for ( t = 0; t <= TEMP_DIG_MAX; t++ )
+      if ( fanCurveEval ( &curve, t ) != searchEval ( &curve, t ) )
+        bad++;
+  }
+  TEST_EQUAL ( bad, 0 );
+
+  return;
+} // end of checkIndex()
+
+/******************************************************************************
+* Function:
+*   checkTable()
+*
+* Description:
+*   Checks random five point curves against the table interpolation they
+*   replaced.  The slopes are rounded to 2^-FAN_CURVE_SLOPE_BITS, so the
+*   speeds may be out by 1 rpm, but no more.
+*
+* Arguments:
+*   none
+*
+* Returns:
+*   none
+******************************************************************************/
+static void checkTable ( void )
+{
+  FAN_CURVE_TYPE curve;       // curve being checked
+  unsigned int   x [ 5 ];     // temperatures of the points
+  unsigned int   y [ 5 ];     // speeds of the points
+  unsigned long  off     = 0; // temperatures where the speed differs
+  long int       maxDiff = 0; // largest difference (rpm)
+  long int       diff;        // difference at this temperature (rpm)
+  unsigned int   t;           // temperature
+  byte           pt, ok;
+  int            it;
+
+  for ( it = 0; it < RANDOM_CURVES; it++ )
+  {
+    for ( pt = 0; pt < 5; pt++ )
+      x [ pt ] = testRandom ( TEMP_DIG_MAX + 1 );
+    sortPoints ( x, 5 );
+    for ( ok = HIGH, pt = 1; pt < 5; pt++ )
+      if ( x [ pt ] <= x [ pt - 1 ] )
+        ok = LOW;
+    if ( !ok ) // the old table needed increasing temperatures
+      continue;
+    for ( pt = 0; pt < 5; pt++ )
+      y [ pt ] = ( it & 1 ) ? 300 + testRandom ( 6000 ) : testRandom ( 65536 );
+
+    TEST_EQUAL ( fanCurveBuild ( &curve, x, y, 5 ), 0 );
+    for ( t = x [ 0 ] + 1; t <= TEMP_DIG_MAX; t++ )
+    {
+      diff = labs ( (long int) fanCurveEval ( &curve, t ) - (long int) tableEval ( t, x, y ) );
+      if ( diff != 0 )
+        off++;
+      if ( diff > maxDiff )
+        maxDiff = diff;
+    }
+  }
+  printf ( "  %lu temperatures off by up to %ld rpm from the table interpolation\n", off, maxDiff );
+  TEST_CHECK ( maxDiff <= 1 );
+
+  return;
+} // end of checkTable()
+
+/******************************************************************************
+* Function:
+*   checkInvalid()
+*
+* Description:
+*   Checks that points which aren't above the last one kept are dropped,
+*   as are points past FAN_CURVE_MAX_PTS, and that the rest still work
+*
+* Arguments:
+*   none
+*
+* Returns:
+*   none
+******************************************************************************/
+static void checkInvalid ( void )
+{
+  static const unsigned int x [ 5 ] = { 100, 100, 50, 200, 200 }; // repeated and decreasing temperatures
+  static const unsigned int y [ 5 ] = { 1, 2, 3, 4, 5 };
+  FAN_CURVE_TYPE            curve;
+  unsigned int              xl [ FAN_CURVE_MAX_PTS + 3 ], yl [ FAN_CURVE_MAX_PTS + 3 ]; // table which is too long
+  byte                      pt;
+
+  TEST_EQUAL ( fanCurveBuild ( &curve, x, y, 5 ), 3 );
+  TEST_EQUAL ( curve.num, 2 );
+  TEST_EQUAL ( fanCurveEval ( &curve, 0 ), 1 );
+  TEST_EQUAL ( fanCurveEval ( &curve, 150 ), 2 );
+  TEST_EQUAL ( fanCurveEval ( &curve, 250 ), 4 );
+
+  for ( pt = 0; pt < FAN_CURVE_MAX_PTS + 3; pt++ )
+  {
+    xl [ pt ] = 100 * ( pt + 1 );
+    yl [ pt ] = 500 + 10 * pt;
+  }
+  TEST_EQUAL ( fanCurveBuild ( &curve, xl, yl, FAN_CURVE_MAX_PTS + 3 ), 3 );
+  TEST_EQUAL ( curve.num, FAN_CURVE_MAX_PTS );
+  TEST_EQUAL ( fanCurveEval ( &curve, TEMP_DIG_MAX ), yl [ FAN_CURVE_MAX_PTS - 1 ] );
+
+  TEST_EQUAL ( fanCurveBuild ( &curve, x, y, 0 ), 0 );
+  TEST_EQUAL ( fanCurveEval ( &curve, 1000 ), 0 );
+
+  return;
+} // end of checkInvalid()
+
+int main ( void )
+{
+  checkIndex ( );
+  checkTable ( );
+  checkInvalid ( );
+
+  return testResult ( "fanCurveTest" );
+}
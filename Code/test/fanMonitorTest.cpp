@@ -0,0 +1,162 @@
+/*
+ * fanMonitorTest.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+
+/* Drives the stall monitor of one fan through its whole life, one control
+ * loop at a time: off, turned on with a fan that never turns, kicked
+ * FANMON_MAX_KICKS times, faulted, retried, started by a retry kick,
+ * stalled while running, faulted again and commanded off.  Every stretch
+ * must last exactly as long as its time in control loops, with the duty
+ * put out overridden to the kick duty or to off, and the stall and kick
+ * counters and the fault flag must follow.  A fan commanded off must never
+ * stall, however long it shows no speed. */
+
+/*******************************************************************************
+ * INCLUDED HEADER FILES
+ ******************************************************************************/
+#include "fanMonitor.h"
+#include "testUtil.h"
+
+/*******************************************************************************
+ * MACRO DEFINITIONS
+ ******************************************************************************/
+#define DUTY         120                                       // commanded duty while on
+#define RPM          900                                       // speed of a turning fan (rpm)
+#define SPINUP_LOOPS FANMON_MS_TO_LOOPS ( FANMON_SPINUP_MS )   // control loops given to spin up
+#define KICK_LOOPS   FANMON_MS_TO_LOOPS ( FANMON_KICK_MS )     // control loops of each kick
+#define RETRY_LOOPS  FANMON_MS_TO_LOOPS ( FANMON_RETRY_MS )    // control loops between retry kicks
+
+/*******************************************************************************
+ * STATIC VARIABLE DEFINITIONS
+ ******************************************************************************/
+static FAN_MON_TYPE mon; // stall monitor under test
+
+/*******************************************************************************
+ * FUNCTION DEFINITIONS
+ ******************************************************************************/
+
+/******************************************************************************
+* Function:
+*   expectRun()
+*
+* Description:
+*   Runs the monitor for a number of control loops with the same command and
+*   speed, and checks it puts out the same duty in every one
+*
+* Arguments:
+*   duty - commanded duty cycle
+*   rpm - measured fan speed (rpm)
+*   out - duty expected out of every loop
+*   loops - number of control loops to run
+*
+* Returns:
+*   none
+******************************************************************************/
+static void expectRun ( byte duty, unsigned int rpm, byte out, unsigned int loops )
+{
+  unsigned int wrong = 0; // loops which put out another duty
+  unsigned int loop;
+  byte         got;       // duty put out
+
+  for ( loop = 0; loop < loops; loop++ )
+  {
+    got = fanMonUpdate ( &mon, duty, rpm );
+    if ( ( got != out ) && ( wrong++ == 0 ) )
+      printf ( "  loop %u of %u: duty %u, expected %u\n", loop, loops, got, out );
+  }
+  TEST_EQUAL ( wrong, 0 );
+
+  return;
+} // end of expectRun()
+
+/******************************************************************************
+* Function:
+*   checkStartKicks()
+*
+* Description:
+*   Turns the fan on with it never turning, and checks each spin-up wait
+*   and kick, up to the fault
+*
+* Arguments:
+*   none
+*
+* Returns:
+*   none
+******************************************************************************/
+static void checkStartKicks ( void )
+{
+  byte kick;
+
+  expectRun ( DUTY, 0, DUTY, SPINUP_LOOPS );
+  for ( kick = 1; kick <= FANMON_MAX_KICKS; kick++ )
+  {
+    expectRun ( DUTY, 0, FANMON_KICK_DUTY, KICK_LOOPS );
+    TEST_EQUAL ( mon.stalls, kick );
+    TEST_EQUAL ( mon.kickCnt, kick );
+    TEST_EQUAL ( fanMonFault ( &mon ), LOW );
+    expectRun ( DUTY, 0, DUTY, SPINUP_LOOPS );
+  }
+
+  expectRun ( DUTY, 0, 0, RETRY_LOOPS ); // faulted, and left off
+  TEST_EQUAL ( mon.state, FANMON_FAULT );
+  TEST_EQUAL ( fanMonFault ( &mon ), HIGH );
+  TEST_EQUAL ( mon.stalls, FANMON_MAX_KICKS + 1 );
+  TEST_EQUAL ( mon.kickCnt, FANMON_MAX_KICKS );
+
+  return;
+} // end of checkStartKicks()
+
+int main ( void )
+{
+  expectRun ( 0, 0, 0, 10 ); // off from power up
+  TEST_EQUAL ( mon.state, FANMON_OFF );
+
+  checkStartKicks ( );
+
+  /* One kick each retry, faulting again straight after a failed one */
+  expectRun ( DUTY, 0, FANMON_KICK_DUTY, KICK_LOOPS );
+  expectRun ( DUTY, 0, DUTY, SPINUP_LOOPS );
+  TEST_EQUAL ( fanMonFault ( &mon ), HIGH ); // still faulted through the retry
+  expectRun ( DUTY, 0, 0, RETRY_LOOPS );
+  TEST_EQUAL ( mon.stalls, FANMON_MAX_KICKS + 2 );
+  TEST_EQUAL ( mon.kickCnt, FANMON_MAX_KICKS + 1 );
+
+  /* A retry kick which starts the fan clears the fault */
+  expectRun ( DUTY, 0, FANMON_KICK_DUTY, KICK_LOOPS );
+  expectRun ( DUTY, 0, DUTY, 1 );
+  expectRun ( DUTY, RPM, DUTY, 5 );
+  TEST_EQUAL ( mon.state, FANMON_RUN );
+  TEST_EQUAL ( fanMonFault ( &mon ), LOW );
+  TEST_EQUAL ( mon.kicks, 0 );
+
+  /* A running fan which stops is kicked straight away, with all its kicks
+   * back */
+  expectRun ( DUTY, 0, FANMON_KICK_DUTY, KICK_LOOPS );
+  expectRun ( DUTY, RPM, DUTY, 5 );
+  TEST_EQUAL ( mon.state, FANMON_RUN );
+  TEST_EQUAL ( mon.stalls, FANMON_MAX_KICKS + 3 );
+  TEST_EQUAL ( mon.kickCnt, FANMON_MAX_KICKS + 3 );
+  expectRun ( DUTY, 0, FANMON_KICK_DUTY, KICK_LOOPS );
+  expectRun ( DUTY, 0, DUTY, SPINUP_LOOPS );
+  expectRun ( DUTY, 0, FANMON_KICK_DUTY, KICK_LOOPS );
+  expectRun ( DUTY, 0, DUTY, SPINUP_LOOPS );
+  expectRun ( DUTY, 0, FANMON_KICK_DUTY, KICK_LOOPS );
+  expectRun ( DUTY, 0, DUTY, SPINUP_LOOPS );
+  expectRun ( DUTY, 0, 0, 1 );
+  TEST_EQUAL ( fanMonFault ( &mon ), HIGH );
+
+  /* Commanding the fan off clears the fault, and it never stalls while
+   * off.  Turned on again, it starts afresh. */
+  expectRun ( 0, 0, 0, 3 * RETRY_LOOPS );
+  TEST_EQUAL ( mon.state, FANMON_OFF );
+  TEST_EQUAL ( fanMonFault ( &mon ), LOW );
+  TEST_EQUAL ( mon.stalls, FANMON_MAX_KICKS + 7 );
+  mon.stalls  = 0;
+  mon.kickCnt = 0;
+  checkStartKicks ( );
+
+  return testResult ( "fanMonitorTest" );
+}
@@ -0,0 +1,85 @@
+/*
+ * fanPlant.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+
+#ifndef FANPLANT_H_
+#define FANPLANT_H_
+
+/*******************************************************************************
+ * INCLUDED HEADER FILES
+ ******************************************************************************/
+#include <math.h>
+#include "Arduino.h"
+#include "fanControlUtils.h"
+
+/*******************************************************************************
+ * MACRO DEFINITIONS
+ ******************************************************************************/
+#define FAN_PLANT_DT      ( LOOPTIME_US / 1e6 ) // time step of the model, one control loop (seconds)
+#define FAN_PLANT_STALL   20                    // duty below which the fan stops (duty counts)
+#define FAN_PLANT_MEAS_K  384                   // weight of the old value in the speed measurement filter (1/1024ths)
+
+/*******************************************************************************
+ * TYPE DEFINITIONS
+ ******************************************************************************/
+/* Model of a fan and its speed measurement.  The steady speed rises with
+ * the duty as a 0.75 power law from 400 rpm just above the stall duty to
+ * 3000 rpm at full duty, the speed follows it with a first order lag, and
+ * the measured speed is filtered like the hall sensor period average. */
+typedef struct FAN_PLANT {
+  double tau;  // time constant of the fan speed (seconds)
+  double rpm;  // fan speed (rpm)
+  double meas; // measured fan speed (rpm)
+} FAN_PLANT_TYPE;
+
+/*******************************************************************************
+ * FUNCTION DEFINITIONS
+ ******************************************************************************/
+
+/******************************************************************************
+* Function:
+*   fanPlantSteady()
+*
+* Description:
+*   Returns the speed a fan settles at for a duty
+*
+* Arguments:
+*   duty - PWM duty (duty counts)
+*
+* Returns:
+*   rpm - steady speed (rpm)
+******************************************************************************/
+static inline double fanPlantSteady ( double duty )
+{
+  if ( duty < FAN_PLANT_STALL )
+    return 0;
+
+  return 400 + 2600 * pow ( ( duty - FAN_PLANT_STALL ) / ( 255.0 - FAN_PLANT_STALL ), 0.75 );
+} // end of fanPlantSteady()
+
+/******************************************************************************
+* Function:
+*   fanPlantStep()
+*
+* Description:
+*   Moves a fan model on by one control loop, and returns the measured speed
+*
+* Arguments:
+*   plant - fan model
+*   duty - PWM duty over the loop (duty counts)
+*
+* Returns:
+*   meas - measured fan speed (rpm)
+******************************************************************************/
+static inline unsigned int fanPlantStep ( FAN_PLANT_TYPE *plant, byte duty )
+{
+  plant->rpm  += ( fanPlantSteady ( duty ) - plant->rpm ) * FAN_PLANT_DT / plant->tau;
+  plant->meas  = ( plant->meas * FAN_PLANT_MEAS_K + plant->rpm * ( 1024 - FAN_PLANT_MEAS_K ) ) / 1024;
+
+  return (unsigned int) plant->meas;
+} // end of fanPlantStep()
+
+#endif /* FANPLANT_H_ */
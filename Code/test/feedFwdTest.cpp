@@ -0,0 +1,236 @@
+/*
+ * feedFwdTest.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+
+/* Checks the temperature rise feedforward on its own (no boost while the
+ * temperature is steady or falling, and the boost a steady rise should
+ * give), then in a thermal model of the cabinet: a load step must peak
+ * lower with more feedforward gain, and settle at the same temperature. */
+
+/*******************************************************************************
+ * INCLUDED HEADER FILES
+ ******************************************************************************/
+#include <math.h>
+#include "feedFwd.h"
+#include "fanCurve.h"
+#include "refShape.h"
+#include "savedVars.h"
+#include "testUtil.h"
+
+/*******************************************************************************
+ * MACRO DEFINITIONS
+ ******************************************************************************/
+#define DT_S           ( LOOPTIME_US / 1e6 )                     // time step, one control loop (seconds)
+#define DIG_PER_DEGC   ( (double) ( TEMP_DIG_MAX + 1 ) / 250.0 ) // digital temperature counts per degC (default scale of 250 degC per 5 V)
+#define AMBIENT_DEGC   25.0                                      // temperature outside the cabinet (degC)
+#define IDLE_W         25.0                                      // heat load while idle (W)
+#define HEAT_CAP_J     1500.0                                    // heat capacity of the cabinet air and parts (J/degC)
+#define LEAK_W         1.0                                       // heat conductance of the cabinet walls (W/degC)
+#define FAN_W_PER_RPM  0.005                                     // heat conductance the fan adds per rpm (W/degC)
+#define SENSOR_TAU     90.0                                      // time constant of the temperature sensor mounting (seconds)
+#define FAN_TAU        2.0                                       // time constant of the fan speed (seconds)
+#define FAN_FULL_W     3.0                                       // fan power at the maximum speed (W)
+#define LOAD_ON_S      60.0                                      // time the load step starts (seconds)
+#define LOAD_OFF_S     900.0                                     // time the load step ends (seconds)
+#define RUN_S          1800.0                                    // length of a run (seconds)
+
+/*******************************************************************************
+ * TYPE DEFINITIONS
+ ******************************************************************************/
+/* Result of a thermal run */
+typedef struct THERMAL_RESULT {
+  double peak;     // highest cabinet temperature during the load (degC)
+  double final;    // cabinet temperature at the end (degC)
+  double energy;   // fan energy (J)
+  byte   boostMax; // high if the boost ever went over ffMax
+} THERMAL_RESULT_TYPE;
+
+/*******************************************************************************
+ * FUNCTION DEFINITIONS
+ ******************************************************************************/
+
+/******************************************************************************
+* Function:
+*   runRamp()
+*
+* Description:
+*   Feeds a temperature which changes by a fixed amount at each sample into
+*   a fresh feedforward, and returns the boost at the end
+*
+* Arguments:
+*   step - change in temperature per sample (digital counts)
+*   samples - number of samples
+*
+* Returns:
+*   boost - speed boost after the last sample (rpm)
+******************************************************************************/
+static unsigned int runRamp ( int step, int samples )
+{
+  FEED_FWD_TYPE ff    = { 0, 0, 0, 0 };   // feedforward
+  long int      temp  = TEMP_DIG_MAX / 2; // temperature (digital counts)
+  unsigned int  boost = 0;                // speed boost (rpm)
+  int           k;                        // loop count
+
+  for ( k = 0; k < samples * FF_SAMPLE_LOOPS; k++ )
+  {
+    if ( ( k % FF_SAMPLE_LOOPS ) == 0 )
+      temp += step;
+    boost = feedFwdUpdate ( &ff, (unsigned int) temp );
+  }
+
+  return boost;
+} // end of runRamp()
+
+/******************************************************************************
+* Function:
+*   checkRamps()
+*
+* Description:
+*   Checks the boost for steady, falling and rising temperatures
+*
+* Arguments:
+*   none
+*
+* Returns:
+*   none
+******************************************************************************/
+static void checkRamps ( void )
+{
+  unsigned int boost;
+  int          step;
+
+  TEST_EQUAL ( runRamp ( 0, 100 ), 0 );
+  TEST_EQUAL ( runRamp ( -3, 100 ), 0 );
+  for ( step = 1; step * FF_PER_MIN * ffGain < ffMax; step++ ) // rate filter settles within a count per minute of the rise
+  {
+    boost = runRamp ( step, 100 );
+    TEST_CHECK ( ( boost <= step * FF_PER_MIN * ffGain ) && ( boost + ffGain >= step * FF_PER_MIN * ffGain ) );
+  }
+  TEST_EQUAL ( runRamp ( 100, 100 ), ffMax );
+
+  return;
+} // end of checkRamps()
+
+/******************************************************************************
+* Function:
+*   runThermal()
+*
+* Description:
+*   Runs the cabinet model through a load step, with fan 1's default fan
+*   curve, reference shaping and feedforward setting the fan speed the way
+*   setRefSpeeds() and shapeRefSpeeds() do.  The fan follows its reference
+*   with a lag, its speed sets how well the cabinet is cooled, and the
+*   temperature is read through the lag of the sensor mounting.
+*
+* Arguments:
+*   gain - feedforward gain (ffGain)
+*   loadW - heat load during the step (W)
+*
+* Returns:
+*   result - peak and final temperature, and fan energy
+******************************************************************************/
+static THERMAL_RESULT_TYPE runThermal ( unsigned int gain, double loadW )
+{
+  const unsigned int  x [ 5 ] = { fan1TurnOnTmp, fan1TblTmp1, fan1TblTmp2, fan1TblTmp3, fan1TblTmp4 }; // fan curve temperatures
+  const unsigned int  y [ 5 ] = { minRpm1, fan1TblSpd1, fan1TblSpd2, fan1TblSpd3, fan1TblSpd4 };       // fan curve speeds
+  THERMAL_RESULT_TYPE result  = { 0, 0, 0, LOW };                                                     // result of the run
+  FAN_CURVE_TYPE      curve;                                                                          // fan curve
+  REF_SHAPE_TYPE      shape   = { 0 };                                                                // reference shaping
+  FEED_FWD_TYPE       ff      = { 0, 0, 0, 0 };                                                       // feedforward
+  double              dt      = DT_S;                                                                 // time step (seconds)
+  double              temp    = AMBIENT_DEGC;                                                         // cabinet temperature (degC)
+  double              sensed  = AMBIENT_DEGC;                                                         // sensor temperature (degC)
+  double              rpm     = 0;                                                                    // fan speed (rpm)
+  double              heatW;                                                                          // heat load (W)
+  double              t;                                                                              // time (seconds)
+  unsigned int        tempDig;                                                                        // sensor temperature, stored digitally
+  unsigned int        boost;                                                                          // feedforward speed boost (rpm)
+  unsigned int        ref     = 0;                                                                    // reference fan speed (rpm)
+  long int            k;                                                                              // loop count
+
+  ffGain = gain;
+  fanCurveBuild ( &curve, x, y, 5 );
+  for ( k = 0; k < (long int) ( RUN_S / dt ); k++ )
+  {
+    t       = k * dt;
+    heatW   = ( ( t < LOAD_ON_S ) || ( t > LOAD_OFF_S ) ) ? IDLE_W : loadW;
+    tempDig = (unsigned int) ( sensed * DIG_PER_DEGC );
+    boost   = feedFwdUpdate ( &ff, tempDig );
+    if ( boost > ffMax )
+      result.boostMax = HIGH;
+
+    if ( tempDig <= fan1TurnOffTmp )
+      ref = 0;
+    else if ( tempDig <= fan1TurnOnTmp )
+    {
+      if ( ref > 0 )
+        ref = minRpm1;
+    }
+    else
+      ref = fanCurveEval ( &curve, tempDig );
+    if ( ( ref > 0 ) && ( boost > 0 ) )
+      ref += boost;
+    ref = refShapeUpdate ( &shape, ref, minRpm1 );
+    if ( ref > maxRpm1 )
+      ref = maxRpm1;
+
+    rpm    += ( ref - rpm ) * dt / FAN_TAU;
+    temp   += ( heatW - ( LEAK_W + FAN_W_PER_RPM * rpm ) * ( temp - AMBIENT_DEGC ) ) / HEAT_CAP_J * dt;
+    sensed += ( temp - sensed ) * dt / SENSOR_TAU;
+    if ( ( t > LOAD_ON_S ) && ( temp > result.peak ) )
+      result.peak = temp;
+    result.energy += FAN_FULL_W * pow ( rpm / maxRpm1, 3 ) * dt;
+  }
+  result.final = temp;
+
+  return result;
+} // end of runThermal()
+
+/******************************************************************************
+* Function:
+*   checkThermal()
+*
+* Description:
+*   Checks that more feedforward gain lowers the peak temperature of a load
+*   step, and leaves the temperature it settles at alone
+*
+* Arguments:
+*   loadW - heat load during the step (W)
+*
+* Returns:
+*   none
+******************************************************************************/
+static void checkThermal ( double loadW )
+{
+  static const unsigned int gains [ ] = { 0, 8, 16 }; // feedforward gains (off, default, double)
+  THERMAL_RESULT_TYPE       result [ 3 ];
+  byte                      g;
+
+  for ( g = 0; g < 3; g++ )
+  {
+    result [ g ] = runThermal ( gains [ g ], loadW );
+    printf ( "  ffGain %2u, %3.0f W load: peak %.2f degC, final %.2f degC, fan energy %.0f J\n",
+             gains [ g ], loadW, result [ g ].peak, result [ g ].final, result [ g ].energy );
+    TEST_CHECK ( !result [ g ].boostMax );
+  }
+  TEST_CHECK ( result [ 1 ].peak < result [ 0 ].peak - 0.25 );
+  TEST_CHECK ( result [ 2 ].peak < result [ 1 ].peak - 0.25 );
+  TEST_CHECK ( fabs ( result [ 2 ].final - result [ 0 ].final ) < 0.2 );
+
+  return;
+} // end of checkThermal()
+
+int main ( void )
+{
+  unsigned int defGain = ffGain; // default feedforward gain
+
+  checkRamps ( );
+  checkThermal ( 120 );
+  checkThermal ( 150 );
+  ffGain = defGain;
+
+  return testResult ( "feedFwdTest" );
+}
@@ -0,0 +1,224 @@
+/*
+ * hallCaptureTest.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+
+/* Feeds the same stream of hall edges to both hall backends, against a
+ * model of timer1 on a simulated clock, and compares what each puts in its
+ * edge ring with the true edge times.  The edges come while interrupts are
+ * held off for a random time, as they are by the other interrupts and
+ * critical sections on the target.  The ICP1 backend must timestamp every
+ * edge exactly, across the wraps of the 16-bit counter, and so measure the
+ * true hall period.  The EXTINT backend timestamps each edge late by the
+ * time interrupts were held off, and its period wanders by that much.
+ *
+ * The glitch filter holds each edge back until the next one, so after each
+ * edge the ring must hold every edge up to the one before it.
+ *
+ * The hall interrupts themselves are in fanControlUtils.cpp, which needs
+ * the whole controller, so the ones here copy them: each samples the hall
+ * level and pushes to its ring just as the original does.  They leave out
+ * the wait for the PWM outputs to be quiet, which hallGlitchTest covers. */
+
+/*******************************************************************************
+ * INCLUDED HEADER FILES
+ ******************************************************************************/
+#include "timeBase.h"
+#include "hallRing.h"
+#include "timer1Sim.h"
+#include "testUtil.h"
+
+/*******************************************************************************
+ * MACRO DEFINITIONS
+ ******************************************************************************/
+#define RUN_EDGES   2000 // hall edges in each run
+#define BATCH_EDGES 4    // edges between period updates (about one control loop tick of a fast fan)
+#define START_US    1234 // time the timer is started (microseconds)
+
+/*******************************************************************************
+ * FUNCTION DECLARATIONS
+ ******************************************************************************/
+ISR ( TIMER1_COMPA_vect ); // scheduler tick interrupt, in sysTimer.cpp
+ISR ( TIMER1_OVF_vect );   // overflow interrupt, in sysTimer.cpp
+
+/*******************************************************************************
+ * STATIC VARIABLE DEFINITIONS
+ ******************************************************************************/
+static HALL_RING_TYPE captRing; // edges timestamped by the ICP1 backend
+static HALL_RING_TYPE extRing;  // edges timestamped by the EXTINT backend
+static byte           hallLevel; // hall sensor level, as HALL1_READ() would read it
+
+/*******************************************************************************
+ * FUNCTION DEFINITIONS
+ ******************************************************************************/
+
+/* Copy of ISR(TIMER1_CAPT_vect) for HALL_BACKEND_ICP1 */
+static void captISR ( void )
+{
+  unsigned int capture = ICR1; // timer1 count latched on the edge
+  byte         level;          // hall level after the edge
+
+  level = hallLevel;
+  if ( level )
+    TCCR1B &= ~_BV ( ICES1 ); // high, so capture the falling edge next
+  else
+    TCCR1B |= _BV ( ICES1 );  // low, so capture the rising edge next
+  TIFR1 = _BV ( ICF1 );       // changing the edge may set the capture flag, so clear it
+
+  hallRingPush ( &captRing, sysTimerExtend ( capture ), level );
+
+  return;
+} // end of captISR()
+
+/* Copy of hall1ISR() for HALL_BACKEND_EXTINT */
+static void extISR ( void )
+{
+  unsigned long stamp = timeBaseNow ( ); // time of the edge (timer1 counts)
+
+  hallRingPush ( &extRing, stamp, hallLevel );
+
+  return;
+} // end of extISR()
+
+/******************************************************************************
+* Function:
+*   checkInit()
+*
+* Description:
+*   Checks sysTimerCaptureInit() starts the capture unit on rising edges
+*   with the noise canceller on, without upsetting the rest of timer1 or
+*   the interrupt state
+*
+* Arguments:
+*   none
+*
+* Returns:
+*   none
+******************************************************************************/
+static void checkInit ( void )
+{
+  byte tccr1b = TCCR1B; // timer1 control before
+  byte timsk1 = TIMSK1; // timer1 interrupt enables before
+
+  TIFR1 = 0;
+  timer1Sim.flags |= _BV ( ICF1 ); // stale capture from before
+  cli ( );
+  sysTimerCaptureInit ( );
+  TEST_CHECK ( !( SREG & SREG_I ) ); // left off, as it was
+  sei ( );
+  sysTimerCaptureInit ( );
+  TEST_CHECK ( SREG & SREG_I ); // left on, as it was
+
+  TEST_EQUAL ( TCCR1B, tccr1b | _BV ( ICNC1 ) | _BV ( ICES1 ) );
+  TEST_EQUAL ( TIMSK1, timsk1 | _BV ( ICIE1 ) );
+  TEST_EQUAL ( timer1Sim.flags & _BV ( ICF1 ), 0 );
+
+  return;
+} // end of checkInit()
+
+/******************************************************************************
+* Function:
+*   runEdges()
+*
+* Description:
+*   Runs a fan at a steady speed, with an uneven hall duty cycle, giving
+*   each edge to both backends while interrupts are held off for up to a
+*   limit.  Checks each ICP1 timestamp is the true edge count, each EXTINT
+*   timestamp is late by the hold, and the periods measured by each.  Each
+*   edge is checked once the next one has let it through the glitch filter.
+*
+* Arguments:
+*   periodUs - full hall period (microseconds)
+*   holdMaxUs - longest time interrupts are held off (microseconds), under
+*               half a hall period and half a timer1 wrap
+*
+* Returns:
+*   none
+******************************************************************************/
+static void runEdges ( unsigned long periodUs, unsigned long holdMaxUs )
+{
+  HALL_EST_TYPE      captEst   = { { 0, 0 }, 0, 0, 0 };           // period estimate from the ICP1 backend
+  HALL_EST_TYPE      extEst    = { { 0, 0 }, 0, 0, 0 };           // period estimate from the EXTINT backend
+  unsigned long      highUs    = periodUs * 2 / 5;                // time the hall signal is high in each period (microseconds)
+  unsigned long      period    = periodUs * SYSTIMER_CNTS_PER_US; // full hall period (timer1 counts)
+  unsigned long      captWrong = 0;                               // ICP1 timestamps or periods which weren't true
+  unsigned long      extWrong  = 0;                               // EXTINT timestamps which weren't late by the hold
+  unsigned long      extErr    = 0;                               // largest error of the EXTINT period (timer1 counts)
+  unsigned long      edgeUs    = micros ( );                      // time of the edge (microseconds)
+  unsigned long long edgeCnt   = 0;                               // true count at the edge
+  unsigned long long prevCnt;                                     // true count at the edge before
+  unsigned long      holdUs    = 0;                               // time interrupts are held off at this edge (microseconds)
+  unsigned long      prevHoldUs;                                  // time interrupts were held off at the edge before (microseconds)
+  unsigned long      err;                                         // error of the EXTINT period (timer1 counts)
+  unsigned long      n;                                           // edge number
+  byte               rising;                                      // high for a rising edge
+
+  memset ( &captRing, 0, sizeof ( captRing ) );
+  memset ( &extRing, 0, sizeof ( extRing ) );
+  hallLevel = LOW; // first edge is rising
+  hallRingInit ( &captRing, hallLevel );
+  hallRingInit ( &extRing, hallLevel );
+  TCCR1B |= _BV ( ICES1 );
+
+  for ( n = 0; n < RUN_EDGES; n++ )
+  {
+    rising = ( ( n & 1 ) == 0 );
+    edgeUs += rising ? periodUs - highUs : highUs;
+    timer1SimRun ( edgeUs - micros ( ) );
+    prevCnt    = edgeCnt;
+    prevHoldUs = holdUs;
+    edgeCnt    = timer1SimCount ( );
+    holdUs     = ( testRandom ( 4 ) == 0 ) ? 0 : testRandom ( holdMaxUs + 1 );
+
+    cli ( ); // the edge comes while interrupts are held off
+    hallLevel = rising;
+    timer1SimEdge ( rising );
+    timer1SimRun ( holdUs );
+    sei ( );
+    extISR ( );          // external interrupts come first
+    timer1SimService ( ); // then the capture
+
+    if ( ( captRing.head != (byte) n ) ||
+         ( ( n > 0 ) && ( (uint32_t) captRing.stamp [ ( n - 1 ) & HALL_RING_MASK ] != (uint32_t) prevCnt ) ) )
+      captWrong++;
+    if ( ( extRing.head != (byte) n ) ||
+         ( ( n > 0 ) && ( (uint32_t) ( extRing.stamp [ ( n - 1 ) & HALL_RING_MASK ] - prevCnt ) != prevHoldUs * SYSTIMER_CNTS_PER_US ) ) )
+      extWrong++;
+
+    if ( ( n % BATCH_EDGES ) == BATCH_EDGES - 1 ) // main loop reads the rings
+    {
+      hallRingUpdate ( &captRing, &captEst );
+      hallRingUpdate ( &extRing, &extEst );
+      if ( ( n >= 2 ) && ( (uint32_t) captEst.period != period ) )
+        captWrong++;
+      err = labs ( (long) (int32_t) ( extEst.period - period ) );
+      if ( err > extErr )
+        extErr = err;
+    }
+  }
+  TEST_EQUAL ( captWrong, 0 );
+  TEST_EQUAL ( extWrong, 0 );
+  TEST_CHECK ( extErr > 0 );                                     // the hold shows up in the EXTINT period...
+  TEST_CHECK ( extErr <= holdMaxUs * SYSTIMER_CNTS_PER_US ); // ...but no more than the longest hold
+  TEST_EQUAL ( captRing.drops + extRing.drops, 0 );
+  TEST_EQUAL ( captRing.glitches + extRing.glitches, 0 );
+
+  return;
+} // end of runEdges()
+
+int main ( void )
+{
+  timer1SimInit ( TIMER1_COMPA_vect, TIMER1_OVF_vect );
+  timer1Sim.capt = captISR;
+  shimAdvanceUs ( START_US );
+  sysTimerInit ( );
+
+  checkInit ( );
+  runEdges ( 20000, 1000 );   // 1500 rpm, with short holds
+  runEdges ( 100000, 16000 ); // 300 rpm, held off for up to half a wrap
+  runEdges ( 65536, 16000 );  // one period every two wraps
+
+  return testResult ( "hallCaptureTest" );
+}
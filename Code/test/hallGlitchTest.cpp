@@ -0,0 +1,446 @@
+/*
+ * hallGlitchTest.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+
+/* Runs a fan at speeds from 300 to 9000 rpm, in both measurement modes,
+ * with a noisy hall signal: a short spike at random PWM switching instants,
+ * and 40 us glitches at random times between the real edges.  The hall
+ * interrupt is modelled cycle by cycle: it runs on each change of the pin,
+ * once the one before has returned, and changes while it runs leave it
+ * pending, as the external interrupt flag does.  It waits in the real
+ * pwmOutQuiet(), against a model of timer0 on the same clock, before it
+ * samples the signal.
+ *
+ * The level must never be sampled during a spike.  Every real edge must
+ * get through the glitch filter exactly once, and no glitch or spike must.  Each interrupt is either an edge let through, the
+ * edge still pending, or a rejected glitch, so the glitch count must make
+ * up the rest.  In period timing mode, each timestamp in the ring must be
+ * within the interrupt latency of its real edge, with none skipped, and
+ * every period in either mode must be within twice that, from the first,
+ * even when a fast fan fills the ring before it is first read.
+ *
+ * The hall interrupt itself is in fanControlUtils.cpp, which needs the
+ * whole controller, so the one here copies it, with its timestamp and hall
+ * level taken from the model. */
+
+/*******************************************************************************
+ * INCLUDED HEADER FILES
+ ******************************************************************************/
+#include "hallRing.h"
+#include "pwmOut.h"
+#include "timeBase.h"
+#include "timer0Sim.h"
+#include "testUtil.h"
+
+/*******************************************************************************
+ * MACRO DEFINITIONS
+ ******************************************************************************/
+#define CYCLES_PER_US   ( F_CPU / 1000000UL )                    // cpu cycles per microsecond
+#define CYCLES_PER_CNT  ( CYCLES_PER_US / SYSTIMER_CNTS_PER_US ) // cpu cycles per timer1 count
+#define PWM_CYCLES      256                                      // cpu cycles in each PWM period
+#define PWM1_DUTY       100                                      // duty of PWM output 1, so a switching instant at count 100
+#define PWM2_DUTY       180                                      // duty of PWM output 2, so a switching instant at count 180
+#define SPIKE_CYCLES    14                                       // length of a PWM spike, inside the blanking window (cpu cycles)
+#define SPIKE_ODDS      8                                        // one switching instant in this many has a spike
+#define GLITCH_CYCLES   ( 40 * CYCLES_PER_US )                   // length of a glitch (cpu cycles)
+#define GLITCH_GAP_US   400                                      // shortest time from the end of one glitch to the next (microseconds)
+#define GLITCH_MEAN_US  4000                                     // mean time between glitches (microseconds)
+#define MAX_GLITCHES    1000                                     // most glitches in one run
+#define ENTRY_CYCLES    32                                       // cpu cycles from the interrupt being taken to its timestamp
+#define SAMPLE_CYCLES   10                                       // cpu cycles from the end of the last read of the count in pwmOutQuiet() to the level being sampled, inside PWMOUT_LEAD_CNTS
+#define EXIT_CYCLES     80                                       // cpu cycles from sampling the level to returning
+#define JITTER_CNTS     50                                       // most a timestamp can be off its real edge, either way (timer1 counts)
+#define LOOP_US         50000                                    // control loop period (microseconds)
+#define RUN_LOOPS       40                                       // control loops at each speed
+#define SETTLE_LOOPS    6                                        // loops before the measurement mode is checked
+#define NO_EDGE         0xFFFFFFFFFFFFFFFFULL                    // no boundary
+
+/*******************************************************************************
+ * TYPE DEFINITIONS
+ ******************************************************************************/
+/* The hall signal during one run */
+typedef struct TRACE {
+  unsigned long long start;                    // time the run starts (cpu cycles)
+  unsigned long long end;                      // time the run ends (cpu cycles)
+  unsigned long long firstEdge;                // time of the first real edge, which is rising (cpu cycles)
+  unsigned long long halfPeriod;               // time between real edges (cpu cycles)
+  unsigned long long glitch [ MAX_GLITCHES ]; // start times of the glitches (cpu cycles)
+  unsigned int       numGlitches;              // number of glitches
+  unsigned int       nextGlitch;               // first glitch which hasn't ended yet
+} TRACE_TYPE;
+
+/*******************************************************************************
+ * STATIC VARIABLE DEFINITIONS
+ ******************************************************************************/
+static TRACE_TYPE     trace;      // hall signal
+static HALL_RING_TYPE ring;       // edge ring
+static HALL_EST_TYPE  est;        // period estimate
+static byte           instant [ 3 ]; // PWM switching instants (timer0 counts)
+
+/*******************************************************************************
+ * FUNCTION DEFINITIONS
+ ******************************************************************************/
+
+/******************************************************************************
+* Function:
+*   spikeAt()
+*
+* Description:
+*   Picks which PWM switching instants have a spike, from a hash of the
+*   instant, so the signal at any time can be worked out afresh
+*
+* Arguments:
+*   period - number of the PWM period
+*   i - switching instant in the period
+*
+* Returns:
+*   spike - high if the instant has a spike
+******************************************************************************/
+static byte spikeAt ( unsigned long long period, byte i )
+{
+  uint32_t hash = (uint32_t) ( period * 3 + i ) * 2654435761UL; // Knuth multiplicative hash
+
+  return ( ( hash >> 24 ) % SPIKE_ODDS ) == 0;
+} // end of spikeAt()
+
+/******************************************************************************
+* Function:
+*   spikeOn()
+*
+* Description:
+*   Checks whether a PWM spike is on the hall signal at a time
+*
+* Arguments:
+*   t - time (cpu cycles)
+*
+* Returns:
+*   on - high during a spike
+******************************************************************************/
+static byte spikeOn ( unsigned long long t )
+{
+  unsigned long long period = t / PWM_CYCLES; // PWM period of time t
+  byte               phase  = (byte) t;       // timer0 count at time t
+  byte               on     = LOW;            // high during a spike
+  byte               i;
+
+  for ( i = 0; i < 3; i++ )
+    if ( ( (byte) ( phase - instant [ i ] ) < SPIKE_CYCLES ) &&
+         spikeAt ( ( phase >= instant [ i ] ) ? period : period - 1, i ) )
+      on ^= 1;
+
+  return on;
+} // end of spikeOn()
+
+/******************************************************************************
+* Function:
+*   hallLevel()
+*
+* Description:
+*   Gives the level of the hall signal at a time: the fan's own level,
+*   inverted during a glitch, and again during a spike
+*
+* Arguments:
+*   t - time (cpu cycles)
+*
+* Returns:
+*   level - signal level
+******************************************************************************/
+static byte hallLevel ( unsigned long long t )
+{
+  byte         level = LOW; // level at time t
+  unsigned int g;
+
+  if ( t >= trace.firstEdge )
+    level = ( ( ( t - trace.firstEdge ) / trace.halfPeriod ) & 1 ) == 0;
+
+  for ( g = trace.nextGlitch; ( g < trace.numGlitches ) && ( trace.glitch [ g ] <= t ); g++ )
+    if ( t < trace.glitch [ g ] + GLITCH_CYCLES )
+      level ^= 1;
+
+  return level ^ spikeOn ( t );
+} // end of hallLevel()
+
+/******************************************************************************
+* Function:
+*   nextBoundary()
+*
+* Description:
+*   Finds the first time after a time at which the signal might change: a
+*   real edge, or the start or end of a glitch or spike
+*
+* Arguments:
+*   t - time (cpu cycles)
+*
+* Returns:
+*   next - time of the next boundary (cpu cycles)
+******************************************************************************/
+static unsigned long long nextBoundary ( unsigned long long t )
+{
+  unsigned long long next = NO_EDGE; // earliest boundary so far
+  unsigned long long b;              // boundary
+  unsigned long long period;         // PWM period
+  byte               i;
+
+  if ( t < trace.firstEdge )
+    next = trace.firstEdge;
+  else
+    next = trace.firstEdge + ( ( t - trace.firstEdge ) / trace.halfPeriod + 1 ) * trace.halfPeriod;
+
+  while ( ( trace.nextGlitch < trace.numGlitches ) && ( trace.glitch [ trace.nextGlitch ] + GLITCH_CYCLES <= t ) )
+    trace.nextGlitch++;
+  if ( trace.nextGlitch < trace.numGlitches )
+  {
+    b = trace.glitch [ trace.nextGlitch ];
+    if ( b <= t )
+      b += GLITCH_CYCLES;
+    if ( b < next )
+      next = b;
+  }
+
+  for ( period = t / PWM_CYCLES - 1; period * PWM_CYCLES < next; period++ ) // spikes, from the one which may still be on
+    for ( i = 0; i < 3; i++ )
+      if ( spikeAt ( period, i ) )
+      {
+        b = period * PWM_CYCLES + instant [ i ];
+        if ( b <= t )
+          b += SPIKE_CYCLES;
+        if ( ( b > t ) && ( b < next ) )
+          next = b;
+      }
+
+  return next;
+} // end of nextBoundary()
+
+/******************************************************************************
+* Function:
+*   nextChange()
+*
+* Description:
+*   Finds the first time after a time at which the signal does change
+*
+* Arguments:
+*   t - time (cpu cycles)
+*
+* Returns:
+*   next - time of the next change (cpu cycles)
+******************************************************************************/
+static unsigned long long nextChange ( unsigned long long t )
+{
+  unsigned long long next = nextBoundary ( t ); // candidate change
+
+  while ( hallLevel ( next ) == hallLevel ( next - 1 ) ) // boundaries which cancel out
+    next = nextBoundary ( next );
+
+  return next;
+} // end of nextChange()
+
+/******************************************************************************
+* Function:
+*   makeTrace()
+*
+* Description:
+*   Sets up the hall signal for a run at one speed, with glitches at random
+*   times far enough from each real edge that the edge can't be confused
+*   with one
+*
+* Arguments:
+*   start - time the run starts (cpu cycles)
+*   rpm - fan speed, at 2 pulses per revolution
+*
+* Returns:
+*   none
+******************************************************************************/
+static void makeTrace ( unsigned long long start, unsigned long rpm )
+{
+  unsigned long long margin = TIME_US_TO_CNTS ( (unsigned long long) HALL_MIN_EDGE_US + 1 ) * CYCLES_PER_CNT +
+                              JITTER_CNTS * CYCLES_PER_CNT; // closest a glitch may come to a real edge (cpu cycles)
+  unsigned long long g;                                     // glitch start
+  unsigned long long edge;                                  // real edge before the glitch
+
+  trace.start       = start;
+  trace.end         = start + (unsigned long long) RUN_LOOPS * LOOP_US * CYCLES_PER_US;
+  trace.halfPeriod  = 60ULL * 1000000 * CYCLES_PER_US / ( rpm * 2 * HALL_EDGES_PER_PERIOD ) / CYCLES_PER_CNT * CYCLES_PER_CNT;
+  trace.firstEdge   = start + trace.halfPeriod;
+  trace.numGlitches = 0;
+  trace.nextGlitch  = 0;
+
+  for ( g = start + margin; trace.numGlitches < MAX_GLITCHES; )
+  {
+    g += ( GLITCH_GAP_US + testRandom ( 2 * ( GLITCH_MEAN_US - GLITCH_GAP_US ) ) ) * CYCLES_PER_US;
+    if ( g + GLITCH_CYCLES + margin > trace.end )
+      break;
+    edge = ( g < trace.firstEdge ) ? start : trace.firstEdge + ( g - trace.firstEdge ) / trace.halfPeriod * trace.halfPeriod;
+    if ( ( g >= edge + margin ) && ( g + GLITCH_CYCLES + margin <= edge + trace.halfPeriod ) )
+      trace.glitch [ trace.numGlitches++ ] = g;
+  }
+
+  return;
+} // end of makeTrace()
+
+/* Copy of hall1ISR(), with the timestamp and hall level from the model */
+static void hallISR ( void )
+{
+  unsigned long stamp = (unsigned long) ( timer0Sim.cycles / CYCLES_PER_CNT ); // time of the edge (timer1 counts)
+
+  pwmOutQuiet ( );
+  hallRingPush ( &ring, stamp, hallLevel ( timer0Sim.cycles + SAMPLE_CYCLES ) );
+
+  return;
+} // end of hallISR()
+
+/******************************************************************************
+* Function:
+*   checkRing()
+*
+* Description:
+*   Checks each timestamp waiting in the ring is within the jitter of a real
+*   edge, and is the edge after the one before
+*
+* Arguments:
+*   lastEdge - number of the real edge of the last timestamp checked, or -1
+*              for none
+*
+* Returns:
+*   wrong - number of timestamps which weren't right
+******************************************************************************/
+static unsigned long checkRing ( long *lastEdge )
+{
+  unsigned long      wrong = 0; // timestamps which weren't right
+  unsigned long long stamp;     // time of the timestamp (cpu cycles)
+  long               edge;      // number of the nearest real edge
+  byte               i;
+
+  for ( i = ring.tail; i != ring.head; i++ )
+  {
+    stamp = (unsigned long long) ring.stamp [ i & HALL_RING_MASK ] * CYCLES_PER_CNT;
+    edge  = (long) ( ( stamp + trace.halfPeriod / 2 - trace.firstEdge ) / trace.halfPeriod );
+    if ( ( llabs ( (long long) ( stamp - ( trace.firstEdge + edge * trace.halfPeriod ) ) ) > JITTER_CNTS * CYCLES_PER_CNT ) ||
+         ( ( *lastEdge >= 0 ) && ( edge != *lastEdge + 1 ) ) )
+      wrong++;
+    *lastEdge = edge;
+  }
+
+  return wrong;
+} // end of checkRing()
+
+/******************************************************************************
+* Function:
+*   runSpeed()
+*
+* Description:
+*   Runs the fan at one speed from a fresh ring, with the control loop
+*   reading the ring every LOOP_US, and checks what gets through
+*
+* Arguments:
+*   rpm - fan speed, at 2 pulses per revolution
+*   countMode - high if edge counting mode is expected at this speed
+*
+* Returns:
+*   none
+******************************************************************************/
+static void runSpeed ( unsigned long rpm, byte countMode )
+{
+  unsigned long      period;                                                        // true full period (timer1 counts)
+  unsigned long      isrRuns   = 0;                                                 // hall interrupts
+  unsigned long      accepted  = 0;                                                 // edges let through
+  unsigned long      realEdges;                                                     // real edges in the run
+  unsigned long      badStamps = 0;                                                 // ring timestamps not at a real edge
+  unsigned long      badPeriod = 0;                                                 // periods out by more than the jitter
+  unsigned long      badMode   = 0;                                                 // settled loops in the wrong measurement mode
+  unsigned long      inSpike   = 0;                                                 // levels sampled during a spike
+  unsigned long      loops     = 0;                                                 // control loops run
+  long               lastEdge  = -1;                                                // real edge of the last timestamp read
+  unsigned long long t;                                                             // time (cpu cycles)
+  unsigned long long change;                                                        // time of the next change of the signal (cpu cycles)
+  unsigned long long flagAt    = 0;                                                 // time the interrupt flag was set (cpu cycles)
+  unsigned long long isrFree   = 0;                                                 // time the last interrupt returned (cpu cycles)
+  unsigned long long loopAt;                                                        // time of the next control loop (cpu cycles)
+  unsigned long long begin;                                                         // time the pending interrupt can be taken (cpu cycles)
+  unsigned long long lastBegin = 0;                                                 // time the last interrupt was taken (cpu cycles)
+  byte               flag      = LOW;                                               // high while the interrupt is pending
+
+  makeTrace ( timer0Sim.cycles, rpm );
+  memset ( &ring, 0, sizeof ( ring ) );
+  memset ( &est, 0, sizeof ( est ) );
+  hallRingInit ( &ring, LOW ); // fan starts low
+  period = (unsigned long) ( trace.halfPeriod * HALL_EDGES_PER_PERIOD / CYCLES_PER_CNT );
+  t      = trace.start;
+  loopAt = trace.start + (unsigned long long) LOOP_US * CYCLES_PER_US;
+
+  while ( loops < RUN_LOOPS )
+  {
+    change = nextChange ( t );
+    begin  = ( flagAt > isrFree ) ? flagAt : isrFree;
+    if ( ( loopAt < change ) && ( !flag || ( loopAt <= begin ) ) ) // main loop reads the ring between interrupts
+    {
+      if ( !est.countMode )
+        badStamps += checkRing ( &lastEdge );
+      else
+        lastEdge = -1;
+      accepted += hallRingUpdate ( &ring, &est );
+      if ( ( est.period != 0 ) && ( labs ( (long) ( est.period - period ) ) > 2 * JITTER_CNTS ) && ( badPeriod++ == 0 ) )
+        printf ( "  %lu rpm: period %lu read as %lu\n", rpm, period, est.period );
+      if ( ( ++loops > SETTLE_LOOPS ) && ( est.countMode != countMode ) )
+        badMode++;
+      t       = loopAt;
+      loopAt += (unsigned long long) LOOP_US * CYCLES_PER_US;
+    }
+    else if ( flag && ( begin < change ) ) // interrupt is taken
+    {
+      timer0Sim.cycles = begin + ENTRY_CYCLES;
+      hallISR ( );
+      if ( spikeOn ( timer0Sim.cycles + SAMPLE_CYCLES ) ) // the time the level was sampled
+        inSpike++;
+      isrFree = timer0Sim.cycles + EXIT_CYCLES;
+      isrRuns++;
+      flag      = LOW;
+      lastBegin = begin;
+      t         = begin;
+    }
+    else // signal changes, setting the interrupt flag if it isn't already
+    {
+      if ( !flag )
+        flagAt = change;
+      flag = HIGH;
+      t    = change;
+    }
+  }
+  accepted        += hallRingUpdate ( &ring, &est ); // edges let through since the last loop
+  timer0Sim.cycles = t;
+
+  realEdges = ( lastBegin - trace.firstEdge ) / trace.halfPeriod + 1; // edges whose interrupt has run
+  TEST_EQUAL ( accepted + ring.drops + ring.pending, realEdges ); // a fast fan fills the ring before the first loop reads it
+  TEST_EQUAL ( (byte) ( isrRuns - accepted - ring.drops - ring.pending ), ring.glitches ); // every other interrupt was a glitch...
+  TEST_CHECK ( isrRuns > realEdges + 2 * trace.numGlitches );                 // ...from the glitches, and many spikes
+  TEST_CHECK ( trace.numGlitches > 0 );
+  TEST_EQUAL ( badStamps, 0 );
+  TEST_EQUAL ( badPeriod, 0 );
+  TEST_EQUAL ( badMode, 0 );
+  TEST_EQUAL ( inSpike, 0 );
+
+  return;
+} // end of runSpeed()
+
+int main ( void )
+{
+  pwmOutInit ( );
+  pwmOutSet ( PWMOUT_1, PWM1_DUTY );
+  pwmOutSet ( PWMOUT_2, PWM2_DUTY );
+  instant [ 0 ] = 0;
+  instant [ 1 ] = OCR0B;
+  instant [ 2 ] = OCR0A;
+  timer0SimInit ( );
+  timer0Sim.cycles = 1000 * PWM_CYCLES;
+
+  runSpeed ( 300, LOW );
+  runSpeed ( 1000, LOW );
+  runSpeed ( 2000, LOW );
+  runSpeed ( 4000, HIGH );
+  runSpeed ( 6000, HIGH );
+  runSpeed ( 9000, HIGH );
+
+  return testResult ( "hallGlitchTest" );
+}
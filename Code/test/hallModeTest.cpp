@@ -0,0 +1,144 @@
+/*
+ * hallModeTest.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+
+/* Steps a fan through speeds on both sides of the two mode switch
+ * thresholds, and in the band between them from above and from below,
+ * pushing its hall edges through hallRingPush() and reading them with
+ * hallRingUpdate() at random control loop windows.  Edge counting mode
+ * must be asked for only once the period drops below HALL_COUNT_ENTER_US,
+ * and period timing only once it rises above HALL_COUNT_EXIT_US, with no
+ * chattering in between.  Once the edges since a step are all at
+ * the new speed, the period must be exact in either mode, including right
+ * after a switch.  The hall signal has an even duty cycle, as edge counting
+ * assumes.  The glitch filter holds each edge back until the next one, so
+ * the ring only ever sees the edges before the newest. */
+
+/*******************************************************************************
+ * INCLUDED HEADER FILES
+ ******************************************************************************/
+#include "hallRing.h"
+#include "timeBase.h"
+#include "testUtil.h"
+
+/*******************************************************************************
+ * MACRO DEFINITIONS
+ ******************************************************************************/
+#define STEP_US       400000 // time at each speed (microseconds)
+#define WINDOW_MIN_US 2000   // shortest time between updates (microseconds)
+#define WINDOW_MAX_US 40000  // longest time between updates (microseconds)
+#define CYCLES        50     // times round the steps
+
+/*******************************************************************************
+ * TYPE DEFINITIONS
+ ******************************************************************************/
+/* One speed step */
+typedef struct STEP {
+  unsigned long periodUs;  // full hall period (microseconds)
+  byte          countMode; // high if edge counting mode is expected by the end of the step
+} STEP_TYPE;
+
+/*******************************************************************************
+ * STATIC VARIABLE DEFINITIONS
+ ******************************************************************************/
+static const STEP_TYPE steps [ ] =
+{
+  { 13000, LOW },  // above the exit threshold
+  { 11000, LOW },  // in the band from above, so no switch
+  { 9900, HIGH },  // just below the enter threshold
+  { 11000, HIGH }, // in the band from below, so no switch
+  { 12400, HIGH }, // just under the exit threshold
+  { 12600, LOW },  // just over the exit threshold
+  { 11000, LOW },  // in the band from above again
+  { 5000, HIGH },  // well below
+  { 20000, LOW },  // well above
+};
+
+static HALL_RING_TYPE ring; // edge ring
+static HALL_EST_TYPE  est;  // period estimate
+
+/*******************************************************************************
+ * FUNCTION DEFINITIONS
+ ******************************************************************************/
+
+int main ( void )
+{
+  unsigned long long nowUs    = 0;   // time now (microseconds)
+  unsigned long long edgeUs   = 0;   // time of the next edge (microseconds)
+  unsigned long      inexact  = 0;   // settled updates with the wrong period
+  unsigned long      badSwaps = 0;   // mode requests with the period on the wrong side of the threshold
+  unsigned long      wrongEnd = 0;   // steps ending in the wrong mode
+  unsigned long      extra    = 0;   // requests and switches beyond the one of each expected at a step
+  unsigned long      pushes   = 0;   // edges pushed so far
+  unsigned long      edges    = 0;   // edges passed on by the glitch filter so far
+  unsigned long      seen     = 0;   // edges read by the last update which had any
+  unsigned long      firstNew;       // number of the first edge at the new speed
+  byte               newOnly;        // high if the last update with edges only used edges at the new speed
+  byte               settled;        // high if the estimate only used edges at the new speed
+  unsigned long long stepEndUs;      // time the step ends (microseconds)
+  unsigned long      period;         // true full period (timer1 counts)
+  byte               wasReq   = LOW; // mode asked for before the update
+  byte               wasCount = LOW; // mode in use before the update
+  byte               swaps;          // mode requests and switches in this step
+  byte               cycle, step;
+
+  hallRingInit ( &ring, LOW ); // first edge is rising
+  for ( cycle = 0; cycle < CYCLES; cycle++ )
+    for ( step = 0; step < sizeof ( steps ) / sizeof ( steps [ 0 ] ); step++ )
+    {
+      period    = TIME_US_TO_CNTS ( steps [ step ].periodUs );
+      firstNew  = pushes;
+      newOnly   = LOW;
+      settled   = LOW;
+      stepEndUs = nowUs + STEP_US;
+      swaps     = 0;
+      while ( nowUs < stepEndUs )
+      {
+        nowUs += WINDOW_MIN_US + testRandom ( WINDOW_MAX_US - WINDOW_MIN_US );
+        for ( ; edgeUs <= nowUs; edgeUs += steps [ step ].periodUs / HALL_EDGES_PER_PERIOD )
+        {
+          hallRingPush ( &ring, TIME_US_TO_CNTS ( edgeUs ), ( pushes & 1 ) ? LOW : HIGH );
+          pushes++;
+        }
+        edges = ( pushes > 0 ) ? pushes - 1 : 0; // newest edge is still pending
+
+        hallRingUpdate ( &ring, &est );
+        if ( edges > seen ) // new edges, measured from the edge before the edge before them
+        {
+          settled = newOnly && ( seen >= firstNew + 2 ); // one new edge just after a switch gives no period, so two runs of them are needed
+          newOnly = ( seen >= firstNew + 2 );
+          seen    = edges;
+        }
+        if ( ring.countModeReq != wasReq )
+        {
+          swaps++;
+          if ( ring.countModeReq && !( est.period < TIME_US_TO_CNTS ( (unsigned long) HALL_COUNT_ENTER_US ) ) )
+            badSwaps++;
+          if ( !ring.countModeReq && !( est.period > TIME_US_TO_CNTS ( (unsigned long) HALL_COUNT_EXIT_US ) ) )
+            badSwaps++;
+        }
+        if ( est.countMode != wasCount ) // made by the interrupt at the next edge
+          swaps++;
+        wasReq   = ring.countModeReq;
+        wasCount = est.countMode;
+        if ( settled && ( est.period != period ) && ( inexact++ == 0 ) )
+          printf ( "  step %u: period %lu read as %lu in %s mode\n", step, period, est.period, est.countMode ? "counting" : "period" );
+      }
+      if ( ( ring.countModeReq != steps [ step ].countMode ) || ( est.countMode != steps [ step ].countMode ) )
+        wrongEnd++;
+      if ( swaps > 2 )
+        extra += swaps - 2;
+    }
+
+  TEST_EQUAL ( inexact, 0 );
+  TEST_EQUAL ( badSwaps, 0 );
+  TEST_EQUAL ( wrongEnd, 0 );
+  TEST_EQUAL ( extra, 0 );
+  TEST_EQUAL ( ring.drops, 0 );
+  TEST_EQUAL ( ring.glitches, 0 );
+
+  return testResult ( "hallModeTest" );
+}
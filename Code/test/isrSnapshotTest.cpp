@@ -0,0 +1,311 @@
+/*
+ * isrSnapshotTest.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+
+/* Checks that isrSnapshot::read() never returns a torn value.  The value
+ * is copied a byte at a time, as on the target, and a stand-in interrupt
+ * fires after each byte, publishing any number of new values in between.
+ * Every read must give a whole value, no older than the newest one when
+ * the read started.  A plain copy of a value under the same interrupts
+ * is torn, which shows the interrupts land where they would do harm. */
+
+/*******************************************************************************
+ * INCLUDED HEADER FILES
+ ******************************************************************************/
+#include "isrSnapshot.h"
+#include "testUtil.h"
+
+/*******************************************************************************
+ * MACRO DEFINITIONS
+ ******************************************************************************/
+#define VAL_BYTES    8      // bytes in the shared value (a count, then its complement)
+#define MAX_FIRES    40     // interrupts scheduled for one read, after which it fires no more
+#define MAX_PUBLISH  3      // most values published by one interrupt, in the random schedules
+#define RANDOM_READS 200000 // reads with random interrupt schedules
+
+/*******************************************************************************
+ * CLASS DECLARATIONS
+ ******************************************************************************/
+
+/*
+ * Class:		isrByte
+ * Function:	NA
+ * Scope:		global
+ * Arguments:	NA
+ * Description:	A byte whose copy lets the stand-in interrupt fire
+ *				straight after it, as it could between the byte loads of a
+ *				copy on the target.
+ */
+class isrByte
+{
+public:
+byte val; // value of the byte
+
+isrByte &operator= ( const isrByte &from ); // copies the byte, then lets the interrupt fire
+};
+
+/*******************************************************************************
+ * TYPE DEFINITIONS
+ ******************************************************************************/
+/* Value shared with the interrupt: a count in the first four bytes, and
+ * its complement in the last four, so a mix of two values doesn't match */
+typedef struct SHARED_VAL {
+  isrByte b [ VAL_BYTES ]; // bytes of the value, copied one at a time
+} SHARED_VAL_TYPE;
+
+/*******************************************************************************
+ * STATIC VARIABLE DEFINITIONS
+ ******************************************************************************/
+static isrSnapshot<SHARED_VAL_TYPE> snap;                // value under test
+static SHARED_VAL_TYPE              plain;               // value shared without a snapshot, to show the tearing
+static byte                         toPlain;             // high if the interrupt writes the plain value instead
+static unsigned long                count;               // count in the newest value published
+static byte                         fires [ MAX_FIRES ]; // values published by each interrupt of this read
+static byte                         numFires;            // interrupts scheduled for this read
+static byte                         fireIdx;             // next interrupt of this read
+static byte                         inIsr;               // high while the interrupt runs, so it doesn't interrupt itself
+
+/*******************************************************************************
+ * FUNCTION DEFINITIONS
+ ******************************************************************************/
+
+/******************************************************************************
+* Function:
+*   makeVal()
+*
+* Description:
+*   Makes the value holding a count
+*
+* Arguments:
+*   n - count
+*
+* Returns:
+*   val - value
+******************************************************************************/
+static SHARED_VAL_TYPE makeVal ( unsigned long n )
+{
+  SHARED_VAL_TYPE val; // value
+  byte            i;
+
+  for ( i = 0; i < VAL_BYTES / 2; i++ )
+  {
+    val.b [ i ].val                 = (byte) ( n >> ( 8 * i ) );
+    val.b [ i + VAL_BYTES / 2 ].val = (byte) ~( n >> ( 8 * i ) );
+  }
+
+  return val;
+} // end of makeVal()
+
+/******************************************************************************
+* Function:
+*   valCount()
+*
+* Description:
+*   Returns the count a value holds, if it is whole
+*
+* Arguments:
+*   val - value
+*   whole - set high if the value is whole, low if it is torn
+*
+* Returns:
+*   n - count
+******************************************************************************/
+static unsigned long valCount ( const SHARED_VAL_TYPE &val, byte *whole )
+{
+  unsigned long n = 0; // count
+  byte          i;
+
+  *whole = HIGH;
+  for ( i = 0; i < VAL_BYTES / 2; i++ )
+  {
+    n |= (unsigned long) val.b [ i ].val << ( 8 * i );
+    if ( val.b [ i + VAL_BYTES / 2 ].val != (byte) ~val.b [ i ].val )
+      *whole = LOW;
+  }
+
+  return n;
+} // end of valCount()
+
+/******************************************************************************
+* Function:
+*   isrByte::operator=()
+*
+* Description:
+*   Copies the byte, then runs the next interrupt of the schedule, which
+*   publishes a number of new values
+*
+* Arguments:
+*   from - byte to copy
+*
+* Returns:
+*   this byte
+******************************************************************************/
+isrByte &isrByte::operator= ( const isrByte &from )
+{
+  byte n; // values published
+
+  val = from.val;
+  if ( inIsr || ( fireIdx >= numFires ) )
+    return *this;
+
+  inIsr = HIGH;
+  for ( n = fires [ fireIdx++ ]; n > 0; n-- )
+  {
+    count++;
+    if ( toPlain )
+      plain = makeVal ( count );
+    else
+      snap.publish ( makeVal ( count ) );
+  }
+  inIsr = LOW;
+
+  return *this;
+} // end of isrByte::operator=()
+
+/******************************************************************************
+* Function:
+*   checkRead()
+*
+* Description:
+*   Reads the value under the current interrupt schedule, and checks it is
+*   whole and no older than the newest value when the read started
+*
+* Arguments:
+*   none
+*
+* Returns:
+*   ok - high if the read was good
+******************************************************************************/
+static byte checkRead ( void )
+{
+  unsigned long before = count; // newest count when the read started
+  unsigned long n;              // count read
+  byte          whole;          // high if the value read was whole
+
+  fireIdx  = 0;
+  n        = valCount ( snap.read ( ), &whole );
+  numFires = 0; // no more interrupts until the next schedule
+
+  return whole && ( n >= before ) && ( n <= count );
+} // end of checkRead()
+
+/******************************************************************************
+* Function:
+*   checkEveryByte()
+*
+* Description:
+*   Runs every schedule of up to two values published after each byte of
+*   the first copy, and none after
+*
+* Arguments:
+*   none
+*
+* Returns:
+*   none
+******************************************************************************/
+static void checkEveryByte ( void )
+{
+  unsigned long bad = 0; // reads which were torn or stale
+  unsigned long sched;   // schedule number, a digit in base 3 for each byte
+  unsigned long left;
+  byte          i;
+
+  for ( sched = 0; sched < 6561; sched++ ) // 3^VAL_BYTES
+  {
+    for ( left = sched, i = 0; i < VAL_BYTES; i++, left /= 3 )
+      fires [ i ] = left % 3;
+    numFires = VAL_BYTES;
+    if ( !checkRead ( ) )
+      bad++;
+  }
+  TEST_EQUAL ( bad, 0 );
+
+  return;
+} // end of checkEveryByte()
+
+/******************************************************************************
+* Function:
+*   checkRandom()
+*
+* Description:
+*   Runs random schedules of up to MAX_PUBLISH values after each byte,
+*   long enough to run through the retries as well as the first copy
+*
+* Arguments:
+*   none
+*
+* Returns:
+*   none
+******************************************************************************/
+static void checkRandom ( void )
+{
+  unsigned long bad = 0; // reads which were torn or stale
+  unsigned long it;
+  byte          i;
+
+  for ( it = 0; it < RANDOM_READS; it++ )
+  {
+    numFires = 1 + testRandom ( MAX_FIRES );
+    for ( i = 0; i < numFires; i++ )
+      fires [ i ] = testRandom ( MAX_PUBLISH + 1 );
+    if ( !checkRead ( ) )
+      bad++;
+  }
+  TEST_EQUAL ( bad, 0 );
+
+  return;
+} // end of checkRandom()
+
+/******************************************************************************
+* Function:
+*   checkPlain()
+*
+* Description:
+*   Copies a plain value under the same interrupts, one value published
+*   after one byte, and counts the copies which are torn
+*
+* Arguments:
+*   none
+*
+* Returns:
+*   none
+******************************************************************************/
+static void checkPlain ( void )
+{
+  SHARED_VAL_TYPE val;      // copy of the plain value
+  unsigned long   torn = 0; // copies which were torn
+  byte            whole;    // high if the copy was whole
+  byte            at, i;
+
+  toPlain = HIGH;
+  plain   = makeVal ( count );
+  for ( at = 0; at < VAL_BYTES; at++ )
+  {
+    for ( i = 0; i < VAL_BYTES; i++ )
+      fires [ i ] = ( i == at );
+    numFires = VAL_BYTES;
+    fireIdx  = 0;
+    val      = plain;
+    numFires = 0;
+    valCount ( val, &whole );
+    if ( !whole )
+      torn++;
+  }
+  toPlain = LOW;
+  TEST_CHECK ( torn > 0 );
+
+  return;
+} // end of checkPlain()
+
+int main ( void )
+{
+  snap.publish ( makeVal ( count ) );
+  checkEveryByte ( );
+  checkRandom ( );
+  checkPlain ( );
+
+  return testResult ( "isrSnapshotTest" );
+}
@@ -0,0 +1,753 @@
+/*
+ * oneWireTest.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+
+/* Runs the 1-Wire driver and the DS18B20 read cycle against a bit-level
+ * model of the bus.  The model sees the bus edges the driver makes through
+ * DDRC, and answers through PINC, as DS18B20s would: presence pulses, ROM
+ * search, match ROM, conversions and scratchpad reads.  It also checks the
+ * driver's slot timing against the DS18B20 data sheet, and that interrupts
+ * are off over the parts of a slot which can't be stretched.
+ *
+ * Checks a search of two sensors, with a device of another family and one
+ * with a bad ROM CRC on the bus too; that a scratchpad with a bad CRC is
+ * rejected; and that a sensor which stops answering part way through a
+ * cycle goes stale, then faulted, while the other is still read. */
+
+/*******************************************************************************
+ * INCLUDED HEADER FILES
+ ******************************************************************************/
+#include "oneWire.h"
+#include "dsTemp.h"
+#include "savedVars.h"
+#include "testUtil.h"
+
+/*******************************************************************************
+ * MACRO DEFINITIONS
+ ******************************************************************************/
+#define OWM_MAX_DEVS       4          // largest number of devices on the modelled bus
+#define OWM_NEVER          0xFF       // quitAfter value of a device which never stops answering
+#define OWM_PRESENCE_WAIT  15         // time from the end of a reset pulse to a presence pulse (us)
+#define OWM_PRESENCE_LEN   120        // length of a presence pulse (us)
+#define OWM_ZERO_LEN       30         // time a device holds the bus low to send a 0, from the start of the slot (us)
+#define OWM_CONV_US        DS_CONV_US // conversion time (us, the data sheet's longest)
+#define OWM_CONVERT_T      0x44       // function command starting a conversion
+#define OWM_READ_SCRATCH   0xBE       // function command reading the scratchpad
+#define OWM_POWER_ON_RAW   0x0550     // temperature register at power-on (85 degC)
+#define SPEC_RESET_LOW     480        // shortest reset pulse (us)
+#define SPEC_RESET_HIGH    480        // shortest time from the end of a reset pulse to the next slot (us)
+#define SPEC_PRESENCE_LO   60         // earliest presence sample, after the longest wait for it (us)
+#define SPEC_PRESENCE_HI   75         // latest presence sample, before the shortest pulse ends (us)
+#define SPEC_SHORT_LOW     15         // longest low time of a write 1 or read slot (us)
+#define SPEC_ZERO_LO       60         // shortest low time of a write 0 slot (us)
+#define SPEC_ZERO_HI       120        // longest low time of a write 0 slot (us)
+#define SPEC_SLOT          61         // shortest time from the start of one slot to the next, including recovery (us)
+#define SPEC_SAMPLE        15         // latest read sample, from the start of the slot (us)
+#define STEP_MAX_US        1200       // most bus time allowed in one step of the read cycle (us)
+#define MAX_STEPS          2000       // steps allowed for a run of cycles, before giving up
+
+/*******************************************************************************
+ * TYPE DEFINITIONS
+ ******************************************************************************/
+/* Protocol states of a modelled device */
+typedef enum OWM_STATE_ENUM
+{
+  OWM_IDLE,     // waiting for a reset
+  OWM_ROM_CMD,  // receiving the ROM command
+  OWM_SEARCH,   // taking part in a ROM search
+  OWM_MATCH,    // receiving a ROM code to match
+  OWM_FUNC_CMD, // receiving a function command
+  OWM_SEND      // sending the scratchpad
+} OWM_STATE_ENUM_TYPE;
+
+/* A modelled DS18B20 (or other device, by its family code) */
+typedef struct OWM_DEVICE {
+  byte          rom [ OW_ROM_BYTES ]; // ROM code
+  int           temp;                 // temperature the next conversion gives (degC times 16)
+  int           raw;                  // temperature register (degC times 16)
+  unsigned long convEnd;              // time the running conversion finishes (us)
+  byte          converting;           // high while a conversion runs
+  byte          present;              // high if the device answers on the bus
+  byte          badCrcs;              // scratchpad reads still to send with a bad CRC
+  byte          quitAfter;            // scratchpad bytes to send before it stops answering (OWM_NEVER if it doesn't)
+  byte          state;                // protocol state
+  byte          bitNum;               // bit number within the current command, ROM code or scratchpad
+  byte          phase;                // search slot of this bit (0 ROM bit, 1 complement, 2 direction)
+  byte          rx;                   // command bits received so far
+  byte          scratch [ 9 ];        // scratchpad being sent
+  unsigned long holdFrom;             // time it starts pulling the bus low (us)
+  unsigned long holdTo;               // time it lets the bus go (us)
+} OWM_DEVICE_TYPE;
+
+/*******************************************************************************
+ * STATIC VARIABLE DEFINITIONS
+ ******************************************************************************/
+static OWM_DEVICE_TYPE owmDevs [ OWM_MAX_DEVS ]; // devices on the bus
+static byte            owmNumDevs;               // number of devices on the bus
+static byte            owmDriven;                // high while the driver pulls the bus low
+static byte            owmAfterReset;            // high from the end of a reset pulse to the next slot
+static unsigned long   owmFallTime;              // time the driver last pulled the bus low (us)
+static unsigned long   owmRiseTime;              // time the driver last let the bus go (us)
+static byte            owmConvertCmd;            // high if a device was told to start a conversion in this slot
+static unsigned long   owmConverts;              // convert commands seen on the bus
+static unsigned long   stepMaxUs;                // most bus time taken by one step of the read cycle (us)
+
+static const byte romA [ OW_ROM_BYTES ] = { 0x28, 0x02, 0x6A, 0x15, 0x09, 0x00, 0x00, 0x00 }; // first sensor (CRC filled in)
+static const byte romB [ OW_ROM_BYTES ] = { 0x28, 0x01, 0x6A, 0x15, 0x09, 0x00, 0x00, 0x00 }; // second sensor (CRC filled in)
+static const byte romC [ OW_ROM_BYTES ] = { 0x10, 0x33, 0x9C, 0x40, 0x01, 0x08, 0x00, 0x00 }; // DS18S20, another family (CRC filled in)
+static const byte romD [ OW_ROM_BYTES ] = { 0x28, 0x00, 0x6A, 0x15, 0x09, 0x00, 0x00, 0x00 }; // sensor with a bad ROM CRC
+
+/*******************************************************************************
+ * FUNCTION DEFINITIONS
+ ******************************************************************************/
+
+/******************************************************************************
+* Function:
+*   modelCrc8()
+*
+* Description:
+*   1-Wire CRC (x^8 + x^5 + x^4 + 1) for the model, done a bit at a time
+*   from the polynomial, apart from owCrc8()
+*
+* Arguments:
+*   buf - bytes
+*   len - number of bytes
+*
+* Returns:
+*   crc - CRC of the bytes
+******************************************************************************/
+static byte modelCrc8 ( const byte *buf, byte len )
+{
+  byte crc = 0; // CRC so far
+  byte cnt, fb;
+
+  for ( ; len > 0; len--, buf++ )
+    for ( cnt = 0; cnt < 8; cnt++ )
+    {
+      fb  = ( crc ^ ( *buf >> cnt ) ) & 0x01; // feedback bit
+      crc = (byte) ( ( crc >> 1 ) | ( fb << 7 ) );
+      if ( fb )
+        crc ^= 0x0C; // taps of x^5 and x^4, shifted down with the register
+    }
+
+  return crc;
+} // end of modelCrc8()
+
+/******************************************************************************
+* Function:
+*   timingCheck()
+*
+* Description:
+*   Counts a check of the driver's timing, and reports it if it failed
+*
+* Arguments:
+*   pass - high if the timing was within the data sheet limits
+*   what - what was checked
+*   us - time measured (us)
+*
+* Returns:
+*   none
+******************************************************************************/
+static void timingCheck ( byte pass, const char *what, unsigned long us )
+{
+  testCheck ( pass, what, (long long) us, 0, __FILE__, __LINE__ );
+
+  return;
+} // end of timingCheck()
+
+/******************************************************************************
+* Function:
+*   romBit()
+*
+* Description:
+*   Returns a bit of a device's ROM code, least significant bit of the
+*   first byte first
+*
+* Arguments:
+*   dev - device
+*   num - bit number (from 0)
+*
+* Returns:
+*   bit - ROM bit
+******************************************************************************/
+static byte romBit ( const OWM_DEVICE_TYPE *dev, byte num )
+{
+  return ( dev->rom [ num >> 3 ] >> ( num & 7 ) ) & 0x01;
+} // end of romBit()
+
+/******************************************************************************
+* Function:
+*   devBitOut()
+*
+* Description:
+*   Returns the bit a device sends in the slot starting now, or 1 if it
+*   isn't sending (a device sends a 1 by leaving the bus alone)
+*
+* Arguments:
+*   dev - device
+*
+* Returns:
+*   bit - bit sent
+******************************************************************************/
+static byte devBitOut ( const OWM_DEVICE_TYPE *dev )
+{
+  if ( dev->state == OWM_SEARCH )
+  {
+    if ( dev->phase == 0 )
+      return romBit ( dev, dev->bitNum );
+    if ( dev->phase == 1 )
+      return !romBit ( dev, dev->bitNum );
+  }
+  else if ( dev->state == OWM_SEND )
+    return ( dev->scratch [ dev->bitNum >> 3 ] >> ( dev->bitNum & 7 ) ) & 0x01;
+
+  return 1;
+} // end of devBitOut()
+
+/******************************************************************************
+* Function:
+*   devFuncCmd()
+*
+* Description:
+*   Carries out a function command a device has received
+*
+* Arguments:
+*   dev - device
+*   cmd - function command
+*   now - time (us)
+*
+* Returns:
+*   none
+******************************************************************************/
+static void devFuncCmd ( OWM_DEVICE_TYPE *dev, byte cmd, unsigned long now )
+{
+  dev->state = OWM_IDLE;
+  if ( dev->converting && ( (long) ( now - dev->convEnd ) >= 0 ) )
+  {
+    dev->raw        = dev->temp;
+    dev->converting = LOW;
+  }
+
+  if ( cmd == OWM_CONVERT_T )
+  {
+    dev->converting = HIGH;
+    dev->convEnd    = now + OWM_CONV_US;
+    owmConvertCmd   = HIGH;
+  }
+  else if ( cmd == OWM_READ_SCRATCH )
+  {
+    dev->scratch [ 0 ] = (byte) dev->raw;
+    dev->scratch [ 1 ] = (byte) ( (unsigned int) dev->raw >> 8 );
+    dev->scratch [ 2 ] = 0x4B; // alarm high
+    dev->scratch [ 3 ] = 0x46; // alarm low
+    dev->scratch [ 4 ] = 0x7F; // configuration, 12 bits
+    dev->scratch [ 5 ] = 0xFF;
+    dev->scratch [ 6 ] = 0x0C;
+    dev->scratch [ 7 ] = 0x10;
+    dev->scratch [ 8 ] = modelCrc8 ( dev->scratch, 8 );
+    if ( dev->badCrcs > 0 )
+    {
+      dev->scratch [ 8 ] ^= 0x01;
+      dev->badCrcs--;
+    }
+    dev->state  = OWM_SEND;
+    dev->bitNum = 0;
+  }
+
+  return;
+} // end of devFuncCmd()
+
+/******************************************************************************
+* Function:
+*   devSlot()
+*
+* Description:
+*   Moves a device on by one slot, at the end of the slot
+*
+* Arguments:
+*   dev - device
+*   bit - bit the driver wrote (1 for a read slot)
+*   now - time (us)
+*
+* Returns:
+*   none
+******************************************************************************/
+static void devSlot ( OWM_DEVICE_TYPE *dev, byte bit, unsigned long now )
+{
+  switch ( dev->state )
+  {
+  case OWM_ROM_CMD:
+  case OWM_FUNC_CMD:
+    dev->rx |= bit << dev->bitNum;
+    if ( ++dev->bitNum < 8 )
+      break;
+    dev->bitNum = 0;
+    if ( dev->state == OWM_FUNC_CMD )
+      devFuncCmd ( dev, dev->rx, now );
+    else if ( dev->rx == OW_SEARCH_ROM )
+    {
+      dev->state = OWM_SEARCH;
+      dev->phase = 0;
+    }
+    else if ( dev->rx == OW_MATCH_ROM )
+      dev->state = OWM_MATCH;
+    else if ( dev->rx == OW_SKIP_ROM )
+      dev->state = OWM_FUNC_CMD;
+    else
+      dev->state = OWM_IDLE;
+    dev->rx = 0;
+    break;
+
+  case OWM_SEARCH:
+    if ( dev->phase < 2 ) // sent the bit or its complement
+      dev->phase++;
+    else if ( bit != romBit ( dev, dev->bitNum ) ) // driver took the other branch, so drop out
+      dev->state = OWM_IDLE;
+    else
+    {
+      dev->phase = 0;
+      if ( ++dev->bitNum >= OW_ROM_BYTES * 8 )
+        dev->state = OWM_IDLE;
+    }
+    break;
+
+  case OWM_MATCH:
+    if ( bit != romBit ( dev, dev->bitNum ) ) // another device's code
+      dev->state = OWM_IDLE;
+    else if ( ++dev->bitNum >= OW_ROM_BYTES * 8 )
+    {
+      dev->state  = OWM_FUNC_CMD;
+      dev->bitNum = 0;
+    }
+    break;
+
+  case OWM_SEND:
+    if ( ++dev->bitNum >= sizeof ( dev->scratch ) * 8 )
+      dev->state = OWM_IDLE;
+    else if ( ( dev->quitAfter != OWM_NEVER ) && ( dev->bitNum == dev->quitAfter * 8 ) ) // stops answering part way through
+      dev->present = LOW;
+    break;
+
+  default:
+    break;
+  }
+
+  return;
+} // end of devSlot()
+
+/******************************************************************************
+* Function:
+*   busWrite()
+*
+* Description:
+*   DDRC write hook.  Turns the driver pulling the bus low or letting it go
+*   into slot starts and ends, checks their timing, and passes them on to
+*   the devices.
+*
+* Arguments:
+*   val - value written to DDRC
+*
+* Returns:
+*   none
+******************************************************************************/
+static void busWrite ( uint8_t val )
+{
+  unsigned long now   = micros ( );                  // time (us)
+  byte          drive = ( val & _BV ( DDC4 ) ) != 0; // high if the driver pulls the bus low
+  unsigned long low;                                 // time the bus was held low (us)
+  byte          bit;                                 // bit written
+  byte          d;
+
+  if ( drive && !owmDriven ) // start of a slot or reset pulse
+  {
+    if ( owmAfterReset )
+      timingCheck ( now - owmRiseTime >= SPEC_RESET_HIGH, "time after reset pulse", now - owmRiseTime );
+    else
+      timingCheck ( now - owmFallTime >= SPEC_SLOT, "slot length", now - owmFallTime );
+    owmFallTime   = now;
+    owmAfterReset = LOW;
+    for ( d = 0; d < owmNumDevs; d++ )
+      if ( owmDevs [ d ].present && !devBitOut ( &owmDevs [ d ] ) )
+      {
+        owmDevs [ d ].holdFrom = now;
+        owmDevs [ d ].holdTo   = now + OWM_ZERO_LEN;
+      }
+  }
+  else if ( !drive && owmDriven ) // end of the low part of a slot or reset pulse
+  {
+    low         = now - owmFallTime;
+    owmRiseTime = now;
+    if ( low >= SPEC_RESET_LOW ) // reset pulse
+    {
+      owmAfterReset = HIGH;
+      for ( d = 0; d < owmNumDevs; d++ )
+      {
+        owmDevs [ d ].state  = OWM_ROM_CMD;
+        owmDevs [ d ].bitNum = 0;
+        owmDevs [ d ].rx     = 0;
+        if ( owmDevs [ d ].present )
+        {
+          owmDevs [ d ].holdFrom = now + OWM_PRESENCE_WAIT;
+          owmDevs [ d ].holdTo   = now + OWM_PRESENCE_WAIT + OWM_PRESENCE_LEN;
+        }
+      }
+    }
+    else
+    {
+      if ( low < SPEC_SHORT_LOW ) // write 1 or read, which mustn't be stretched
+      {
+        timingCheck ( low >= 1, "write 1 low time", low );
+        timingCheck ( !( SREG & SREG_I ), "interrupts off for write 1 low time", low );
+      }
+      else
+        timingCheck ( ( low >= SPEC_ZERO_LO ) && ( low <= SPEC_ZERO_HI ), "write 0 low time", low );
+      bit = low < SPEC_SHORT_LOW;
+      for ( d = 0; d < owmNumDevs; d++ )
+        if ( owmDevs [ d ].present )
+          devSlot ( &owmDevs [ d ], bit, now );
+      if ( owmConvertCmd ) // counted once for all the devices told
+      {
+        owmConverts++;
+        owmConvertCmd = LOW;
+      }
+    }
+  }
+  owmDriven = drive;
+
+  return;
+} // end of busWrite()
+
+/******************************************************************************
+* Function:
+*   busRead()
+*
+* Description:
+*   PINC read hook.  Gives the bus level, low if the driver or any device
+*   is pulling it low, and checks when the driver samples it.
+*
+* Arguments:
+*   none
+*
+* Returns:
+*   val - value read from PINC
+******************************************************************************/
+static uint8_t busRead ( void )
+{
+  unsigned long now = micros ( ); // time (us)
+  byte          low = owmDriven;  // high if the bus is low
+  byte          d;
+
+  if ( owmAfterReset ) // presence sample
+    timingCheck ( ( now - owmRiseTime >= SPEC_PRESENCE_LO ) && ( now - owmRiseTime <= SPEC_PRESENCE_HI ), "presence sample time", now - owmRiseTime );
+  else // read sample
+  {
+    timingCheck ( now - owmFallTime <= SPEC_SAMPLE, "read sample time", now - owmFallTime );
+    timingCheck ( !( SREG & SREG_I ), "interrupts off for read sample", now - owmFallTime );
+  }
+
+  for ( d = 0; d < owmNumDevs; d++ )
+    if ( owmDevs [ d ].present && ( (long) ( now - owmDevs [ d ].holdFrom ) >= 0 ) && ( (long) ( now - owmDevs [ d ].holdTo ) < 0 ) )
+      low = HIGH;
+
+  return low ? (uint8_t) ~_BV ( PINC4 ) : 0xFF;
+} // end of busRead()
+
+/******************************************************************************
+* Function:
+*   busSetup()
+*
+* Description:
+*   Puts devices on the bus, answering, with the power-on temperature
+*
+* Arguments:
+*   roms - ROM codes of the devices
+*   num - number of devices
+*
+* Returns:
+*   none
+******************************************************************************/
+static void busSetup ( const byte *const *roms, byte num )
+{
+  byte d;
+
+  owmNumDevs = num;
+  for ( d = 0; d < num; d++ )
+  {
+    memset ( &owmDevs [ d ], 0, sizeof ( owmDevs [ d ] ) );
+    memcpy ( owmDevs [ d ].rom, roms [ d ], OW_ROM_BYTES );
+    owmDevs [ d ].raw       = OWM_POWER_ON_RAW;
+    owmDevs [ d ].temp      = OWM_POWER_ON_RAW;
+    owmDevs [ d ].present   = HIGH;
+    owmDevs [ d ].quitAfter = OWM_NEVER;
+    owmDevs [ d ].rom [ OW_ROM_BYTES - 1 ] = modelCrc8 ( owmDevs [ d ].rom, OW_ROM_BYTES - 1 );
+    if ( roms [ d ] == romD ) // the one with a bad ROM CRC
+      owmDevs [ d ].rom [ OW_ROM_BYTES - 1 ] ^= 0x40;
+  }
+
+  return;
+} // end of busSetup()
+
+/******************************************************************************
+* Function:
+*   runCycles()
+*
+* Description:
+*   Runs the DS18B20 read cycle, one step every DS_STEP_US, until the
+*   sensors have been told to start a number more conversions.  So each
+*   cycle's sensor reads come before the count goes up again.  Checks the
+*   bus time of each step.
+*
+* Arguments:
+*   num - number of conversions to wait for
+*
+* Returns:
+*   done - high if the conversions were started within MAX_STEPS steps
+******************************************************************************/
+static byte runCycles ( byte num )
+{
+  unsigned long target = owmConverts + num; // conversion count to stop at
+  unsigned long start;                      // time at the start of a step (us)
+  unsigned long busUs;                      // bus time of a step (us)
+  int           k;
+
+  for ( k = 0; ( k < MAX_STEPS ) && ( owmConverts < target ); k++ )
+  {
+    start = micros ( );
+    dsTempStep ( );
+    busUs = micros ( ) - start;
+    if ( busUs > stepMaxUs )
+      stepMaxUs = busUs;
+    shimAdvanceUs ( ( busUs < DS_STEP_US ) ? DS_STEP_US - busUs : 0 );
+  }
+
+  return owmConverts >= target;
+} // end of runCycles()
+
+/******************************************************************************
+* Function:
+*   expectedDig()
+*
+* Description:
+*   Returns the digital temperature a sensor reading should give, through
+*   the scale of the analog input it stands in for
+*
+* Arguments:
+*   dev - sensor number
+*   raw - temperature register (degC times 16)
+*
+* Returns:
+*   dig - temperature, stored digitally
+******************************************************************************/
+static unsigned int expectedDig ( byte dev, int raw )
+{
+  int c10 = (int) ( ( (long int) raw * 10 ) / 16 ); // degC times 10
+
+  return ( dev == 0 ) ? C10ToDigTemp1 ( c10 ) : C10ToDigTemp2 ( c10 );
+} // end of expectedDig()
+
+/******************************************************************************
+* Function:
+*   sameRom()
+*
+* Description:
+*   Returns high if a ROM code found is a device's
+*
+* Arguments:
+*   found - ROM code found
+*   dev - device
+*
+* Returns:
+*   same - high if they match
+******************************************************************************/
+static byte sameRom ( const byte *found, const OWM_DEVICE_TYPE *dev )
+{
+  return memcmp ( found, dev->rom, OW_ROM_BYTES ) == 0;
+} // end of sameRom()
+
+/******************************************************************************
+* Function:
+*   checkCrc()
+*
+* Description:
+*   Checks owCrc8() on the example ROM code of the 1-Wire CRC application
+*   note, and against the model's CRC on random buffers
+*
+* Arguments:
+*   none
+*
+* Returns:
+*   none
+******************************************************************************/
+static void checkCrc ( void )
+{
+  static const byte example [ OW_ROM_BYTES ] = { 0x02, 0x1C, 0xB8, 0x01, 0x00, 0x00, 0x00, 0xA2 };
+  byte              buf [ 9 ];
+  unsigned long     bad = 0;
+  byte              len, i;
+  int               it;
+
+  TEST_EQUAL ( owCrc8 ( example, OW_ROM_BYTES ), 0 );
+  TEST_EQUAL ( modelCrc8 ( example, OW_ROM_BYTES ), 0 );
+  for ( it = 0; it < 10000; it++ )
+  {
+    len = 1 + testRandom ( sizeof ( buf ) );
+    for ( i = 0; i < len; i++ )
+      buf [ i ] = testRandom ( 256 );
+    if ( owCrc8 ( buf, len ) != modelCrc8 ( buf, len ) )
+      bad++;
+  }
+  TEST_EQUAL ( bad, 0 );
+
+  return;
+} // end of checkCrc()
+
+/******************************************************************************
+* Function:
+*   checkSearch()
+*
+* Description:
+*   Checks the ROM search: two sensors on their own, then with a device of
+*   another family and a sensor with a bad ROM CRC, which must be left out.
+*   The search takes the 0 branch first, so the sensor whose code has a 0
+*   at the first bit they differ at is found first.
+*
+* Arguments:
+*   none
+*
+* Returns:
+*   none
+******************************************************************************/
+static void checkSearch ( void )
+{
+  static const byte *const two [ ]  = { romB, romA };
+  static const byte *const four [ ] = { romD, romC, romB, romA };
+  byte                     roms [ OWM_MAX_DEVS ][ OW_ROM_BYTES ];
+
+  busSetup ( two, 0 );
+  TEST_EQUAL ( owReset ( ), LOW );
+  TEST_EQUAL ( owSearch ( roms, OWM_MAX_DEVS, 0x28 ), 0 );
+
+  busSetup ( two, 2 );
+  TEST_EQUAL ( owReset ( ), HIGH );
+  TEST_EQUAL ( owSearch ( roms, OWM_MAX_DEVS, 0x28 ), 2 );
+  TEST_CHECK ( sameRom ( roms [ 0 ], &owmDevs [ 1 ] ) ); // romA has a 0 at bit 8, where romB has a 1
+  TEST_CHECK ( sameRom ( roms [ 1 ], &owmDevs [ 0 ] ) );
+  TEST_EQUAL ( owSearch ( roms, 1, 0x28 ), 1 );
+  TEST_CHECK ( sameRom ( roms [ 0 ], &owmDevs [ 1 ] ) );
+
+  busSetup ( four, 4 );
+  TEST_EQUAL ( owSearch ( roms, OWM_MAX_DEVS, 0x28 ), 2 );
+  TEST_CHECK ( sameRom ( roms [ 0 ], &owmDevs [ 3 ] ) );
+  TEST_CHECK ( sameRom ( roms [ 1 ], &owmDevs [ 2 ] ) );
+  TEST_EQUAL ( owSearch ( roms, OWM_MAX_DEVS, 0x10 ), 1 );
+  TEST_CHECK ( sameRom ( roms [ 0 ], &owmDevs [ 1 ] ) );
+
+  return;
+} // end of checkSearch()
+
+/******************************************************************************
+* Function:
+*   checkCycle()
+*
+* Description:
+*   Runs the read cycle with two sensors: both must be read and converted
+*   to digital temperatures, a scratchpad with a bad CRC must be rejected,
+*   and a sensor which stops answering part way through reading its
+*   scratchpad must go stale, then faulted after DS_STALE_CONVS missed
+*   conversions, while the other sensor is still read.  It must come back
+*   when the sensor does.
+*
+* Arguments:
+*   none
+*
+* Returns:
+*   none
+******************************************************************************/
+static void checkCycle ( void )
+{
+  static const byte *const two [ ] = { romA, romB };
+  OWM_DEVICE_TYPE         *a       = &owmDevs [ 0 ]; // first sensor found
+  OWM_DEVICE_TYPE         *b       = &owmDevs [ 1 ]; // second sensor found
+  byte                     missed;                   // conversions the second sensor has missed
+
+  busSetup ( two, 2 );
+  a->temp = 401;  // 25.0625 degC
+  b->temp = -168; // -10.5 degC, below the bottom of the scale
+  dsTempInit ( );
+  TEST_CHECK ( dsTempFault ( 0 ) && dsTempFault ( 1 ) ); // nothing read yet
+
+  /* First conversion, then its reads */
+  TEST_CHECK ( runCycles ( 2 ) );
+  TEST_CHECK ( !dsTempFault ( 0 ) && !dsTempFault ( 1 ) );
+  TEST_EQUAL ( dsTempRead ( 0 ), expectedDig ( 0, 401 ) );
+  TEST_EQUAL ( dsTempRead ( 1 ), 0 );
+
+  a->temp = 1000; // 62.5 degC
+  b->temp = 560;  // 35 degC
+  TEST_CHECK ( runCycles ( 1 ) );
+  TEST_EQUAL ( dsTempRead ( 0 ), expectedDig ( 0, 1000 ) );
+  TEST_EQUAL ( dsTempRead ( 1 ), expectedDig ( 1, 560 ) );
+
+  /* Scratchpad with a bad CRC is dropped, and the last good reading kept */
+  a->temp    = 800;
+  a->badCrcs = 1;
+  TEST_CHECK ( runCycles ( 1 ) );
+  TEST_EQUAL ( dsTempRead ( 0 ), expectedDig ( 0, 1000 ) );
+  TEST_CHECK ( !dsTempFault ( 0 ) );
+  TEST_CHECK ( runCycles ( 1 ) );
+  TEST_EQUAL ( dsTempRead ( 0 ), expectedDig ( 0, 800 ) );
+
+  /* Second sensor stops answering three bytes into its scratchpad */
+  b->temp      = 640;
+  b->quitAfter = 3;
+  TEST_CHECK ( runCycles ( 1 ) );
+  TEST_CHECK ( !b->present );
+  TEST_EQUAL ( dsTempRead ( 1 ), expectedDig ( 1, 560 ) );
+  for ( missed = 1; missed < DS_STALE_CONVS; missed++ ) // stale, but not faulted yet
+  {
+    TEST_CHECK ( !dsTempFault ( 1 ) );
+    a->temp = 800 + 16 * missed;
+    TEST_CHECK ( runCycles ( 1 ) );
+    TEST_EQUAL ( dsTempRead ( 0 ), expectedDig ( 0, 800 + 16 * missed ) );
+  }
+  TEST_CHECK ( dsTempFault ( 1 ) );
+  TEST_CHECK ( !dsTempFault ( 0 ) );
+
+  /* And comes back */
+  b->present   = HIGH;
+  b->quitAfter = OWM_NEVER;
+  TEST_CHECK ( runCycles ( 1 ) );
+  TEST_CHECK ( !dsTempFault ( 1 ) );
+  TEST_EQUAL ( dsTempRead ( 1 ), expectedDig ( 1, 640 ) );
+
+  /* Whole bus stops answering, so the cycle backs off and both fault */
+  a->present = LOW;
+  b->present = LOW;
+  TEST_CHECK ( !runCycles ( 1 ) );
+  TEST_CHECK ( dsTempFault ( 0 ) && dsTempFault ( 1 ) );
+  a->present = HIGH;
+  b->present = HIGH;
+  TEST_CHECK ( runCycles ( 2 ) );
+  TEST_CHECK ( !dsTempFault ( 0 ) && !dsTempFault ( 1 ) );
+
+  return;
+} // end of checkCycle()
+
+int main ( void )
+{
+  DDRC.writeHook = busWrite;
+  PINC.readHook  = busRead;
+  shimAdvanceUs ( 1000 ); // bus idle for a while before the first slot
+
+  checkCrc ( );
+  checkSearch ( );
+  checkCycle ( );
+
+  printf ( "  longest step of the read cycle: %lu us of bus time\n", stepMaxUs );
+  TEST_CHECK ( stepMaxUs <= STEP_MAX_US );
+
+  return testResult ( "oneWireTest" );
+}
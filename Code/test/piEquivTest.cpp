@@ -0,0 +1,269 @@
+/*
+ * piEquivTest.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+
+/* Checks the piControllerQ template, as the fans use it, against the PI
+ * controller it replaced (kept in ref/), bit for bit: the duty, both terms
+ * and the integrator state must match after every step.  "make test" runs
+ * a sweep of every error over a spread of integrator states, feedforwards
+ * and gains.  "make test-full" runs it exhaustively: every error at every
+ * integrator state for each set of gains, which takes a while. */
+
+/*******************************************************************************
+ * INCLUDED HEADER FILES
+ ******************************************************************************/
+#include <string.h>
+#include "piController.h"
+#include "ref/piControllerRef.h"
+#include "testUtil.h"
+
+/*******************************************************************************
+ * MACRO DEFINITIONS
+ ******************************************************************************/
+#define INT16_LO        -32768 // lowest 16-bit int on the target
+#define INT16_HI        32767  // highest 16-bit int on the target
+#define QUICK_STATE_GAP 1025   // gap between integrator states in the quick sweep of errors
+#define QUICK_FF_GAP    4097   // gap between integrator states in the quick sweep of feedforwards
+#define FULL_FF_GAP     257    // gap between integrator states in the full sweep of feedforwards
+#define QUICK_ERR_GAP   7      // gap between errors in the quick sweep of preloads
+#define QUICK_RUNS      2000   // random runs in the quick check
+#define FULL_RUNS       200000 // random runs in the full check
+#define RUN_STEPS       500    // steps in each random run
+#define MAX_REPORTS     10     // mismatches reported in full
+
+/*******************************************************************************
+ * TYPE DEFINITIONS
+ ******************************************************************************/
+/* Gains and integrator limits of a controller */
+typedef struct GAIN_SET {
+  int kp;   // proportional gain (2^-13 duty counts per error count)
+  int ki;   // integral gain (2^-17 duty counts per error count per 100 milliseconds)
+  int imax; // maximum integrator value (tenths of error count times seconds)
+  int imin; // minimum integrator value (tenths of error count times seconds)
+} GAIN_SET_TYPE;
+
+/*******************************************************************************
+ * STATIC VARIABLE DEFINITIONS
+ ******************************************************************************/
+static const GAIN_SET_TYPE gainSets [ ] = {
+  { 5000, 5000, 30000, -30000 },   // saved variable defaults
+  { 0, 5000, 30000, -30000 },      // no proportional gain, so the integrator is held at the limit
+  { 5000, 0, 30000, -30000 },      // no integral gain, so there's no back-calculation
+  { 32767, 32767, 32767, -32768 }, // largest gains and limits, so the terms saturate
+  { 1, 1, 100, -100 },             // smallest gains
+  { 9000, 4000, 20000, -5000 },    // uneven limits
+  { 2500, 800, 32767, 0 },         // integrator which can't go negative
+  { 0, 0, 0, 0 }                   // controller which is switched off
+};
+static const int stepFfs [ ] = { -16384, -1021, -4, -1, 0, 3, 4, 500, 1020, 1023, 1024, 16383 }; // feedforwards, around the output limits (quarter duty counts)
+
+static unsigned long long steps;      // steps compared
+static unsigned long long mismatches; // steps which didn't match
+
+/*******************************************************************************
+ * FUNCTION DEFINITIONS
+ ******************************************************************************/
+
+/******************************************************************************
+* Function:
+*   sameState()
+*
+* Description:
+*   Compares the state of the two controllers, and reports the first few
+*   which differ
+*
+* Arguments:
+*   what - name of the step
+*   pi - controller under test
+*   ref - reference controller
+*   duty, refDuty - duties they gave (equal if there was no step)
+*   errVal - error of the step
+*   ffTerm - feedforward of the step
+*
+* Returns:
+*   none
+******************************************************************************/
+static void sameState ( const char *what, piController *pi, piControllerRef *ref, byte duty, byte refDuty, int errVal, int ffTerm )
+{
+  steps++;
+  if ( ( duty == refDuty ) && ( pi->getIntState ( ) == ref->getIntState ( ) ) &&
+       ( pi->getIntTerm ( ) == ref->getIntTerm ( ) ) && ( pi->getPropTerm ( ) == ref->getPropTerm ( ) ) )
+    return;
+
+  if ( mismatches++ < MAX_REPORTS )
+    printf ( "  %s, error %d, ff %d: duty %u/%u, integrator %d/%d, terms %d+%d/%d+%d\n", what, errVal, ffTerm, duty, refDuty,
+             pi->getIntState ( ), ref->getIntState ( ), pi->getPropTerm ( ), pi->getIntTerm ( ), ref->getPropTerm ( ), ref->getIntTerm ( ) );
+
+  return;
+} // end of sameState()
+
+/******************************************************************************
+* Function:
+*   sweepErrors()
+*
+* Description:
+*   Runs one step from a spread of integrator states, for every error and
+*   a set of feedforwards.  No feedforward means the single argument
+*   piControl().
+*
+* Arguments:
+*   gains - gains and integrator limits
+*   stateGap - gap between integrator states (1 for every state)
+*   numFfs - number of feedforwards from stepFfs[] (0 for none)
+*
+* Returns:
+*   none
+******************************************************************************/
+static void sweepErrors ( const GAIN_SET_TYPE *gains, long int stateGap, byte numFfs )
+{
+  piController    pi ( gains->imax, gains->imin, gains->kp, gains->ki );               // controller under test
+  piControllerRef ref ( LOOPTIME_US, gains->imax, gains->imin, gains->kp, gains->ki ); // reference controller
+  long int        state, err;
+  byte            f;
+
+  for ( state = INT16_LO; state <= INT16_HI; state += stateGap )
+    for ( err = INT16_LO; err <= INT16_HI; err++ )
+    {
+      if ( numFfs == 0 )
+      {
+        pi.resetInt ( (int) state );
+        ref.resetInt ( (int) state );
+        sameState ( "step", &pi, &ref, pi.piControl ( (int) err ), ref.piControl ( (int) err ), (int) err, 0 );
+      }
+      for ( f = 0; f < numFfs; f++ )
+      {
+        pi.resetInt ( (int) state );
+        ref.resetInt ( (int) state );
+        sameState ( "step", &pi, &ref, pi.piControl ( (int) err, stepFfs [ f ] ), ref.piControl ( (int) err, stepFfs [ f ] ), (int) err, stepFfs [ f ] );
+      }
+    }
+
+  return;
+} // end of sweepErrors()
+
+/******************************************************************************
+* Function:
+*   sweepPreloads()
+*
+* Description:
+*   Preloads both controllers at every duty, over a spread of errors and
+*   feedforwards, and runs the step after
+*
+* Arguments:
+*   gains - gains and integrator limits
+*   errGap - gap between errors (1 for every error)
+*
+* Returns:
+*   none
+******************************************************************************/
+static void sweepPreloads ( const GAIN_SET_TYPE *gains, long int errGap )
+{
+  static const int preloadFfs [ ] = { -1020, 0, 7, 1020 };                              // feedforwards (quarter duty counts)
+  piController     pi ( gains->imax, gains->imin, gains->kp, gains->ki );               // controller under test
+  piControllerRef  ref ( LOOPTIME_US, gains->imax, gains->imin, gains->kp, gains->ki ); // reference controller
+  long int         err;
+  int              d;
+  byte             f;
+
+  for ( d = 0; d <= 255; d++ )
+    for ( err = INT16_LO; err <= INT16_HI; err += errGap )
+      for ( f = 0; f < sizeof ( preloadFfs ) / sizeof ( preloadFfs [ 0 ] ); f++ )
+      {
+        pi.resetInt ( );
+        ref.resetInt ( );
+        pi.preload ( (byte) d, (int) err, preloadFfs [ f ] );
+        ref.preload ( (byte) d, (int) err, preloadFfs [ f ] );
+        sameState ( "preload", &pi, &ref, 0, 0, (int) err, preloadFfs [ f ] );
+        sameState ( "step after preload", &pi, &ref, pi.piControl ( (int) err, preloadFfs [ f ] ),
+                    ref.piControl ( (int) err, preloadFfs [ f ] ), (int) err, preloadFfs [ f ] );
+      }
+
+  return;
+} // end of sweepPreloads()
+
+/******************************************************************************
+* Function:
+*   randomRuns()
+*
+* Description:
+*   Runs both controllers through random runs of steps, with random gains
+*   and limits which are sometimes changed part way, and random preloads
+*   and resets, so the integrator state carries from step to step
+*
+* Arguments:
+*   runs - number of runs
+*
+* Returns:
+*   none
+******************************************************************************/
+static void randomRuns ( unsigned long runs )
+{
+  unsigned long run;
+  int           kp, ki, imax, imin, err, ff, k;
+  unsigned long pick; // what to do at this step
+  byte          duty; // duty to preload
+
+  for ( run = 0; run < runs; run++ )
+  {
+    kp   = testRandom ( INT16_HI + 1 );
+    ki   = testRandom ( INT16_HI + 1 );
+    imax = testRandom ( INT16_HI + 1 );
+    imin = -(int) testRandom ( INT16_HI + 2 );
+    piController    pi ( imax, imin, kp, ki );
+    piControllerRef ref ( LOOPTIME_US, imax, imin, kp, ki );
+
+    for ( k = 0; k < RUN_STEPS; k++ )
+    {
+      pick = testRandom ( 100 );
+      err  = INT16_LO + (int) testRandom ( 65536 );
+      ff   = -2048 + (int) testRandom ( 4097 );
+      if ( pick < 2 )
+      {
+        kp = testRandom ( INT16_HI + 1 );
+        ki = testRandom ( INT16_HI + 1 );
+        pi.setGains ( imax, imin, kp, ki );
+        ref.setGains ( LOOPTIME_US, imax, imin, kp, ki );
+      }
+      else if ( pick < 4 )
+      {
+        duty = testRandom ( 256 );
+        pi.preload ( duty, err, ff );
+        ref.preload ( duty, err, ff );
+        sameState ( "preload", &pi, &ref, 0, 0, err, ff );
+      }
+      else if ( pick < 5 )
+      {
+        pi.resetInt ( );
+        ref.resetInt ( );
+      }
+      else if ( pick < 30 )
+        sameState ( "step", &pi, &ref, pi.piControl ( err ), ref.piControl ( err ), err, 0 );
+      else
+        sameState ( "step", &pi, &ref, pi.piControl ( err, ff ), ref.piControl ( err, ff ), err, ff );
+    }
+  }
+
+  return;
+} // end of randomRuns()
+
+int main ( int argc, char **argv )
+{
+  byte full = ( argc > 1 ) && ( strcmp ( argv [ 1 ], "full" ) == 0 ); // high for the exhaustive sweeps
+  byte g;
+
+  for ( g = 0; g < sizeof ( gainSets ) / sizeof ( gainSets [ 0 ] ); g++ )
+  {
+    sweepErrors ( &gainSets [ g ], full ? 1 : QUICK_STATE_GAP, 0 );
+    sweepErrors ( &gainSets [ g ], full ? FULL_FF_GAP : QUICK_FF_GAP, sizeof ( stepFfs ) / sizeof ( stepFfs [ 0 ] ) );
+    sweepPreloads ( &gainSets [ g ], full ? 1 : QUICK_ERR_GAP );
+  }
+  randomRuns ( full ? FULL_RUNS : QUICK_RUNS );
+
+  printf ( "  %llu steps compared, %llu mismatches\n", steps, mismatches );
+  TEST_EQUAL ( mismatches, 0 );
+
+  return testResult ( full ? "piEquivTest full" : "piEquivTest" );
+}
@@ -0,0 +1,241 @@
+/*
+ * piStepTest.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+
+/* Step tests of the PI controller against the fan model, for the cases
+ * where the integrator used to wind up: a start from standstill, a step
+ * big enough to saturate the output, a reference the fan can't reach, and
+ * taking over from something else which has been setting the duty.  Also
+ * checks that preload() gives back the running duty exactly. */
+
+/*******************************************************************************
+ * INCLUDED HEADER FILES
+ ******************************************************************************/
+#include "piController.h"
+#include "savedVars.h"
+#include "fanPlant.h"
+#include "testUtil.h"
+
+/*******************************************************************************
+ * MACRO DEFINITIONS
+ ******************************************************************************/
+#define SETTLE_PCT   2   // band the speed must settle in (percent of the reference)
+#define SETTLE_MAX   7.0 // longest settling time allowed (seconds; a wound-up integrator took up to 21 s)
+#define START_OS_MAX 100 // largest overshoot allowed starting from standstill or after a handover (rpm; up to 1154 rpm when wound up)
+#define STEP_OS_MAX  50  // largest overshoot allowed after a saturating step or an unreachable reference (rpm; up to 199 rpm when wound up)
+
+/*******************************************************************************
+ * TYPE DEFINITIONS
+ ******************************************************************************/
+/* Result of a run at one reference */
+typedef struct TRACK_RESULT {
+  double settle;    // time to settle in the band for good (seconds, negative if it never did)
+  double overshoot; // largest distance past the reference, in the direction of travel (rpm)
+} TRACK_RESULT_TYPE;
+
+/*******************************************************************************
+ * STATIC VARIABLE DEFINITIONS
+ ******************************************************************************/
+static FAN_PLANT_TYPE plant; // fan model
+static byte           duty;  // duty sent to the fan
+
+/*******************************************************************************
+ * FUNCTION DEFINITIONS
+ ******************************************************************************/
+
+/******************************************************************************
+* Function:
+*   track()
+*
+* Description:
+*   Runs the fan under PI control at a reference for a while
+*
+* Arguments:
+*   pi - PI controller
+*   ref - reference speed (rpm)
+*   secs - time to run for (seconds)
+*   dir - direction of travel, 1 up or -1 down, for the overshoot
+*
+* Returns:
+*   result - settling time and overshoot
+******************************************************************************/
+static TRACK_RESULT_TYPE track ( piController *pi, unsigned int ref, double secs, int dir )
+{
+  TRACK_RESULT_TYPE result = { -1, 0 }; // result of the run
+  double            over;               // distance past the reference (rpm)
+  long int          k;                  // loop count
+
+  for ( k = 0; k < (long int) ( secs / FAN_PLANT_DT ); k++ )
+  {
+    duty = pi->piControl ( (int) ref - (int) plant.meas );
+    fanPlantStep ( &plant, duty );
+    over = dir * ( plant.meas - ref );
+    if ( over > result.overshoot )
+      result.overshoot = over;
+    if ( fabs ( plant.meas - ref ) > ref * SETTLE_PCT / 100.0 )
+      result.settle = -1;
+    else if ( result.settle < 0 )
+      result.settle = k * FAN_PLANT_DT;
+  }
+
+  return result;
+} // end of track()
+
+/******************************************************************************
+* Function:
+*   holdDuty()
+*
+* Description:
+*   Holds the fan at a fixed duty while the PI controller keeps running
+*   with its output ignored (as in the debug states), then hands control
+*   back the way regSpeeds() does after takeOver()
+*
+* Arguments:
+*   pi - PI controller
+*   ref - reference speed (rpm)
+*   held - duty the fan is held at
+*   secs - time to hold it for (seconds)
+*
+* Returns:
+*   none
+******************************************************************************/
+static void holdDuty ( piController *pi, unsigned int ref, byte held, double secs )
+{
+  long int k; // loop count
+
+  for ( k = 0; k < (long int) ( secs / FAN_PLANT_DT ); k++ )
+  {
+    pi->piControl ( (int) ref - (int) plant.meas );
+    duty = held;
+    fanPlantStep ( &plant, duty );
+  }
+  if ( duty == 0 )
+    pi->resetInt ( );
+  else
+    pi->preload ( duty, (int) ref - (int) plant.meas, 0 );
+
+  return;
+} // end of holdDuty()
+
+/******************************************************************************
+* Function:
+*   checkSettle()
+*
+* Description:
+*   Checks a run settled in time, without too much overshoot
+*
+* Arguments:
+*   what - name of the run
+*   tau - time constant of the fan (seconds)
+*   result - result of the run
+*   osMax - largest overshoot allowed (rpm)
+*
+* Returns:
+*   none
+******************************************************************************/
+static void checkSettle ( const char *what, double tau, TRACK_RESULT_TYPE result, double osMax )
+{
+  printf ( "  tau %.1f s, %-28s overshoot %4.0f rpm, settled in %5.2f s\n", tau, what, result.overshoot, result.settle );
+  TEST_CHECK ( ( result.settle >= 0 ) && ( result.settle <= SETTLE_MAX ) );
+  TEST_CHECK ( result.overshoot <= osMax );
+
+  return;
+} // end of checkSettle()
+
+/******************************************************************************
+* Function:
+*   checkSteps()
+*
+* Description:
+*   Runs each step test on a fan with a given time constant
+*
+* Arguments:
+*   tau - time constant of the fan (seconds)
+*
+* Returns:
+*   none
+******************************************************************************/
+static void checkSteps ( double tau )
+{
+  piController pi ( pi1Imax, pi1Imin, pi1Kp, pi1Ki ); // PI controller, with the default gains
+
+  plant = { tau, 0, 0 };
+  checkSettle ( "standstill to 1500 rpm:", tau, track ( &pi, 1500, 30, 1 ), START_OS_MAX );
+
+  plant = { tau, 0, 0 };
+  pi.resetInt ( );
+  track ( &pi, 900, 20, 1 );
+  checkSettle ( "900 to 2800 rpm:", tau, track ( &pi, 2800, 30, 1 ), STEP_OS_MAX );
+
+  plant = { tau, 0, 0 };
+  pi.resetInt ( );
+  track ( &pi, 2000, 20, 1 );
+  track ( &pi, 3400, 20, 1 ); // above full speed, so the output sits at its limit
+  checkSettle ( "3400 (unreachable) to 2000:", tau, track ( &pi, 2000, 30, -1 ), STEP_OS_MAX );
+
+  plant = { tau, 0, 0 };
+  pi.resetInt ( );
+  track ( &pi, 1500, 20, 1 );
+  holdDuty ( &pi, 1500, 0, 30 );
+  checkSettle ( "held off 30 s:", tau, track ( &pi, 1500, 30, 1 ), START_OS_MAX );
+
+  plant = { tau, 0, 0 };
+  pi.resetInt ( );
+  track ( &pi, 1500, 20, 1 );
+  holdDuty ( &pi, 1500, 200, 10 );
+  checkSettle ( "held at duty 200 10 s:", tau, track ( &pi, 1500, 30, -1 ), START_OS_MAX );
+
+  return;
+} // end of checkSteps()
+
+/******************************************************************************
+* Function:
+*   checkPreload()
+*
+* Description:
+*   Checks that after preload(), the next control step gives back the
+*   running duty, for every duty the controller can give, over a range of
+*   errors and feedforwards which leave the terms inside their limits
+*
+* Arguments:
+*   none
+*
+* Returns:
+*   none
+******************************************************************************/
+static void checkPreload ( void )
+{
+  static const int ffs [ ] = { -400, 0, 7, 400 };         // feedforwards tried (quarter duty counts)
+  piController     pi ( pi1Imax, pi1Imin, pi1Kp, pi1Ki ); // PI controller, with the default gains
+  unsigned long    bad = 0;                               // preloads which didn't give the duty back
+  int              d;                                     // running duty
+  int              err;                                   // speed error (rpm)
+  byte             f;                                     // feedforward number
+
+  for ( d = MINPIOUTPUT; d <= MAXPIOUTPUT; d++ )
+    for ( err = -1000; err <= 1000; err++ )
+      for ( f = 0; f < sizeof ( ffs ) / sizeof ( ffs [ 0 ] ); f++ )
+      {
+        pi.preload ( (byte) d, err, ffs [ f ] );
+        if ( pi.piControl ( err, ffs [ f ] ) != d )
+          bad++;
+      }
+  TEST_EQUAL ( bad, 0 );
+
+  return;
+} // end of checkPreload()
+
+int main ( void )
+{
+  static const double taus [ ] = { 0.6, 1.2, 2.5 }; // fan time constants (seconds)
+  byte                t;
+
+  for ( t = 0; t < sizeof ( taus ) / sizeof ( taus [ 0 ] ); t++ )
+    checkSteps ( taus [ t ] );
+  checkPreload ( );
+
+  return testResult ( "piStepTest" );
+}
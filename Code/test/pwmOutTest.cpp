@@ -0,0 +1,236 @@
+/*
+ * pwmOutTest.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+
+/* Checks the timer0 set up by pwmOut against a model of the waveform fast
+ * PWM makes on each pin.  pwmOutInit() must take timer0 over from the
+ * Arduino core, with its overflow interrupt off, and leave both pins driven
+ * low.  Each duty must then give duty+1 high counts in every 256, except 0,
+ * which must disconnect the pin from the timer and leave it low, with no
+ * one-count pulse.  Setting one channel must never touch the other.
+ *
+ * pwmOutQuiet() is run against a model of the timer0 count, from every
+ * count in the period and for every pair of compare values.  It must only
+ * return with the count clear of the window around each switching instant,
+ * from PWMOUT_LEAD_CNTS before it to PWMOUT_BLANK_CNTS after, must return at
+ * once when the count already is, and must never wait longer than the
+ * three windows take, allowing for the polling loop. */
+
+/*******************************************************************************
+ * INCLUDED HEADER FILES
+ ******************************************************************************/
+#include "pwmOut.h"
+#include "timer0Sim.h"
+#include "testUtil.h"
+
+/*******************************************************************************
+ * MACRO DEFINITIONS
+ ******************************************************************************/
+#define PWM_CNTS  256 // timer0 counts in each PWM period
+#define QUIET_MAX ( 3 * ( PWMOUT_LEAD_CNTS + PWMOUT_BLANK_CNTS + TIMER0_SIM_READ_CYCLES - 1 ) + TIMER0_SIM_READ_CYCLES ) // longest wait for quiet: all three windows, each with a gap after it too short for a read to land in, then the read which sees the count clear (timer0 counts)
+
+/*******************************************************************************
+ * FUNCTION DEFINITIONS
+ ******************************************************************************/
+
+/******************************************************************************
+* Function:
+*   highCnts()
+*
+* Description:
+*   Models the waveform on a PWM pin over one period.  When connected, fast
+*   PWM sets the pin at BOTTOM and clears it on the compare match, so it is
+*   high from count 0 to the compare value.  When disconnected, the pin is
+*   driven at the level last written to it, if it is an output.
+*
+* Arguments:
+*   chan - PWM output
+*
+* Returns:
+*   cnts - counts for which the pin is high in each period (-1 if the pin
+*          isn't driven)
+******************************************************************************/
+static int highCnts ( PWMOUT_ENUM_TYPE chan )
+{
+  byte pin = ( chan == PWMOUT_1 ) ? PWM1PIN : PWM2PIN; // pin of the output
+  byte com = ( chan == PWMOUT_1 ) ? COM0B1 : COM0A1;   // compare output mode bit
+  byte ocr = ( chan == PWMOUT_1 ) ? OCR0B : OCR0A;     // compare value
+  int  cnts;                                           // high counts
+
+  if ( shimPinMode [ pin ] != OUTPUT )
+    return -1;
+  if ( TCCR0A & _BV ( com ) )
+    for ( cnts = 0; ( cnts < PWM_CNTS ) && ( cnts <= ocr ); cnts++ )
+      ;
+  else
+    cnts = ( shimPinLevel [ pin ] == LOW ) ? 0 : PWM_CNTS;
+
+  return cnts;
+} // end of highCnts()
+
+/******************************************************************************
+* Function:
+*   checkInit()
+*
+* Description:
+*   Starts from timer0 as the Arduino core leaves it, with the pins high,
+*   and checks pwmOutInit() takes it over and drives both pins low
+*
+* Arguments:
+*   none
+*
+* Returns:
+*   none
+******************************************************************************/
+static void checkInit ( void )
+{
+  TIMSK0 = _BV ( TOIE0 );                 // millis() overflow interrupt
+  TCCR0A = _BV ( WGM01 ) | _BV ( WGM00 ); // fast PWM
+  TCCR0B = _BV ( CS01 ) | _BV ( CS00 );   // divide by 64
+  shimPinLevel [ PWM1PIN ] = HIGH;
+  shimPinLevel [ PWM2PIN ] = HIGH;
+
+  pwmOutInit ( );
+
+  TEST_EQUAL ( TIMSK0, 0 );
+  TEST_EQUAL ( TCCR0A, _BV ( WGM01 ) | _BV ( WGM00 ) ); // fast PWM to 0xFF, both outputs disconnected
+  TEST_EQUAL ( TCCR0B, _BV ( CS00 ) );                  // 62500 Hz
+  TEST_EQUAL ( highCnts ( PWMOUT_1 ), 0 );
+  TEST_EQUAL ( highCnts ( PWMOUT_2 ), 0 );
+
+  return;
+} // end of checkInit()
+
+/******************************************************************************
+* Function:
+*   checkDuty()
+*
+* Description:
+*   Sets every duty on one output, with the other at a random duty, and
+*   checks the high time of each
+*
+* Arguments:
+*   chan - PWM output to step through its duties
+*
+* Returns:
+*   none
+******************************************************************************/
+static void checkDuty ( PWMOUT_ENUM_TYPE chan )
+{
+  PWMOUT_ENUM_TYPE other = ( chan == PWMOUT_1 ) ? PWMOUT_2 : PWMOUT_1; // output left alone
+  unsigned long    wrong = 0;                                           // duties which gave the wrong waveform
+  int              duty, otherDuty, otherCnts;
+
+  for ( duty = 0; duty < 256; duty++ )
+  {
+    otherDuty = testRandom ( 256 );
+    pwmOutSet ( other, otherDuty );
+    otherCnts = highCnts ( other );
+
+    pwmOutSet ( chan, duty );
+    if ( ( highCnts ( chan ) != ( ( duty == 0 ) ? 0 : duty + 1 ) ) ||
+         ( highCnts ( other ) != otherCnts ) ||
+         ( otherCnts != ( ( otherDuty == 0 ) ? 0 : otherDuty + 1 ) ) ||
+         ( TCCR0A & ( _BV ( COM0A0 ) | _BV ( COM0B0 ) ) ) ) // never inverted or toggling
+    {
+      if ( wrong++ == 0 )
+        printf ( "  channel %d duty %d gave %d high counts\n", chan, duty, highCnts ( chan ) );
+    }
+  }
+  TEST_EQUAL ( wrong, 0 );
+  TEST_EQUAL ( TIMSK0, 0 ); // overflow interrupt still off
+
+  return;
+} // end of checkDuty()
+
+/******************************************************************************
+* Function:
+*   inBlank()
+*
+* Description:
+*   Checks whether a timer0 count is in the window around one of the PWM
+*   switching instants: the bottom, and each compare match
+*
+* Arguments:
+*   cnt - timer0 count
+*
+* Returns:
+*   blank - high if the count is in a window
+******************************************************************************/
+static byte inBlank ( byte cnt )
+{
+  return ( (byte) ( cnt + PWMOUT_LEAD_CNTS ) < PWMOUT_LEAD_CNTS + PWMOUT_BLANK_CNTS ) ||
+         ( (byte) ( cnt - OCR0A + PWMOUT_LEAD_CNTS ) < PWMOUT_LEAD_CNTS + PWMOUT_BLANK_CNTS ) ||
+         ( (byte) ( cnt - OCR0B + PWMOUT_LEAD_CNTS ) < PWMOUT_LEAD_CNTS + PWMOUT_BLANK_CNTS );
+} // end of inBlank()
+
+/******************************************************************************
+* Function:
+*   checkQuiet()
+*
+* Description:
+*   Calls pwmOutQuiet() from every timer0 count, for every pair of duties,
+*   and checks the count it returns at and how long it waited
+*
+* Arguments:
+*   none
+*
+* Returns:
+*   none
+******************************************************************************/
+static void checkQuiet ( void )
+{
+  unsigned long      blank   = 0; // returns with the count in a window
+  unsigned long      slow    = 0; // waits longer than the windows take
+  unsigned long      waited  = 0; // waits when the count was already clear
+  unsigned long      longest = 0; // longest wait (timer0 counts)
+  unsigned long long start;       // count at the call
+  unsigned long      wait;        // time waited (timer0 counts)
+  int                duty1, duty2, cnt;
+
+  timer0SimInit ( );
+  for ( duty1 = 0; duty1 < 256; duty1++ )
+  {
+    pwmOutSet ( PWMOUT_1, duty1 );
+    for ( duty2 = 0; duty2 < 256; duty2++ )
+    {
+      pwmOutSet ( PWMOUT_2, duty2 );
+      for ( cnt = 0; cnt < PWM_CNTS; cnt++ )
+      {
+        start            = timer0Sim.cycles + ( (byte) ( cnt - timer0Sim.cycles ) );
+        timer0Sim.cycles = start;
+        timer0Sim.reads  = 0;
+        pwmOutQuiet ( );
+        wait             = timer0Sim.cycles - start;
+
+        if ( inBlank ( (byte) ( timer0Sim.cycles - TIMER0_SIM_READ_CYCLES ) ) ) // count at the last read
+          blank++;
+        if ( wait > QUIET_MAX )
+          slow++;
+        if ( !inBlank ( cnt ) && ( timer0Sim.reads != 1 ) )
+          waited++;
+        if ( wait > longest )
+          longest = wait;
+      }
+    }
+  }
+  TEST_EQUAL ( blank, 0 );
+  TEST_EQUAL ( slow, 0 );
+  TEST_EQUAL ( waited, 0 );
+  TEST_CHECK ( longest > 3 * ( PWMOUT_LEAD_CNTS + PWMOUT_BLANK_CNTS ) ); // some pairs of duties do chain the windows together
+
+  return;
+} // end of checkQuiet()
+
+int main ( void )
+{
+  checkInit ( );
+  checkDuty ( PWMOUT_1 );
+  checkDuty ( PWMOUT_2 );
+  checkQuiet ( );
+
+  return testResult ( "pwmOutTest" );
+}
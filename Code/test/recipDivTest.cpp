@@ -0,0 +1,177 @@
+/*
+ * recipDivTest.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+
+/* Checks recipDiv() against an exact divide.  Every quotient q of num/den
+ * must be within the documented bound, |q - num/den| <= num/den * 2^-13 + 1,
+ * which is checked in exact integer arithmetic.  This is run over every
+ * hall period the speed measurement can give, for several pulses per
+ * revolution, and over random dividends and divisors of every width.  The
+ * speed from each period must also be within 1 rpm.  Divisors below
+ * RECIP_MIN_DEN must divide exactly, and a zero divisor must give
+ * 0xFFFFFFFF. */
+
+/*******************************************************************************
+ * INCLUDED HEADER FILES
+ ******************************************************************************/
+#include "recipDiv.h"
+#include "timeBase.h"
+#include "testUtil.h"
+
+/*******************************************************************************
+ * MACRO DEFINITIONS
+ ******************************************************************************/
+#define RPM_CNTS( ppr )  ( 60UL * TIME_US_TO_CNTS ( TIMEBASE_US_PER_SEC ) / ( ppr ) ) // speed times full hall period (rpm * timer1 counts), as FAN_RPM_CNTS()
+#define MAX_RPM          9999                                                       // highest speed measured (rpm)
+#define MIN_RPM          50                                                         // lowest speed measured (rpm)
+#define RANDOM_DIVS      2000000                                                    // random divides checked
+
+/*******************************************************************************
+ * FUNCTION DEFINITIONS
+ ******************************************************************************/
+
+/******************************************************************************
+* Function:
+*   inBound()
+*
+* Description:
+*   Checks a quotient is within the error bound of recipDiv(), using
+*   |q * den - num| * 2^13 <= num + den * 2^13, which has no rounding
+*
+* Arguments:
+*   num - dividend
+*   den - divisor
+*   q - quotient
+*
+* Returns:
+*   ok - high if the quotient is within the bound
+******************************************************************************/
+static byte inBound ( unsigned long num, unsigned long den, unsigned long q )
+{
+  __int128 err = (__int128) q * den - num; // error times the divisor
+
+  if ( err < 0 )
+    err = -err;
+
+  return ( err * 8192 ) <= ( (__int128) num + (__int128) den * 8192 );
+} // end of inBound()
+
+/******************************************************************************
+* Function:
+*   checkPeriods()
+*
+* Description:
+*   Divides the speed constant by every full hall period from the highest
+*   speed to the lowest, and checks each quotient is within the bound and
+*   within 1 rpm of the exact speed
+*
+* Arguments:
+*   ppr - hall sensor pulses-per-revolution
+*
+* Returns:
+*   none
+******************************************************************************/
+static void checkPeriods ( byte ppr )
+{
+  unsigned long num     = RPM_CNTS ( ppr ); // speed times full hall period
+  unsigned long outside = 0;                // quotients outside the bound
+  unsigned long offRpm  = 0;                // speeds more than 1 rpm out
+  unsigned long period;                     // full hall period (timer1 counts)
+  unsigned long q;                          // quotient
+
+  for ( period = num / MAX_RPM; period <= num / MIN_RPM; period++ )
+  {
+    q = recipDiv ( num, period );
+    if ( !inBound ( num, period, q ) && ( outside++ == 0 ) )
+      printf ( "  %lu / %lu gave %lu\n", num, period, q );
+    if ( labs ( (long) ( q * period ) - (long) num ) > (long) period ) // |q - num/period| > 1
+      offRpm++;
+  }
+  TEST_EQUAL ( outside, 0 );
+  TEST_EQUAL ( offRpm, 0 );
+
+  return;
+} // end of checkPeriods()
+
+/******************************************************************************
+* Function:
+*   checkRandom()
+*
+* Description:
+*   Checks the bound for random dividends and divisors, each of a random
+*   width, so every normalization shift is used
+*
+* Arguments:
+*   none
+*
+* Returns:
+*   none
+******************************************************************************/
+static void checkRandom ( void )
+{
+  unsigned long outside = 0; // quotients outside the bound
+  unsigned long num, den, q;
+  unsigned long it;
+
+  for ( it = 0; it < RANDOM_DIVS; it++ )
+  {
+    num = testRandom ( 0x100000000ULL ) >> testRandom ( 32 );
+    den = testRandom ( 0x100000000ULL ) >> testRandom ( 32 );
+    if ( den < RECIP_MIN_DEN )
+      den = RECIP_MIN_DEN + testRandom ( 0x10000 );
+    q = recipDiv ( num, den );
+    if ( !inBound ( num, den, q ) && ( outside++ == 0 ) )
+      printf ( "  %lu / %lu gave %lu\n", num, den, q );
+  }
+  TEST_EQUAL ( outside, 0 );
+
+  return;
+} // end of checkRandom()
+
+/******************************************************************************
+* Function:
+*   checkSmall()
+*
+* Description:
+*   Checks divisors below RECIP_MIN_DEN divide exactly, and a zero divisor
+*   gives the largest quotient
+*
+* Arguments:
+*   none
+*
+* Returns:
+*   none
+******************************************************************************/
+static void checkSmall ( void )
+{
+  static const unsigned long nums [ ] = { 0, 1, 2, 3, 7, 0xFFFF, 0x10000, 12345678, 0x7FFFFFFF, 0xFFFFFFFF }; // dividends tried
+  unsigned long              wrong    = 0;                                                                    // quotients which weren't exact
+  unsigned long              den;
+  byte                       i;
+
+  for ( i = 0; i < sizeof ( nums ) / sizeof ( nums [ 0 ] ); i++ )
+  {
+    for ( den = 1; den < RECIP_MIN_DEN; den++ )
+      if ( recipDiv ( nums [ i ], den ) != nums [ i ] / den )
+        wrong++;
+    if ( recipDiv ( nums [ i ], 0 ) != 0xFFFFFFFF )
+      wrong++;
+  }
+  TEST_EQUAL ( wrong, 0 );
+
+  return;
+} // end of checkSmall()
+
+int main ( void )
+{
+  checkSmall ( );
+  checkPeriods ( 1 );
+  checkPeriods ( 2 );
+  checkPeriods ( 4 );
+  checkRandom ( );
+
+  return testResult ( "recipDivTest" );
+}
@@ -0,0 +1,325 @@
+/*
+ * piControllerRef.cpp
+ *
+ *  Created on: Oct 29, 2016
+ *      Author: agent
+ */
+
+
+#include "piControllerRef.h"
+
+/*******************************************************************************
+ * MACRO DEFINITIONS
+ ******************************************************************************/
+#define PI_AW_GAIN( sampleTime ) ( (int) ( ( ( sampleTime ) << 9 ) / 25000UL ) ) // anti-windup gain for a sample time (microseconds), which is the sample time in units of 1.6 seconds / 2^15
+
+
+/*******************************************************************************
+ * FUNCTION DEFINITIONS
+ ******************************************************************************/
+
+
+/******************************************************************************
+* Function:
+*   piControllerRef()
+*
+* Description:
+*   Constructor function for a piControllerRef object, with all gains and
+*   limits zero.  setGains() must be called before the controller is used.
+*
+* Arguments:
+*   none
+*
+* Returns:
+*   none
+******************************************************************************/
+piControllerRef :: piControllerRef ( void )
+{
+  sampleTime  = 0; // sample time (microseconds)
+  errIntegral = 0; // integral of error (tenths of error count times seconds)
+  maxErrInt   = 0; // maximum value of errIntegral (tenths of error count times seconds)
+  minErrInt   = 0; // maximum value of errIntegral (tenths of error count times seconds)
+  kp          = 0; // Proportional gain (2^-13 duty counts per error count)
+  ki          = 0; // Integral gain (2^-17 duty counts per error count per 100 milliseconds)
+  awGain      = 0; // anti-windup gain
+  IntTerm     = 0; // start with integral term = 0
+  PropTerm    = 0; // start with proportional term = 0
+
+  return; // exit function
+}         // end of piControllerRef()
+
+/******************************************************************************
+* Function:
+*   piControllerRef()
+*
+* Description:
+*   Constructor function for a piControllerRef object
+*
+* Arguments:
+*   sampleTimeSet - sets sample time (microseconds)
+*   maxErrIntSet - sets max integrator value (tenths of error count times seconds)
+*   minErrIntSet - sets min integrator value (tenths of error count times seconds)
+*   kpSet - sets proportional gain (2^-13 duty counts per error count)
+*   kiSet - sets integral gain (2^-17 duty counts per error count per 100 milliseconds)
+*
+* Returns:
+*   none
+******************************************************************************/
+piControllerRef :: piControllerRef ( unsigned long sampleTimeSet, int maxErrIntSet, int minErrIntSet, int kpSet, int kiSet )
+{
+  sampleTime  = sampleTimeSet;                // set sample time (microseconds)
+  errIntegral = 0;                            // integral of error (tenths of error count times seconds)
+  maxErrInt   = maxErrIntSet;                 // maximum value of errIntegral (tenths of error count times seconds)
+  minErrInt   = minErrIntSet;                 // maximum value of errIntegral (tenths of error count times seconds)
+  kp          = kpSet;                        // Proportional gain (2^-13 duty counts per error count)
+  ki          = kiSet;                        // Integral gain (2^-17 duty counts per error count per 100 milliseconds)
+  awGain      = PI_AW_GAIN ( sampleTimeSet ); // anti-windup gain
+  IntTerm     = 0;                            // start with integral term = 0
+  PropTerm    = 0;                            // start with proportional term = 0
+
+  return; // exit function
+}         // end of piControllerRef()
+
+/******************************************************************************
+* Function:
+*   setGains()
+*
+* Description:
+*   Updates gains in the piControllerRef object
+*
+* Arguments:
+*   sampleTimeSet - sets sample time (microseconds)
+*   maxErrIntSet - sets max integrator value (tenths of error count times seconds)
+*   minErrIntSet - sets min integrator value (tenths of error count times seconds)
+*   kpSet - sets proportional gain (2^-13 duty counts per error count)
+*   kiSet - sets integral gain (2^-17 duty counts per error count per 100 milliseconds)
+*
+* Returns:
+*   none
+******************************************************************************/
+void piControllerRef :: setGains ( unsigned long sampleTimeSet, int maxErrIntSet, int minErrIntSet, int kpSet, int kiSet )
+{
+  sampleTime = sampleTimeSet;                // set sample time (microseconds)
+  maxErrInt  = maxErrIntSet;                 // maximum value of errIntegral (tenths of error count times seconds)
+  minErrInt  = minErrIntSet;                 // maximum value of errIntegral (tenths of error count times seconds)
+  kp         = kpSet;                        // Proportional gain (2^-13 duty counts per error count)
+  ki         = kiSet;                        // Integral gain (2^-17 duty counts per error count per 100 milliseconds)
+  awGain     = PI_AW_GAIN ( sampleTimeSet ); // anti-windup gain
+
+  return; // exit function
+}         // end of setGains()
+
+
+/******************************************************************************
+* Function:
+*   resetInt()
+*
+* Description:
+*   Resets integrator to zero
+*
+* Arguments:
+*   none
+*
+* Returns:
+*   none
+******************************************************************************/
+void piControllerRef :: resetInt ( void )
+{
+  errIntegral = 0; // set integrator to zero (tenths of error count times seconds)
+
+  return; // exit function
+}         // end of resetInt()
+
+/******************************************************************************
+* Function:
+*   resetInt()
+*
+* Description:
+*   Resets integrator to specified value
+*
+* Arguments:
+*   errInt - value to set integrator to (tenths of error count times seconds)
+*
+* Returns:
+*   none
+******************************************************************************/
+void piControllerRef :: resetInt ( int errInt )
+{
+  errIntegral = errInt; // set integrator to specified value (tenths of error count times seconds)
+
+  return; // exit function
+}         // end of resetInt()
+
+/******************************************************************************
+* Function:
+*   preload()
+*
+* Description:
+*   Pre-loads the integrator for a bumpless handover, so that the next
+*   control step gives the duty the fan is already running at (if the error
+*   and feedforward are unchanged).  The integrator is set short of the
+*   state which gives the duty by what that step will add to it, and the
+*   state is rounded up, so the integral term doesn't come out a count low.
+*   Used when control is handed back to the controller after something
+*   else has been setting the duty.
+*
+* Arguments:
+*   dutyNow - duty the fan is running at
+*   errVal - error term input to PI
+*   ffTerm - feedforward term, in quarter of duty counts
+*
+* Returns:
+*   none
+******************************************************************************/
+void piControllerRef :: preload ( byte dutyNow, int errVal, int ffTerm )
+{
+  long int intTarget; // integral term needed, in quarter of duty counts
+  long int intState;  // integrator state which gives it (tenths of error count times seconds)
+
+  if ( ki <= 0 ) // integrator can't be set through a zero gain
+    return;
+
+  PropTerm  = (int) constrain ( ( (long) errVal * kp ) >> 11, -16384, 16383 ); // proportional term, in quarter of duty counts
+  intTarget = ( (long) dutyNow << 2 ) - PropTerm - ffTerm;                     // integral term which gives the duty
+  intState  = intTarget << 15;
+  if ( intState > 0 )
+    intState = ( intState + ki - 1 ) / ki; // round up (the divide rounds toward zero)
+  else
+    intState = intState / ki;
+  errIntegral = (int) constrain ( intState - ( ( (long int) errVal ) * (long int) sampleTime ) / 100000L, (long int) minErrInt, (long int) maxErrInt ); // less what the next step adds
+  IntTerm     = (int) constrain ( ( (long) errIntegral * ki ) >> 15, -16384, 16383 );                                                                // integral term, in quarter of duty counts
+
+  return; // exit function
+}         // end of preload()
+
+/******************************************************************************
+* Function:
+*   piControl()
+*
+* Description:
+*   Executes PI control step
+*
+* Arguments:
+*   errVal - error term input to PI
+*
+* Returns:
+*   none
+******************************************************************************/
+byte piControllerRef :: piControl ( int errVal )
+{
+  return piControl ( errVal, 0 ); // exit function
+} // end of piControl()
+
+/******************************************************************************
+* Function:
+*   piControl()
+*
+* Description:
+*   Executes PI control step, with a feedforward term added to the output.
+*   The feedforward gives most of the duty needed for a new speed at once,
+*   so the integrator only has to make up the difference.
+*
+*   Anti-windup is by back-calculation: whenever the output saturates, the
+*   amount it is over the limit is fed back into the integrator, pulling
+*   the output back towards the limit with a tracking time constant equal
+*   to the integral time (kp / ki).  So the integrator never winds up past
+*   what the output can use, and the output comes off the limit as soon as
+*   the error reverses, instead of waiting for the integrator to unwind.
+*   A shorter time constant drags the integrator down while a large step
+*   saturates the proportional term, and the speed then creeps in.  With
+*   no proportional gain, the integrator is held at the limit instead.
+*
+* Arguments:
+*   errVal - error term input to PI
+*   ffTerm - feedforward term, in quarter of duty counts
+*
+* Returns:
+*   none
+******************************************************************************/
+byte piControllerRef :: piControl ( int errVal, int ffTerm )
+{
+  long int dutyOut; // output duty, before limiting (quarter of duty counts)
+  long int excess;  // amount the output is over its limits (quarter of duty counts)
+
+  errIntegral = (int) constrain (
+    ( ( (long int) errIntegral ) + ( ( ( (long int) errVal ) * (long int) sampleTime ) / 100000L ) ), // add to integrator, which holds error in tenths of rpm times seconds
+    ( (long int) minErrInt ), ( (long int) maxErrInt ) );                                             // constrain to stay within integrator limits
+
+  PropTerm = (int) constrain ( ( (long) errVal * kp ) >> 11, -16384, 16383 );      // proportional term, in quarter of duty counts
+  IntTerm  = (int) constrain ( ( (long) errIntegral * ki ) >> 15, -16384, 16383 ); // integral term, in quarter of duty counts
+  dutyOut  = (long) PropTerm + IntTerm + ffTerm;                                    // output duty
+
+  /* Feed the saturation back into the integrator */
+  if ( dutyOut > ( MAXPIOUTPUT << 2 ) + 3 )
+    excess = dutyOut - ( ( MAXPIOUTPUT << 2 ) + 3 );
+  else if ( dutyOut < ( MINPIOUTPUT << 2 ) )
+    excess = dutyOut - ( MINPIOUTPUT << 2 );
+  else
+    excess = 0;
+  if ( ( excess != 0 ) && ( ki > 0 ) )
+  {
+    if ( kp > 0 )
+      excess = ( excess * awGain ) / kp; // pull integrator back towards the limit over the integral time
+    else
+      excess = ( excess << 15 ) / ki;    // hold integrator at the limit
+    errIntegral = (int) constrain ( errIntegral - excess, (long int) minErrInt, (long int) maxErrInt ); // feed back into integrator (tenths of error count times seconds)
+    IntTerm     = (int) constrain ( ( (long) errIntegral * ki ) >> 15, -16384, 16383 );                 // integral term, in quarter of duty counts
+  }
+
+  return (byte) constrain ( dutyOut >> 2, MINPIOUTPUT, MAXPIOUTPUT ); // exit function
+} // end of piControl()
+
+
+/******************************************************************************
+* Function:
+*   getPropTerm()
+*
+* Description:
+*   returns the proportional term.  good for debugging.
+*
+* Arguments:
+*   none
+*
+* Returns:
+*   PropTerm - proportional term, in quarters of duty count
+******************************************************************************/
+int piControllerRef :: getPropTerm ( void )
+{
+  return PropTerm;
+} // end of getPropTerm()
+
+/******************************************************************************
+* Function:
+*   getIntTerm()
+*
+* Description:
+*   returns the integral term.  good for debugging.
+*
+* Arguments:
+*   none
+*
+* Returns:
+*   IntTerm - integral term, in quarters of duty count
+******************************************************************************/
+int piControllerRef :: getIntTerm ( void )
+{
+  return IntTerm;
+} // end of getIntTerm()
+
+/******************************************************************************
+* Function:
+*   getIntState()
+*
+* Description:
+*   returns the integrator state.  good for debugging.
+*
+* Arguments:
+*   none
+*
+* Returns:
+*   errIntegral - integrator state, (tenths of error count times seconds)
+******************************************************************************/
+int piControllerRef :: getIntState ( void )
+{
+  return errIntegral;
+} // end of getIntState()
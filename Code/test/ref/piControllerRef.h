@@ -0,0 +1,72 @@
+/*
+ * piControllerRef.h
+ *
+ *  Created on: Oct 29, 2016
+ *      Author: agent
+ */
+
+/* The PI controller as it was before it became the piControllerQ template,
+ * kept for piEquivTest to check the template against, bit for bit.  The
+ * class is renamed, and preload() has the fix made to the template's (it
+ * leaves out what the next step adds to the integrator, and rounds up), so
+ * the two can still be compared through a handover.  Don't change it
+ * otherwise. */
+
+#ifndef PICONTROLLERREF_H_
+#define PICONTROLLERREF_H_
+
+#include "Arduino.h"
+
+/*******************************************************************************
+ * MACRO DEFINITIONS
+ ******************************************************************************/
+#define MINPIOUTPUT 1   // minimum PI output control value (must be >= 0, <= 255)
+#define MAXPIOUTPUT 255 // maximum PI output control value (must be >=0, <= 255, >= MINOUTPUT)
+
+/*******************************************************************************
+ * CLASS DECLARATIONS
+ ******************************************************************************/
+
+/*
+ * Class:		piControllerRef
+ * Function:	NA
+ * Scope:		global
+ * Arguments:	NA
+ * Description:	This class contains the PI Controller functions and data
+ */
+class piControllerRef
+{
+private:
+unsigned long sampleTime;  // sample time, (microseconds)
+int           errIntegral; // integral of error  (tenths of error count times seconds)
+int           maxErrInt;   // maximum value of errIntegral  (tenths of error count times seconds)
+int           minErrInt;   // maximum value of errIntegral  (tenths of error count times seconds)
+int           kp;          // Proportional gain (2^-13 duty counts per error count)
+int           ki;          // Integral gain (2^-17 duty counts per error count per 100 milliseconds)
+int           awGain;      // anti-windup gain, so the back-calculation runs over the integral time (sample time in units of 1.6 seconds / 2^15)
+int           PropTerm;    // proportional term (quarter of duty counts)
+int           IntTerm;     // integral term (quarter of duty counts)
+
+public:
+piControllerRef ( void ); // constructor for piControllerRef, with gains to be set by setGains()
+piControllerRef ( unsigned long sampleTimeSet,
+  int                           maxErrIntSet,
+  int                           minErrIntSet,
+  int                           kpSet,
+  int                           kiSet ); // constructor for piControllerRef
+void setGains ( unsigned long sampleTimeSet,
+  int                         maxErrIntSet,
+  int                         minErrIntSet,
+  int                         kpSet,
+  int                         kiSet ); // method for updating gains of PI controller
+void resetInt ( void );                                // resets integral term to zero
+void resetInt ( int errInt );                          // resets integral term to specified value
+void preload ( byte dutyNow, int errVal, int ffTerm ); // pre-loads the integrator so the next step gives the current duty (bumpless handover)
+byte piControl ( int errVal );                         // executes one iteration of PI control loop
+byte piControl ( int errVal, int ffTerm );             // executes one iteration of PI control loop, with a feedforward term added to the output
+int  getPropTerm ( void );                             // returns the proportional term.  good for debugging.
+int  getIntTerm ( void );                              // returns the integral term.  good for debugging.
+int  getIntState ( void );                             // returns the integrator state.  good for debugging.
+};
+
+#endif /* PICONTROLLERREF_H_ */
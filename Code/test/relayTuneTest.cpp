@@ -0,0 +1,236 @@
+/*
+ * relayTuneTest.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+
+/* Runs the relay auto-tune experiment against the fan model, from a
+ * standstill: the relay bias must be a duty which holds the fan near the
+ * reference, however slow the fan is to settle, the cycle periods and
+ * swings it measures must match the ones seen from outside, and the gains
+ * it gives must hold the fan at the reference and settle speed steps
+ * without ringing.  Experiments which can't work must fail rather than
+ * give gains. */
+
+/*******************************************************************************
+ * INCLUDED HEADER FILES
+ ******************************************************************************/
+#include "relayTune.h"
+#include "piController.h"
+#include "savedVars.h"
+#include "fanPlant.h"
+#include "testUtil.h"
+
+/*******************************************************************************
+ * MACRO DEFINITIONS
+ ******************************************************************************/
+#define STEP_LOOPS    600   // control loops given to each speed step (30 seconds)
+#define SETTLE_PCT    2     // band the speed must settle in (percent of the reference)
+#define SETTLE_MAX    3.0   // longest settling time allowed for a step (seconds)
+#define OVERSHOOT_PCT 20    // largest overshoot allowed (percent of the step)
+
+/*******************************************************************************
+ * TYPE DEFINITIONS
+ ******************************************************************************/
+/* Result of a speed step */
+typedef struct STEP_RESULT {
+  double settle;    // time to settle in the band for good (seconds, negative if it never did)
+  double overshoot; // largest overshoot past the new reference (rpm)
+} STEP_RESULT_TYPE;
+
+/*******************************************************************************
+ * FUNCTION DEFINITIONS
+ ******************************************************************************/
+
+/******************************************************************************
+* Function:
+*   runStep()
+*
+* Description:
+*   Holds the fan at one speed, then steps the reference to another, with
+*   the PI controller closing the loop
+*
+* Arguments:
+*   plant - fan model
+*   pi - PI controller
+*   from - reference held first (rpm)
+*   to - reference stepped to (rpm)
+*
+* Returns:
+*   result - settling time and overshoot of the step
+******************************************************************************/
+static STEP_RESULT_TYPE runStep ( FAN_PLANT_TYPE *plant, piController *pi, unsigned int from, unsigned int to )
+{
+  STEP_RESULT_TYPE result = { -1, 0 }; // result of the step
+  unsigned int     meas   = (unsigned int) plant->meas;
+  double           over;               // distance past the new reference (rpm)
+  int              k;                  // loop count
+
+  for ( k = 0; k < STEP_LOOPS; k++ )
+    meas = fanPlantStep ( plant, pi->piControl ( (int) from - (int) meas ) );
+  for ( k = 0; k < STEP_LOOPS; k++ )
+  {
+    meas = fanPlantStep ( plant, pi->piControl ( (int) to - (int) meas ) );
+    over = ( to > from ) ? plant->meas - to : to - plant->meas;
+    if ( over > result.overshoot )
+      result.overshoot = over;
+    if ( fabs ( plant->meas - to ) > to * SETTLE_PCT / 100.0 )
+      result.settle = -1;
+    else if ( result.settle < 0 )
+      result.settle = k * FAN_PLANT_DT;
+  }
+
+  return result;
+} // end of runStep()
+
+/******************************************************************************
+* Function:
+*   tuneCase()
+*
+* Description:
+*   Runs a relay experiment on a fan with a given time constant, checks
+*   what it measured against the speed trace, and step tests the gains
+*
+* Arguments:
+*   tau - time constant of the fan (seconds)
+*   ref - speed to tune at (rpm)
+*
+* Returns:
+*   none
+******************************************************************************/
+static void tuneCase ( double tau, unsigned int ref )
+{
+  FAN_PLANT_TYPE   plant = { tau, 0, 0 };                 // fan model
+  piController     pi ( pi1Imax, pi1Imin, pi1Kp, pi1Ki ); // controller holding the fan during settling, with the default gains
+  RELAY_TUNE_TYPE  tune;                                  // relay experiment
+  STEP_RESULT_TYPE up, down;                              // results of the step tests
+  unsigned long    sumPeriod  = 0;                        // sum of the measured cycle periods, seen from outside (control loops)
+  unsigned long    sumSwing   = 0;                        // sum of the measured cycle swings, seen from outside (rpm)
+  unsigned int     meas       = 0;                        // measured speed (rpm)
+  unsigned int     rpmMax     = 0;                        // highest speed this cycle (rpm)
+  unsigned int     rpmMin     = 0;                        // lowest speed this cycle (rpm)
+  unsigned int     lastUp     = 0;                        // relay loop count at the last upward switch
+  unsigned int     cycles     = 0;                        // upward switches of the relay
+  unsigned int     loops      = 0;                        // control loops of the experiment
+  unsigned int     relayLoops = 0;                        // control loops since the relay started
+  byte             duty;                                  // duty sent to the fan
+  byte             phase      = RTUNE_SETTLE;             // phase of the experiment
+  byte             wasHigh    = LOW;                      // high if the relay was high on the last loop
+  byte             badDuty    = LOW;                      // high if the relay sent out any other duty than its two levels
+  int              kp         = 0;                        // tuned proportional gain
+  int              ki         = 0;                        // tuned integral gain
+
+  relayTuneStart ( &tune, ref, 0, 0 );
+  while ( ( phase < RTUNE_DONE ) && ( loops++ < 2 * RTUNE_MAX_LOOPS + 2 ) )
+  {
+    duty  = pi.piControl ( (int) ref - (int) meas );
+    phase = relayTuneStep ( &tune, meas, &duty );
+    if ( ( phase == RTUNE_RELAY ) || ( phase == RTUNE_DONE ) ) // the step finishing the last cycle is still a relay step
+    {
+      if ( ( relayLoops > 0 ) && ( duty != tune.bias + tune.amp ) && ( duty != tune.bias - tune.amp ) ) // the PI duty still goes out on the step the relay starts
+        badDuty = HIGH;
+      if ( relayLoops == 0 )
+        rpmMax = rpmMin = meas;
+      if ( meas > rpmMax )
+        rpmMax = meas;
+      if ( meas < rpmMin )
+        rpmMin = meas;
+      if ( ( duty > tune.bias ) && !wasHigh && ( relayLoops > 0 ) ) // upward switch, ending a cycle
+      {
+        if ( ++cycles > RTUNE_SKIP_CYCLES + 1 )
+        {
+          sumPeriod += relayLoops - lastUp;
+          sumSwing  += rpmMax - rpmMin;
+        }
+        lastUp = relayLoops;
+        rpmMax = rpmMin = meas;
+      }
+      wasHigh = ( duty > tune.bias );
+      relayLoops++;
+    }
+    meas = fanPlantStep ( &plant, duty );
+  }
+
+  TEST_EQUAL ( phase, RTUNE_DONE );
+  TEST_CHECK ( fabs ( fanPlantSteady ( tune.bias ) - ref ) <= ref >> RTUNE_BAND_SHIFT );
+  TEST_CHECK ( !badDuty );
+  TEST_EQUAL ( tune.sumPeriod, sumPeriod );
+  TEST_EQUAL ( tune.sumSwing, sumSwing );
+  TEST_CHECK ( relayTuneGains ( &tune, &kp, &ki ) );
+  TEST_CHECK ( ( kp > 0 ) && ( ki > 0 ) );
+
+  /* Gains must settle steps either way, without much overshoot */
+  pi.setGains ( pi1Imax, pi1Imin, kp, ki );
+  up   = runStep ( &plant, &pi, ref * 3 / 4, ref );
+  down = runStep ( &plant, &pi, ref, ref * 3 / 4 );
+  printf ( "  tau %.1f s, %u rpm: bias %u, amp %u, period %.2f s, swing %lu rpm -> kp %d, ki %d; "
+           "up %.2f s / %.0f rpm, down %.2f s / %.0f rpm\n",
+           tau, ref, tune.bias, tune.amp, tune.sumPeriod * FAN_PLANT_DT / RTUNE_MEAS_CYCLES,
+           tune.sumSwing / RTUNE_MEAS_CYCLES, kp, ki, up.settle, up.overshoot, down.settle, down.overshoot );
+  TEST_CHECK ( ( up.settle >= 0 ) && ( up.settle <= SETTLE_MAX ) );
+  TEST_CHECK ( ( down.settle >= 0 ) && ( down.settle <= SETTLE_MAX ) );
+  TEST_CHECK ( up.overshoot <= ref / 4.0 * OVERSHOOT_PCT / 100.0 );
+  TEST_CHECK ( down.overshoot <= ref / 4.0 * OVERSHOOT_PCT / 100.0 );
+
+  return;
+} // end of tuneCase()
+
+/******************************************************************************
+* Function:
+*   failCase()
+*
+* Description:
+*   Runs a relay experiment which can't work, and checks it fails without
+*   giving gains
+*
+* Arguments:
+*   ref - speed to tune at (rpm)
+*   stuck - high if the measured speed freezes once the relay starts
+*
+* Returns:
+*   none
+******************************************************************************/
+static void failCase ( unsigned int ref, byte stuck )
+{
+  FAN_PLANT_TYPE  plant = { 1.2, 0, 0 };                 // fan model
+  piController    pi ( pi1Imax, pi1Imin, pi1Kp, pi1Ki ); // controller holding the fan during settling, with the default gains
+  RELAY_TUNE_TYPE tune;                                  // relay experiment
+  unsigned int    meas  = 0;                             // measured speed (rpm)
+  unsigned int    loops = 0;                             // control loops of the experiment
+  byte            duty;                                  // duty sent to the fan
+  byte            phase = RTUNE_SETTLE;                  // phase of the experiment
+  int             kp    = -1;                            // tuned proportional gain (must be left alone)
+  int             ki    = -1;                            // tuned integral gain (must be left alone)
+
+  relayTuneStart ( &tune, ref, 0, 0 );
+  while ( ( phase < RTUNE_DONE ) && ( loops++ < 2 * RTUNE_MAX_LOOPS + 2 ) )
+  {
+    duty  = pi.piControl ( (int) ref - (int) meas );
+    phase = relayTuneStep ( &tune, meas, &duty );
+    if ( !stuck || ( phase == RTUNE_SETTLE ) )
+      meas = fanPlantStep ( &plant, duty );
+  }
+
+  TEST_EQUAL ( phase, RTUNE_FAILED );
+  TEST_CHECK ( !relayTuneGains ( &tune, &kp, &ki ) );
+  TEST_CHECK ( ( kp == -1 ) && ( ki == -1 ) );
+
+  return;
+} // end of failCase()
+
+int main ( void )
+{
+  static const double       taus [ ] = { 0.6, 1.2, 2.5 }; // fan time constants (seconds)
+  static const unsigned int refs [ ] = { 1200, 2200 };    // speeds to tune at (rpm)
+  byte                      t, r;
+
+  for ( t = 0; t < sizeof ( taus ) / sizeof ( taus [ 0 ] ); t++ )
+    for ( r = 0; r < sizeof ( refs ) / sizeof ( refs [ 0 ] ); r++ )
+      tuneCase ( taus [ t ], refs [ r ] );
+
+  failCase ( 3400, LOW );  // above full speed, so the fan never settles
+  failCase ( 1500, HIGH ); // fan stops responding once the relay starts, so the relay never switches
+
+  return testResult ( "relayTuneTest" );
+}
@@ -0,0 +1,67 @@
+/*
+ * Arduino.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+
+/* Host stand-in for the Arduino core, with just enough of it for the
+ * modules the tests build.  Time is simulated: it only moves on when the
+ * code under test waits, or when a test calls shimAdvanceUs(). */
+
+#ifndef ARDUINO_H_
+#define ARDUINO_H_
+
+/*******************************************************************************
+ * INCLUDED HEADER FILES
+ ******************************************************************************/
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/pgmspace.h>
+
+/*******************************************************************************
+ * MACRO DEFINITIONS
+ ******************************************************************************/
+#define HIGH   1
+#define LOW    0
+#define INPUT  0
+#define OUTPUT 1
+#define A0     14
+#define A1     15
+#define A2     16
+#define A3     17
+#define A4     18
+#define A5     19
+
+#define SHIM_PINS 20 // number of pins, digital and analog
+
+#define constrain( amt, low, high ) ( ( amt ) < ( low ) ? ( low ) : ( ( amt ) > ( high ) ? ( high ) : ( amt ) ) )
+
+/*******************************************************************************
+ * TYPE DEFINITIONS
+ ******************************************************************************/
+typedef uint8_t byte;
+typedef bool    boolean;
+
+/*******************************************************************************
+ * EXTERNAL VARIABLE DECLARATIONS
+ ******************************************************************************/
+extern uint8_t shimPinLevel [ SHIM_PINS ]; // level last written to each pin
+extern uint8_t shimPinMode [ SHIM_PINS ];  // mode last set for each pin
+
+/*******************************************************************************
+ * FUNCTION DECLARATIONS
+ ******************************************************************************/
+unsigned long micros ( void );                     // returns the simulated time (microseconds)
+unsigned long millis ( void );                     // returns the simulated time (milliseconds)
+void          delayMicroseconds ( unsigned int us ); // moves the simulated time on
+void          delay ( unsigned long ms );          // moves the simulated time on
+void          digitalWrite ( uint8_t pin, uint8_t val );
+void          pinMode ( uint8_t pin, uint8_t mode );
+void          shimAdvanceUs ( unsigned long us );  // moves the simulated time on, as if the code had run for a while
+
+#endif /* ARDUINO_H_ */
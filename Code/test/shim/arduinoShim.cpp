@@ -0,0 +1,91 @@
+/*
+ * arduinoShim.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+
+/*******************************************************************************
+ * INCLUDED HEADER FILES
+ ******************************************************************************/
+#include "Arduino.h"
+#include <avr/sleep.h>
+
+/*******************************************************************************
+ * GLOBAL VARIABLE DEFINITIONS
+ ******************************************************************************/
+shimReg8  SREG   = { SREG_I, 0, 0 }; // status register, interrupts enabled
+shimReg8  TCCR0A = { 0, 0, 0 };      // timer0 control A
+shimReg8  TCCR0B = { 0, 0, 0 };      // timer0 control B
+shimReg8  TIFR0  = { 0, 0, 0 };      // timer0 interrupt flags
+shimReg8  TIMSK0 = { 0, 0, 0 };      // timer0 interrupt enables
+shimReg8  TCNT0  = { 0, 0, 0 };      // timer0 count
+shimReg8  OCR0A  = { 0, 0, 0 };      // timer0 compare A
+shimReg8  OCR0B  = { 0, 0, 0 };      // timer0 compare B
+shimReg8  TCCR1A = { 0, 0, 0 };      // timer1 control A
+shimReg8  TCCR1B = { 0, 0, 0 };      // timer1 control B
+shimReg8  TIFR1  = { 0, 0, 0 };      // timer1 interrupt flags
+shimReg8  TIMSK1 = { 0, 0, 0 };      // timer1 interrupt enables
+shimReg16 TCNT1  = { 0, 0, 0 };      // timer1 count
+shimReg16 OCR1A  = { 0, 0, 0 };      // timer1 compare A
+shimReg16 ICR1   = { 0, 0, 0 };      // timer1 input capture
+shimReg8  ADMUX  = { 0, 0, 0 };      // ADC multiplexer selection
+shimReg8  ADCSRA = { 0, 0, 0 };      // ADC control and status A
+shimReg8  ADCSRB = { 0, 0, 0 };      // ADC control and status B
+shimReg8  DIDR0  = { 0, 0, 0 };      // analog pin digital input disables
+shimReg16 ADC    = { 0, 0, 0 };      // ADC result
+shimReg8  DDRC   = { 0, 0, 0 };      // port C data direction
+shimReg8  PORTC  = { 0, 0, 0 };      // port C output latch
+shimReg8  PINC   = { 0xFF, 0, 0 };   // port C inputs (pulled high)
+
+uint8_t shimPinLevel [ SHIM_PINS ]; // level last written to each pin
+uint8_t shimPinMode [ SHIM_PINS ];  // mode last set for each pin
+
+uint8_t shimSleepMode;             // sleep mode last set
+uint8_t shimSleepEnabled;          // high while sleeping is enabled
+void ( *shimSleepHook ) ( void ); // runs in place of sleeping, if set
+
+/*******************************************************************************
+ * STATIC VARIABLE DEFINITIONS
+ ******************************************************************************/
+static unsigned long shimTimeUs; // simulated time (microseconds)
+
+/*******************************************************************************
+ * FUNCTION DEFINITIONS
+ ******************************************************************************/
+unsigned long micros ( void )
+{
+  return shimTimeUs;
+}
+
+unsigned long millis ( void )
+{
+  return shimTimeUs / 1000UL;
+}
+
+void delayMicroseconds ( unsigned int us )
+{
+  shimTimeUs += us;
+}
+
+void delay ( unsigned long ms )
+{
+  shimTimeUs += ms * 1000UL;
+}
+
+void shimAdvanceUs ( unsigned long us )
+{
+  shimTimeUs += us;
+}
+
+void digitalWrite ( uint8_t pin, uint8_t val )
+{
+  if ( pin < SHIM_PINS )
+    shimPinLevel [ pin ] = val;
+}
+
+void pinMode ( uint8_t pin, uint8_t mode )
+{
+  if ( pin < SHIM_PINS )
+    shimPinMode [ pin ] = mode;
+}
@@ -0,0 +1,31 @@
+/*
+ * interrupt.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+
+/* Host stand-in for the interrupt control of the ATmega328P.  There are no
+ * interrupts on the host, so these only keep the global interrupt flag in
+ * SREG up to date, for tests to check.  An ISR becomes a plain function of
+ * the vector's name, which a test calls where the interrupt would fire. */
+
+#ifndef AVR_INTERRUPT_H_
+#define AVR_INTERRUPT_H_
+
+#include <avr/io.h>
+
+/*******************************************************************************
+ * MACRO DEFINITIONS
+ ******************************************************************************/
+#define SREG_I 0x80 // global interrupt enable bit of SREG
+
+#define ISR( vect ) void vect ( void )
+
+/*******************************************************************************
+ * FUNCTION DEFINITIONS
+ ******************************************************************************/
+inline void cli ( void ) { SREG &= (uint8_t) ~SREG_I; }
+inline void sei ( void ) { SREG |= SREG_I; }
+
+#endif /* AVR_INTERRUPT_H_ */
@@ -0,0 +1,125 @@
+/*
+ * io.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+
+/* Host stand-in for the ATmega328P registers the tested modules use.  Each
+ * register can be given hooks, so a test can model the hardware behind it
+ * (a timer counting behind TCNT1, for instance). */
+
+#ifndef AVR_IO_H_
+#define AVR_IO_H_
+
+#include <stdint.h>
+
+/*******************************************************************************
+ * MACRO DEFINITIONS
+ ******************************************************************************/
+#define _BV( b ) ( 1 << ( b ) )
+
+/* Timer0 register bits */
+#define WGM00  0 // TCCR0A
+#define WGM01  1
+#define COM0B0 4
+#define COM0B1 5
+#define COM0A0 6
+#define COM0A1 7
+#define CS00   0 // TCCR0B
+#define CS01   1
+#define CS02   2
+#define WGM02  3
+#define TOIE0  0 // TIMSK0
+#define TOV0   0 // TIFR0
+#define OCF0A  1
+#define OCF0B  2
+
+/* Timer1 register bits */
+#define CS10   0 // TCCR1B
+#define CS11   1
+#define ICES1  6
+#define ICNC1  7
+#define TOIE1  0 // TIMSK1
+#define OCIE1A 1
+#define ICIE1  5
+#define TOV1   0 // TIFR1
+#define OCF1A  1
+#define ICF1   5
+
+/* Port C register bits */
+#define DDC4   4 // DDRC
+#define PORTC4 4 // PORTC
+#define PINC4  4 // PINC
+
+/* ADC register bits */
+#define ADPS0  0 // ADCSRA
+#define ADPS1  1
+#define ADPS2  2
+#define ADIE   3
+#define ADIF   4
+#define ADATE  5
+#define ADSC   6
+#define ADEN   7
+#define REFS0  6 // ADMUX
+#define REFS1  7
+
+/*******************************************************************************
+ * CLASS DECLARATIONS
+ ******************************************************************************/
+
+/*
+ * Class:		shimReg
+ * Function:	NA
+ * Scope:		global
+ * Arguments:	NA
+ * Description:	An 8 or 16-bit register.  Reads come from readHook if one
+ *				is set, and writes are passed on to writeHook if one is set.
+ */
+template <typename T>
+class shimReg
+{
+public:
+T val;                        // value last written
+T ( *readHook ) ( void );     // gives the value read, if set
+void ( *writeHook ) ( T val ); // told of each value written, if set
+
+operator T ( ) const { return readHook ? readHook ( ) : val; }
+shimReg &operator= ( T v ) { val = v; if ( writeHook ) writeHook ( v ); return *this; }
+template <typename V> shimReg &operator|= ( V v ) { return *this = (T) ( val | v ); }
+template <typename V> shimReg &operator&= ( V v ) { return *this = (T) ( val & v ); }
+template <typename V> shimReg &operator^= ( V v ) { return *this = (T) ( val ^ v ); }
+template <typename V> shimReg &operator+= ( V v ) { return *this = (T) ( val + v ); }
+};
+
+typedef shimReg<uint8_t>  shimReg8;
+typedef shimReg<uint16_t> shimReg16;
+
+/*******************************************************************************
+ * EXTERNAL VARIABLE DECLARATIONS
+ ******************************************************************************/
+extern shimReg8  SREG;
+extern shimReg8  TCCR0A;
+extern shimReg8  TCCR0B;
+extern shimReg8  TIFR0;
+extern shimReg8  TIMSK0;
+extern shimReg8  TCNT0;
+extern shimReg8  OCR0A;
+extern shimReg8  OCR0B;
+extern shimReg8  TCCR1A;
+extern shimReg8  TCCR1B;
+extern shimReg8  TIFR1;
+extern shimReg8  TIMSK1;
+extern shimReg16 TCNT1;
+extern shimReg16 OCR1A;
+extern shimReg16 ICR1;
+extern shimReg8  ADMUX;
+extern shimReg8  ADCSRA;
+extern shimReg8  ADCSRB;
+extern shimReg8  DIDR0;
+extern shimReg16 ADC;
+extern shimReg8  DDRC;
+extern shimReg8  PORTC;
+extern shimReg8  PINC;
+
+#endif /* AVR_IO_H_ */
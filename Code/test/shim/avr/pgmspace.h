@@ -0,0 +1,20 @@
+/*
+ * pgmspace.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+
+/* Host stand-in for the flash access of the ATmega328P.  Flash and RAM
+ * share one address space on the host, so the reads are plain reads. */
+
+#ifndef AVR_PGMSPACE_H_
+#define AVR_PGMSPACE_H_
+
+#define PROGMEM
+#define PSTR( s )            ( s )
+#define pgm_read_byte( a )  ( *( a ) )
+#define pgm_read_word( a )  ( *( a ) )
+#define pgm_read_dword( a ) ( *( a ) )
+
+#endif /* AVR_PGMSPACE_H_ */
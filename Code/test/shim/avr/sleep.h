@@ -0,0 +1,37 @@
+/*
+ * sleep.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+
+/* Host stand-in for the sleep modes of the ATmega328P.  Sleeping calls
+ * shimSleepHook, if a test has set one, which stands for the time passing
+ * and the interrupt which wakes the core. */
+
+#ifndef AVR_SLEEP_H_
+#define AVR_SLEEP_H_
+
+#include <stdint.h>
+
+/*******************************************************************************
+ * MACRO DEFINITIONS
+ ******************************************************************************/
+#define SLEEP_MODE_IDLE 0
+
+/*******************************************************************************
+ * EXTERNAL VARIABLE DECLARATIONS
+ ******************************************************************************/
+extern uint8_t shimSleepMode;             // sleep mode last set
+extern uint8_t shimSleepEnabled;          // high while sleeping is enabled
+extern void ( *shimSleepHook ) ( void ); // runs in place of sleeping, if set
+
+/*******************************************************************************
+ * FUNCTION DEFINITIONS
+ ******************************************************************************/
+inline void set_sleep_mode ( uint8_t mode ) { shimSleepMode = mode; }
+inline void sleep_enable ( void ) { shimSleepEnabled = 1; }
+inline void sleep_disable ( void ) { shimSleepEnabled = 0; }
+inline void sleep_cpu ( void ) { if ( shimSleepHook ) shimSleepHook ( ); }
+
+#endif /* AVR_SLEEP_H_ */
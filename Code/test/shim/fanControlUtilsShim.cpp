@@ -0,0 +1,21 @@
+/*
+ * fanControlUtilsShim.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+
+/* Host stand-in for the globals of fanControlUtils which the fan channels
+ * read, without the LCD and buttons behind them.  Tests set them directly. */
+
+/*******************************************************************************
+ * INCLUDED HEADER FILES
+ ******************************************************************************/
+#include "fanControlUtils.h"
+
+/*******************************************************************************
+ * GLOBAL VARIABLE DEFINITIONS
+ ******************************************************************************/
+unsigned int  Temp1     = 0; // Temperature 1 input, stored digitally (0-TEMP_DIG_MAX)
+unsigned int  Temp2     = 0; // Temperature 2 input, stored digitally (0-TEMP_DIG_MAX)
+unsigned long runTime_s = 0; // program run-time since reset (seconds)
@@ -0,0 +1,43 @@
+/*
+ * savedVarsShim.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+
+/* Host stand-in for the saved variables: every variable in the table,
+ * set to its default, with no EEPROM behind them. */
+
+/*******************************************************************************
+ * INCLUDED HEADER FILES
+ ******************************************************************************/
+#include "savedVars.h"
+
+/*******************************************************************************
+ * EEPROM-STORED GLOBAL VARIABLE DEFINITIONS
+ ******************************************************************************/
+#define SAVEDVARDEF( a, b, c, d, e, f ) b c a = f;
+SAVEDVARLIST
+#undef SAVEDVARDEF
+
+/*******************************************************************************
+ * GLOBAL VARIABLE DEFINITIONS
+ ******************************************************************************/
+unsigned char savedVarsGen; // changes whenever a saved variable is loaded or saved
+
+/*******************************************************************************
+ * FUNCTION DEFINITIONS
+ ******************************************************************************/
+int loadVar ( void *varPtr )
+{
+  savedVarsGen++;
+
+  return SAVEVAR_SUCCESS;
+}
+
+int saveVar ( void *varPtr )
+{
+  savedVarsGen++;
+
+  return SAVEVAR_SUCCESS;
+}
@@ -0,0 +1,249 @@
+/*
+ * sysTimerTest.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+
+/* Runs the loop tick of sysTimer against a model of timer1 on a simulated
+ * clock.  Each tick must be scheduled exactly SYSTICK_CNTS timer counts
+ * after the one before, however long the loop took or the tick interrupt
+ * was held off, and across every wrap of the 16-bit counter.
+ * sysTimerWaitTick() must sleep with interrupts on, only when no tick is
+ * pending, go back to sleep when some other interrupt wakes the core, and
+ * count the ticks missed by an overrun (up to 255). */
+
+/*******************************************************************************
+ * INCLUDED HEADER FILES
+ ******************************************************************************/
+#include "sysTimer.h"
+#include "timer1Sim.h"
+#include "testUtil.h"
+
+/*******************************************************************************
+ * MACRO DEFINITIONS
+ ******************************************************************************/
+#define TICK_US   ( (unsigned long) SYSTICK_CNTS * SYSTIMER_PRESCALE / ( F_CPU / 1000000UL ) ) // time between ticks (microseconds)
+#define RUN_TICKS 2000                                                                      // ticks in each run of the loop
+#define START_US  1234                                                                      // time the timer is started, off the timer's count boundaries (microseconds)
+
+/*******************************************************************************
+ * FUNCTION DECLARATIONS
+ ******************************************************************************/
+ISR ( TIMER1_COMPA_vect ); // scheduler tick interrupt, in sysTimer.cpp
+
+/*******************************************************************************
+ * STATIC VARIABLE DEFINITIONS
+ ******************************************************************************/
+static unsigned long long firstCnt; // timer count of the first tick
+static unsigned long      ticks;    // ticks counted by sysTimerWaitTick() since the first
+
+/*******************************************************************************
+ * FUNCTION DEFINITIONS
+ ******************************************************************************/
+
+/******************************************************************************
+* Function:
+*   waitTick()
+*
+* Description:
+*   Waits for the next tick, checks interrupts are back on afterwards, and
+*   counts the ticks
+*
+* Arguments:
+*   none
+*
+* Returns:
+*   got - ticks returned by sysTimerWaitTick()
+******************************************************************************/
+static byte waitTick ( void )
+{
+  byte got = sysTimerWaitTick ( ); // ticks since the last wait
+
+  TEST_CHECK ( SREG & SREG_I );
+  TEST_EQUAL ( shimSleepMode, SLEEP_MODE_IDLE );
+  TEST_EQUAL ( shimSleepEnabled, LOW );
+  ticks += got;
+
+  return got;
+} // end of waitTick()
+
+/******************************************************************************
+* Function:
+*   checkSleep()
+*
+* Description:
+*   Sleep hook which checks the core only sleeps with sleeping enabled and
+*   interrupts on, as it would otherwise never wake, then sleeps.  One time
+*   in three, some other interrupt (a hall edge, say) wakes the core part
+*   way to the tick.
+*
+* Arguments:
+*   none
+*
+* Returns:
+*   none
+******************************************************************************/
+static void checkSleep ( void )
+{
+  unsigned long toTick = (uint16_t) ( OCR1A - TCNT1 ); // timer counts to the next tick
+
+  TEST_CHECK ( SREG & SREG_I );
+  TEST_CHECK ( shimSleepEnabled );
+  toTick = toTick * SYSTIMER_PRESCALE / ( F_CPU / 1000000UL ); // in microseconds
+  if ( ( toTick > 1 ) && ( testRandom ( 3 ) == 0 ) )
+  {
+    timer1Sim.sleeps++;
+    timer1SimRun ( testRandom ( toTick - 1 ) );
+  }
+  else
+    timer1SimSleep ( );
+
+  return;
+} // end of checkSleep()
+
+/******************************************************************************
+* Function:
+*   checkSteady()
+*
+* Description:
+*   Runs the loop for a random time short of a tick, after every tick, and
+*   checks each wait sleeps and wakes on the tick.  One time in four, the
+*   loop has interrupts off across the tick instead, holding the tick
+*   interrupt off by up to a millisecond, and the wait returns at once.
+*   The next tick must be scheduled on its count either way, with no drift.
+*
+* Arguments:
+*   none
+*
+* Returns:
+*   none
+******************************************************************************/
+static void checkSteady ( void )
+{
+  unsigned long n;      // tick number
+  unsigned long late;   // ticks which didn't wake or weren't scheduled on their count
+  unsigned long sleeps; // sleeps before the wait
+  unsigned long toTick; // time to the tick (microseconds)
+  byte          held;   // high if the tick interrupt is held off
+  byte          got;    // ticks returned by the wait
+
+  late = 0;
+  for ( n = 1; n <= RUN_TICKS; n++ )
+  {
+    toTick = (unsigned long) ( firstCnt + n * SYSTICK_CNTS - timer1SimCount ( ) ) * SYSTIMER_PRESCALE / ( F_CPU / 1000000UL );
+    held   = ( testRandom ( 4 ) == 0 );
+    if ( held )
+    {
+      cli ( );
+      timer1SimRun ( toTick + testRandom ( 1000 ) );
+      sei ( );
+      timer1SimService ( ); // the held off tick interrupt runs as soon as interrupts are on
+    }
+    else
+      timer1SimRun ( testRandom ( toTick - 100 ) );
+    sleeps = timer1Sim.sleeps;
+    got    = waitTick ( );
+    if ( !TEST_EQUAL ( got, 1 ) )
+      break; // off the tick, so the rest would fail too
+    TEST_EQUAL ( timer1Sim.sleeps > sleeps, !held );
+    if ( !held && ( timer1SimCount ( ) != firstCnt + n * SYSTICK_CNTS ) )
+      late++;
+    if ( OCR1A != (uint16_t) ( firstCnt + ( n + 1 ) * SYSTICK_CNTS ) )
+      late++;
+  }
+  TEST_EQUAL ( late, 0 );
+
+  return;
+} // end of checkSteady()
+
+/******************************************************************************
+* Function:
+*   checkOverrun()
+*
+* Description:
+*   Runs the loop for longer than a tick, by up to five ticks, and checks
+*   the wait returns at once with every tick missed, so the ticks counted
+*   keep up with the timer
+*
+* Arguments:
+*   none
+*
+* Returns:
+*   none
+******************************************************************************/
+static void checkOverrun ( void )
+{
+  unsigned long n;       // loop iteration
+  unsigned long runUs;   // time the loop runs (microseconds)
+  unsigned long sleeps;  // sleeps before the wait
+  unsigned long waitCnt; // timer count before the wait
+  byte          got;     // ticks returned by the wait
+
+  for ( n = 0; n < RUN_TICKS; n++ )
+  {
+    runUs = TICK_US + testRandom ( 5 * TICK_US );
+    timer1SimRun ( runUs );
+    sleeps  = timer1Sim.sleeps;
+    waitCnt = timer1SimCount ( );
+    got     = waitTick ( );
+    TEST_EQUAL ( got, ( waitCnt - firstCnt ) / SYSTICK_CNTS - ( ticks - got ) );
+    TEST_EQUAL ( timer1Sim.sleeps, sleeps ); // a tick was pending, so it didn't sleep
+    waitTick ( );                             // back onto the tick
+  }
+  TEST_EQUAL ( timer1SimCount ( ), firstCnt + ticks * SYSTICK_CNTS );
+
+  return;
+} // end of checkOverrun()
+
+/******************************************************************************
+* Function:
+*   checkSaturate()
+*
+* Description:
+*   Runs the loop for far longer than 255 ticks, and checks the wait
+*   returns 255 rather than a wrapped count
+*
+* Arguments:
+*   none
+*
+* Returns:
+*   none
+******************************************************************************/
+static void checkSaturate ( void )
+{
+  byte got; // ticks returned by the wait
+
+  timer1SimRun ( 300 * TICK_US );
+  got = sysTimerWaitTick ( );
+  TEST_EQUAL ( got, 255 );
+
+  return;
+} // end of checkSaturate()
+
+int main ( void )
+{
+  byte got; // ticks returned by the first wait
+
+  timer1SimInit ( TIMER1_COMPA_vect, NULL );
+  shimSleepHook = checkSleep;
+  shimAdvanceUs ( START_US );
+
+  cli ( );
+  sysTimerInit ( );
+  TEST_CHECK ( !( SREG & SREG_I ) ); // left off, as it was
+  sei ( );
+  TEST_CHECK ( TIMSK1 & _BV ( OCIE1A ) );
+
+  firstCnt = timer1SimCount ( ) + SYSTICK_CNTS;
+  got      = waitTick ( );
+  TEST_EQUAL ( got, 1 );
+  TEST_EQUAL ( timer1SimCount ( ), firstCnt );
+  ticks = 0;
+
+  checkSteady ( );
+  checkOverrun ( );
+  checkSaturate ( );
+
+  return testResult ( "sysTimerTest" );
+}
@@ -0,0 +1,201 @@
+/*
+ * taskSchedTest.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+
+/* Runs the task table through taskSchedRun() on a stream of ticks, with
+ * stand-ins for the tasks which log when they run.  Each task must run on
+ * the ticks given by its period and phase, in table order within a tick,
+ * and only once after an overrun, however many of its ticks were missed,
+ * without losing its phase.  The tasks which are kept out of the control
+ * loop's tick must never share it. */
+
+/*******************************************************************************
+ * INCLUDED HEADER FILES
+ ******************************************************************************/
+#include "taskSched.h"
+#include "testUtil.h"
+
+/*******************************************************************************
+ * MACRO DEFINITIONS
+ ******************************************************************************/
+#define RUN_TICKS 100000 // ticks in each run of the scheduler
+
+/*******************************************************************************
+ * TYPE DEFINITIONS
+ ******************************************************************************/
+/* Index of each task in the table */
+#define TASKDEF( a, b, c ) TASK_##a,
+typedef enum TASK_ENUM
+{
+  TASKLIST
+  NUM_TASKS
+} TASK_ENUM_TYPE;
+#undef TASKDEF
+
+/*******************************************************************************
+ * STATIC VARIABLE DEFINITIONS
+ ******************************************************************************/
+#define TASKDEF( a, b, c ) b,
+static const byte taskPeriod [ NUM_TASKS ] = { TASKLIST }; // period of each task (ticks)
+#undef TASKDEF
+#define TASKDEF( a, b, c ) c,
+static const byte taskPhase [ NUM_TASKS ] = { TASKLIST }; // phase of each task (ticks)
+#undef TASKDEF
+static const byte apartTasks [ ] = { TASK_displayTask, TASK_serialTask, TASK_oneWireTask, TASK_dutyMapTask }; // tasks which must not share the control loop's tick
+
+static byte ran [ NUM_TASKS ]; // order in which each task ran in this call (0 if it didn't)
+static byte numRan;            // tasks run in this call
+
+/*******************************************************************************
+ * FUNCTION DEFINITIONS
+ ******************************************************************************/
+
+/******************************************************************************
+* Function:
+*   taskRan()
+*
+* Description:
+*   Logs a task running
+*
+* Arguments:
+*   task - task which ran
+*
+* Returns:
+*   none
+******************************************************************************/
+static void taskRan ( byte task )
+{
+  TEST_EQUAL ( ran [ task ], 0 ); // once per call at most
+  ran [ task ] = ++numRan;
+
+  return;
+} // end of taskRan()
+
+/* Stand-ins for the tasks */
+#define TASKDEF( a, b, c ) void a ( void ) { taskRan ( TASK_##a ); }
+TASKLIST
+#undef TASKDEF
+
+/******************************************************************************
+* Function:
+*   dueIn()
+*
+* Description:
+*   Says whether a task falls due on any of a run of ticks
+*
+* Arguments:
+*   task - task
+*   first - number of the first tick (0 for the first tick after init)
+*   ticks - number of ticks
+*
+* Returns:
+*   due - high if the task is due on any of the ticks
+******************************************************************************/
+static byte dueIn ( byte task, unsigned long first, byte ticks )
+{
+  unsigned long t;
+
+  for ( t = first; t < first + ticks; t++ )
+    if ( ( t % taskPeriod [ task ] ) == taskPhase [ task ] )
+      return HIGH;
+
+  return LOW;
+} // end of dueIn()
+
+/******************************************************************************
+* Function:
+*   runTicks()
+*
+* Description:
+*   Runs the scheduler from init through a stream of ticks, and checks the
+*   tasks which ran in each call, and their order
+*
+* Arguments:
+*   maxTicks - largest number of ticks in one call (1 for no overruns)
+*
+* Returns:
+*   none
+******************************************************************************/
+static void runTicks ( byte maxTicks )
+{
+  unsigned long first = 0; // number of the first tick of this call
+  unsigned long wrong = 0; // tasks which ran when they shouldn't have, or didn't when they should
+  unsigned long order = 0; // calls in which the tasks ran out of table order
+  byte          ticks;     // ticks in this call
+  byte          task, last;
+
+  taskSchedInit ( );
+  while ( first < RUN_TICKS )
+  {
+    ticks = 1;
+    if ( ( maxTicks > 1 ) && ( testRandom ( 4 ) == 0 ) )
+      ticks += testRandom ( maxTicks );
+    memset ( ran, 0, sizeof ( ran ) );
+    numRan = 0;
+    taskSchedRun ( ticks );
+
+    for ( task = 0, last = 0; task < NUM_TASKS; task++ )
+    {
+      if ( ( ran [ task ] != 0 ) != dueIn ( task, first, ticks ) )
+        wrong++;
+      if ( ran [ task ] != 0 )
+      {
+        if ( ran [ task ] < last )
+          order++;
+        last = ran [ task ];
+      }
+    }
+    first += ticks;
+  }
+  TEST_EQUAL ( wrong, 0 );
+  TEST_EQUAL ( order, 0 );
+
+  return;
+} // end of runTicks()
+
+/******************************************************************************
+* Function:
+*   checkTable()
+*
+* Description:
+*   Checks each phase is within its period, and that no task kept out of
+*   the control loop's tick ever falls due on it
+*
+* Arguments:
+*   none
+*
+* Returns:
+*   none
+******************************************************************************/
+static void checkTable ( void )
+{
+  unsigned long t;
+  byte          task, i;
+
+  for ( task = 0; task < NUM_TASKS; task++ )
+    TEST_CHECK ( taskPhase [ task ] < taskPeriod [ task ] );
+
+  for ( i = 0; i < sizeof ( apartTasks ); i++ )
+    for ( t = 0; t < RUN_TICKS; t++ )
+      if ( dueIn ( TASK_controlTask, t, 1 ) && dueIn ( apartTasks [ i ], t, 1 ) )
+      {
+        TEST_CHECK ( !"task shares the control loop's tick" );
+        printf ( "  task %u, tick %lu\n", apartTasks [ i ], t );
+        break;
+      }
+
+  return;
+} // end of checkTable()
+
+int main ( void )
+{
+  checkTable ( );
+  runTicks ( 1 );
+  runTicks ( 3 );
+  runTicks ( 255 );
+
+  return testResult ( "taskSchedTest" );
+}
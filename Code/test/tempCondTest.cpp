@@ -0,0 +1,317 @@
+/*
+ * tempCondTest.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+
+/* Checks the conditioning stage of a temperature sensor.  The median must
+ * be that of the newest tmpMedN readings, or of all of them while the
+ * history is still filling, for every tmpMedN, and a single spike must
+ * never get through.  The filter must start from the first reading and
+ * settle exactly on a new level, up or down, however slow it is set.
+ *
+ * A reading past tmpMinRaw or tmpMaxRaw, or more than tmpMaxStep from the
+ * last, must fault the sensor on that loop, counted once, with the output
+ * held at the last good filtered value for as long as it stays faulted.
+ * The fault must clear on exactly the TEMPCOND_CLEAR_LOOPS-th good reading
+ * in a row, with the filter restarted from the reading, and a bad reading
+ * part way through must start the count again. */
+
+/*******************************************************************************
+ * INCLUDED HEADER FILES
+ ******************************************************************************/
+#include "tempCond.h"
+#include "savedVars.h"
+#include "testUtil.h"
+
+/*******************************************************************************
+ * MACRO DEFINITIONS
+ ******************************************************************************/
+#define MEDIAN_RUNS  2000 // random runs of the median check for each tmpMedN
+#define MEDIAN_LOOPS 12   // readings in each run
+#define LEVEL        2000 // steady raw temperature
+#define SETTLE_LOOPS 200  // control loops allowed to settle, for a filter gain of up to 768
+#define CRAWL_LOOPS  8192 // control loops allowed to settle, for the slowest filter gains
+
+/*******************************************************************************
+ * STATIC VARIABLE DEFINITIONS
+ ******************************************************************************/
+static TEMP_COND_TYPE cond; // conditioning stage under test
+static unsigned int   out;  // last output of the stage
+
+/*******************************************************************************
+ * FUNCTION DEFINITIONS
+ ******************************************************************************/
+
+/******************************************************************************
+* Function:
+*   restart()
+*
+* Description:
+*   Starts the stage afresh, as at power up
+*
+* Arguments:
+*   medN - number of readings to take the median of
+*   filt - filter gain
+*
+* Returns:
+*   none
+******************************************************************************/
+static void restart ( unsigned int medN, unsigned int filt )
+{
+  memset ( &cond, 0, sizeof ( cond ) );
+  tmpMedN = medN;
+  tmpFilt = filt;
+
+  return;
+} // end of restart()
+
+/******************************************************************************
+* Function:
+*   expectRun()
+*
+* Description:
+*   Updates the stage with the same reading a number of times, and checks
+*   the output and the fault flag are as expected after every update
+*
+* Arguments:
+*   raw - raw reading
+*   expOut - output expected
+*   expFault - fault flag expected
+*   loops - number of updates
+*
+* Returns:
+*   none
+******************************************************************************/
+static void expectRun ( unsigned int raw, unsigned int expOut, byte expFault, unsigned int loops )
+{
+  unsigned int wrong = 0; // updates which didn't match
+  unsigned int loop;
+
+  for ( loop = 0; loop < loops; loop++ )
+  {
+    out = tempCondUpdate ( &cond, raw );
+    if ( ( ( out != expOut ) || ( tempCondFault ( &cond ) != expFault ) ) && ( wrong++ == 0 ) )
+      printf ( "  loop %u of %u of %u: out %u, fault %u\n", loop, loops, raw, out, tempCondFault ( &cond ) );
+  }
+  TEST_EQUAL ( wrong, 0 );
+
+  return;
+} // end of expectRun()
+
+/******************************************************************************
+* Function:
+*   checkMedian()
+*
+* Description:
+*   Feeds random runs of readings with the filter off, so the output is the
+*   median, and checks it against a sort of the newest readings, including
+*   while the history is filling.  The readings stay close enough together
+*   not to fault.
+*
+* Arguments:
+*   none
+*
+* Returns:
+*   none
+******************************************************************************/
+static void checkMedian ( void )
+{
+  unsigned int  readings [ MEDIAN_LOOPS ]; // readings of this run
+  unsigned int  sorted [ TEMPCOND_MED_MAX ];
+  unsigned long wrong = 0;                 // outputs which weren't the median
+  unsigned int  medN, num, val;
+  unsigned int  run, loop, i, j;
+
+  for ( medN = 1; medN <= TEMPCOND_MED_MAX; medN++ )
+  {
+    for ( run = 0; run < MEDIAN_RUNS; run++ )
+    {
+      restart ( medN, 0 );
+      for ( loop = 0; loop < MEDIAN_LOOPS; loop++ )
+      {
+        readings [ loop ] = LEVEL + testRandom ( tmpMaxStep / 2 );
+        out               = tempCondUpdate ( &cond, readings [ loop ] );
+
+        num = ( loop + 1 < medN ) ? loop + 1 : medN;
+        for ( i = 0; i < num; i++ )
+        {
+          val = readings [ loop - i ];
+          for ( j = i; ( j > 0 ) && ( sorted [ j - 1 ] > val ); j-- )
+            sorted [ j ] = sorted [ j - 1 ];
+          sorted [ j ] = val;
+        }
+        if ( ( ( out != sorted [ num / 2 ] ) || tempCondFault ( &cond ) ) && ( wrong++ == 0 ) )
+          printf ( "  tmpMedN %u, loop %u: out %u, median %u\n", medN, loop, out, sorted [ num / 2 ] );
+      }
+    }
+  }
+  TEST_EQUAL ( wrong, 0 );
+
+  /* A single spike, either way, doesn't get through a median of 3 */
+  restart ( 3, 0 );
+  expectRun ( LEVEL, LEVEL, LOW, 5 );
+  expectRun ( TEMP_DIG_MAX, LEVEL, LOW, 1 );
+  expectRun ( LEVEL, LEVEL, LOW, 2 );
+  expectRun ( 0, LEVEL, LOW, 1 );
+  expectRun ( LEVEL, LEVEL, LOW, 2 );
+  TEST_EQUAL ( cond.faults, 0 );
+
+  return;
+} // end of checkMedian()
+
+/******************************************************************************
+* Function:
+*   settleTo()
+*
+* Description:
+*   Ramps the reading to a new level in allowed steps, then holds it there,
+*   and checks the output moves monotonically and settles exactly on it
+*
+* Arguments:
+*   from - level the stage is settled at
+*   to - new level
+*   maxLoops - most control loops the output may take to settle
+*
+* Returns:
+*   none
+******************************************************************************/
+static void settleTo ( unsigned int from, unsigned int to, unsigned int maxLoops )
+{
+  unsigned int backwards = 0;    // outputs which moved away from the new level
+  unsigned int last      = from; // output of the loop before
+  unsigned int raw       = from; // reading
+  unsigned int loop;
+
+  for ( loop = 0; ( loop < maxLoops ) && ( out != to ); loop++ )
+  {
+    if ( raw != to )
+      raw = ( to > raw ) ? ( ( to - raw > tmpMaxStep ) ? raw + tmpMaxStep : to ) :
+        ( ( raw - to > tmpMaxStep ) ? raw - tmpMaxStep : to );
+    out = tempCondUpdate ( &cond, raw );
+    if ( ( to > from ) ? ( out < last ) : ( out > last ) )
+      backwards++;
+    last = out;
+  }
+  if ( out != to )
+    printf ( "  tmpFilt %u: %u to %u stalled at %u\n", tmpFilt, from, to, out );
+  TEST_EQUAL ( out, to );
+  TEST_EQUAL ( backwards, 0 );
+  expectRun ( to, to, LOW, 10 ); // and stays there
+
+  return;
+} // end of settleTo()
+
+/******************************************************************************
+* Function:
+*   checkFilter()
+*
+* Description:
+*   Checks the filter starts from the first reading, and settles exactly on
+*   a rise and a fall, for every setting up to the slowest
+*
+* Arguments:
+*   none
+*
+* Returns:
+*   none
+******************************************************************************/
+static void checkFilter ( void )
+{
+  static const unsigned int filts [ ] = { 0, 512, 768, 1000, 1022, 1023 }; // filter gains tried
+  static const unsigned int rises [ ] = { 1, 15, 40, 300 };                // changes of level tried
+  byte                      i, j;
+
+  for ( i = 0; i < sizeof ( filts ) / sizeof ( filts [ 0 ] ); i++ )
+  {
+    restart ( 1, filts [ i ] );
+    expectRun ( LEVEL, LEVEL, LOW, 1 ); // first reading starts the filter
+    for ( j = 0; j < sizeof ( rises ) / sizeof ( rises [ 0 ] ); j++ )
+    {
+      settleTo ( LEVEL, LEVEL + rises [ j ], ( filts [ i ] <= 768 ) ? SETTLE_LOOPS : CRAWL_LOOPS );
+      settleTo ( LEVEL + rises [ j ], LEVEL, ( filts [ i ] <= 768 ) ? SETTLE_LOOPS : CRAWL_LOOPS );
+    }
+  }
+  TEST_EQUAL ( cond.faults, 0 );
+
+  return;
+} // end of checkFilter()
+
+/******************************************************************************
+* Function:
+*   checkFaults()
+*
+* Description:
+*   Faults the sensor with each of the checks in turn, and clears it
+*
+* Arguments:
+*   none
+*
+* Returns:
+*   none
+******************************************************************************/
+static void checkFaults ( void )
+{
+  unsigned int held; // output held while faulted
+
+  /* The limits themselves are good readings */
+  restart ( 1, 0 );
+  expectRun ( tmpMinRaw, tmpMinRaw, LOW, 1 );
+  restart ( 1, 0 );
+  expectRun ( tmpMaxRaw, tmpMaxRaw, LOW, 1 );
+  TEST_EQUAL ( cond.faults, 0 );
+
+  /* Open sensor, part way through a slew, held at the last good output.
+   * The reading back from the rail is a step, and then it takes
+   * TEMPCOND_CLEAR_LOOPS good ones, with the filter restarting there. */
+  restart ( 1, 768 );
+  expectRun ( LEVEL, LEVEL, LOW, 1 );
+  expectRun ( LEVEL + tmpMaxStep, LEVEL + tmpMaxStep / 4, LOW, 1 );
+  held = out;
+  expectRun ( tmpMinRaw - 1, held, HIGH, 50 );
+  TEST_EQUAL ( cond.faults, 1 );
+  expectRun ( LEVEL + tmpMaxStep, held, HIGH, 1 );                       // step back from the rail
+  expectRun ( LEVEL + tmpMaxStep, held, HIGH, TEMPCOND_CLEAR_LOOPS - 1 );
+  expectRun ( LEVEL + tmpMaxStep, LEVEL + tmpMaxStep, LOW, 1 );          // cleared, from the reading
+  TEST_EQUAL ( cond.faults, 1 );
+
+  /* Shorted sensor, with a bad reading part way through clearing */
+  held = out;
+  expectRun ( tmpMaxRaw + 1, held, HIGH, 1 );
+  expectRun ( LEVEL, held, HIGH, 1 );
+  expectRun ( LEVEL, held, HIGH, TEMPCOND_CLEAR_LOOPS / 2 );
+  expectRun ( TEMP_DIG_MAX, held, HIGH, 1 );
+  expectRun ( LEVEL, held, HIGH, 1 );
+  expectRun ( LEVEL, held, HIGH, TEMPCOND_CLEAR_LOOPS - 1 );
+  expectRun ( LEVEL, LEVEL, LOW, 1 );
+  TEST_EQUAL ( cond.faults, 2 );
+
+  /* A step of tmpMaxStep is allowed, one more isn't.  Staying at the new
+   * level clears the fault. */
+  expectRun ( LEVEL - tmpMaxStep, LEVEL - tmpMaxStep / 4, LOW, 1 );
+  held = out;
+  expectRun ( LEVEL + 1, held, HIGH, 1 );
+  expectRun ( LEVEL + 1, held, HIGH, TEMPCOND_CLEAR_LOOPS - 1 );
+  expectRun ( LEVEL + 1, LEVEL + 1, LOW, 1 );
+  TEST_EQUAL ( cond.faults, 3 );
+
+  /* A sensor open from power up starts its filter when it clears */
+  restart ( 3, 768 );
+  expectRun ( 0, 0, HIGH, 10 );
+  expectRun ( LEVEL, 0, HIGH, 2 );                        // median up, a step
+  expectRun ( LEVEL, 0, HIGH, TEMPCOND_CLEAR_LOOPS - 1 );
+  expectRun ( LEVEL, LEVEL, LOW, 1 );
+  TEST_EQUAL ( cond.faults, 1 );
+
+  return;
+} // end of checkFaults()
+
+int main ( void )
+{
+  checkMedian ( );
+  checkFilter ( );
+  checkFaults ( );
+
+  return testResult ( "tempCondTest" );
+}
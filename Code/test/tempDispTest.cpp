@@ -0,0 +1,122 @@
+/*
+ * tempDispTest.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+
+/* Checks the cached display conversion against the DigTempXToC10() and
+ * DigTempXToF10() macros, which stay as the reference.  Every digital
+ * temperature code is converted for each sensor, in both units, with a
+ * grid of offsets and gains (the limits, zero, one either side of the
+ * rounding points of the offset divide, and the defaults) and with random
+ * ones.  The result must equal the macro exactly, and the whole and tenth
+ * parts from tempDispSplit() must equal "/ 10" and "abs ( ) % 10" of it,
+ * as the LCD screens printed them, up to the TEMPDISP_MAX_X10 clamp.
+ * Changing the settings between conversions must rebuild the cache. */
+
+/*******************************************************************************
+ * INCLUDED HEADER FILES
+ ******************************************************************************/
+#include "tempDisp.h"
+#include "savedVars.h"
+#include "testUtil.h"
+
+/*******************************************************************************
+ * MACRO DEFINITIONS
+ ******************************************************************************/
+#define RANDOM_PAIRS 200 // random offset and gain pairs checked
+
+/*******************************************************************************
+ * STATIC VARIABLE DEFINITIONS
+ ******************************************************************************/
+static const int gridOfs [ ]  = { -5000, -2500, -501, -500, -499, -137, -1, 0, 1, 122, 123, 499, 500, 501, 1234, 4999, 5000 }; // offsets tried (mV at 0 degC)
+static const int gridGain [ ] = { -5000, -250, -7, -1, 0, 1, 7, 100, 249, 250, 251, 333, 1000, 4999, 5000 };                  // gains tried (degC per 5 V)
+
+static unsigned long wrongX10;   // conversions which didn't match the macro
+static unsigned long wrongSplit; // splits which didn't match the macro
+static unsigned long clamped;    // conversions past the split clamp
+
+/*******************************************************************************
+ * FUNCTION DEFINITIONS
+ ******************************************************************************/
+
+/******************************************************************************
+* Function:
+*   checkSetting()
+*
+* Description:
+*   Sets both sensors to an offset and gain, and checks every digital
+*   temperature code of each in both units
+*
+* Arguments:
+*   ofs - sensor offset
+*   gain - sensor gain
+*
+* Returns:
+*   none
+******************************************************************************/
+static void checkSetting ( int ofs, int gain )
+{
+  unsigned int raw;    // digital temperature
+  int          expX10; // temperature times 10 from the macro
+  int          gotX10; // temperature times 10 from the cache
+  int          mag;    // magnitude of expX10, clamped as the split does
+  int          whole;  // whole part from the split
+  byte         tenth;  // tenths from the split
+  byte         sensor;
+
+  Temp1Offset    = ofs;
+  Temp1DegCPer5V = gain;
+  Temp2Offset    = -ofs; // a different setting on each, to catch the sensors crossed
+  Temp2DegCPer5V = gain;
+
+  for ( useFtemp = 0; useFtemp <= 1; useFtemp++ )
+  {
+    for ( raw = 0; raw <= TEMP_DIG_MAX; raw++ )
+    {
+      for ( sensor = 0; sensor < TEMPDISP_NUM; sensor++ )
+      {
+        if ( sensor == TEMPDISP_1 )
+          expX10 = useFtemp ? DigTemp1ToF10 ( raw ) : DigTemp1ToC10 ( raw );
+        else
+          expX10 = useFtemp ? DigTemp2ToF10 ( raw ) : DigTemp2ToC10 ( raw );
+
+        gotX10 = tempDispX10 ( (TEMPDISP_ENUM_TYPE) sensor, raw );
+        if ( ( gotX10 != expX10 ) && ( wrongX10++ < 5 ) )
+          printf ( "  sensor %u, ofs %d, gain %d, useFtemp %u, raw %u: %d, macro %d\n", sensor + 1, ofs, gain, useFtemp, raw, gotX10, expX10 );
+
+        tempDispSplit ( (TEMPDISP_ENUM_TYPE) sensor, raw, &whole, &tenth );
+        mag = abs ( expX10 );
+        if ( mag > TEMPDISP_MAX_X10 )
+        {
+          mag = TEMPDISP_MAX_X10;
+          clamped++;
+        }
+        if ( ( ( whole != ( ( expX10 < 0 ) ? -mag : mag ) / 10 ) || ( tenth != mag % 10 ) ) && ( wrongSplit++ < 5 ) )
+          printf ( "  sensor %u, ofs %d, gain %d, useFtemp %u, raw %u: %d.%u, macro %d\n", sensor + 1, ofs, gain, useFtemp, raw, whole, tenth, expX10 );
+      }
+    }
+  }
+
+  return;
+} // end of checkSetting()
+
+int main ( void )
+{
+  unsigned int i, j;
+
+  for ( i = 0; i < sizeof ( gridOfs ) / sizeof ( gridOfs [ 0 ] ); i++ )
+    for ( j = 0; j < sizeof ( gridGain ) / sizeof ( gridGain [ 0 ] ); j++ )
+      checkSetting ( gridOfs [ i ], gridGain [ j ] );
+  for ( i = 0; i < sizeof ( gridOfs ) / sizeof ( gridOfs [ 0 ] ); i++ )
+    checkSetting ( gridOfs [ i ], 250 ); // only the offset changes
+  for ( i = 0; i < RANDOM_PAIRS; i++ )
+    checkSetting ( (int) testRandom ( 10001 ) - 5000, (int) testRandom ( 10001 ) - 5000 );
+
+  TEST_EQUAL ( wrongX10, 0 );
+  TEST_EQUAL ( wrongSplit, 0 );
+  TEST_CHECK ( clamped > 0 ); // the clamp was reached
+
+  return testResult ( "tempDispTest" );
+}
@@ -0,0 +1,106 @@
+/*
+ * testUtil.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+
+#ifndef TESTUTIL_H_
+#define TESTUTIL_H_
+
+/*******************************************************************************
+ * INCLUDED HEADER FILES
+ ******************************************************************************/
+#include <stdio.h>
+
+/*******************************************************************************
+ * MACRO DEFINITIONS
+ ******************************************************************************/
+#define TEST_CHECK( cond ) \
+  /* Counts a check, and reports it if the condition is false */ \
+  testCheck ( ( cond ) ? 1 : 0, #cond, 0, 0, __FILE__, __LINE__ )
+#define TEST_EQUAL( a, b ) \
+  /* Counts a check, and reports both values if they differ */ \
+  testCheck ( ( ( a ) == ( b ) ) ? 1 : 0, #a " == " #b, (long long) ( a ), (long long) ( b ), __FILE__, __LINE__ )
+
+/*******************************************************************************
+ * STATIC VARIABLE DEFINITIONS
+ ******************************************************************************/
+static unsigned long       testChecks;          // number of checks made
+static unsigned long       testFails;           // number of checks which failed
+static const unsigned long testMaxReports = 20; // failures reported in full, so a broken sweep doesn't flood the output
+static unsigned long       testSeed       = 1;  // state of the pseudo-random number generator
+
+/*******************************************************************************
+ * FUNCTION DEFINITIONS
+ ******************************************************************************/
+
+/******************************************************************************
+* Function:
+*   testCheck()
+*
+* Description:
+*   Counts a check, and reports it if it failed
+*
+* Arguments:
+*   pass - nonzero if the check passed
+*   what - text of the check
+*   a, b - values compared (reported if the check failed)
+*   file, line - where the check is
+*
+* Returns:
+*   pass - nonzero if the check passed
+******************************************************************************/
+static inline int testCheck ( int pass, const char *what, long long a, long long b, const char *file, int line )
+{
+  testChecks++;
+  if ( !pass && ( testFails++ < testMaxReports ) )
+    printf ( "%s:%d: FAILED %s (%lld, %lld)\n", file, line, what, a, b );
+
+  return pass;
+} // end of testCheck()
+
+/******************************************************************************
+* Function:
+*   testRandom()
+*
+* Description:
+*   Returns a pseudo-random number, the same sequence on every host
+*   (32-bit xorshift)
+*
+* Arguments:
+*   range - number of values to pick from
+*
+* Returns:
+*   val - number from 0 to range - 1
+******************************************************************************/
+static inline unsigned long testRandom ( unsigned long range )
+{
+  testSeed ^= ( testSeed << 13 ) & 0xFFFFFFFFUL;
+  testSeed ^= testSeed >> 17;
+  testSeed ^= ( testSeed << 5 ) & 0xFFFFFFFFUL;
+
+  return testSeed % range;
+} // end of testRandom()
+
+/******************************************************************************
+* Function:
+*   testResult()
+*
+* Description:
+*   Prints the totals of a test program, and returns its exit status
+*
+* Arguments:
+*   name - name of the test program
+*
+* Returns:
+*   status - 0 if every check passed, 1 if not
+******************************************************************************/
+static inline int testResult ( const char *name )
+{
+  printf ( "%s: %lu checks, %lu failed\n", name, testChecks, testFails );
+
+  return ( testFails == 0 ) ? 0 : 1;
+} // end of testResult()
+
+#endif /* TESTUTIL_H_ */
@@ -0,0 +1,185 @@
+/*
+ * timeBaseTest.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+
+/* Checks the time base against a model of timer1 on a simulated clock.
+ * The uptime clock must match the exact time after weeks of ticks.  The
+ * extended timer1 counts, and the microsecond clocks made from them, must
+ * match the true count at random reads across the wraps of the 16-bit
+ * counter, the 32-bit count (36 minutes) and the 32-bit microsecond clock
+ * (71 minutes), with reads made while an overflow is still pending too.
+ * TIME_ELAPSED() must give the true interval across those wraps.
+ *
+ * long is 64 bits on the host, so the 32-bit values don't wrap by
+ * themselves here.  They are cut to 32 bits, as they are on the target,
+ * before being checked.  For the same reason the overflow count doesn't
+ * wrap into the epoch on the host, and that carry isn't checked. */
+
+/*******************************************************************************
+ * INCLUDED HEADER FILES
+ ******************************************************************************/
+#include "timeBase.h"
+#include "timer1Sim.h"
+#include "testUtil.h"
+
+/*******************************************************************************
+ * MACRO DEFINITIONS
+ ******************************************************************************/
+#define UPTIME_TICKS ( 1UL << 27 ) // scheduler ticks run through the uptime clock (about 19 days)
+#define WRAP_CNTS    0x10000ULL    // timer1 counts between overflows
+#define WRAP_US      ( WRAP_CNTS / SYSTIMER_CNTS_PER_US ) // time between overflows (microseconds)
+#define RUN_WRAPS    40            // overflows run through at each starting point
+#define HOLD_MAX_US  16000         // longest time interrupts are held off, under half an overflow, as the pending overflow check needs (microseconds)
+
+/*******************************************************************************
+ * FUNCTION DECLARATIONS
+ ******************************************************************************/
+ISR ( TIMER1_COMPA_vect ); // scheduler tick interrupt, in sysTimer.cpp
+ISR ( TIMER1_OVF_vect );   // overflow interrupt, in sysTimer.cpp
+
+/*******************************************************************************
+ * STATIC VARIABLE DEFINITIONS
+ ******************************************************************************/
+static unsigned long long extraCnt; // true count less the model's count, from overflows counted without the model
+
+/*******************************************************************************
+ * FUNCTION DEFINITIONS
+ ******************************************************************************/
+
+/******************************************************************************
+* Function:
+*   checkUptime()
+*
+* Description:
+*   Advances the uptime clock by runs of up to 255 ticks, and checks it
+*   against the exact time after each
+*
+* Arguments:
+*   none
+*
+* Returns:
+*   none
+******************************************************************************/
+static void checkUptime ( void )
+{
+  unsigned long long total = 0; // ticks so far
+  unsigned long      wrong = 0; // runs after which the clock was wrong
+  byte               ticks;     // ticks in this run
+
+  while ( total < UPTIME_TICKS )
+  {
+    ticks  = 1 + testRandom ( 255 );
+    total += ticks;
+    timeBaseTick ( ticks );
+    if ( ( timeBaseUptimeSubUs ( ) >= TIMEBASE_US_PER_SEC ) ||
+         ( (unsigned long long) timeBaseUptimeSec ( ) * TIMEBASE_US_PER_SEC + timeBaseUptimeSubUs ( ) != total * SYSTICK_US ) )
+      wrong++;
+  }
+  TEST_EQUAL ( wrong, 0 );
+
+  return;
+} // end of checkUptime()
+
+/******************************************************************************
+* Function:
+*   skipTo()
+*
+* Description:
+*   Runs the overflow interrupt without the model, as if the timer had run
+*   for a while, to bring the count to half a run short of a wrap quickly
+*
+* Arguments:
+*   wrapOvf - overflow count at the wrap
+*
+* Returns:
+*   none
+******************************************************************************/
+static void skipTo ( unsigned long long wrapOvf )
+{
+  unsigned long long num = wrapOvf - RUN_WRAPS / 2 - ( sysTimerCount64 ( ) >> 16 ); // overflows to skip
+
+  extraCnt += num * WRAP_CNTS;
+  while ( num-- > 0 )
+    TIMER1_OVF_vect ( );
+
+  return;
+} // end of skipTo()
+
+/******************************************************************************
+* Function:
+*   checkWraps()
+*
+* Description:
+*   Runs the model through a number of overflows, reading the time at
+*   random, sometimes with interrupts held off across an overflow, and
+*   checks each read against the true count
+*
+* Arguments:
+*   none
+*
+* Returns:
+*   none
+******************************************************************************/
+static void checkWraps ( void )
+{
+  unsigned long long endCnt   = timer1SimCount ( ) + RUN_WRAPS * WRAP_CNTS; // model count to stop at
+  unsigned long long lastCnt  = 0;                                          // true count at the last read
+  unsigned long long sinceCnt = timer1SimCount ( ) + extraCnt;              // true count at the timestamp
+  unsigned long      since    = timeBaseNow ( );                            // timestamp to measure intervals from
+  unsigned long      wrong    = 0;                                          // reads which didn't match
+  unsigned long long cnt;                                                   // true count
+
+  while ( timer1SimCount ( ) < endCnt )
+  {
+    if ( testRandom ( 4 ) == 0 )
+    {
+      cli ( ); // read while an overflow may be pending
+      timer1SimRun ( testRandom ( HOLD_MAX_US ) );
+    }
+    else
+      timer1SimRun ( testRandom ( WRAP_US / 3 ) );
+
+    cnt = timer1SimCount ( ) + extraCnt;
+    if ( ( sysTimerCount64 ( ) != cnt ) || ( cnt < lastCnt ) ||
+         ( (unsigned long) (uint32_t) sysTimerCount ( ) != (uint32_t) cnt ) ||
+         ( (unsigned long) (uint32_t) timeBaseNow ( ) != (uint32_t) cnt ) ||
+         ( timeBaseMicros64 ( ) != cnt / SYSTIMER_CNTS_PER_US ) ||
+         ( (unsigned long) (uint32_t) timeBaseMicros ( ) != (uint32_t) ( cnt / SYSTIMER_CNTS_PER_US ) ) ||
+         ( (unsigned long) (uint32_t) TIME_ELAPSED ( (uint32_t) timeBaseNow ( ), (uint32_t) since ) != cnt - sinceCnt ) )
+    {
+      if ( wrong++ == 0 )
+        printf ( "  count %llu read as %llu\n", cnt, sysTimerCount64 ( ) );
+    }
+    lastCnt = cnt;
+    sei ( );
+    timer1SimService ( ); // a pending overflow runs as soon as interrupts are on
+
+    if ( testRandom ( 8 ) == 0 ) // measure from here on
+    {
+      since    = timeBaseNow ( );
+      sinceCnt = timer1SimCount ( ) + extraCnt;
+    }
+  }
+  TEST_EQUAL ( wrong, 0 );
+
+  return;
+} // end of checkWraps()
+
+int main ( void )
+{
+  timer1SimInit ( TIMER1_COMPA_vect, TIMER1_OVF_vect );
+  sysTimerInit ( );
+
+  checkUptime ( );
+
+  checkWraps ( );        // from power-up
+  skipTo ( 0x10000ULL ); // 32-bit count wraps (36 minutes)
+  checkWraps ( );
+  skipTo ( 0x20000ULL ); // 32-bit microsecond clock wraps (71 minutes)
+  checkWraps ( );
+
+  return testResult ( "timeBaseTest" );
+}
@@ -0,0 +1,73 @@
+/*
+ * timer0Sim.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+
+#ifndef TIMER0SIM_H_
+#define TIMER0SIM_H_
+
+/*******************************************************************************
+ * INCLUDED HEADER FILES
+ ******************************************************************************/
+#include "Arduino.h"
+
+/*******************************************************************************
+ * MACRO DEFINITIONS
+ ******************************************************************************/
+#define TIMER0_SIM_READ_CYCLES 5 // cpu cycles taken by each pass of a loop polling TCNT0
+
+/*******************************************************************************
+ * TYPE DEFINITIONS
+ ******************************************************************************/
+/* Model of timer0 behind TCNT0, as pwmOut sets it up: counting at the cpu
+ * clock, from 0 to 0xFF.  It keeps its own clock in cpu cycles, finer than
+ * the shim's microseconds, and each read of TCNT0 moves it on by the time
+ * a polling loop takes, so code waiting on the count finishes. */
+typedef struct TIMER0_SIM {
+  unsigned long long cycles; // cpu cycles since time zero
+  unsigned long      reads;  // reads of TCNT0
+} TIMER0_SIM_TYPE;
+
+/*******************************************************************************
+ * STATIC VARIABLE DEFINITIONS
+ ******************************************************************************/
+static TIMER0_SIM_TYPE timer0Sim; // the model of timer0
+
+/*******************************************************************************
+ * FUNCTION DEFINITIONS
+ ******************************************************************************/
+
+/* Read hook of TCNT0 */
+static inline uint8_t timer0SimReadCnt ( void )
+{
+  uint8_t cnt = (uint8_t) timer0Sim.cycles; // count now
+
+  timer0Sim.cycles += TIMER0_SIM_READ_CYCLES;
+  timer0Sim.reads++;
+
+  return cnt;
+} // end of timer0SimReadCnt()
+
+/******************************************************************************
+* Function:
+*   timer0SimInit()
+*
+* Description:
+*   Puts the model behind TCNT0
+*
+* Arguments:
+*   none
+*
+* Returns:
+*   none
+******************************************************************************/
+static inline void timer0SimInit ( void )
+{
+  TCNT0.readHook = timer0SimReadCnt;
+
+  return;
+} // end of timer0SimInit()
+
+#endif /* TIMER0SIM_H_ */
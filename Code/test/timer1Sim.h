@@ -0,0 +1,268 @@
+/*
+ * timer1Sim.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: agent
+ */
+
+#ifndef TIMER1SIM_H_
+#define TIMER1SIM_H_
+
+/*******************************************************************************
+ * INCLUDED HEADER FILES
+ ******************************************************************************/
+#include "Arduino.h"
+#include "sysTimer.h"
+#include <avr/interrupt.h>
+#include <avr/sleep.h>
+
+/*******************************************************************************
+ * TYPE DEFINITIONS
+ ******************************************************************************/
+/* Model of timer1 behind its registers.  It counts up from time zero at
+ * SYSTIMER_PRESCALE cpu cycles per count, raises the compare A and overflow
+ * flags as it passes OCR1A and wraps, latches ICR1 on the edges the test
+ * gives it, and runs the interrupt of each flag whose enable is set, in
+ * vector order, while interrupts are on.  The interrupts are given by the
+ * test, as the modules under test define them. */
+typedef struct TIMER1_SIM {
+  void ( *capt ) ( void );  // input capture interrupt (TIMER1_CAPT_vect), or none
+  void ( *compA ) ( void ); // compare A interrupt (TIMER1_COMPA_vect)
+  void ( *ovf ) ( void );   // overflow interrupt (TIMER1_OVF_vect), or none
+  byte flags;               // raised interrupt flags (as in TIFR1)
+  unsigned long isrs;       // interrupts run
+  unsigned long sleeps;     // times the core went to sleep
+} TIMER1_SIM_TYPE;
+
+/*******************************************************************************
+ * STATIC VARIABLE DEFINITIONS
+ ******************************************************************************/
+static TIMER1_SIM_TYPE timer1Sim; // the model of timer1
+
+/*******************************************************************************
+ * FUNCTION DEFINITIONS
+ ******************************************************************************/
+
+/******************************************************************************
+* Function:
+*   timer1SimCount()
+*
+* Description:
+*   Returns the count of timer1 since time zero, without wrapping
+*
+* Arguments:
+*   none
+*
+* Returns:
+*   count - timer1 counts since time zero
+******************************************************************************/
+static inline unsigned long long timer1SimCount ( void )
+{
+  return (unsigned long long) micros ( ) * ( F_CPU / 1000000UL ) / SYSTIMER_PRESCALE;
+} // end of timer1SimCount()
+
+static inline uint16_t timer1SimReadCnt ( void ) { return (uint16_t) timer1SimCount ( ); }
+static inline uint8_t  timer1SimReadFlags ( void ) { return timer1Sim.flags; }
+static inline void     timer1SimWriteFlags ( uint8_t val ) { timer1Sim.flags &= (uint8_t) ~val; } // writing a one clears the flag
+
+/******************************************************************************
+* Function:
+*   timer1SimService()
+*
+* Description:
+*   Runs the interrupt of each raised flag whose enable is set, if
+*   interrupts are on, clearing the flag as the hardware does.  Interrupts
+*   are off while each one runs.
+*
+* Arguments:
+*   none
+*
+* Returns:
+*   serviced - high if any interrupt ran
+******************************************************************************/
+static inline byte timer1SimService ( void )
+{
+  byte serviced = LOW; // high once an interrupt has run
+
+  while ( SREG & SREG_I )
+  {
+    if ( ( timer1Sim.flags & _BV ( ICF1 ) ) && ( TIMSK1 & _BV ( ICIE1 ) ) && timer1Sim.capt )
+    {
+      timer1Sim.flags &= (uint8_t) ~_BV ( ICF1 );
+      cli ( );
+      timer1Sim.capt ( );
+      sei ( );
+      timer1Sim.isrs++;
+    }
+    else if ( ( timer1Sim.flags & _BV ( OCF1A ) ) && ( TIMSK1 & _BV ( OCIE1A ) ) && timer1Sim.compA )
+    {
+      timer1Sim.flags &= (uint8_t) ~_BV ( OCF1A );
+      cli ( );
+      timer1Sim.compA ( );
+      sei ( );
+      timer1Sim.isrs++;
+    }
+    else if ( ( timer1Sim.flags & _BV ( TOV1 ) ) && ( TIMSK1 & _BV ( TOIE1 ) ) && timer1Sim.ovf )
+    {
+      timer1Sim.flags &= (uint8_t) ~_BV ( TOV1 );
+      cli ( );
+      timer1Sim.ovf ( );
+      sei ( );
+      timer1Sim.isrs++;
+    }
+    else
+      break;
+    serviced = HIGH;
+  }
+
+  return serviced;
+} // end of timer1SimService()
+
+/******************************************************************************
+* Function:
+*   timer1SimNext()
+*
+* Description:
+*   Moves the time on to the next compare match or overflow, if it comes
+*   before a time limit, raises its flag and runs any interrupts due
+*
+* Arguments:
+*   endUs - time limit (microseconds)
+*
+* Returns:
+*   event - high if there was an event before the limit
+******************************************************************************/
+static inline byte timer1SimNext ( unsigned long endUs )
+{
+  unsigned long long cnt   = timer1SimCount ( );                     // count now
+  unsigned long      toCmp = (uint16_t) ( OCR1A - (uint16_t) cnt ); // counts to the next compare match
+  unsigned long      toOvf = 0x10000UL - (uint16_t) cnt;            // counts to the next overflow
+  unsigned long      step;                                          // counts to the next event
+  unsigned long long at;                                            // time of the next event (microseconds)
+
+  if ( toCmp == 0 ) // matched at this count already, so next time round
+    toCmp = 0x10000UL;
+  step = ( toCmp < toOvf ) ? toCmp : toOvf;
+  at   = ( ( cnt + step ) * SYSTIMER_PRESCALE + F_CPU / 1000000UL - 1 ) / ( F_CPU / 1000000UL ); // first microsecond at the count
+  if ( at > endUs )
+    return LOW;
+
+  shimAdvanceUs ( (unsigned long) at - micros ( ) );
+  if ( step == toCmp )
+    timer1Sim.flags |= _BV ( OCF1A );
+  if ( step == toOvf )
+    timer1Sim.flags |= _BV ( TOV1 );
+  timer1SimService ( );
+
+  return HIGH;
+} // end of timer1SimNext()
+
+/******************************************************************************
+* Function:
+*   timer1SimEdge()
+*
+* Description:
+*   Gives the input capture unit an edge on the ICP1 pin now.  If it is in
+*   the direction selected by ICES1, the count is latched into ICR1, the
+*   capture flag is raised, and the interrupt runs if it can.  The noise
+*   canceller's fixed delay of 4 cpu cycles is left out.
+*
+* Arguments:
+*   rising - high for a rising edge, low for a falling one
+*
+* Returns:
+*   none
+******************************************************************************/
+static inline void timer1SimEdge ( byte rising )
+{
+  if ( ( ( TCCR1B & _BV ( ICES1 ) ) != 0 ) == ( rising != LOW ) )
+  {
+    ICR1             = (uint16_t) timer1SimCount ( );
+    timer1Sim.flags |= _BV ( ICF1 );
+    timer1SimService ( );
+  }
+
+  return;
+} // end of timer1SimEdge()
+
+/******************************************************************************
+* Function:
+*   timer1SimRun()
+*
+* Description:
+*   Moves the time on, as if the core ran code for a while, running the
+*   timer interrupts as they fall due (if interrupts are on)
+*
+* Arguments:
+*   us - time the code runs for (microseconds)
+*
+* Returns:
+*   none
+******************************************************************************/
+static inline void timer1SimRun ( unsigned long us )
+{
+  unsigned long endUs = micros ( ) + us; // time the code finishes
+
+  timer1SimService ( );
+  while ( timer1SimNext ( endUs ) )
+    ;
+  shimAdvanceUs ( endUs - micros ( ) );
+
+  return;
+} // end of timer1SimRun()
+
+/******************************************************************************
+* Function:
+*   timer1SimSleep()
+*
+* Description:
+*   Sleeps until an interrupt runs.  Used as shimSleepHook.  If no
+*   interrupt is enabled, it gives up after a few wraps of the timer, as
+*   the core would never wake.
+*
+* Arguments:
+*   none
+*
+* Returns:
+*   none
+******************************************************************************/
+static inline void timer1SimSleep ( void )
+{
+  unsigned long isrs = timer1Sim.isrs; // interrupts run before sleeping
+  byte          events;                // events while asleep
+
+  timer1Sim.sleeps++;
+  timer1SimService ( );
+  for ( events = 0; ( timer1Sim.isrs == isrs ) && ( events < 10 ); events++ )
+    timer1SimNext ( (unsigned long) -1 );
+
+  return;
+} // end of timer1SimSleep()
+
+/******************************************************************************
+* Function:
+*   timer1SimInit()
+*
+* Description:
+*   Puts the model behind the timer1 registers
+*
+* Arguments:
+*   compA - compare A interrupt
+*   ovf - overflow interrupt, or NULL for none
+*
+* Returns:
+*   none
+******************************************************************************/
+static inline void timer1SimInit ( void ( *compA ) ( void ), void ( *ovf ) ( void ) )
+{
+  timer1Sim.compA = compA;
+  timer1Sim.ovf   = ovf;
+  TCNT1.readHook  = timer1SimReadCnt;
+  TIFR1.readHook  = timer1SimReadFlags;
+  TIFR1.writeHook = timer1SimWriteFlags;
+  shimSleepHook   = timer1SimSleep;
+
+  return;
+} // end of timer1SimInit()
+
+#endif /* TIMER1SIM_H_ */